@@ -0,0 +1,517 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Evaluates a (potentially very large) list of parameter sets with one of the
+ * evaluation methods. The parameter sets are streamed from a binary file
+ * (consecutive records of Parameters::Size float32 values) or a JSON-lines
+ * file (one object per line mapping parameter ids to values, missing values
+ * are taken from the base parameters). The base parameters, the spike train
+ * and the environment are read from a ParameterCollection JSON file if given,
+ * otherwise the defaults are used. The parameter sets are evaluated in
+ * parallel, the results are written in input order either as binary float32
+ * records or as CSV. Malformed lines result in the default (worst) result, so
+ * the n-th output record always belongs to the n-th input record.
+ */
+
+#include <exploration/SpikeTrainEvaluation.hpp>
+#include <exploration/SingleGroupSingleOutEvaluation.hpp>
+#include <exploration/SingleGroupMultiOutEvaluation.hpp>
+#include <common/Timer.hpp>
+#include <utils/ParameterCollection.hpp>
+#include <io/JsonIo.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace AdExpSim;
+
+/**
+ * Maximum number of parameter sets which are read ahead of the evaluation.
+ */
+static constexpr size_t INPUT_QUEUE_SIZE = 4096;
+
+/**
+ * Maximum number of results which may be pending in the reorder buffer. Workers
+ * block once they get ahead of the writer by this number of items.
+ */
+static constexpr size_t REORDER_BUFFER_SIZE = 4096;
+
+/**
+ * SIGINT handler. Sets the global "cancel" flag to true when called once,
+ * terminates the program if called twice. This allows to terminate the program,
+ * even if it is not responsive (the cancel flag is not checked).
+ */
+static std::atomic<bool> cancel(false);
+void int_handler(int)
+{
+	if (cancel) {
+		exit(1);
+	}
+	cancel = true;
+}
+
+static bool endsWith(const std::string &s, const std::string &suffix)
+{
+	return s.size() >= suffix.size() &&
+	       s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * Parses a single line of a JSON-lines file. Only flat objects mapping
+ * parameter ids (as in Parameters::nameIds) to numbers are supported. Returns
+ * false if the line is empty or malformed.
+ */
+static bool parseJsonLine(const std::string &line, Parameters &params)
+{
+	const char *p = line.c_str();
+	auto skipWs = [&p]() {
+		while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+			p++;
+		}
+	};
+
+	skipWs();
+	if (*p != '{') {
+		return false;
+	}
+	p++;
+	while (true) {
+		skipWs();
+		if (*p == '}') {
+			return true;
+		}
+		if (*p != '"') {
+			return false;
+		}
+		const char *keyStart = ++p;
+		while (*p && *p != '"') {
+			p++;
+		}
+		if (!*p) {
+			return false;
+		}
+		const std::string key(keyStart, p - keyStart);
+		p++;
+		skipWs();
+		if (*p != ':') {
+			return false;
+		}
+		p++;
+		char *end;
+		const double value = strtod(p, &end);
+		if (end == p) {
+			return false;
+		}
+		p = end;
+
+		auto it = std::find(Parameters::nameIds.begin(),
+		                    Parameters::nameIds.end(), key);
+		if (it != Parameters::nameIds.end()) {
+			params[it - Parameters::nameIds.begin()] = value;
+		}
+
+		skipWs();
+		if (*p == ',') {
+			p++;
+		} else if (*p != '}') {
+			return false;
+		}
+	}
+}
+
+/**
+ * Parameter set read from the input together with a flag indicating whether
+ * it could be parsed.
+ */
+struct InputParameters {
+	Parameters params;
+	bool valid = true;
+};
+
+/**
+ * Reads parameter sets from either a binary or a JSON-lines stream.
+ */
+class ParameterReader {
+private:
+	std::istream &is;
+	bool jsonl;
+	Parameters base;
+	size_t line;
+
+public:
+	ParameterReader(std::istream &is, bool jsonl, const Parameters &base)
+	    : is(is), jsonl(jsonl), base(base), line(0)
+	{
+	}
+
+	/**
+	 * Reads the next parameter set, returns false if the end of the stream has
+	 * been reached. Malformed lines are returned as invalid input, so the
+	 * sequence numbers of the following records are not shifted.
+	 */
+	bool read(InputParameters &in)
+	{
+		Parameters &params = in.params;
+		params = base;
+		in.valid = true;
+		if (!jsonl) {
+			float buf[Parameters::Size];
+			if (!is.read(reinterpret_cast<char *>(buf), sizeof(buf))) {
+				return false;
+			}
+			for (size_t i = 0; i < Parameters::Size; i++) {
+				params[i] = buf[i];
+			}
+			return true;
+		}
+
+		std::string s;
+		while (std::getline(is, s)) {
+			line++;
+			if (s.find_first_not_of(" \t\r") == std::string::npos) {
+				continue;
+			}
+			if (!parseJsonLine(s, params)) {
+				std::cerr << "Malformed line " << line
+				          << ", writing the default result" << std::endl;
+				in.valid = false;
+			}
+			return true;
+		}
+		return false;
+	}
+};
+
+/**
+ * Bounded, blocking single-producer multi-consumer queue containing the
+ * parameter sets together with their sequence number.
+ */
+class InputQueue {
+private:
+	std::vector<InputParameters> buf;
+	size_t head, tail;
+	bool closed;
+	std::mutex mutex;
+	std::condition_variable notEmpty, notFull;
+
+public:
+	InputQueue(size_t capacity)
+	    : buf(capacity), head(0), tail(0), closed(false)
+	{
+	}
+
+	void push(const InputParameters &params)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notFull.wait(lock, [this] { return tail - head < buf.size(); });
+		buf[tail % buf.size()] = params;
+		tail++;
+		notEmpty.notify_one();
+	}
+
+	void close()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		closed = true;
+		notEmpty.notify_all();
+	}
+
+	bool pop(size_t &seq, InputParameters &params)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notEmpty.wait(lock, [this] { return head < tail || closed; });
+		if (head == tail) {
+			return false;
+		}
+		seq = head;
+		params = buf[head % buf.size()];
+		head++;
+		notFull.notify_one();
+		return true;
+	}
+};
+
+/**
+ * Bounded reorder buffer. Workers insert results with their sequence number,
+ * the writer fetches them in sequence order. Workers which are too far ahead
+ * of the writer are blocked until the writer catches up.
+ */
+class ReorderBuffer {
+private:
+	std::vector<EvaluationResult> buf;
+	std::vector<bool> filled;
+	size_t next;
+	bool done;
+	std::mutex mutex;
+	std::condition_variable notFull, available;
+
+public:
+	ReorderBuffer(size_t capacity)
+	    : buf(capacity), filled(capacity, false), next(0), done(false)
+	{
+	}
+
+	void push(size_t seq, EvaluationResult &&res)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notFull.wait(lock, [this, seq] { return seq < next + buf.size(); });
+		buf[seq % buf.size()] = std::move(res);
+		filled[seq % buf.size()] = true;
+		if (seq == next) {
+			available.notify_one();
+		}
+	}
+
+	/**
+	 * Marks the end of the result stream. All workers must have finished.
+	 */
+	void finish()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		done = true;
+		available.notify_all();
+	}
+
+	/**
+	 * Fetches the next result in sequence order. Waits at most 100ms, returns
+	 * false if no result is available.
+	 */
+	bool pop(EvaluationResult &res, bool &finished)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		available.wait_for(lock, std::chrono::milliseconds(100), [this] {
+			return filled[next % buf.size()] || done;
+		});
+		finished = false;
+		if (!filled[next % buf.size()]) {
+			finished = done;
+			return false;
+		}
+		res = std::move(buf[next % buf.size()]);
+		filled[next % buf.size()] = false;
+		next++;
+		notFull.notify_all();
+		return true;
+	}
+};
+
+/**
+ * Writes a single result either as binary or as CSV record.
+ */
+static void writeResult(std::ostream &os, bool csv, const EvaluationResult &res)
+{
+	if (csv) {
+		for (size_t i = 0; i < res.size(); i++) {
+			os << (i > 0 ? "," : "") << res[i];
+		}
+		os << "\n";
+	} else {
+		os.write(reinterpret_cast<const char *>(res.data()),
+		         res.size() * sizeof(Val));
+	}
+}
+
+template <typename Evaluation>
+static size_t runBatch(const Evaluation &evaluation, ParameterReader &reader,
+                       std::ostream &os, bool csv)
+{
+	const EvaluationResultDescriptor &descr = evaluation.descriptor();
+	if (csv) {
+		for (size_t i = 0; i < descr.size(); i++) {
+			os << (i > 0 ? "," : "") << descr.id(i);
+		}
+		os << "\n";
+	}
+
+	InputQueue input(INPUT_QUEUE_SIZE);
+	ReorderBuffer output(REORDER_BUFFER_SIZE);
+
+	// Reader thread, reads the parameters and pushes them into the input
+	// queue, blocks if the queue is full
+	std::thread readerThread([&]() {
+		InputParameters in;
+		while (!cancel && reader.read(in)) {
+			input.push(in);
+		}
+		input.close();
+	});
+
+	// Worker threads, evaluate the parameter sets
+	auto worker = [&]() {
+		size_t seq;
+		InputParameters in;
+		while (input.pop(seq, in)) {
+			WorkingParameters wp(in.params);
+			EvaluationResult res(descr.size());
+			if (!cancel && in.valid && wp.valid()) {
+				wp.update();
+				evaluation.evaluateInto(wp, res.data());
+			} else {
+				res = descr.defaultResult();
+			}
+			output.push(seq, std::move(res));
+		}
+	};
+	const size_t nThreads =
+	    std::max<size_t>(1, std::thread::hardware_concurrency());
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < nThreads; i++) {
+		workers.emplace_back(worker);
+	}
+	std::thread finisher([&]() {
+		for (auto &thread : workers) {
+			thread.join();
+		}
+		output.finish();
+	});
+
+	// Write the results in order
+	size_t count = 0;
+	EvaluationResult res;
+	bool finished = false;
+	while (!finished) {
+		// Keep draining the buffer after a cancel to unblock the workers, but
+		// do not write any further results
+		if (output.pop(res, finished) && !cancel) {
+			writeResult(os, csv, res);
+			if ((++count % 1000) == 0) {
+				std::cerr << "Evaluated " << count << " parameter sets\r";
+			}
+		}
+	}
+
+	readerThread.join();
+	finisher.join();
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	signal(SIGINT, int_handler);
+
+	// Read the optional parameter collection, all other arguments are
+	// positional
+	std::vector<std::string> args;
+	std::string configFile;
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--config" && i + 1 < argc) {
+			configFile = argv[++i];
+		} else {
+			args.emplace_back(argv[i]);
+		}
+	}
+
+	if (args.size() != 4) {
+		std::cout << "Evaluates a list of parameter sets in parallel."
+		          << std::endl;
+		std::cout << "Usage: " << argv[0]
+		          << " [--config <CONFIG>] <MODEL> <EVALUATION> "
+		             "<PARAMETERS_IN> <RESULTS_OUT>" << std::endl;
+		std::cout << "CONFIG is a JSON file as stored by the GUI, it provides "
+		          << "the base parameters, the spike train and the environment"
+		          << std::endl;
+		std::cout << "MODEL is one of IfCondExp, AdIfCondExp" << std::endl;
+		std::cout << "EVALUATION is one of Train, SgSo, SgMo" << std::endl;
+		std::cout << "PARAMETERS_IN is a JSON-lines file (*.jsonl) or a "
+		          << "binary file containing " << Parameters::Size
+		          << " float32 values per parameter set" << std::endl;
+		std::cout << "RESULTS_OUT is a CSV file (*.csv) or a binary file "
+		          << "containing one float32 record per parameter set"
+		          << std::endl;
+		return 1;
+	}
+
+	// Load the parameter collection
+	ParameterCollection pc;
+	if (!configFile.empty()) {
+		std::ifstream cs(configFile);
+		if (!cs.good() || !JsonIo::loadParameters(cs, pc)) {
+			std::cerr << "Error while reading " << configFile << std::endl;
+			return 1;
+		}
+	}
+
+	// Parse the model and evaluation type
+	auto model = std::find(ParameterCollection::modelNames.begin(),
+	                       ParameterCollection::modelNames.end(), args[0]);
+	auto evaluation =
+	    std::find(ParameterCollection::evaluationNames.begin(),
+	              ParameterCollection::evaluationNames.end(), args[1]);
+	if (model == ParameterCollection::modelNames.end() ||
+	    evaluation == ParameterCollection::evaluationNames.end()) {
+		std::cerr << "Invalid model or evaluation name" << std::endl;
+		return 1;
+	}
+	pc.model = ModelType(model - ParameterCollection::modelNames.begin());
+	pc.evaluation = EvaluationType(
+	    evaluation - ParameterCollection::evaluationNames.begin());
+	const bool useIfCondExp = pc.model == ModelType::IF_COND_EXP;
+
+	// Open the input and output files
+	const std::string inFile = args[2], outFile = args[3];
+	const bool jsonl = endsWith(inFile, ".jsonl") || endsWith(inFile, ".json");
+	const bool csv = endsWith(outFile, ".csv");
+	std::ifstream is(inFile, jsonl ? std::ios::in : std::ios::binary);
+	std::ofstream os(outFile, csv ? std::ios::out : std::ios::binary);
+	if (!is.good() || !os.good()) {
+		std::cerr << "Error while opening the input or output file"
+		          << std::endl;
+		return 1;
+	}
+	ParameterReader reader(is, jsonl, pc.params);
+
+	Timer timer;
+	size_t count = 0;
+	switch (pc.evaluation) {
+		case EvaluationType::SPIKE_TRAIN:
+			count = runBatch(SpikeTrainEvaluation(pc.train, useIfCondExp),
+			                 reader, os, csv);
+			break;
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			count = runBatch(SingleGroupSingleOutEvaluation(
+			                     pc.environment, pc.singleGroup, useIfCondExp),
+			                 reader, os, csv);
+			break;
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			count = runBatch(SingleGroupMultiOutEvaluation(
+			                     pc.environment, pc.singleGroup, useIfCondExp),
+			                 reader, os, csv);
+			break;
+	}
+	timer.pause();
+
+	std::cerr << std::endl;
+	std::cout << "Evaluated " << count << " parameter sets" << std::endl;
+	std::cout << timer << std::endl;
+	if (cancel) {
+		std::cout << "Manually aborted batch evaluation" << std::endl;
+		return 1;
+	}
+	return 0;
+}
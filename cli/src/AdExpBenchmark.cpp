@@ -0,0 +1,831 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file AdExpBenchmark.cpp
+ *
+ * Benchmark suite covering the performance critical parts of the simulator:
+ * the simulation with each integrator and flag set, the evaluation measures,
+ * the fractional spike count, the exploration (for an increasing number of
+ * threads) and the time the optimization needs to reach a certain target
+ * value. All fixtures are built from fixed seeds and the default parameters,
+ * so the numbers of two runs (e.g. of two different releases) can be directly
+ * compared. The results can be written as JSON or CSV file.
+ *
+ * @author Andreas Stöckel
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <exploration/Exploration.hpp>
+#include <exploration/FractionalSpikeCount.hpp>
+#include <exploration/Optimization.hpp>
+#include <exploration/SingleGroupMultiOutEvaluation.hpp>
+#include <exploration/SingleGroupSingleOutEvaluation.hpp>
+#include <exploration/SpikeTrainEvaluation.hpp>
+#include <simulation/Controller.hpp>
+#include <simulation/DormandPrinceIntegrator.hpp>
+#include <simulation/HardwareParameters.hpp>
+#include <simulation/Integrator.hpp>
+#include <simulation/Model.hpp>
+#include <simulation/Recorder.hpp>
+#include <simulation/SpikeTrain.hpp>
+#include <simulation/Statistics.hpp>
+
+using namespace AdExpSim;
+
+/**
+ * SIGINT handler. Sets the global "cancel" flag to true when called once,
+ * terminates the program if called twice. This allows to terminate the program,
+ * even if it is not responsive (the cancel flag is not checked).
+ */
+static bool cancel = false;
+void int_handler(int)
+{
+	if (cancel) {
+		exit(1);
+	}
+	cancel = true;
+}
+
+/**
+ * Seed used for all randomly generated input spikes.
+ */
+static constexpr size_t SEED = 47491;
+
+/**
+ * Options controlling the benchmark run.
+ */
+struct BenchmarkOptions {
+	size_t warmup = 2;
+	size_t reps = 10;
+	size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	double timeout = 60.0;
+	bool quick = false;
+	std::string filter;
+	std::string output;
+};
+
+/**
+ * Result of a single benchmark, contains the wall clock time of each
+ * repetition.
+ */
+struct BenchmarkResult {
+	std::string group;
+	std::string name;
+	size_t threads;
+	size_t items;
+	double cost;
+	double value;
+	std::vector<double> times;
+
+	BenchmarkResult(const std::string &group, const std::string &name,
+	                size_t threads = 1)
+	    : group(group), name(name), threads(threads), items(0), cost(0), value(0)
+	{
+	}
+
+	double min() const
+	{
+		return times.empty() ? 0.0 : *std::min_element(times.begin(), times.end());
+	}
+
+	double median() const
+	{
+		if (times.empty()) {
+			return 0.0;
+		}
+		std::vector<double> ts = times;
+		std::sort(ts.begin(), ts.end());
+		const size_t n = ts.size();
+		return (n % 2 == 1) ? ts[n / 2] : (ts[n / 2 - 1] + ts[n / 2]) * 0.5;
+	}
+
+	double mean() const
+	{
+		double sum = 0.0;
+		for (double t : times) {
+			sum += t;
+		}
+		return times.empty() ? 0.0 : sum / times.size();
+	}
+
+	double stddev() const
+	{
+		if (times.size() < 2) {
+			return 0.0;
+		}
+		const double mu = mean();
+		double sum = 0.0;
+		for (double t : times) {
+			sum += (t - mu) * (t - mu);
+		}
+		return sqrt(sum / (times.size() - 1));
+	}
+
+	double throughput() const
+	{
+		const double t = median();
+		return t > 0.0 ? items * 1000.0 / t : 0.0;
+	}
+};
+
+/**
+ * Class collecting and running the individual benchmarks.
+ */
+class BenchmarkSuite {
+private:
+	const BenchmarkOptions &opts;
+	std::vector<BenchmarkResult> results;
+
+	/**
+	 * Returns the current wall clock time in milliseconds. The Timer class
+	 * measures the CPU time of the calling thread and thus cannot be used for
+	 * multi-threaded benchmarks.
+	 */
+	static double now()
+	{
+		using namespace std::chrono;
+		return duration_cast<duration<double, std::milli>>(
+		           steady_clock::now().time_since_epoch())
+		    .count();
+	}
+
+public:
+	BenchmarkSuite(const BenchmarkOptions &opts) : opts(opts) {}
+
+	/**
+	 * Returns true if the benchmark with the given name should be executed.
+	 */
+	bool enabled(const std::string &group, const std::string &name) const
+	{
+		return !cancel && (opts.filter.empty() ||
+		                   (group + "/" + name).find(opts.filter) !=
+		                       std::string::npos);
+	}
+
+	/**
+	 * Runs the given function for the configured number of warmup and
+	 * measurement repetitions. The function returns the number of work items
+	 * it processed.
+	 */
+	BenchmarkResult &run(BenchmarkResult res, std::function<size_t()> f)
+	{
+		std::cerr << std::setw(16) << res.group << " " << std::setw(32)
+		          << res.name << " ";
+		for (size_t i = 0; i < opts.warmup && !cancel; i++) {
+			f();
+		}
+		for (size_t i = 0; i < opts.reps && !cancel; i++) {
+			const double t0 = now();
+			res.items = f();
+			res.times.push_back(now() - t0);
+		}
+		std::cerr << std::fixed << std::setprecision(3) << std::setw(12)
+		          << res.median() << "ms " << std::setw(14)
+		          << res.throughput() << "/s" << std::endl;
+		results.emplace_back(std::move(res));
+		return results.back();
+	}
+
+	/**
+	 * Adds an externally measured result.
+	 */
+	BenchmarkResult &add(BenchmarkResult res)
+	{
+		std::cerr << std::setw(16) << res.group << " " << std::setw(32)
+		          << res.name << " " << std::fixed << std::setprecision(3)
+		          << std::setw(12) << res.median() << "ms " << std::setw(14)
+		          << res.value << std::endl;
+		results.emplace_back(std::move(res));
+		return results.back();
+	}
+
+	void writeCsv(std::ostream &os) const
+	{
+		os << "group,name,threads,reps,items,min_ms,median_ms,mean_ms,"
+		      "stddev_ms,items_per_sec,cost,value" << std::endl;
+		os << std::setprecision(9);
+		for (const BenchmarkResult &r : results) {
+			os << r.group << "," << r.name << "," << r.threads << ","
+			   << r.times.size() << "," << r.items << "," << r.min() << ","
+			   << r.median() << "," << r.mean() << "," << r.stddev() << ","
+			   << r.throughput() << "," << r.cost << "," << r.value
+			   << std::endl;
+		}
+	}
+
+	void writeJson(std::ostream &os) const
+	{
+		char date[32];
+		const time_t t = time(nullptr);
+		strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+
+		os << std::setprecision(9);
+		os << "{" << std::endl;
+		os << "\t\"date\": \"" << date << "\"," << std::endl;
+		os << "\t\"hardwareConcurrency\": "
+		   << std::thread::hardware_concurrency() << "," << std::endl;
+		os << "\t\"warmup\": " << opts.warmup << "," << std::endl;
+		os << "\t\"reps\": " << opts.reps << "," << std::endl;
+		os << "\t\"quick\": " << (opts.quick ? "true" : "false") << ","
+		   << std::endl;
+		os << "\t\"seed\": " << SEED << "," << std::endl;
+		os << "\t\"results\": [";
+		for (size_t i = 0; i < results.size(); i++) {
+			const BenchmarkResult &r = results[i];
+			os << (i == 0 ? "" : ",") << std::endl;
+			os << "\t\t{\"group\": \"" << r.group << "\", \"name\": \""
+			   << r.name << "\", \"threads\": " << r.threads
+			   << ", \"items\": " << r.items << ", \"minMs\": " << r.min()
+			   << ", \"medianMs\": " << r.median()
+			   << ", \"meanMs\": " << r.mean()
+			   << ", \"stddevMs\": " << r.stddev()
+			   << ", \"itemsPerSec\": " << r.throughput()
+			   << ", \"cost\": " << r.cost << ", \"value\": " << r.value
+			   << ", \"timesMs\": [";
+			for (size_t j = 0; j < r.times.size(); j++) {
+				os << (j == 0 ? "" : ", ") << r.times[j];
+			}
+			os << "]}";
+		}
+		os << std::endl << "\t]" << std::endl;
+		os << "}" << std::endl;
+	}
+};
+
+/*
+ * Canonical fixtures
+ */
+
+/**
+ * Environment and group descriptor of the first scenario used in the
+ * optimization and exploration tools.
+ */
+static const SpikeTrainEnvironment env(1, 200_ms, 5_ms, 10_ms);
+static const SingleGroupMultiOutDescriptor group(3, 2, 1);
+
+/**
+ * Group descriptor of the spike train used in the multi-fidelity optimization
+ * benchmark.
+ */
+static const SingleGroupMultiOutDescriptor trainGroup(6, 4, 1);
+
+/**
+ * Returns the name of the neuron model used for the given flag.
+ */
+static std::string modelName(bool useIfCondExp)
+{
+	return useIfCondExp ? "IfCondExp" : "AdIfCondExp";
+}
+
+/*
+ * Model::simulate
+ */
+
+static volatile Val sink;
+
+template <uint8_t Flags, typename Integrator>
+static void benchmarkSimulate(BenchmarkSuite &suite, const std::string &name,
+                              Integrator integrator, Time tDelta, size_t n,
+                              const SpikeTrain &train, const Parameters &params)
+{
+	if (!suite.enabled("simulate", name)) {
+		return;
+	}
+
+	// Each repetition simulates the spike train n times to get measurable
+	// times for the adaptive integrator. The final state is written to a
+	// volatile variable, otherwise the compiler might remove the entire
+	// simulation.
+	auto f = [&]() -> size_t {
+		for (size_t i = 0; i < n; i++) {
+			LastStateRecorder recorder;
+			DefaultController controller;
+			Integrator in(integrator);
+			Model::simulate<Flags>(train.getSpikes(), recorder, controller, in,
+			                       params, tDelta, train.getMaxT());
+			sink = recorder.state().v();
+		}
+		return n;
+	};
+
+	// Count the derivative evaluations of a single simulation
+	SimulationStatistics stats;
+	{
+		NullRecorder recorder;
+		DefaultController controller;
+		Integrator in(integrator);
+		Model::simulate<Flags>(train.getSpikes(), recorder, controller, in,
+		                       params, tDelta, train.getMaxT(), State(),
+		                       Time(-1), StatisticsCollector(stats));
+	}
+
+	BenchmarkResult &res = suite.run(BenchmarkResult("simulate", name), f);
+	res.cost = stats.rhsEvaluations;
+	res.value = stats.outputSpikes;
+}
+
+template <uint8_t Flags>
+static void benchmarkSimulateFlags(BenchmarkSuite &suite,
+                                   const std::string &flagName,
+                                   const SpikeTrain &train,
+                                   const Parameters &params)
+{
+	benchmarkSimulate<Flags>(suite, "Euler/10us/" + flagName,
+	                         EulerIntegrator(), 10e-6_s, 1, train, params);
+	benchmarkSimulate<Flags>(suite, "Midpoint/10us/" + flagName,
+	                         MidpointIntegrator(), 10e-6_s, 1, train, params);
+	benchmarkSimulate<Flags>(suite, "RungeKutta/10us/" + flagName,
+	                         RungeKuttaIntegrator(), 10e-6_s, 1, train, params);
+	benchmarkSimulate<Flags>(suite, "DormandPrince/1e-3/" + flagName,
+	                         DormandPrinceIntegrator(1e-3), 1e-6_s, 10, train,
+	                         params);
+	benchmarkSimulate<Flags>(suite, "DormandPrince/1e-4/" + flagName,
+	                         DormandPrinceIntegrator(1e-4), 1e-6_s, 10, train,
+	                         params);
+}
+
+static void benchmarkSimulations(BenchmarkSuite &suite,
+                                 const SpikeTrain &train)
+{
+	const Parameters params;
+	benchmarkSimulateFlags<0>(suite, "AdExp", train, params);
+	benchmarkSimulateFlags<Model::FAST_EXP>(suite, "AdExpFastExp", train,
+	                                        params);
+	benchmarkSimulateFlags<Model::FAST_EXP | Model::CLAMP_ITH>(
+	    suite, "AdExpFastExpClamp", train, params);
+	benchmarkSimulateFlags<Model::IF_COND_EXP>(suite, "IfCondExp", train,
+	                                           params);
+}
+
+/*
+ * Integrator::integrate
+ */
+
+template <typename Integrator>
+static void benchmarkIntegrate(BenchmarkSuite &suite, const std::string &name,
+                               Integrator integrator)
+{
+	if (!suite.enabled("integrate", name)) {
+		return;
+	}
+
+	// Integrate a cheap linear system relaxing towards a fixed point, so the
+	// cost is dominated by the integrator itself and not by the derivative.
+	// Each step is fed with the result of the previous step, which prevents
+	// the compiler from hoisting the computation out of the loop.
+	static constexpr size_t N = 100000;
+	const State rate(10.0, 200.0, 200.0, 7.0);
+	const State target(-60e-3, 0.1, 0.05, 1.0);
+	auto df = [&](const State &s) { return (target - s) * rate; };
+	auto f = [&]() -> size_t {
+		Integrator in(integrator);
+		State s(-10e-3, 1.0, 0.5, 0.0);
+		for (size_t i = 0; i < N; i++) {
+			s = in.integrate(10e-6_s, 1_ms, s, df).first;
+			s.lE() += 1e-3;
+		}
+		sink = s.v();
+		return N;
+	};
+	suite.run(BenchmarkResult("integrate", name), f);
+}
+
+static void benchmarkIntegrators(BenchmarkSuite &suite)
+{
+	benchmarkIntegrate(suite, "Euler", EulerIntegrator());
+	benchmarkIntegrate(suite, "Midpoint", MidpointIntegrator());
+	benchmarkIntegrate(suite, "RungeKutta", RungeKuttaIntegrator());
+	benchmarkIntegrate(suite, "DormandPrince/1e-3",
+	                   DormandPrinceIntegrator(1e-3));
+}
+
+/*
+ * Evaluation::evaluate and FractionalSpikeCount::calculate
+ */
+
+template <typename Evaluation>
+static void benchmarkEvaluate(BenchmarkSuite &suite, const std::string &name,
+                              const Evaluation &eval)
+{
+	if (!suite.enabled("evaluate", name)) {
+		return;
+	}
+
+	const WorkingParameters params{Parameters()};
+	static constexpr size_t N = 10;
+	auto f = [&]() -> size_t {
+		for (size_t i = 0; i < N; i++) {
+			eval.evaluate(params);
+		}
+		return N;
+	};
+
+	SimulationStatistics stats;
+	const EvaluationResult r = eval.evaluate(params, stats);
+
+	BenchmarkResult &res = suite.run(BenchmarkResult("evaluate", name), f);
+	res.cost = stats.rhsEvaluations;
+	res.value = r[eval.descriptor().optimizationDim()];
+}
+
+static void benchmarkEvaluations(BenchmarkSuite &suite,
+                                 const SpikeTrain &train)
+{
+	for (bool useIfCondExp : {true, false}) {
+		const std::string model = modelName(useIfCondExp);
+		benchmarkEvaluate(
+		    suite, "SGSO/" + model,
+		    SingleGroupSingleOutEvaluation(env, group, useIfCondExp));
+		benchmarkEvaluate(
+		    suite, "SGMO/" + model,
+		    SingleGroupMultiOutEvaluation(env, group, useIfCondExp));
+		benchmarkEvaluate(suite, "ST/" + model,
+		                  SpikeTrainEvaluation(train, useIfCondExp));
+	}
+}
+
+static void benchmarkFractionalSpikeCount(BenchmarkSuite &suite)
+{
+	size_t seed = SEED;
+	const SpikeVec spikes = buildSpikeGroup(1.0, group.n, env, false, Time(),
+	                                        nullptr, nullptr, &seed);
+	const WorkingParameters params{Parameters()};
+	for (bool useIfCondExp : {true, false}) {
+		const std::string name = modelName(useIfCondExp);
+		if (!suite.enabled("fracSpikeCount", name)) {
+			continue;
+		}
+
+		FractionalSpikeCount eval(useIfCondExp);
+		static constexpr size_t N = 10;
+		auto f = [&]() -> size_t {
+			for (size_t i = 0; i < N; i++) {
+				eval.calculate(spikes, params);
+			}
+			return N;
+		};
+
+		SimulationStatistics stats;
+		FractionalSpikeCount::Result r =
+		    eval.calculate(spikes, params, StatisticsCollector(stats));
+
+		BenchmarkResult &res =
+		    suite.run(BenchmarkResult("fracSpikeCount", name), f);
+		res.cost = stats.rhsEvaluations;
+		res.value = r.fracSpikeCount();
+	}
+}
+
+/*
+ * Exploration::run
+ */
+
+static void benchmarkExploration(BenchmarkSuite &suite,
+                                 const BenchmarkOptions &opts)
+{
+	// Thread counts: powers of two up to the maximum thread count and the
+	// maximum thread count itself
+	std::vector<size_t> threadCounts;
+	for (size_t n = 1; n < opts.threads; n *= 2) {
+		threadCounts.push_back(n);
+	}
+	threadCounts.push_back(opts.threads);
+
+	const size_t resolution = opts.quick ? 16 : 32;
+	const SingleGroupSingleOutEvaluation eval(env, group, false);
+	double tSingle = 0.0;
+	for (size_t nThreads : threadCounts) {
+		const std::string name = "SGSO/" + std::to_string(resolution) + "x" +
+		                         std::to_string(resolution) + "/" +
+		                         std::to_string(nThreads);
+		if (!suite.enabled("explore", name)) {
+			continue;
+		}
+
+		Exploration exploration(true, Parameters(), Parameters::idx_gL,
+		                        Parameters::idx_tauE,
+		                        DiscreteRange(0.01e-6, 0.2e-6, resolution),
+		                        DiscreteRange(1e-3, 20e-3, resolution));
+		exploration.setThreadCount(nThreads);
+		auto f = [&]() -> size_t {
+			exploration.run(eval, [](Val) { return !cancel; });
+			return resolution * resolution;
+		};
+
+		// Store the speedup relative to the single threaded run in "value"
+		BenchmarkResult &res =
+		    suite.run(BenchmarkResult("explore", name, nThreads), f);
+		if (nThreads == 1) {
+			tSingle = res.median();
+		}
+		res.value = (tSingle > 0.0 && res.median() > 0.0)
+		                ? tSingle / res.median()
+		                : 0.0;
+	}
+}
+
+/*
+ * ExplorationMemory
+ */
+
+static void benchmarkExplorationMemory(BenchmarkSuite &suite,
+                                       const BenchmarkOptions &opts)
+{
+	// Run a single exploration and store its results with each storage type
+	const size_t resolution = opts.quick ? 32 : 64;
+	const SingleGroupMultiOutEvaluation eval(env, group, false);
+	Exploration exploration(true, Parameters(), Parameters::idx_gL,
+	                        Parameters::idx_tauE,
+	                        DiscreteRange(0.01e-6, 0.2e-6, resolution),
+	                        DiscreteRange(1e-3, 20e-3, resolution));
+	bool hasExploration = false;
+
+	const std::vector<std::pair<std::string, ExplorationStorage>> storages{
+	    {"float", ExplorationStorage::FLOAT},
+	    {"quantized16", ExplorationStorage::QUANTIZED16},
+	    {"quantized8", ExplorationStorage::QUANTIZED8}};
+	for (const auto &storage : storages) {
+		const std::string name = "SGMO/" + std::to_string(resolution) + "x" +
+		                         std::to_string(resolution) + "/" +
+		                         storage.first;
+		if (!suite.enabled("memory", name)) {
+			continue;
+		}
+		if (!hasExploration) {
+			exploration.run(eval, [](Val) { return !cancel; });
+			hasExploration = true;
+		}
+
+		// Copy the results to a memory instance with the selected storage
+		const ExplorationMemory &src = exploration.mem();
+		ExplorationMemory mem(src.descriptor, src.resX, src.resY,
+		                      storage.second);
+		for (size_t y = 0; y < src.resY; y++) {
+			for (size_t x = 0; x < src.resX; x++) {
+				mem.store(x, y, src(x, y));
+			}
+		}
+		mem.compact();
+
+		// Measure the time needed to decode all dimensions, store the memory
+		// usage in bytes in "value"
+		std::vector<Val> buf(mem.resX * mem.resY);
+		auto f = [&]() -> size_t {
+			for (size_t i = 0; i < mem.size(); i++) {
+				mem.copyRows(i, 0, mem.resY, buf.data());
+				sink = buf[i];
+			}
+			return mem.size() * mem.resX * mem.resY;
+		};
+		suite.run(BenchmarkResult("memory", name), f).value =
+		    mem.memoryUsage();
+	}
+}
+
+/*
+ * Optimization::optimize
+ */
+
+// Dimensions optimized in the optimization benchmarks (all continuous
+// parameters of the IfCondExp model)
+static const std::vector<size_t> optimizationDims{
+    WorkingParameters::idx_lL, WorkingParameters::idx_lE,
+    WorkingParameters::idx_tauRef, WorkingParameters::idx_eTh,
+    WorkingParameters::idx_w};
+
+/**
+ * Runs a single optimization benchmark, returns the median time-to-target in
+ * milliseconds or zero if the benchmark is disabled.
+ */
+template <typename Evaluation>
+static double benchmarkOptimization(BenchmarkSuite &suite,
+                                    const BenchmarkOptions &opts,
+                                    const std::string &name,
+                                    const Optimization &optimization,
+                                    const Evaluation &eval, Val target)
+{
+	if (!suite.enabled("optimize", name)) {
+		return 0.0;
+	}
+
+	// Optimize starting at the default parameters. The measured time is the
+	// time until the best result reaches the target value, the optimization
+	// finishes or the timeout is reached.
+	const std::vector<WorkingParameters> input{WorkingParameters(Parameters())};
+
+	BenchmarkResult res("optimize", name, opts.threads);
+	Val bestSum = 0.0;
+	for (size_t i = 0; i < opts.reps && !cancel; i++) {
+		const auto t0 = std::chrono::steady_clock::now();
+		Val best = 0.0;
+		size_t its = 0;
+		optimization.optimize(input, eval,
+		                      [&](size_t nIt, size_t, float eval,
+		                          const std::vector<OptimizationResult> &,
+		                          const SurrogateStatistics &) {
+			its = nIt;
+			best = std::max<Val>(best, eval);
+			const std::chrono::duration<double> t =
+			    std::chrono::steady_clock::now() - t0;
+			return best < target && !cancel && t.count() < opts.timeout;
+		});
+		const std::chrono::duration<double, std::milli> t =
+		    std::chrono::steady_clock::now() - t0;
+		res.times.push_back(t.count());
+		res.items = its;
+		bestSum += best;
+	}
+
+	// Store the mean best evaluation result in "value", it is smaller than the
+	// target if the optimization timed out
+	res.value = res.times.empty() ? 0.0 : bestSum / res.times.size();
+	return suite.add(res).median();
+}
+
+static void benchmarkOptimizations(BenchmarkSuite &suite,
+                                   const BenchmarkOptions &opts,
+                                   const SpikeTrain &train)
+{
+	Optimization optimization(ModelType::IF_COND_EXP, optimizationDims);
+	benchmarkOptimization(
+	    suite, opts, "SGSO/IfCondExp/0.6", optimization,
+	    SingleGroupSingleOutEvaluation(env, group, true), 0.6);
+	benchmarkOptimization(
+	    suite, opts, "SGMO/IfCondExp/0.892", optimization,
+	    SingleGroupMultiOutEvaluation(env, group, true), 0.892);
+
+	// Same optimizations with the surrogate model
+	optimization.setUseSurrogate(true);
+	benchmarkOptimization(
+	    suite, opts, "SGSO/IfCondExp/0.6/surrogate", optimization,
+	    SingleGroupSingleOutEvaluation(env, group, true), 0.6);
+	benchmarkOptimization(
+	    suite, opts, "SGMO/IfCondExp/0.892/surrogate", optimization,
+	    SingleGroupMultiOutEvaluation(env, group, true), 0.892);
+
+	// Same optimizations with the CMA-ES algorithm
+	optimization.setUseSurrogate(false);
+	optimization.setAlgorithm(OptimizationAlgorithm::CMA_ES);
+	benchmarkOptimization(
+	    suite, opts, "SGSO/IfCondExp/0.6/cma-es", optimization,
+	    SingleGroupSingleOutEvaluation(env, group, true), 0.6);
+	benchmarkOptimization(
+	    suite, opts, "SGMO/IfCondExp/0.892/cma-es", optimization,
+	    SingleGroupMultiOutEvaluation(env, group, true), 0.892);
+
+	// Compare the strategies used to respect the BrainScaleS hardware
+	// restrictions. These optimizations run until they finish by themselves,
+	// the value is the best hardware compatible result.
+	constexpr Val NO_TARGET = std::numeric_limits<Val>::max();
+	for (HardwareStrategy strategy :
+	     {HardwareStrategy::MIX_FACTOR, HardwareStrategy::PROJECTION}) {
+		const std::string strategyName =
+		    strategy == HardwareStrategy::MIX_FACTOR ? "mix" : "projection";
+		const Optimization hwOptimization(ModelType::IF_COND_EXP,
+		                                  optimizationDims,
+		                                  BrainScaleSParameters::inst, strategy);
+		benchmarkOptimization(
+		    suite, opts, "SGSO/IfCondExp/BrainScaleS/" + strategyName,
+		    hwOptimization, SingleGroupSingleOutEvaluation(env, group, true),
+		    NO_TARGET);
+	}
+
+	// Compare the time-to-target of the multi-fidelity optimization with the
+	// full fidelity optimization on a longer spike train. The speedup of the
+	// multi-fidelity optimization is stored in "value" of an additional result.
+	const SpikeTrainEvaluation trainEval(train, true);
+	Optimization mfOptimization(ModelType::IF_COND_EXP, optimizationDims);
+	const double tFull =
+	    benchmarkOptimization(suite, opts, "Train/IfCondExp/1.0",
+	                          mfOptimization, trainEval, 1.0);
+	mfOptimization.setFidelityLadder(Optimization::defaultFidelityLadder());
+	const double tMf = benchmarkOptimization(
+	    suite, opts, "Train/IfCondExp/1.0/multi-fidelity", mfOptimization,
+	    trainEval, 1.0);
+	if (tFull > 0.0 && tMf > 0.0) {
+		BenchmarkResult res("optimize", "Train/IfCondExp/1.0/speedup",
+		                    opts.threads);
+		res.value = tFull / tMf;
+		suite.add(res);
+	}
+}
+
+/*
+ * Main program
+ */
+
+static void usage(const char *name)
+{
+	std::cerr << "Usage: " << name
+	          << " [--quick] [--warmup N] [--reps N] [--threads N]"
+	             " [--timeout SEC] [--filter STR] [OUTPUT.json|OUTPUT.csv]"
+	          << std::endl;
+}
+
+static bool endsWith(const std::string &s, const std::string &suffix)
+{
+	return s.size() >= suffix.size() &&
+	       s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+	signal(SIGINT, int_handler);
+
+	// Parse the command line
+	BenchmarkOptions opts;
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--quick") {
+			opts.quick = true;
+			opts.warmup = 1;
+			opts.reps = 3;
+			opts.timeout = 10.0;
+		} else if (arg == "--warmup" && hasValue) {
+			opts.warmup = std::stoul(argv[++i]);
+		} else if (arg == "--reps" && hasValue) {
+			opts.reps = std::max<size_t>(1, std::stoul(argv[++i]));
+		} else if (arg == "--threads" && hasValue) {
+			opts.threads = std::max<size_t>(1, std::stoul(argv[++i]));
+		} else if (arg == "--timeout" && hasValue) {
+			opts.timeout = std::stod(argv[++i]);
+		} else if (arg == "--filter" && hasValue) {
+			opts.filter = argv[++i];
+		} else if (arg[0] != '-' && opts.output.empty() &&
+		           (endsWith(arg, ".json") || endsWith(arg, ".csv"))) {
+			opts.output = arg;
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Build the input spike trains used in the simulation, spike train
+	// evaluation and optimization benchmarks. They are built first, so the
+	// internal seed of the SpikeTrain class is in the same state in each run.
+	const SpikeTrain train(group, 10, env, false);
+	const SpikeTrain optimizationTrain(trainGroup, 40, env, false);
+
+	// Run all benchmarks
+	BenchmarkSuite suite(opts);
+	benchmarkSimulations(suite, train);
+	benchmarkIntegrators(suite);
+	benchmarkEvaluations(suite, train);
+	benchmarkFractionalSpikeCount(suite);
+	benchmarkExploration(suite, opts);
+	benchmarkExplorationMemory(suite, opts);
+	benchmarkOptimizations(suite, opts, optimizationTrain);
+
+	// Write the results
+	if (opts.output.empty()) {
+		suite.writeCsv(std::cout);
+	} else {
+		std::ofstream os(opts.output);
+		if (!os.good()) {
+			std::cerr << "Error while opening " << opts.output << std::endl;
+			return 1;
+		}
+		if (endsWith(opts.output, ".json")) {
+			suite.writeJson(os);
+		} else {
+			suite.writeCsv(os);
+		}
+	}
+
+	if (cancel) {
+		std::cerr << "Manually aborted benchmark" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -21,7 +21,10 @@
 #include <simulation/Recorder.hpp>
 #include <simulation/SpikeTrain.hpp>
 #include <exploration/SimplexPool.hpp>
+#include <exploration/TraceFit.hpp>
+#include <io/TraceIo.hpp>
 
+#include <atomic>
 #include <csignal>
 #include <cmath>
 #include <iostream>
@@ -31,24 +34,6 @@
 
 using namespace AdExpSim;
 
-struct ReferenceData {
-	float t, v;
-
-	ReferenceData(float t = 0.0, float v = 0.0) : t(t), v(v) {}
-};
-
-std::vector<std::string> split(const std::string &text, char sep)
-{
-	std::vector<std::string> tokens;
-	size_t start = 0, end = 0;
-	while ((end = text.find(sep, start)) != std::string::npos) {
-		tokens.push_back(text.substr(start, end - start));
-		start = end + 1;
-	}
-	tokens.push_back(text.substr(start));
-	return tokens;
-}
-
 bool cancel = false;
 void int_handler(int)
 {
@@ -77,7 +62,7 @@ public:
 	{
 		if (valid()) {
 			Model::simulate<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
-			    spikes, recorder, controller, integrator, wParams, Time(-1),
+			    spikes, recorder, controller, integrator, wParams, 0.1_ms,
 			    max_t);
 		}
 	}
@@ -94,32 +79,30 @@ int main(int argc, char *argv[])
 {
 	signal(SIGINT, int_handler);
 
+	// Use the gradient based fitter if requested
+	bool useGradient = (argc == 4 && std::string(argv[1]) == "--gradient");
+	if (useGradient) {
+		argc--;
+		argv++;
+	}
+
 	if (argc != 3) {
 		std::cout << "Tries to fit a model parameter to a previously recorded "
 		          << "spike train." << std::endl;
 		std::cout << "Usage: " << argv[0]
-		          << " <REFERENCE_DATA> <FITTED_DATA_OUT>" << std::endl;
+		          << " [--gradient] <REFERENCE_DATA> <FITTED_DATA_OUT>"
+		          << std::endl;
 		return 1;
 	}
 
 	// Read the CSV data
 	std::cout << "Reading CSV file..." << std::endl;
-	float min_t = std::numeric_limits<float>::max();
-	float max_t = std::numeric_limits<float>::lowest();
-	std::vector<ReferenceData> ref;
-	std::ifstream fin(argv[1]);
-	while (fin.good()) {
-		std::string line;
-		std::getline(fin, line);
-		auto parts = split(line, ',');
-		if (parts.size() == 2) {
-			ReferenceData data(std::stof(parts[0]) / 1000.0,
-			                   std::stof(parts[1]) / 1000.0);
-			ref.push_back(data);
-			min_t = std::min(min_t, data.t);
-			max_t = std::max(max_t, data.t);
-		}
+	TraceVec trace;
+	if (!TraceIo::loadTrace(argv[1], trace) || trace.empty()) {
+		std::cerr << "Error while reading " << argv[1] << std::endl;
+		return 1;
 	}
+	const float max_t = trace.back().t;
 
 	// Initialize the parameters
 	Parameters params;
@@ -132,39 +115,63 @@ int main(int argc, char *argv[])
 	params.tauE() = 5e-3;
 	params.gL() = params.cM() / 5.0e-3;
 
-	auto f = [&ref, max_t](const Parameters &params) -> float {
-		Simulation sim(params, Time::sec(max_t));
-		if (!sim.valid()) {
-			return std::numeric_limits<Val>::max();
-		}
-		double err = 0;
-		for (auto &r : ref) {
-			auto val = sim.data().interpolate(r.t);
-			float dv = r.v - val.v();
-			err += dv * dv;
-		}
-		return sqrt(err / ref.size());
-	};
-
-	// Create the simplex algorithm instance, fetch the to-be-optimized
-	// dimensions
+	// Fetch the to-be-optimized dimensions. The simplex fits these entries of
+	// the Parameters, the gradient based fitter the entries with the same
+	// indices in the WorkingParameters, i.e. lE = 1 / tauE instead of tauE and
+	// the weight relative to cM instead of w. Note that eL is not part of the
+	// working parameters and thus cannot be fitted.
 	std::vector<size_t> dims = {Parameters::idx_tauE,
-	                            /*Parameters::idx_gL, Parameters::idx_eL,*/
+	                            /*Parameters::idx_gL,*/
 	                            Parameters::idx_w};
-	SimplexPool<Parameters> simplex(params, dims);
-	auto res = simplex.run(f, [](size_t nIt, size_t sample, Val err) -> bool {
-		std::cout << "nIt: " << nIt << ", sample: " << sample
-		          << ", err: " << err << "             \r";
-		return !cancel;
-	});
+
+	// The TraceFit instance compares the simulation to the reference trace
+	// without storing the simulated trace. Use the same fixed timestep as the
+	// Simulation class above.
+	TraceFit fit(trace, {Spike(1002_ms, 1.0)}, dims, params.eL(), true,
+	             0.1_ms);
+	std::atomic<size_t> nSimulations(0);
+	auto f = [&fit, &nSimulations](const Parameters &params) -> float {
+		nSimulations++;
+		return fit.cost(WorkingParameters(params));
+	};
+
+	Parameters best;
+	Val costInit, costBest;
+	if (useGradient) {
+		// Fit the trace using the Levenberg-Marquardt algorithm and the
+		// forward sensitivities of the membrane potential
+		auto res = fit.run(
+		    WorkingParameters(params),
+		    [](size_t nIt, size_t nSim, Val err) -> bool {
+			    std::cout << "nIt: " << nIt << ", simulations: " << nSim
+			              << ", err: " << err << "             \r";
+			    return !cancel;
+			});
+		best = res.best.toParameters(params);
+		costInit = res.costInit;
+		costBest = res.costBest;
+		nSimulations = res.nSimulations;
+	} else {
+		// Create the simplex algorithm instance
+		SimplexPool<Parameters> simplex(params, dims);
+		auto res =
+		    simplex.run(f, [](size_t nIt, size_t sample, Val err) -> bool {
+			    std::cout << "nIt: " << nIt << ", sample: " << sample
+			              << ", err: " << err << "             \r";
+			    return !cancel;
+			});
+		best = res.best;
+		costInit = res.costInit;
+		costBest = res.costBest;
+	}
 
 	std::cout << std::endl;
 	std::cout << "Done." << std::endl;
 	std::cout << std::endl;
-	std::cout << "Initial error: " << res.costInit << std::endl;
-	std::cout << "Final error: " << res.costBest << std::endl;
+	std::cout << "Initial error: " << costInit << std::endl;
+	std::cout << "Final error: " << costBest << std::endl;
+	std::cout << "Simulations: " << nSimulations.load() << std::endl;
 
-	Parameters best = res.best;
 	for (size_t i = 0; i < Parameters::Size; i++) {
 		std::cout << Parameters::names[i] << ": " << best[i] << " ("
 		          << params[i] << ")" << std::endl;
@@ -0,0 +1,181 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * Fits the model parameters to a large number of recorded membrane potential
+ * traces. The traces are loaded and fitted in parallel, each one using the
+ * Levenberg-Marquardt algorithm with the forward sensitivities of the model.
+ * Prints a summary table once all traces have been processed.
+ */
+
+#include <common/Timer.hpp>
+#include <exploration/TraceFit.hpp>
+#include <io/TraceIo.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace AdExpSim;
+
+/**
+ * SIGINT handler. Sets the global "cancel" flag to true when called once,
+ * terminates the program if called twice.
+ */
+static std::atomic<bool> cancel(false);
+void int_handler(int)
+{
+	if (cancel) {
+		exit(1);
+	}
+	cancel = true;
+}
+
+/**
+ * Result of fitting a single trace.
+ */
+struct FitSummary {
+	bool loaded = false;
+	size_t nSamples = 0;
+	size_t nIt = 0;
+	size_t nSimulations = 0;
+	Val costInit = 0.0;
+	Val costBest = 0.0;
+	Parameters best;
+	double time = 0.0;
+};
+
+int main(int argc, char *argv[])
+{
+	signal(SIGINT, int_handler);
+
+	if (argc < 2) {
+		std::cout << "Fits the model parameters to a set of previously "
+		          << "recorded membrane potential traces." << std::endl;
+		std::cout << "Usage: " << argv[0] << " <REFERENCE_DATA>..."
+		          << std::endl;
+		std::cout << "REFERENCE_DATA are CSV files containing the time in ms "
+		          << "and the membrane potential in mV" << std::endl;
+		return 1;
+	}
+	const std::vector<std::string> files(argv + 1, argv + argc);
+	const size_t nFiles = files.size();
+
+	// Initialize the parameters, same as in AdExpFit
+	Parameters params;
+	params.cM() = 0.2e-9;
+	params.eE() = 0.0e-3;
+	params.eReset() = -75e-3;
+	params.eL() = -70e-3;
+	params.eTh() = -55e-3;
+	params.w() = 16.0e-9;
+	params.tauE() = 5e-3;
+	params.gL() = params.cM() / 5.0e-3;
+	const std::vector<size_t> dims = {WorkingParameters::idx_lE,
+	                                  WorkingParameters::idx_w};
+	const SpikeVec spikes = {Spike(1002_ms, 1.0)};
+
+	// Worker threads, each one loads and fits the next trace
+	std::vector<FitSummary> results(nFiles);
+	std::atomic<size_t> next(0), done(0);
+	auto worker = [&]() {
+		TraceVec trace;
+		size_t i;
+		while (!cancel && (i = next.fetch_add(1)) < nFiles) {
+			Timer timer;
+			FitSummary &summary = results[i];
+			summary.loaded = TraceIo::loadTrace(files[i], trace);
+			if (summary.loaded && !trace.empty()) {
+				TraceFit fit(trace, spikes, dims, params.eL(), true, 0.1_ms);
+				auto res = fit.run(WorkingParameters(params),
+				                   [](size_t, size_t, Val) { return !cancel; });
+				summary.nSamples = trace.size();
+				summary.nIt = res.nIt;
+				summary.nSimulations = res.nSimulations;
+				summary.costInit = res.costInit;
+				summary.costBest = res.costBest;
+				summary.best = res.best.toParameters(params);
+			}
+			summary.time = timer.time();
+			done++;
+		}
+	};
+	const size_t nThreads = std::max<size_t>(
+	    1, std::min<size_t>(nFiles, std::thread::hardware_concurrency()));
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < nThreads; i++) {
+		workers.emplace_back(worker);
+	}
+	while (done.load() < nFiles && !cancel) {
+		std::cerr << "Fitted " << done.load() << "/" << nFiles << " traces\r";
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	for (auto &thread : workers) {
+		thread.join();
+	}
+	std::cerr << "Fitted " << done.load() << "/" << nFiles << " traces"
+	          << std::endl;
+
+	// Print the summary table
+	std::cout << std::left << std::setw(32) << "file" << std::right
+	          << std::setw(9) << "samples" << std::setw(5) << "it"
+	          << std::setw(6) << "sims" << std::setw(15) << "rmse_init[mV]"
+	          << std::setw(12) << "rmse[mV]" << std::setw(12) << "tauE[ms]"
+	          << std::setw(10) << "w[nS]" << std::setw(11) << "time[ms]"
+	          << std::endl;
+	size_t nFailed = 0;
+	double costSum = 0.0;
+	for (size_t i = 0; i < nFiles; i++) {
+		const FitSummary &s = results[i];
+		std::cout << std::left << std::setw(32) << files[i] << std::right;
+		if (!s.loaded || s.nSamples == 0) {
+			std::cout << std::setw(9) << "error" << std::endl;
+			nFailed++;
+			continue;
+		}
+		std::cout << std::setw(9) << s.nSamples << std::setw(5) << s.nIt
+		          << std::setw(6) << s.nSimulations << std::fixed
+		          << std::setprecision(4) << std::setw(15)
+		          << s.costInit * 1000.0 << std::setw(12)
+		          << s.costBest * 1000.0 << std::setw(12)
+		          << s.best.tauE() * 1000.0 << std::setw(10)
+		          << s.best.w() * 1e9 << std::setprecision(1)
+		          << std::setw(11) << s.time << std::defaultfloat
+		          << std::endl;
+		costSum += s.costBest;
+	}
+	if (nFailed < nFiles) {
+		std::cout << std::endl
+		          << std::setprecision(4) << "Mean rmse: "
+		          << costSum / (nFiles - nFailed) * 1000.0 << " mV"
+		          << std::endl;
+	}
+	if (nFailed > 0) {
+		std::cout << nFailed << " file(s) could not be read" << std::endl;
+	}
+
+	return nFailed > 0 ? 1 : 0;
+}
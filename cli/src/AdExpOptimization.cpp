@@ -23,6 +23,7 @@
 #include <exploration/SingleGroupSingleOutEvaluation.hpp>
 #include <exploration/SingleGroupMultiOutEvaluation.hpp>
 #include <exploration/Optimization.hpp>
+#include <exploration/RobustEvaluation.hpp>
 #include <common/Timer.hpp>
 #include <utils/ParameterCollection.hpp>
 
@@ -32,6 +33,7 @@
 #include <iomanip>
 #include <fstream>
 #include <sstream>
+#include <string>
 
 using namespace AdExpSim;
 
@@ -49,11 +51,21 @@ void int_handler(int)
 	cancel = true;
 }
 
+/**
+ * Number of noisy spike train realizations used to re-rank the optimization
+ * results and maximum number of re-ranked results. Note that the re-ranking
+ * happens after the optimization, the optimizer itself still only sees a
+ * single spike train realization.
+ */
+static constexpr size_t ROBUST_REALIZATIONS = 32;
+static constexpr size_t ROBUST_CANDIDATES = 8;
+
 static WorkingParameters run_optimisation(
     const std::vector<size_t> &dims, const WorkingParameters &params,
     const SpikeTrainEnvironment &env,
     const SingleGroupMultiOutDescriptor &group,
-    const EvaluationType evaluationType,
+    const EvaluationType evaluationType, bool useSurrogate,
+    OptimizationAlgorithm algorithm, bool robust, uint64_t seed,
     const ModelType modelType = ModelType::IF_COND_EXP)
 {
 	// Prepare the input vector
@@ -63,11 +75,16 @@ static WorkingParameters run_optimisation(
 	// result on std::cerr
 	auto progressCallback =
 	    [&](size_t nIt, size_t nInput, float eval,
-	          const std::vector<OptimizationResult> &output)->bool
+	          const std::vector<OptimizationResult> &output,
+	          const SurrogateStatistics &stats)->bool
 	{
 		std::cerr << "nIt: " << nIt << " nInput: " << nInput
 		          << " nOutput: " << output.size();
 		std::cerr << " eval: " << eval;
+		if (useSurrogate) {
+			std::cerr << " surrogate hits: " << int(stats.hitRate() * 100.0)
+			          << "% saved: " << int(stats.savedTime()) << "s";
+		}
 		std::cerr << "        \r";
 		return !cancel;
 	};
@@ -81,6 +98,9 @@ static WorkingParameters run_optimisation(
 
 	// Optimisation dimension
 	Optimization optimization(modelType, dims);
+	optimization.setUseSurrogate(useSurrogate);
+	optimization.setAlgorithm(algorithm);
+	optimization.setSeed(seed);
 
 	std::vector<OptimizationResult> res;
 
@@ -112,6 +132,53 @@ static WorkingParameters run_optimisation(
 		wpOut = res[0].params;
 	}
 
+	// Re-rank the best results on an ensemble of noisy spike train
+	// realizations. Candidates are rejected as soon as they are significantly
+	// worse than the current incumbent. The ensemble consists of spike train
+	// evaluations, so only results of the spike train evaluation can be
+	// re-ranked without changing the objective.
+	if (robust && evaluationType != EvaluationType::SPIKE_TRAIN) {
+		std::cout << "Skipping the robust re-ranking, only supported for the "
+		             "spike train evaluation" << std::endl;
+	} else if (robust && !res.empty()) {
+		std::cout << "Re-ranking on " << ROBUST_REALIZATIONS
+		          << " spike train realizations..." << std::endl;
+		RobustEvaluation ensemble(train, ROBUST_REALIZATIONS, 0, useIfCondExp);
+		RobustEvaluationResult incumbent = ensemble.evaluateRobust(wpOut);
+		const RobustEvaluationResult initial = ensemble.evaluateRobust(params);
+		const size_t dim = ensemble.descriptor().optimizationDim();
+		const size_t nRanked = std::min(ROBUST_CANDIDATES, res.size());
+		size_t nEvaluated = 0, nRejected = 0, nCandidates = 0;
+		for (size_t i = 1; i < nRanked && !cancel; i++) {
+			if (!res[i].params.valid()) {
+				continue;
+			}
+			nCandidates++;
+			RobustEvaluationResult candidate;
+			const RobustComparison cmp =
+			    ensemble.compare(res[i].params, incumbent, candidate);
+			if (cmp == RobustComparison::BETTER) {
+				ensemble.complete(res[i].params, candidate);
+			}
+			nEvaluated += candidate.size();
+			if (cmp == RobustComparison::WORSE) {
+				nRejected++;
+			} else if (cmp == RobustComparison::BETTER ||
+			           candidate.mean[dim] > incumbent.mean[dim]) {
+				incumbent = candidate;
+				wpOut = res[i].params;
+			}
+		}
+		std::cout << "Candidates: " << nCandidates
+		          << " rejected early: " << nRejected
+		          << " realizations evaluated: " << nEvaluated << " of "
+		          << nCandidates * ROBUST_REALIZATIONS << std::endl;
+		std::cout << "Robust result: " << incumbent.mean[dim] << " +- "
+		          << incumbent.stdErr << std::endl;
+		std::cout << "Robust initial: " << initial.mean[dim] << " +- "
+		          << initial.stdErr << std::endl;
+	}
+
 	std::cout << "Final parameters: " << std::endl;
 	Parameters pOpt =
 	    wpOut.toParameters(DefaultParameters::cM, DefaultParameters::eL);
@@ -148,7 +215,10 @@ static WorkingParameters run_optimisation(
 }
 
 static void optimise_scenario(const SpikeTrainEnvironment &env,
-                              const SingleGroupMultiOutDescriptor &group)
+                              const SingleGroupMultiOutDescriptor &group,
+                              bool useSurrogate,
+                              OptimizationAlgorithm algorithm, bool robust,
+                              uint64_t seed)
 {
 	std::cout << "Base neuron parameters:" << std::endl;
 	Parameters params;
@@ -191,7 +261,8 @@ static void optimise_scenario(const SpikeTrainEnvironment &env,
 	std::cout << "=====================" << std::endl;
 	std::cout << std::endl;
 
-	run_optimisation(dims, params, env, group, EvaluationType::SPIKE_TRAIN);
+	run_optimisation(dims, params, env, group, EvaluationType::SPIKE_TRAIN,
+	                 useSurrogate, algorithm, robust, seed);
 
 	if (env.burstSize == 1 && group.nOut == 1) {
 		std::cout << std::endl;
@@ -200,7 +271,8 @@ static void optimise_scenario(const SpikeTrainEnvironment &env,
 		std::cout << "====================" << std::endl;
 		std::cout << std::endl;
 		run_optimisation(dims, params, env, group,
-		                 EvaluationType::SINGLE_GROUP_SINGLE_OUT);
+		                 EvaluationType::SINGLE_GROUP_SINGLE_OUT, useSurrogate,
+		                 algorithm, robust, seed);
 	}
 
 	std::cout << std::endl;
@@ -210,12 +282,36 @@ static void optimise_scenario(const SpikeTrainEnvironment &env,
 	std::cout << std::endl;
 
 	run_optimisation(dims, params, env, group,
-	                 EvaluationType::SINGLE_GROUP_MULTI_OUT);
+	                 EvaluationType::SINGLE_GROUP_MULTI_OUT, useSurrogate,
+	                 algorithm, robust, seed);
 	std::cout << std::endl;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+	// Use the surrogate model to skip unpromising evaluations, the CMA-ES
+	// algorithm, the robust re-ranking and a specific seed if requested
+	bool useSurrogate = false;
+	bool robust = false;
+	uint64_t seed = Optimization::DEFAULT_SEED;
+	OptimizationAlgorithm algorithm = OptimizationAlgorithm::SIMPLEX;
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--surrogate") {
+			useSurrogate = true;
+		} else if (std::string(argv[i]) == "--cma-es") {
+			algorithm = OptimizationAlgorithm::CMA_ES;
+		} else if (std::string(argv[i]) == "--robust") {
+			robust = true;
+		} else if (std::string(argv[i]) == "--seed" && i + 1 < argc) {
+			seed = std::stoull(argv[++i]);
+		} else {
+			std::cerr << "Usage: " << argv[0]
+			          << " [--surrogate] [--cma-es] [--robust] [--seed <N>]"
+			          << std::endl;
+			return 1;
+		}
+	}
+
 	signal(SIGINT, int_handler);
 
 	// Run the exploration, write the result matrices to a file
@@ -226,7 +322,8 @@ int main()
 	std::cout << std::endl;
 
 	optimise_scenario(SpikeTrainEnvironment(1, 200_ms, 5_ms, 10_ms),
-	                  SingleGroupMultiOutDescriptor(3, 2, 1));
+	                  SingleGroupMultiOutDescriptor(3, 2, 1), useSurrogate,
+	                  algorithm, robust, seed);
 
 	// Run the exploration, write the result matrices to a file
 	std::cout << std::endl;
@@ -236,7 +333,8 @@ int main()
 	std::cout << std::endl;
 
 	optimise_scenario(SpikeTrainEnvironment(3, 200_ms, 5_ms, 10_ms),
-	                  SingleGroupMultiOutDescriptor(3, 2, 1));
+	                  SingleGroupMultiOutDescriptor(3, 2, 1), useSurrogate,
+	                  algorithm, robust, seed);
 
 	// Run the exploration, write the result matrices to a file
 	std::cout << std::endl;
@@ -246,7 +344,8 @@ int main()
 	std::cout << std::endl;
 
 	optimise_scenario(SpikeTrainEnvironment(3, 200_ms, 5_ms, 10_ms),
-	                  SingleGroupMultiOutDescriptor(9, 6, 1));
+	                  SingleGroupMultiOutDescriptor(9, 6, 1), useSurrogate,
+	                  algorithm, robust, seed);
 
 	return 0;
 }
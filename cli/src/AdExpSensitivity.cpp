@@ -0,0 +1,226 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Calculates the first-order and total Sobol indices of all evaluation result
+ * dimensions with respect to the selected working parameters, which are
+ * sampled from the parameter ranges of the default ParameterCollection or from
+ * a relative spread around the default parameters. Lists the parameters which
+ * have no notable influence on the optimization dimension and can thus be
+ * excluded from the optimization.
+ */
+
+#include <exploration/SensitivityAnalysis.hpp>
+#include <exploration/SpikeTrainEvaluation.hpp>
+#include <exploration/SingleGroupSingleOutEvaluation.hpp>
+#include <exploration/SingleGroupMultiOutEvaluation.hpp>
+#include <common/Timer.hpp>
+#include <utils/ParameterCollection.hpp>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace AdExpSim;
+
+static bool cancel = false;
+void int_handler(int)
+{
+	if (cancel) {
+		exit(1);
+	}
+	cancel = true;
+}
+
+static bool showProgress(Val progress)
+{
+	std::cerr << std::setw(8) << std::setprecision(4) << progress * 100.0
+	          << "%   \r";
+	return !cancel;
+}
+
+static void usage(const char *name)
+{
+	std::cerr << "Usage: " << name
+	          << " <MODEL> <EVALUATION> [--samples N] [--bootstrap N]"
+	             " [--dims optimize|explore|all] [--spread X] [--threshold X]"
+	             " [--threads N] [--seed N]"
+	          << std::endl;
+	std::cerr << "MODEL is one of IfCondExp, AdIfCondExp" << std::endl;
+	std::cerr << "EVALUATION is one of Train, SgSo, SgMo" << std::endl;
+}
+
+static void printResult(const SensitivityResult &res, Val threshold)
+{
+	const size_t d = res.dims.size();
+	std::cout << std::fixed << std::setprecision(3);
+	for (size_t k = 0; k < res.descriptor.size(); k++) {
+		std::cout << std::endl;
+		std::cout << res.descriptor.name(k) << " (variance "
+		          << res.variance[k] << ")" << std::endl;
+		std::cout << std::setw(12) << "parameter" << std::setw(18)
+		          << "first-order" << std::setw(18) << "total" << std::endl;
+		for (size_t i = 0; i < d; i++) {
+			const SensitivityIndex &idx = res(k, i);
+			std::cout << std::setw(12) << WorkingParameters::names[res.dims[i]]
+			          << std::setw(9) << idx.first << " +- " << std::setw(5)
+			          << idx.firstConf << std::setw(9) << idx.total << " +- "
+			          << std::setw(5) << idx.totalConf << std::endl;
+		}
+	}
+
+	const size_t dim = res.descriptor.optimizationDim();
+	std::cout << std::endl;
+	std::cout << "Parameters with total index below " << threshold << " for "
+	          << res.descriptor.name(dim) << ":";
+	for (size_t i : res.insensitive(dim, threshold)) {
+		std::cout << " " << WorkingParameters::names[i];
+	}
+	std::cout << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	signal(SIGINT, int_handler);
+
+	if (argc < 3) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	// Parse the model and evaluation type
+	ParameterCollection pc;
+	auto model = std::find(ParameterCollection::modelNames.begin(),
+	                       ParameterCollection::modelNames.end(), argv[1]);
+	auto evaluation =
+	    std::find(ParameterCollection::evaluationNames.begin(),
+	              ParameterCollection::evaluationNames.end(), argv[2]);
+	if (model == ParameterCollection::modelNames.end() ||
+	    evaluation == ParameterCollection::evaluationNames.end()) {
+		std::cerr << "Invalid model or evaluation name" << std::endl;
+		return 1;
+	}
+	pc.model = ModelType(model - ParameterCollection::modelNames.begin());
+	pc.evaluation = EvaluationType(
+	    evaluation - ParameterCollection::evaluationNames.begin());
+	const bool useIfCondExp = pc.model == ModelType::IF_COND_EXP;
+
+	// Parse the options
+	size_t samples = 1024, bootstrap = 100, threads = 0;
+	uint64_t seed = SensitivityAnalysis::DEFAULT_SEED;
+	Val threshold = 0.01, spread = 0.0;
+	std::string dimsName = "optimize";
+	for (int i = 3; i < argc; i++) {
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--samples" && hasValue) {
+			samples = std::max<size_t>(1, std::stoul(argv[++i]));
+		} else if (arg == "--bootstrap" && hasValue) {
+			bootstrap = std::stoul(argv[++i]);
+		} else if (arg == "--dims" && hasValue) {
+			dimsName = argv[++i];
+		} else if (arg == "--spread" && hasValue) {
+			spread = std::stod(argv[++i]);
+		} else if (arg == "--threshold" && hasValue) {
+			threshold = std::stod(argv[++i]);
+		} else if (arg == "--threads" && hasValue) {
+			threads = std::stoul(argv[++i]);
+		} else if (arg == "--seed" && hasValue) {
+			seed = std::stoull(argv[++i]);
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Select the analysed dimensions and sample them from the parameter
+	// ranges of the ParameterCollection, or from the given relative spread
+	// around the base parameters
+	std::vector<size_t> dims;
+	if (dimsName == "optimize") {
+		dims = pc.optimizationDims();
+	} else if (dimsName == "explore") {
+		dims = pc.explorationDims();
+	} else if (dimsName == "all") {
+		for (size_t i = 0; i < WorkingParameters::Size; i++) {
+			dims.push_back(i);
+		}
+	} else {
+		usage(argv[0]);
+		return 1;
+	}
+	if (useIfCondExp) {
+		dims.erase(std::remove_if(dims.begin(), dims.end(), [](size_t i) {
+			           return !WorkingParameters::inIfCondExp[i];
+			       }), dims.end());
+	}
+	const WorkingParameters params(pc.params);
+	std::vector<Range> ranges;
+	for (size_t i : dims) {
+		if (spread > 0.0) {
+			const Val a = params[i] * (1.0 - spread);
+			const Val b = params[i] * (1.0 + spread);
+			ranges.emplace_back(std::min(a, b), std::max(a, b));
+		} else {
+			ranges.emplace_back(pc.min[i], pc.max[i]);
+		}
+	}
+
+	SensitivityAnalysis analysis(params, dims, ranges, samples);
+	analysis.setBootstrap(bootstrap);
+	analysis.setSeed(seed);
+	analysis.setThreads(threads);
+	std::cout << "Analysing " << dims.size() << " parameters with "
+	          << analysis.evaluations() << " evaluations" << std::endl;
+
+	Timer timer;
+	SensitivityResult res;
+	switch (pc.evaluation) {
+		case EvaluationType::SPIKE_TRAIN:
+			res = analysis.run(SpikeTrainEvaluation(pc.train, useIfCondExp),
+			                   showProgress);
+			break;
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			res = analysis.run(
+			    SingleGroupSingleOutEvaluation(pc.environment, pc.singleGroup,
+			                                   useIfCondExp),
+			    showProgress);
+			break;
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			res = analysis.run(
+			    SingleGroupMultiOutEvaluation(pc.environment, pc.singleGroup,
+			                                  useIfCondExp),
+			    showProgress);
+			break;
+	}
+	timer.pause();
+	std::cerr << std::endl;
+
+	if (!res.valid()) {
+		std::cout << "Manually aborted sensitivity analysis" << std::endl;
+		return 1;
+	}
+	printResult(res, threshold);
+	std::cout << std::endl;
+	std::cout << timer << std::endl;
+	return 0;
+}
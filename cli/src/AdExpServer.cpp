@@ -0,0 +1,338 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Headless compute server. Accepts exploration and optimization jobs from the
+ * GUI (or any other RemoteClient) over a Unix domain or TCP socket, runs them
+ * using all local cores and streams the results back to the client. If the
+ * persistent result store is enabled (see ResultStore::defaultFilename()),
+ * jobs keep running when the client disconnects and their results can be
+ * fetched from the store by resubmitting the job. Otherwise jobs are aborted
+ * when the client disconnects.
+ */
+
+#include <exploration/Exploration.hpp>
+#include <exploration/Optimization.hpp>
+#include <exploration/SpikeTrainEvaluation.hpp>
+#include <exploration/SingleGroupSingleOutEvaluation.hpp>
+#include <exploration/SingleGroupMultiOutEvaluation.hpp>
+#include <simulation/HardwareParameters.hpp>
+#include <io/RemoteIo.hpp>
+#include <io/ResultStore.hpp>
+
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace AdExpSim;
+
+/**
+ * Persistent store containing the results of earlier jobs, shared by all
+ * jobs. nullptr if the store is disabled.
+ */
+static std::shared_ptr<ResultStore> resultStore;
+
+/**
+ * State of a single job running on the server.
+ */
+struct Job {
+	std::thread thread;
+	std::atomic<bool> aborted;
+	std::atomic<bool> finished;
+
+	Job() : aborted(false), finished(false) {}
+};
+
+/**
+ * Runs an exploration job and streams tiles and progress to the client.
+ */
+static void explore(RemoteConnection &connection, RemoteIo::ExploreJob job,
+                    Job &state)
+{
+	Exploration exploration =
+	    job.useFullParams
+	        ? Exploration(true, job.fullParams, job.dimX, job.dimY,
+	                      job.rangeX, job.rangeY)
+	        : Exploration(job.params, job.dimX, job.dimY, job.rangeX,
+	                      job.rangeY);
+	exploration.setResultCache(resultStore);
+
+	const uint32_t id = job.id;
+	auto progressCallback = [&](Val p) -> bool {
+		connection.send(RemoteIo::encodeProgress(id, p));
+		return !state.aborted.load();
+	};
+	auto tileCallback = [&](const ExplorationTile &tile) {
+		connection.send(RemoteIo::encodeTile(id, tile));
+	};
+
+	const ParameterCollection &params = job.collection;
+	bool ok = false;
+	switch (params.evaluation) {
+		case EvaluationType::SPIKE_TRAIN:
+			ok = exploration.run(
+			    SpikeTrainEvaluation(params.train,
+			                         params.model == ModelType::IF_COND_EXP),
+			    progressCallback, tileCallback);
+			break;
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			ok = exploration.run(SingleGroupSingleOutEvaluation(
+			                         params.environment, params.singleGroup,
+			                         params.model == ModelType::IF_COND_EXP),
+			                     progressCallback, tileCallback);
+			break;
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			ok = exploration.run(SingleGroupMultiOutEvaluation(
+			                         params.environment, params.singleGroup,
+			                         params.model == ModelType::IF_COND_EXP),
+			                     progressCallback, tileCallback);
+			break;
+	}
+	connection.send(RemoteIo::encodeDone(id, ok && !state.aborted.load()));
+}
+
+/**
+ * Runs an optimization job and streams the intermediate results to the
+ * client.
+ */
+static void optimize(RemoteConnection &connection, RemoteIo::OptimizeJob job,
+                     Job &state)
+{
+	const ParameterCollection &params = job.collection;
+	const std::vector<size_t> dims = params.optimizationDims();
+	Optimization optimization =
+	    job.limitToHw
+	        ? Optimization(params.model, dims, BrainScaleSParameters::inst)
+	        : Optimization(params.model, dims);
+	optimization.setAlgorithm(job.algorithm);
+	optimization.setResultCache(resultStore);
+
+	std::vector<WorkingParameters> input{params.params};
+	RemoteIo::OptimizationState res{job.id, false, 0, 0, 0.0, {}};
+	auto progressCallback =
+	    [&](size_t nIt, size_t nInput, float eval,
+	        const std::vector<OptimizationResult> &output,
+	        const SurrogateStatistics &) -> bool {
+		res.nIt = nIt;
+		res.nInput = nInput;
+		res.eval = eval;
+		res.output = output;
+		connection.send(RemoteIo::encodeOptimization(res));
+		return !state.aborted.load();
+	};
+
+	switch (params.evaluation) {
+		case EvaluationType::SPIKE_TRAIN:
+			res.output = optimization.optimize(
+			    input,
+			    SpikeTrainEvaluation(params.train,
+			                         params.model == ModelType::IF_COND_EXP),
+			    progressCallback);
+			break;
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			res.output = optimization.optimize(
+			    input, SingleGroupSingleOutEvaluation(
+			               params.environment, params.singleGroup,
+			               params.model == ModelType::IF_COND_EXP),
+			    progressCallback);
+			break;
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			res.output = optimization.optimize(
+			    input, SingleGroupMultiOutEvaluation(
+			               params.environment, params.singleGroup,
+			               params.model == ModelType::IF_COND_EXP),
+			    progressCallback);
+			break;
+	}
+
+	// Send the final result
+	res.done = true;
+	res.nInput = 0;
+	res.eval = 0.0;
+	connection.send(RemoteIo::encodeOptimization(res));
+	connection.send(RemoteIo::encodeDone(job.id, !state.aborted.load()));
+}
+
+/**
+ * Runs the given job function, reports errors to the client instead of
+ * terminating the server.
+ */
+template <typename F>
+static void runJob(RemoteConnection &connection, uint32_t id, F f)
+{
+	try {
+		f();
+	}
+	catch (const std::exception &ex) {
+		std::cerr << "Error in job " << id << ": " << ex.what() << std::endl;
+		connection.send(RemoteIo::encodeDone(id, false));
+	}
+}
+
+/**
+ * Handles the messages of a single client until the connection is closed.
+ */
+static void session(std::unique_ptr<RemoteConnection> connection)
+{
+	std::map<uint32_t, std::unique_ptr<Job>> jobs;
+
+	// Joins and removes all jobs which have finished. If "wait" is set, waits
+	// for all jobs to finish, if "abort" is set, aborts them beforehand.
+	auto reap = [&jobs](bool wait, bool abort) {
+		for (auto it = jobs.begin(); it != jobs.end();) {
+			if (abort) {
+				it->second->aborted.store(true);
+			}
+			std::thread &thread = it->second->thread;
+			if (wait || it->second->finished.load() || !thread.joinable()) {
+				if (thread.joinable()) {
+					thread.join();
+				}
+				it = jobs.erase(it);
+			} else {
+				it++;
+			}
+		}
+	};
+
+	// Starts a new job, aborts any job with the same id
+	auto start = [&](uint32_t id) -> Job & {
+		auto it = jobs.find(id);
+		if (it != jobs.end()) {
+			it->second->aborted.store(true);
+			if (it->second->thread.joinable()) {
+				it->second->thread.join();
+			}
+			jobs.erase(it);
+		}
+		Job *job = new Job();
+		jobs.emplace(id, std::unique_ptr<Job>(job));
+		return *job;
+	};
+
+	RemoteConnection &conn = *connection;
+	RemoteMessage msg;
+	while (conn.receive(msg)) {
+		reap(false, false);
+		try {
+			switch (msg.type()) {
+				case RemoteMessageType::EXPLORE: {
+					RemoteIo::ExploreJob job;
+					if (!RemoteIo::decodeExplore(msg, job)) {
+						std::cerr << "Invalid exploration request" << std::endl;
+						break;
+					}
+					Job &state = start(job.id);
+					state.thread = std::thread([&conn, job, &state]() {
+						runJob(conn, job.id,
+						       [&]() { explore(conn, job, state); });
+						state.finished.store(true);
+					});
+					break;
+				}
+				case RemoteMessageType::OPTIMIZE: {
+					RemoteIo::OptimizeJob job;
+					if (!RemoteIo::decodeOptimize(msg, job)) {
+						std::cerr << "Invalid optimization request"
+						          << std::endl;
+						break;
+					}
+					Job &state = start(job.id);
+					state.thread = std::thread([&conn, job, &state]() {
+						runJob(conn, job.id,
+						       [&]() { optimize(conn, job, state); });
+						state.finished.store(true);
+					});
+					break;
+				}
+				case RemoteMessageType::CANCEL: {
+					uint32_t id;
+					if (msg.read(id)) {
+						auto it = jobs.find(id);
+						if (it != jobs.end()) {
+							it->second->aborted.store(true);
+						}
+					}
+					break;
+				}
+				default:
+					std::cerr << "Unexpected message type " << int(msg.type())
+					          << std::endl;
+					break;
+			}
+		}
+		catch (const std::exception &ex) {
+			// Malformed requests must not take down the other sessions
+			std::cerr << "Error while handling a request: " << ex.what()
+			          << std::endl;
+		}
+	}
+
+	// The client disconnected. If results are stored persistently, let the
+	// running jobs finish, so restarting them later (e.g. from a new GUI
+	// instance) reuses their results. Otherwise their results are lost, so
+	// abort them.
+	std::cerr << "Client disconnected" << std::endl;
+	reap(true, resultStore == nullptr);
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc > 2) {
+		std::cerr << "Usage: " << argv[0] << " [ADDRESS]" << std::endl;
+		std::cerr << "ADDRESS is either unix:PATH or [HOST]:PORT, defaults to "
+		          << RemoteIo::DEFAULT_ADDRESS << std::endl;
+		return 1;
+	}
+
+	const std::string address =
+	    argc > 1 ? std::string(argv[1]) : RemoteIo::DEFAULT_ADDRESS;
+	RemoteListener listener(address);
+	if (!listener.good()) {
+		std::cerr << "Error while listening on " << address << std::endl;
+		return 1;
+	}
+	std::cerr << "Listening on " << address << std::endl;
+
+	// Open the persistent result store
+	const std::string storeFilename = ResultStore::defaultFilename();
+	if (!storeFilename.empty()) {
+		resultStore = std::make_shared<ResultStore>(storeFilename);
+		if (!resultStore->good()) {
+			std::cerr << "Cannot open result store " << storeFilename
+			          << std::endl;
+			resultStore = nullptr;
+		}
+	}
+
+	while (true) {
+		std::unique_ptr<RemoteConnection> connection = listener.accept();
+		if (!connection) {
+			std::cerr << "Error while accepting a connection" << std::endl;
+			continue;
+		}
+		std::cerr << "Client connected" << std::endl;
+		std::thread(session, std::move(connection)).detach();
+	}
+	return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Samples the selected working parameters with a fixed budget of quasi-random
+ * samples. The samples are streamed to a sweep file while the sweep is
+ * running, afterwards the sweep is projected onto each pair of swept
+ * parameters and the projections are written as exploration files.
+ */
+
+#include <exploration/Sweep.hpp>
+#include <exploration/SpikeTrainEvaluation.hpp>
+#include <exploration/SingleGroupSingleOutEvaluation.hpp>
+#include <exploration/SingleGroupMultiOutEvaluation.hpp>
+#include <io/ExplorationIo.hpp>
+#include <io/SweepIo.hpp>
+#include <common/Timer.hpp>
+#include <utils/ParameterCollection.hpp>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace AdExpSim;
+
+static bool cancel = false;
+void int_handler(int)
+{
+	if (cancel) {
+		exit(1);
+	}
+	cancel = true;
+}
+
+static bool showProgress(Val progress)
+{
+	std::cerr << std::setw(8) << std::setprecision(4) << progress * 100.0
+	          << "%   \r";
+	return !cancel;
+}
+
+static void usage(const char *name)
+{
+	std::cerr << "Usage: " << name
+	          << " <MODEL> <EVALUATION> [--samples N] [--sampling sobol|lhs]"
+	             " [--dims optimize|explore|all] [--spread X]"
+	             " [--resolution N] [--threads N] [--seed N]"
+	             " [--output PREFIX]"
+	          << std::endl;
+	std::cerr << "MODEL is one of IfCondExp, AdIfCondExp" << std::endl;
+	std::cerr << "EVALUATION is one of Train, SgSo, SgMo" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	signal(SIGINT, int_handler);
+
+	if (argc < 3) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	// Parse the model and evaluation type
+	ParameterCollection pc;
+	auto model = std::find(ParameterCollection::modelNames.begin(),
+	                       ParameterCollection::modelNames.end(), argv[1]);
+	auto evaluation =
+	    std::find(ParameterCollection::evaluationNames.begin(),
+	              ParameterCollection::evaluationNames.end(), argv[2]);
+	if (model == ParameterCollection::modelNames.end() ||
+	    evaluation == ParameterCollection::evaluationNames.end()) {
+		std::cerr << "Invalid model or evaluation name" << std::endl;
+		return 1;
+	}
+	pc.model = ModelType(model - ParameterCollection::modelNames.begin());
+	pc.evaluation = EvaluationType(
+	    evaluation - ParameterCollection::evaluationNames.begin());
+	const bool useIfCondExp = pc.model == ModelType::IF_COND_EXP;
+
+	// Parse the options
+	size_t samples = 16384, resolution = 64, threads = 0;
+	uint64_t seed = Sweep::DEFAULT_SEED;
+	Val spread = 0.0;
+	SweepSampling sampling = SweepSampling::SOBOL;
+	std::string dimsName = "optimize";
+	std::string prefix = std::string("sweep_") + argv[1] + "_" + argv[2];
+	for (int i = 3; i < argc; i++) {
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--samples" && hasValue) {
+			samples = std::max<size_t>(1, std::stoul(argv[++i]));
+		} else if (arg == "--sampling" && hasValue &&
+		           std::string(argv[i + 1]) == "sobol") {
+			sampling = SweepSampling::SOBOL;
+			i++;
+		} else if (arg == "--sampling" && hasValue &&
+		           std::string(argv[i + 1]) == "lhs") {
+			sampling = SweepSampling::LATIN_HYPERCUBE;
+			i++;
+		} else if (arg == "--dims" && hasValue) {
+			dimsName = argv[++i];
+		} else if (arg == "--spread" && hasValue) {
+			spread = std::stod(argv[++i]);
+		} else if (arg == "--resolution" && hasValue) {
+			resolution = std::max<size_t>(1, std::stoul(argv[++i]));
+		} else if (arg == "--threads" && hasValue) {
+			threads = std::stoul(argv[++i]);
+		} else if (arg == "--seed" && hasValue) {
+			seed = std::stoull(argv[++i]);
+		} else if (arg == "--output" && hasValue) {
+			prefix = argv[++i];
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Select the swept dimensions and sample them from the parameter ranges of
+	// the ParameterCollection, or from the given relative spread around the
+	// base parameters
+	std::vector<size_t> dims;
+	if (dimsName == "optimize") {
+		dims = pc.optimizationDims();
+	} else if (dimsName == "explore") {
+		dims = pc.explorationDims();
+	} else if (dimsName == "all") {
+		for (size_t i = 0; i < WorkingParameters::Size; i++) {
+			dims.push_back(i);
+		}
+	} else {
+		usage(argv[0]);
+		return 1;
+	}
+	if (useIfCondExp) {
+		dims.erase(std::remove_if(dims.begin(), dims.end(), [](size_t i) {
+			           return !WorkingParameters::inIfCondExp[i];
+			       }), dims.end());
+	}
+	const WorkingParameters params(pc.params);
+	std::vector<Range> ranges;
+	for (size_t i : dims) {
+		if (spread > 0.0) {
+			const Val a = params[i] * (1.0 - spread);
+			const Val b = params[i] * (1.0 + spread);
+			ranges.emplace_back(std::min(a, b), std::max(a, b));
+		} else {
+			ranges.emplace_back(pc.min[i], pc.max[i]);
+		}
+	}
+
+	Sweep sweep(params, dims, ranges, samples, sampling);
+	sweep.setSeed(seed);
+	sweep.setThreadCount(threads);
+	std::cout << "Sweeping " << dims.size() << " parameters with " << samples
+	          << " samples" << std::endl;
+
+	// Write the chunks to the sweep file as soon as they are complete. The
+	// writer is created with the first chunk, as the result descriptor is only
+	// known once the sweep has started.
+	const std::string filename = prefix + ".adsweep";
+	std::unique_ptr<SweepWriter> writer;
+	bool writeOk = true;
+	auto chunkCallback = [&](const SweepMemory &mem, size_t c) {
+		if (!writer) {
+			writer.reset(new SweepWriter(filename, sweep, mem.descriptor));
+		}
+		writeOk = writer->storeChunk(mem, c) && writeOk;
+	};
+
+	Timer timer;
+	bool ok = false;
+	switch (pc.evaluation) {
+		case EvaluationType::SPIKE_TRAIN:
+			ok = sweep.run(SpikeTrainEvaluation(pc.train, useIfCondExp),
+			               showProgress, chunkCallback);
+			break;
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			ok = sweep.run(
+			    SingleGroupSingleOutEvaluation(pc.environment, pc.singleGroup,
+			                                   useIfCondExp),
+			    showProgress, chunkCallback);
+			break;
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			ok = sweep.run(
+			    SingleGroupMultiOutEvaluation(pc.environment, pc.singleGroup,
+			                                  useIfCondExp),
+			    showProgress, chunkCallback);
+			break;
+	}
+	timer.pause();
+	if (writer) {
+		writer->close();
+	}
+	std::cerr << std::endl;
+
+	// Report the written file, an aborted sweep leaves a partial file in which
+	// only the completed samples are marked as valid
+	if (!writeOk) {
+		std::cerr << "Error while writing " << filename << std::endl;
+		return 1;
+	}
+	if (!ok) {
+		std::cout << "Manually aborted sweep" << std::endl;
+		if (writer) {
+			std::cout << "Partial sweep written to " << filename << std::endl;
+		}
+		return 1;
+	}
+	std::cout << "Sweep written to " << filename << std::endl;
+
+	// Project the sweep onto each pair of swept parameters
+	for (size_t i = 0; i < dims.size(); i++) {
+		for (size_t j = i + 1; j < dims.size(); j++) {
+			const std::string projectionFilename =
+			    prefix + "_X" + WorkingParameters::nameIds[dims[i]] + "_Y" +
+			    WorkingParameters::nameIds[dims[j]] + ".adexpl";
+			if (!ExplorationIo::storeExploration(
+			        projectionFilename,
+			        sweep.project(i, j, resolution, resolution))) {
+				std::cerr << "Error while writing " << projectionFilename
+				          << std::endl;
+				return 1;
+			}
+			std::cout << "Projection written to " << projectionFilename
+			          << std::endl;
+		}
+	}
+	std::cout << std::endl;
+	std::cout << timer << std::endl;
+	return 0;
+}
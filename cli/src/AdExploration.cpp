@@ -21,6 +21,7 @@
 #include <iostream>
 #include <fstream>
 #include <limits>
+#include <memory>
 
 #include <exploration/Exploration.hpp>
 #include <exploration/SpikeTrainEvaluation.hpp>
@@ -28,6 +29,8 @@
 #include <exploration/SingleGroupMultiOutEvaluation.hpp>
 #include <simulation/Model.hpp>
 #include <simulation/Recorder.hpp>
+#include <io/ExplorationIo.hpp>
+#include <io/ResultStore.hpp>
 #include <io/SurfacePlotIo.hpp>
 #include <utils/ParameterCollection.hpp>
 #include <common/Timer.hpp>
@@ -40,6 +43,21 @@ using namespace AdExpSim;
  * even if it is not responsive (the cancel flag is not checked).
  */
 static bool cancel = false;
+
+/**
+ * Persistent store containing the results of earlier runs, nullptr if the
+ * store is disabled. The store is only used if the ADEXPSIM_RESULT_STORE
+ * environment variable is set, otherwise the simulation statistics are
+ * printed.
+ */
+static std::shared_ptr<ResultStore> resultStore;
+
+/**
+ * If set, each result dimension is additionally written as text surface plot
+ * (one CSV file per dimension).
+ */
+static bool writeCsv = false;
+
 void int_handler(int)
 {
 	if (cancel) {
@@ -118,58 +136,121 @@ bool runExploration(const std::string &prefix, const SpikeTrainEnvironment &env,
 
 	const bool useIfCondExp = (model == ModelType::IF_COND_EXP);
 
+	// Assemble the output file name
+	static size_t idx = 0;
+	idx++;
+	std::string filename = "i" + std::to_string(idx) + "_" + prefix + "_" +
+	    ParameterCollection::evaluationNames[size_t(evaluation)];
+	if (evaluation == EvaluationType::SPIKE_TRAIN) {
+		filename = filename + "_N" + std::to_string(spikeTrainN);
+	}
+	filename = filename + "_X" + Parameters::nameIds[dimX] + "_Y" +
+	    Parameters::nameIds[dimY] + "_" +
+	    ParameterCollection::modelNames[size_t(model)];
+
 	bool ok = false;
 	Exploration exploration(true, params, dimX, dimY, rangeX, rangeY);
+	const uint64_t hits0 = resultStore ? resultStore->hits() : 0;
+	const uint64_t lookups0 = resultStore ? resultStore->lookups() : 0;
+	if (resultStore) {
+		// Reuse the results of earlier runs. The instrumentation counters are
+		// only available if all simulations are actually executed.
+		exploration.setResultCache(resultStore);
+	} else {
+		exploration.setCollectStatistics(true);
+	}
+	// Write the tiles to the exploration file as soon as they are complete.
+	// The writer is created with the first tile, as the result dimensions are
+	// only known once the exploration has started.
+	std::unique_ptr<ExplorationWriter> writer;
+	bool writeOk = true;
+	auto tileCallback = [&](const ExplorationTile &tile) {
+		if (!writer) {
+			writer.reset(new ExplorationWriter(filename + ".adexpl",
+			                                   exploration,
+			                                   exploration.mem().descriptor));
+		}
+		writeOk = writer->storeTile(tile) && writeOk;
+	};
+
 	Timer timer;
 	switch (evaluation) {
 		case EvaluationType::SPIKE_TRAIN: {
 			SpikeTrain train(singleGroup, spikeTrainN, env, false);
 			ok = exploration.run(SpikeTrainEvaluation(train, useIfCondExp),
-			                     showProgress);
+			                     showProgress, tileCallback);
 			break;
 		}
 		case EvaluationType::SINGLE_GROUP_SINGLE_OUT: {
 			ok = exploration.run(
 			    SingleGroupSingleOutEvaluation(env, singleGroup, useIfCondExp),
-			    showProgress);
+			    showProgress, tileCallback);
 			break;
 		}
 		case EvaluationType::SINGLE_GROUP_MULTI_OUT: {
 			ok = exploration.run(
 			    SingleGroupMultiOutEvaluation(env, singleGroup, useIfCondExp),
-			    showProgress);
+			    showProgress, tileCallback);
 			break;
 		}
 	}
 	timer.pause();
+	if (writer) {
+		writer->close();
+	}
 	std::cout << std::endl;
 	std::cout << "Done." << std::endl;
 	std::cout << timer << std::endl;
 
-	// Dump the results
-	if (ok && !cancel) {
-		static size_t idx = 0;
-		idx++;
+	if (resultStore) {
+		std::cout << "Result store hits: " << (resultStore->hits() - hits0)
+		          << "/" << (resultStore->lookups() - lookups0) << std::endl;
+	} else {
+		const SimulationStatistics &stats = exploration.statistics();
+		std::cout << "Simulations: " << stats.simulations << std::endl;
+		std::cout << "Integrator steps: " << stats.steps << " ("
+		          << stats.rejectedSteps << " rejected)" << std::endl;
+		std::cout << "RHS evaluations: " << stats.rhsEvaluations << std::endl;
+		std::cout << "Input/output spikes: " << stats.inputSpikes << "/"
+		          << stats.outputSpikes << std::endl;
+		std::cout << "Terminated by end time/controller abort/settled: "
+		          << stats.termination(TerminationReason::END_TIME) << "/"
+		          << stats.termination(TerminationReason::CONTROLLER_ABORT)
+		          << "/"
+		          << stats.termination(TerminationReason::CONTROLLER_SETTLED)
+		          << std::endl;
+	}
 
+	// Report the written file, an aborted exploration leaves a partial file
+	// in which only the completed rows are marked as valid
+	if (!writeOk) {
+		std::cerr << "Error while writing " << filename << ".adexpl"
+		          << std::endl;
+		return false;
+	}
+	if (!ok || cancel) {
+		if (writer) {
+			std::cout << "Partial exploration written to " << filename
+			          << ".adexpl" << std::endl;
+		}
+		return false;
+	}
+	std::cout << "Exploration written to " << filename << ".adexpl"
+	          << std::endl;
+
+	// Write the individual layers as text files if requested
+	if (writeCsv) {
 		const EvaluationResultDescriptor &descr = exploration.descriptor();
 		for (size_t i = 0; i < descr.size(); i++) {
-			std::string filename = "i" + std::to_string(idx) + "_" + prefix + "_" +
-			    ParameterCollection::evaluationNames[size_t(evaluation)];
-			if (evaluation == EvaluationType::SPIKE_TRAIN) {
-				filename = filename + "_N" + std::to_string(spikeTrainN);
-			}
-			filename = filename + "_X" + Parameters::nameIds[dimX] + "_Y" +
-			    Parameters::nameIds[dimY] + "_" + descr.id(i) + "_" +
-			    ParameterCollection::evaluationNames[size_t(evaluation)] + "_" +
-			    ParameterCollection::modelNames[size_t(model)] + ".csv";
-			std::cout << "Writing layer " << descr.id(i) << " to " << filename
-			          << std::endl;
-			std::ofstream os(filename);
+			const std::string layerFilename =
+			    filename + "_" + descr.id(i) + ".csv";
+			std::cout << "Writing layer " << descr.id(i) << " to "
+			          << layerFilename << std::endl;
+			std::ofstream os(layerFilename);
 			SurfacePlotIo::storeSurfacePlot(os, exploration, i, false);
 		}
-		return true;
 	}
-	return false;
+	return true;
 }
 
 bool runExplorations(const std::string &prefix,
@@ -209,10 +290,30 @@ bool runExplorations(const std::string &prefix,
 	return true;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--csv") {
+			writeCsv = true;
+		} else {
+			std::cerr << "Usage: " << argv[0] << " [--csv]" << std::endl;
+			return 1;
+		}
+	}
+
 	signal(SIGINT, int_handler);
 
+	// Open the persistent result store
+	const std::string storeFilename = ResultStore::defaultFilename();
+	if (!storeFilename.empty()) {
+		resultStore = std::make_shared<ResultStore>(storeFilename);
+		if (!resultStore->good()) {
+			std::cerr << "Cannot open result store " << storeFilename
+			          << std::endl;
+			resultStore = nullptr;
+		}
+	}
+
 	// Setup the parameters, set an initial value for w
 	Parameters params;
 
@@ -0,0 +1,333 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <type_traits>
+
+#include "CompressedMatrix.hpp"
+
+namespace AdExpSim {
+
+constexpr size_t CompressedMatrix::BLOCK_SIZE;
+constexpr uint32_t CompressedMatrix::CONSTANT;
+constexpr uint32_t CompressedMatrix::BINARY;
+
+static_assert(CompressedMatrix::BLOCK_SIZE == 64,
+              "BinaryBlock masks hold exactly 64 values");
+
+template <>
+std::vector<uint8_t> &CompressedMatrix::dense<uint8_t>(Storage &s)
+{
+	return s.dense8;
+}
+
+template <>
+std::vector<uint16_t> &CompressedMatrix::dense<uint16_t>(Storage &s)
+{
+	return s.dense16;
+}
+
+template <>
+std::vector<uint32_t> &CompressedMatrix::dense<uint32_t>(Storage &s)
+{
+	return s.dense32;
+}
+
+template <>
+const std::vector<uint8_t> &CompressedMatrix::dense<uint8_t>(
+    const Storage &s)
+{
+	return s.dense8;
+}
+
+template <>
+const std::vector<uint16_t> &CompressedMatrix::dense<uint16_t>(
+    const Storage &s)
+{
+	return s.dense16;
+}
+
+template <>
+const std::vector<uint32_t> &CompressedMatrix::dense<uint32_t>(
+    const Storage &s)
+{
+	return s.dense32;
+}
+
+/**
+ * Calls the given function with a null pointer of the code type used for the
+ * given encoding.
+ */
+template <typename F>
+static void dispatch(MatrixEncoding encoding, F f)
+{
+	switch (encoding) {
+		case MatrixEncoding::QUANTIZED8:
+			f(static_cast<uint8_t *>(nullptr));
+			break;
+		case MatrixEncoding::QUANTIZED16:
+			f(static_cast<uint16_t *>(nullptr));
+			break;
+		default:
+			f(static_cast<uint32_t *>(nullptr));
+			break;
+	}
+}
+
+CompressedMatrix::CompressedMatrix(size_t w, size_t h, MatrixEncoding encoding,
+                                   Range range)
+    : s(std::make_shared<Storage>()),
+      w(w),
+      h(h),
+      blocksPerRow((w + BLOCK_SIZE - 1) / BLOCK_SIZE),
+      encoding(encoding),
+      offs(0.0),
+      scale(1.0),
+      invScale(1.0),
+      maxCode(0xFFFFFFFF)
+{
+	if (encoding != MatrixEncoding::FLOAT32) {
+		maxCode = (encoding == MatrixEncoding::QUANTIZED8) ? 0xFF : 0xFFFF;
+		offs = range.min;
+		scale = std::max<Val>(0.0, range.max - range.min) / Val(maxCode);
+		invScale = scale > 0.0 ? 1.0 / scale : 0.0;
+	}
+	s->blocks.resize(blocksPerRow * h, Block{CONSTANT, encode(0.0)});
+}
+
+template <typename Code>
+uint32_t CompressedMatrix::allocDense(uint32_t code)
+{
+	std::vector<Code> &d = dense<Code>(*s);
+	uint32_t slot;
+	if (!s->freeDense.empty()) {
+		slot = s->freeDense.back();
+		s->freeDense.pop_back();
+	} else {
+		slot = d.size() / BLOCK_SIZE;
+		d.resize(d.size() + BLOCK_SIZE);
+	}
+	std::fill(d.begin() + slot * BLOCK_SIZE,
+	          d.begin() + (slot + 1) * BLOCK_SIZE, Code(code));
+	return slot;
+}
+
+template <typename Code>
+void CompressedMatrix::setCode(size_t x, size_t y, uint32_t code)
+{
+	Block &b = s->blocks[y * blocksPerRow + x / BLOCK_SIZE];
+	const size_t i = x % BLOCK_SIZE;
+	if (b.slot == CONSTANT) {
+		// Nothing to do if the value does not change, otherwise convert the
+		// block to a dense block
+		if (b.code == code) {
+			return;
+		}
+		b.slot = allocDense<Code>(b.code);
+	} else if (b.slot & BINARY) {
+		// Just update the mask if the code is one of the two codes, otherwise
+		// convert the block to a dense block
+		const uint32_t idx = b.slot & ~BINARY;
+		BinaryBlock &bb = s->binary[idx];
+		const uint64_t bit = uint64_t(1) << i;
+		if (code == bb.hi) {
+			bb.mask |= bit;
+			return;
+		} else if (code == bb.lo) {
+			bb.mask &= ~bit;
+			return;
+		}
+		const BinaryBlock old = bb;
+		s->freeBinary.push_back(idx);
+		b.slot = allocDense<Code>(old.lo);
+		Code *d = &dense<Code>(*s)[b.slot * BLOCK_SIZE];
+		for (size_t j = 0; j < BLOCK_SIZE; j++) {
+			if ((old.mask >> j) & 1) {
+				d[j] = old.hi;
+			}
+		}
+	}
+	dense<Code>(*s)[b.slot * BLOCK_SIZE + i] = Code(code);
+}
+
+void CompressedMatrix::set(size_t x, size_t y, Val v)
+{
+	detatch();
+	const uint32_t code = encode(v);
+	dispatch(encoding, [&](auto c) {
+		this->setCode<typename std::remove_pointer<decltype(c)>::type>(x, y,
+		                                                               code);
+	});
+}
+
+template <typename Code>
+void CompressedMatrix::compactBlock(Block &b, size_t n)
+{
+	if (b.slot == CONSTANT || (b.slot & BINARY)) {
+		return;
+	}
+
+	// Check whether the block contains at most two distinct codes, build the
+	// mask selecting the second code
+	const Code *d = &dense<Code>(*s)[b.slot * BLOCK_SIZE];
+	const Code lo = d[0];
+	Code hi = lo;
+	bool hasHi = false;
+	uint64_t mask = 0;
+	for (size_t i = 1; i < n; i++) {
+		if (d[i] == lo) {
+			continue;
+		}
+		if (!hasHi) {
+			hi = d[i];
+			hasHi = true;
+		} else if (d[i] != hi) {
+			return;
+		}
+		mask |= uint64_t(1) << i;
+	}
+
+	// Release the dense block and replace it with the cheaper representation
+	s->freeDense.push_back(b.slot);
+	if (!hasHi) {
+		b = Block{CONSTANT, lo};
+		return;
+	}
+	uint32_t idx;
+	if (!s->freeBinary.empty()) {
+		idx = s->freeBinary.back();
+		s->freeBinary.pop_back();
+	} else {
+		idx = s->binary.size();
+		s->binary.emplace_back();
+	}
+	s->binary[idx] = BinaryBlock{mask, lo, hi};
+	b = Block{idx | BINARY, 0};
+}
+
+template <typename Code>
+void CompressedMatrix::pack()
+{
+	// Copy all used dense and two-valued blocks to new arrays, this drops the
+	// blocks released by compactBlock()
+	std::vector<Code> &d = dense<Code>(*s);
+	std::vector<Code> nd;
+	std::vector<BinaryBlock> nb;
+	nd.reserve(d.size() - s->freeDense.size() * BLOCK_SIZE);
+	nb.reserve(s->binary.size() - s->freeBinary.size());
+	for (Block &b : s->blocks) {
+		if (b.slot == CONSTANT) {
+			continue;
+		} else if (b.slot & BINARY) {
+			nb.push_back(s->binary[b.slot & ~BINARY]);
+			b.slot = uint32_t(nb.size() - 1) | BINARY;
+		} else {
+			nd.insert(nd.end(), d.begin() + b.slot * BLOCK_SIZE,
+			          d.begin() + (b.slot + 1) * BLOCK_SIZE);
+			b.slot = nd.size() / BLOCK_SIZE - 1;
+		}
+	}
+	d.swap(nd);
+	s->binary.swap(nb);
+	s->freeDense.clear();
+	s->freeBinary.clear();
+}
+
+void CompressedMatrix::compact(size_t x0, size_t y0, size_t x1, size_t y1)
+{
+	x1 = std::min(x1, w);
+	y1 = std::min(y1, h);
+	if (x0 >= x1 || y0 >= y1) {
+		return;
+	}
+	detatch();
+	dispatch(encoding, [&](auto c) {
+		using Code = typename std::remove_pointer<decltype(c)>::type;
+		for (size_t y = y0; y < y1; y++) {
+			for (size_t bi = x0 / BLOCK_SIZE; bi <= (x1 - 1) / BLOCK_SIZE;
+			     bi++) {
+				this->compactBlock<Code>(s->blocks[y * blocksPerRow + bi],
+				                         std::min(BLOCK_SIZE, w - bi * BLOCK_SIZE));
+			}
+		}
+	});
+}
+
+void CompressedMatrix::compact()
+{
+	compact(0, 0, w, h);
+	dispatch(encoding, [&](auto c) {
+		this->pack<typename std::remove_pointer<decltype(c)>::type>();
+	});
+}
+
+template <typename Code>
+void CompressedMatrix::decodeRow(size_t y, Val *out) const
+{
+	const Block *blocks = &s->blocks[y * blocksPerRow];
+	const std::vector<Code> &d = dense<Code>(*s);
+	for (size_t bi = 0; bi < blocksPerRow; bi++, out += BLOCK_SIZE) {
+		const Block &b = blocks[bi];
+		const size_t n = std::min(BLOCK_SIZE, w - bi * BLOCK_SIZE);
+		if (b.slot == CONSTANT) {
+			std::fill(out, out + n, decode(b.code));
+		} else if (b.slot & BINARY) {
+			const BinaryBlock &bb = s->binary[b.slot & ~BINARY];
+			const Val lo = decode(bb.lo), hi = decode(bb.hi);
+			for (size_t i = 0; i < n; i++) {
+				out[i] = ((bb.mask >> i) & 1) ? hi : lo;
+			}
+		} else if (encoding == MatrixEncoding::FLOAT32) {
+			memcpy(out, &d[b.slot * BLOCK_SIZE], n * sizeof(Val));
+		} else {
+			// Plain loop over the codes, vectorized by the compiler
+			const Code *src = &d[b.slot * BLOCK_SIZE];
+			const Val o = offs, sc = scale;
+			for (size_t i = 0; i < n; i++) {
+				out[i] = o + sc * Val(src[i]);
+			}
+		}
+	}
+}
+
+void CompressedMatrix::decodeRows(size_t y0, size_t y1, Val *out) const
+{
+	dispatch(encoding, [&](auto c) {
+		using Code = typename std::remove_pointer<decltype(c)>::type;
+		for (size_t y = y0; y < y1; y++) {
+			this->decodeRow<Code>(y, out + (y - y0) * w);
+		}
+	});
+}
+
+Matrix CompressedMatrix::decode() const
+{
+	Matrix res(w, h);
+	decodeRows(0, h, res.data());
+	return res;
+}
+
+size_t CompressedMatrix::memoryUsage() const
+{
+	return sizeof(Block) * s->blocks.size() +
+	       sizeof(BinaryBlock) * s->binary.size() +
+	       sizeof(uint8_t) * s->dense8.size() +
+	       sizeof(uint16_t) * s->dense16.size() +
+	       sizeof(uint32_t) * s->dense32.size();
+}
+}
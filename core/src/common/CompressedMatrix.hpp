@@ -0,0 +1,311 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file CompressedMatrix.hpp
+ *
+ * Matrix storing floating point values in a quantized and block compressed
+ * form. Used to keep the results of very large explorations in memory.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_COMPRESSED_MATRIX_HPP_
+#define _ADEXPSIM_COMPRESSED_MATRIX_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Matrix.hpp"
+#include "Types.hpp"
+
+namespace AdExpSim {
+
+/**
+ * Specifies how the individual values of a CompressedMatrix are stored.
+ */
+enum class MatrixEncoding : int {
+	/**
+	 * Values are stored as 32-bit floating point values without loss of
+	 * precision.
+	 */
+	FLOAT32 = 0,
+
+	/**
+	 * Values are linearly quantized to 16 bits within the value range given
+	 * in the constructor.
+	 */
+	QUANTIZED16 = 1,
+
+	/**
+	 * Values are linearly quantized to 8 bits within the value range given in
+	 * the constructor.
+	 */
+	QUANTIZED8 = 2
+};
+
+/**
+ * The CompressedMatrix class stores a two dimensional field of values. Each
+ * row is split into blocks of BLOCK_SIZE values. Blocks are either stored as
+ * a single constant value, as a bit mask selecting between two values (e.g. for
+ * binary result dimensions) or as a dense array of encoded values. Writing to
+ * a constant or two-valued block converts it to a dense block, compact() turns
+ * dense blocks back into the cheaper representations. Uses copy on write
+ * semantics just as the Matrix class.
+ */
+class CompressedMatrix {
+public:
+	/**
+	 * Number of values in a single block.
+	 */
+	static constexpr size_t BLOCK_SIZE = 64;
+
+private:
+	/**
+	 * Slot value marking a constant block.
+	 */
+	static constexpr uint32_t CONSTANT = 0xFFFFFFFF;
+
+	/**
+	 * Flag marking the slot of a two-valued block.
+	 */
+	static constexpr uint32_t BINARY = 0x80000000;
+
+	/**
+	 * Descriptor of a single block. Slot either is CONSTANT, in which case
+	 * code is the value of the entire block, contains the BINARY flag and the
+	 * index of a BinaryBlock, or is the index of a dense block.
+	 */
+	struct Block {
+		uint32_t slot;
+		uint32_t code;
+	};
+
+	/**
+	 * Block consisting of two values only, a set bit in mask selects the
+	 * code hi, an unset bit the code lo.
+	 */
+	struct BinaryBlock {
+		uint64_t mask;
+		uint32_t lo;
+		uint32_t hi;
+	};
+
+	/**
+	 * Memory shared between copies of the matrix. Only the dense array
+	 * matching the encoding is used.
+	 */
+	struct Storage {
+		std::vector<Block> blocks;
+		std::vector<BinaryBlock> binary;
+		std::vector<uint8_t> dense8;
+		std::vector<uint16_t> dense16;
+		std::vector<uint32_t> dense32;
+		std::vector<uint32_t> freeBinary;
+		std::vector<uint32_t> freeDense;
+	};
+
+	/**
+	 * Shared pointer referencing the memory, used for the copy on write
+	 * behaviour.
+	 */
+	std::shared_ptr<Storage> s;
+
+	/**
+	 * Width and height of the matrix and number of blocks per row.
+	 */
+	size_t w, h, blocksPerRow;
+
+	/**
+	 * Encoding of the values.
+	 */
+	MatrixEncoding encoding;
+
+	/**
+	 * Offset and scale used to convert quantized codes to values, maximum
+	 * quantized code.
+	 */
+	Val offs, scale, invScale;
+	uint32_t maxCode;
+
+	template <typename Code>
+	static std::vector<Code> &dense(Storage &s);
+
+	template <typename Code>
+	static const std::vector<Code> &dense(const Storage &s);
+
+	template <typename Code>
+	uint32_t allocDense(uint32_t code);
+
+	template <typename Code>
+	void setCode(size_t x, size_t y, uint32_t code);
+
+	template <typename Code>
+	void compactBlock(Block &b, size_t n);
+
+	template <typename Code>
+	void pack();
+
+	template <typename Code>
+	void decodeRow(size_t y, Val *out) const;
+
+	/**
+	 * Returns the code stored at index i of the given dense block.
+	 */
+	uint32_t denseCode(uint32_t slot, size_t i) const
+	{
+		const size_t idx = slot * BLOCK_SIZE + i;
+		switch (encoding) {
+			case MatrixEncoding::QUANTIZED8:
+				return s->dense8[idx];
+			case MatrixEncoding::QUANTIZED16:
+				return s->dense16[idx];
+			default:
+				return s->dense32[idx];
+		}
+	}
+
+	/**
+	 * Clones the internal memory, making this instance independent from
+	 * changes made by others.
+	 */
+	void detatch()
+	{
+		if (s.use_count() > 1) {
+			s = std::make_shared<Storage>(*s);
+		}
+	}
+
+public:
+	/**
+	 * Default constructor. Creates an empty matrix.
+	 */
+	CompressedMatrix() : CompressedMatrix(0, 0) {}
+
+	/**
+	 * Creates a new matrix with the given extent, all values are initialized
+	 * with the lower boundary of the range.
+	 *
+	 * @param encoding specifies how the values are stored.
+	 * @param range is the value range used for the quantization, values outside
+	 * of this range are clamped. Ignored for MatrixEncoding::FLOAT32.
+	 */
+	CompressedMatrix(size_t w, size_t h,
+	                 MatrixEncoding encoding = MatrixEncoding::FLOAT32,
+	                 Range range = Range(0.0, 1.0));
+
+	/**
+	 * Converts the given value to its code.
+	 */
+	uint32_t encode(Val v) const
+	{
+		if (encoding == MatrixEncoding::FLOAT32) {
+			uint32_t code;
+			memcpy(&code, &v, sizeof(code));
+			return code;
+		}
+		if (!(v > offs)) {
+			return 0;
+		}
+		const Val c = (v - offs) * invScale + Val(0.5);
+		return c >= maxCode ? maxCode : uint32_t(c);
+	}
+
+	/**
+	 * Converts the given code back to a value.
+	 */
+	Val decode(uint32_t code) const
+	{
+		if (encoding == MatrixEncoding::FLOAT32) {
+			Val v;
+			memcpy(&v, &code, sizeof(v));
+			return v;
+		}
+		return offs + scale * Val(code);
+	}
+
+	/**
+	 * Returns the value at position x and y.
+	 */
+	Val operator()(size_t x, size_t y) const
+	{
+		const Block &b = s->blocks[y * blocksPerRow + x / BLOCK_SIZE];
+		const size_t i = x % BLOCK_SIZE;
+		if (b.slot == CONSTANT) {
+			return decode(b.code);
+		} else if (b.slot & BINARY) {
+			const BinaryBlock &bb = s->binary[b.slot & ~BINARY];
+			return decode(((bb.mask >> i) & 1) ? bb.hi : bb.lo);
+		}
+		return decode(denseCode(b.slot, i));
+	}
+
+	/**
+	 * Sets the value at position x and y.
+	 */
+	void set(size_t x, size_t y, Val v);
+
+	/**
+	 * Converts blocks within the given region which only contain one or two
+	 * distinct values to the compact representations. Should be called once
+	 * a region has been written.
+	 */
+	void compact(size_t x0, size_t y0, size_t x1, size_t y1);
+
+	/**
+	 * Compacts the entire matrix and releases the memory of all blocks which
+	 * are no longer used.
+	 */
+	void compact();
+
+	/**
+	 * Decodes the rows y0 to y1 (exclusive) to the given memory, which must
+	 * provide space for (y1 - y0) * width values.
+	 */
+	void decodeRows(size_t y0, size_t y1, Val *out) const;
+
+	/**
+	 * Decodes the entire matrix.
+	 */
+	Matrix decode() const;
+
+	/**
+	 * Returns the number of bytes currently occupied by the matrix data.
+	 */
+	size_t memoryUsage() const;
+
+	/**
+	 * Returns the width of the matrix.
+	 */
+	size_t getWidth() const { return w; }
+
+	/**
+	 * Returns the height of the matrix.
+	 */
+	size_t getHeight() const { return h; }
+
+	/**
+	 * Returns the encoding of the values.
+	 */
+	MatrixEncoding getEncoding() const { return encoding; }
+};
+}
+
+#endif /* _ADEXPSIM_COMPRESSED_MATRIX_HPP_ */
@@ -0,0 +1,160 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ConcurrentQueue.hpp
+ *
+ * Contains a bounded, lock-free queue which allows multiple threads to
+ * exchange data without blocking each other.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_CONCURRENT_QUEUE_HPP_
+#define _ADEXPSIM_CONCURRENT_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace AdExpSim {
+
+/**
+ * The ConcurrentQueue class is a bounded multi-producer, multi-consumer FIFO
+ * queue which does not use any locks. Each slot of the ring buffer carries a
+ * sequence number which tells producers and consumers whether the slot is
+ * currently free or filled; the read and write positions are claimed with a
+ * single compare-and-swap operation.
+ */
+template <typename T>
+class ConcurrentQueue {
+private:
+	/**
+	 * A single slot of the ring buffer.
+	 */
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	/**
+	 * Ring buffer, its size is a power of two.
+	 */
+	std::unique_ptr<Cell[]> buffer;
+
+	/**
+	 * Size of the ring buffer minus one, used to wrap the positions.
+	 */
+	size_t mask;
+
+	/**
+	 * Position the next element is written to.
+	 */
+	std::atomic<size_t> enqueuePos;
+
+	/**
+	 * Position the next element is read from.
+	 */
+	std::atomic<size_t> dequeuePos;
+
+public:
+	/**
+	 * Constructor of the ConcurrentQueue class.
+	 *
+	 * @param capacity is the minimum number of elements the queue can hold.
+	 * The capacity is rounded up to the next power of two.
+	 */
+	explicit ConcurrentQueue(size_t capacity)
+	    : enqueuePos(0), dequeuePos(0)
+	{
+		size_t size = 2;
+		while (size < capacity) {
+			size *= 2;
+		}
+		buffer.reset(new Cell[size]);
+		mask = size - 1;
+		for (size_t i = 0; i < size; i++) {
+			buffer[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	ConcurrentQueue(const ConcurrentQueue &) = delete;
+	ConcurrentQueue &operator=(const ConcurrentQueue &) = delete;
+
+	/**
+	 * Appends an element to the queue. Returns false if the queue is full, in
+	 * this case the element is not moved.
+	 */
+	bool push(T &&value)
+	{
+		Cell *cell;
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &buffer[pos & mask];
+			const size_t seq = cell->sequence.load(std::memory_order_acquire);
+			const std::ptrdiff_t diff =
+			    std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+			if (diff == 0) {
+				if (enqueuePos.compare_exchange_weak(
+				        pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+		cell->data = std::move(value);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Removes the first element from the queue and moves it into the given
+	 * variable. Returns false if the queue is empty.
+	 */
+	bool pop(T &value)
+	{
+		Cell *cell;
+		size_t pos = dequeuePos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &buffer[pos & mask];
+			const size_t seq = cell->sequence.load(std::memory_order_acquire);
+			const std::ptrdiff_t diff =
+			    std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1);
+			if (diff == 0) {
+				if (dequeuePos.compare_exchange_weak(
+				        pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+		value = std::move(cell->data);
+		cell->sequence.store(pos + mask + 1, std::memory_order_release);
+		return true;
+	}
+};
+}
+
+#endif /* _ADEXPSIM_CONCURRENT_QUEUE_HPP_ */
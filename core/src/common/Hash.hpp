@@ -0,0 +1,109 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Hash.hpp
+ *
+ * Contains the Hash class, a small helper for calculating stable 64-bit hashes
+ * of simulation inputs.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_HASH_HPP_
+#define _ADEXPSIM_HASH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Types.hpp"
+
+namespace AdExpSim {
+
+/**
+ * The Hash class calculates the FNV-1a hash of a sequence of values. In
+ * contrast to std::hash the result only depends on the bit patterns of the
+ * values, so it is stable across program runs and may be stored on disk. Note
+ * that the values are hashed in the native byte order.
+ */
+class Hash {
+private:
+	/**
+	 * Current hash value.
+	 */
+	uint64_t mHash;
+
+public:
+	/**
+	 * Creates a new Hash instance, the initial state is the FNV-1a offset
+	 * basis.
+	 */
+	Hash() : mHash(14695981039346656037ULL) {}
+
+	/**
+	 * Adds the given memory region to the hash.
+	 */
+	Hash &add(const void *data, size_t size)
+	{
+		const uint8_t *p = static_cast<const uint8_t *>(data);
+		for (size_t i = 0; i < size; i++) {
+			mHash = (mHash ^ p[i]) * 1099511628211ULL;
+		}
+		return *this;
+	}
+
+	/**
+	 * Adds a single arithmetic or enum value to the hash. Structures are
+	 * deliberately not supported, as their padding bytes are undefined.
+	 */
+	template <typename T>
+	Hash &operator<<(const T &value)
+	{
+		static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+		              "Only arithmetic and enum types can be hashed");
+		return add(&value, sizeof(T));
+	}
+
+	/**
+	 * Adds the given time value to the hash.
+	 */
+	Hash &operator<<(const Time &t) { return *this << t.t; }
+
+	/**
+	 * Adds the size and all elements of the given vector to the hash.
+	 */
+	template <typename T>
+	Hash &operator<<(const std::vector<T> &vec)
+	{
+		*this << uint64_t(vec.size());
+		for (const T &value : vec) {
+			*this << value;
+		}
+		return *this;
+	}
+
+	/**
+	 * Returns the current hash value.
+	 */
+	uint64_t value() const { return mHash; }
+};
+}
+
+#endif /* _ADEXPSIM_HASH_HPP_ */
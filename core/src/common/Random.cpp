@@ -0,0 +1,161 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Random.hpp"
+
+namespace AdExpSim {
+
+constexpr size_t SobolSequence::MAX_DIMS;
+constexpr size_t SobolSequence::BITS;
+
+void RandomStream::fill(uint32_t *dst, size_t n)
+{
+	// Each iteration is independent of all others, so the loop can be
+	// vectorized
+	const size_t nBlocks = (n + 3) / 4;
+	const uint64_t first = block;
+	for (size_t i = 0; i < n / 4; i++) {
+		const Philox::Counter c = generate(first + i);
+		dst[4 * i + 0] = c[0];
+		dst[4 * i + 1] = c[1];
+		dst[4 * i + 2] = c[2];
+		dst[4 * i + 3] = c[3];
+	}
+	if (n % 4 != 0) {
+		const Philox::Counter c = generate(first + nBlocks - 1);
+		for (size_t j = 0; j < n % 4; j++) {
+			dst[4 * (nBlocks - 1) + j] = c[j];
+		}
+	}
+
+	// Continue with the block following the generated ones
+	block = first + nBlocks;
+	pos = 4;
+}
+
+void RandomStream::uniform(Val *dst, size_t n, Val a, Val b)
+{
+	std::vector<uint32_t> raw(n);
+	fill(raw.data(), n);
+	const Val scale = b - a;
+	for (size_t i = 0; i < n; i++) {
+		dst[i] = a + scale * toUniform(raw[i]);
+	}
+}
+
+void RandomStream::normal(Val *dst, size_t n, Val mu, Val sigma)
+{
+	static constexpr Val TWO_PI = 2.0 * M_PI;
+
+	// Each pair of uniform numbers yields two normally distributed numbers,
+	// the first half of the result is taken from the cosine branch of the
+	// Box-Muller transform, the second half from the sine branch. The branches
+	// are calculated in separate loops, which allows the compiler to vectorize
+	// them instead of merging the calls into a scalar sincos.
+	const size_t m = (n + 1) / 2;
+	std::vector<uint32_t> raw(2 * m);
+	fill(raw.data(), raw.size());
+	std::vector<Val> r(m), phi(m);
+	for (size_t i = 0; i < m; i++) {
+		r[i] = sigma * std::sqrt(Val(-2.0) * std::log(toUniform(raw[i])));
+		phi[i] = TWO_PI * toUniform(raw[m + i]);
+	}
+	for (size_t i = 0; i < m; i++) {
+		dst[i] = mu + r[i] * std::cos(phi[i]);
+	}
+	for (size_t i = m; i < n; i++) {
+		dst[i] = mu + r[i - m] * std::sin(phi[i - m]);
+	}
+}
+
+/**
+ * Primitive polynomials and initial direction numbers for the dimensions two
+ * and above, taken from the "new-joe-kuo-6.21201" table. The polynomial is
+ * stored as its degree s and the coefficients a of the inner terms, the
+ * initial direction numbers m are odd and smaller than 2^(i + 1).
+ */
+struct SobolDirection {
+	uint32_t s;
+	uint32_t a;
+	uint32_t m[7];
+};
+
+static const SobolDirection SOBOL_DIRECTIONS[SobolSequence::MAX_DIMS - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}}};
+
+void SobolSequence::init(size_t dims)
+{
+	this->dims = std::min(dims, MAX_DIMS);
+	shift.fill(0);
+
+	// The first dimension is the van der Corput sequence
+	for (size_t b = 0; b < BITS; b++) {
+		v[0][b] = uint32_t(1) << (BITS - 1 - b);
+	}
+
+	// All other dimensions follow the recurrence defined by their polynomial
+	for (size_t d = 1; d < this->dims; d++) {
+		const SobolDirection &dir = SOBOL_DIRECTIONS[d - 1];
+		for (size_t b = 0; b < BITS; b++) {
+			if (b < dir.s) {
+				v[d][b] = dir.m[b] << (BITS - 1 - b);
+			} else {
+				uint32_t x = v[d][b - dir.s] ^ (v[d][b - dir.s] >> dir.s);
+				for (size_t k = 1; k < dir.s; k++) {
+					if ((dir.a >> (dir.s - 1 - k)) & 1) {
+						x ^= v[d][b - k];
+					}
+				}
+				v[d][b] = x;
+			}
+		}
+	}
+}
+
+SobolSequence::SobolSequence(size_t dims, uint64_t seed)
+{
+	init(dims);
+	RandomStream random(seed);
+	for (size_t d = 0; d < this->dims; d++) {
+		shift[d] = random();
+	}
+}
+}
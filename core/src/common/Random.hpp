@@ -0,0 +1,292 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Random.hpp
+ *
+ * Contains a counter-based random number generator. Each random number is a
+ * pure function of the seed, the stream id and its index, so independent
+ * streams can be handed out to threads or tasks without any synchronization
+ * and the result does not depend on the order in which they are consumed.
+ * Additionally contains the Sobol low-discrepancy sequence, whose points are
+ * a pure function of their index as well.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_RANDOM_HPP_
+#define _ADEXPSIM_RANDOM_HPP_
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "Types.hpp"
+
+namespace AdExpSim {
+
+/**
+ * Implementation of the Philox4x32-10 bijection described in Salmon et al.,
+ * "Parallel Random Numbers: As Easy as 1, 2, 3", 2011. Maps a 128 bit counter
+ * and a 64 bit key onto 128 random bits.
+ */
+struct Philox {
+	using Counter = std::array<uint32_t, 4>;
+	using Key = std::array<uint32_t, 2>;
+
+	/**
+	 * Applies the ten Philox rounds to the given counter.
+	 */
+	static Counter generate(Counter c, Key k)
+	{
+		static constexpr uint64_t M0 = 0xD2511F53;
+		static constexpr uint64_t M1 = 0xCD9E8D57;
+		static constexpr uint32_t W0 = 0x9E3779B9;
+		static constexpr uint32_t W1 = 0xBB67AE85;
+		for (size_t i = 0; i < 10; i++) {
+			const uint64_t p0 = M0 * c[0];
+			const uint64_t p1 = M1 * c[2];
+			c = Counter{{uint32_t(p1 >> 32) ^ c[1] ^ k[0], uint32_t(p1),
+			             uint32_t(p0 >> 32) ^ c[3] ^ k[1], uint32_t(p0)}};
+			k[0] += W0;
+			k[1] += W1;
+		}
+		return c;
+	}
+};
+
+/**
+ * The RandomStream class addresses a stream of random numbers by a seed (e.g.
+ * identifying an optimization run) and a stream id (e.g. identifying a task).
+ * The n-th number of a stream is always the same, no matter which thread
+ * requests it. Fulfills the UniformRandomBitGenerator concept, so it can be
+ * used with the distributions from the <random> header.
+ */
+class RandomStream {
+public:
+	using result_type = uint32_t;
+
+private:
+	/**
+	 * Philox key derived from the seed.
+	 */
+	Philox::Key key;
+
+	/**
+	 * Stream id, stored in the upper half of the Philox counter.
+	 */
+	uint64_t stream;
+
+	/**
+	 * Index of the next block of four random numbers.
+	 */
+	uint64_t block;
+
+	/**
+	 * Current block of random numbers and index of the next unused number.
+	 */
+	Philox::Counter buf;
+	size_t pos;
+
+	/**
+	 * Generates the block with the given index.
+	 */
+	Philox::Counter generate(uint64_t idx) const
+	{
+		return Philox::generate(
+		    Philox::Counter{{uint32_t(idx), uint32_t(idx >> 32),
+		                     uint32_t(stream), uint32_t(stream >> 32)}},
+		    key);
+	}
+
+	/**
+	 * Generates n raw random numbers into the given buffer, starting at the
+	 * next block boundary.
+	 */
+	void fill(uint32_t *dst, size_t n);
+
+public:
+	/**
+	 * Constructor of the RandomStream class.
+	 *
+	 * @param seed is the global seed, e.g. of a single optimization run.
+	 * @param stream is the id of the stream within the seed, e.g. a task id.
+	 * @param offset is the index of the first random number.
+	 */
+	RandomStream(uint64_t seed = 0, uint64_t stream = 0, uint64_t offset = 0)
+	    : key{{uint32_t(seed), uint32_t(seed >> 32)}}, stream(stream)
+	{
+		seek(offset);
+	}
+
+	/**
+	 * Jumps to the random number with the given index in O(1).
+	 */
+	void seek(uint64_t offset)
+	{
+		block = offset / 4;
+		pos = offset % 4;
+		buf = generate(block++);
+	}
+
+	static constexpr result_type min() { return 0; }
+
+	static constexpr result_type max()
+	{
+		return std::numeric_limits<result_type>::max();
+	}
+
+	/**
+	 * Returns the next random number.
+	 */
+	result_type operator()()
+	{
+		if (pos == 4) {
+			buf = generate(block++);
+			pos = 0;
+		}
+		return buf[pos++];
+	}
+
+	/**
+	 * Returns a uniformly distributed value in the open interval (0, 1).
+	 */
+	Val uniform() { return toUniform((*this)()); }
+
+	/**
+	 * Fills the given array with n values uniformly distributed in the
+	 * interval (a, b). The numbers are generated in blocks, which allows the
+	 * compiler to vectorize the generator.
+	 */
+	void uniform(Val *dst, size_t n, Val a = 0.0, Val b = 1.0);
+
+	/**
+	 * Fills the given array with n normally distributed values with mean mu
+	 * and standard deviation sigma using the Box-Muller transform.
+	 */
+	void normal(Val *dst, size_t n, Val mu = 0.0, Val sigma = 1.0);
+
+	/**
+	 * Converts a raw random number to a uniformly distributed value in the
+	 * open interval (0, 1).
+	 */
+	static Val toUniform(uint32_t x)
+	{
+		return (Val(x >> 8) + Val(0.5)) * Val(1.0 / 16777216.0);
+	}
+
+	/**
+	 * Derives a stream id from the content of the given vector, so that tasks
+	 * working on the same data use the same random numbers, regardless of
+	 * the thread which executes them.
+	 */
+	template <typename Vector>
+	static uint64_t streamId(const Vector &v)
+	{
+		// FNV-1a hash over the bit patterns of the vector elements
+		uint64_t hash = 14695981039346656037ULL;
+		for (const Val &x : v) {
+			uint32_t bits;
+			std::memcpy(&bits, &x, sizeof(bits));
+			hash = (hash ^ bits) * 1099511628211ULL;
+		}
+		return hash;
+	}
+};
+
+/**
+ * The SobolSequence class generates the points of the Sobol low-discrepancy
+ * sequence using the direction numbers by Joe and Kuo, "Constructing Sobol
+ * sequences with better two-dimensional projections", 2008. The first 2^m
+ * points cover the unit hypercube far more evenly than the same number of
+ * random points. Points are calculated directly from their index, so they can
+ * be generated in parallel and in any order.
+ */
+class SobolSequence {
+public:
+	/**
+	 * Maximum number of dimensions supported by the direction number table.
+	 */
+	static constexpr size_t MAX_DIMS = 21;
+
+private:
+	/**
+	 * Number of bits of each coordinate.
+	 */
+	static constexpr size_t BITS = 32;
+
+	/**
+	 * Number of dimensions.
+	 */
+	size_t dims;
+
+	/**
+	 * Direction numbers for each dimension and bit.
+	 */
+	std::array<std::array<uint32_t, BITS>, MAX_DIMS> v;
+
+	/**
+	 * Random digital shift applied to each dimension, zero if the sequence is
+	 * not scrambled.
+	 */
+	std::array<uint32_t, MAX_DIMS> shift;
+
+	void init(size_t dims);
+
+public:
+	/**
+	 * Creates the plain Sobol sequence with the given number of dimensions,
+	 * which is clamped to MAX_DIMS.
+	 */
+	explicit SobolSequence(size_t dims) { init(dims); }
+
+	/**
+	 * Creates a Sobol sequence which is randomized by a digital shift derived
+	 * from the given seed. The shift preserves the uniformity of the
+	 * sequence, but different seeds yield independent point sets.
+	 */
+	SobolSequence(size_t dims, uint64_t seed);
+
+	/**
+	 * Writes the coordinates of the point with the given index to dst. All
+	 * coordinates lie in the open interval (0, 1).
+	 */
+	void point(uint64_t idx, Val *dst) const
+	{
+		// Each set bit of the Gray code of the index selects a direction number
+		const uint64_t gray = idx ^ (idx >> 1);
+		for (size_t d = 0; d < dims; d++) {
+			uint32_t x = shift[d];
+			for (size_t b = 0; b < BITS && (gray >> b) != 0; b++) {
+				if ((gray >> b) & 1) {
+					x ^= v[d][b];
+				}
+			}
+			dst[d] = RandomStream::toUniform(x);
+		}
+	}
+
+	/**
+	 * Returns the number of dimensions.
+	 */
+	size_t size() const { return dims; }
+};
+}
+
+#endif /* _ADEXPSIM_RANDOM_HPP_ */
@@ -0,0 +1,84 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ThreadLimit.hpp
+ *
+ * Contains the ThreadLimit class, which allows another thread to restrict the
+ * number of worker threads of a running computation.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_THREAD_LIMIT_HPP_
+#define _ADEXPSIM_THREAD_LIMIT_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+namespace AdExpSim {
+
+/**
+ * The ThreadLimit class holds the number of worker threads of a computation
+ * which are currently allowed to run. The worker threads of the computation
+ * are numbered starting with zero; a worker whose index is larger or equal to
+ * the limit pauses until the limit is increased again. The limit may be
+ * changed at any time from any thread, e.g. by a scheduler distributing a
+ * global CPU budget between several computations. A limit of zero pauses the
+ * computation entirely.
+ */
+class ThreadLimit {
+private:
+	/**
+	 * Number of worker threads currently allowed to run.
+	 */
+	std::atomic<size_t> mLimit;
+
+public:
+	/**
+	 * Value used to indicate that the number of threads is not restricted.
+	 */
+	static constexpr size_t UNLIMITED = std::numeric_limits<size_t>::max();
+
+	/**
+	 * Constructor of the ThreadLimit class.
+	 *
+	 * @param limit is the initial number of worker threads allowed to run.
+	 */
+	explicit ThreadLimit(size_t limit = UNLIMITED) : mLimit(limit) {}
+
+	/**
+	 * Sets the number of worker threads allowed to run.
+	 */
+	void set(size_t limit) { mLimit.store(limit); }
+
+	/**
+	 * Returns the number of worker threads allowed to run.
+	 */
+	size_t get() const { return mLimit.load(); }
+
+	/**
+	 * Returns true if the worker thread with the given index may currently
+	 * perform work, false if it should pause.
+	 */
+	bool allows(size_t idx) const { return idx < mLimit.load(); }
+};
+}
+
+#endif /* _ADEXPSIM_THREAD_LIMIT_HPP_ */
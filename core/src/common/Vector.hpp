@@ -167,6 +167,15 @@ public:
 		return map(v, [s](Val a) { return a / s; });
 	}
 
+	/**
+	 * Calculates s * v + acc. Used to accumulate the stages of the Runge-Kutta
+	 * integrators without creating an intermediate vector for each product.
+	 */
+	friend Impl fmadd(Val s, const T &v, const T &acc)
+	{
+		return map(v, acc, [s](Val a, Val b) { return s * a + b; });
+	}
+
 	friend std::ostream &operator<<(std::ostream &os, const T &m)
 	{
 		os << "{";
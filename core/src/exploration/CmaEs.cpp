@@ -0,0 +1,93 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CmaEs.hpp"
+
+namespace AdExpSim {
+namespace CmaEsInternal {
+
+// Maximum number of Jacobi sweeps
+static constexpr size_t MAX_SWEEPS = 50;
+
+void eigen(size_t n, std::vector<double> A, std::vector<double> &B,
+           std::vector<double> &d)
+{
+	// Start with the identity matrix as eigenvector matrix
+	B.assign(n * n, 0.0);
+	for (size_t i = 0; i < n; i++) {
+		B[i * n + i] = 1.0;
+	}
+
+	// Apply Jacobi rotations until all off-diagonal elements vanish
+	for (size_t sweep = 0; sweep < MAX_SWEEPS; sweep++) {
+		double off = 0.0;
+		for (size_t p = 0; p < n; p++) {
+			for (size_t q = p + 1; q < n; q++) {
+				off += A[p * n + q] * A[p * n + q];
+			}
+		}
+		if (off < 1e-30) {
+			break;
+		}
+
+		for (size_t p = 0; p < n; p++) {
+			for (size_t q = p + 1; q < n; q++) {
+				const double apq = A[p * n + q];
+				if (apq == 0.0) {
+					continue;
+				}
+
+				// Calculate the rotation angle
+				const double theta = (A[q * n + q] - A[p * n + p]) / (2.0 * apq);
+				const double t =
+				    (theta >= 0.0 ? 1.0 : -1.0) /
+				    (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+				const double c = 1.0 / std::sqrt(t * t + 1.0);
+				const double s = t * c;
+
+				// Rotate the rows/columns p and q of A and the columns of B
+				for (size_t k = 0; k < n; k++) {
+					const double akp = A[k * n + p];
+					const double akq = A[k * n + q];
+					A[k * n + p] = c * akp - s * akq;
+					A[k * n + q] = s * akp + c * akq;
+				}
+				for (size_t k = 0; k < n; k++) {
+					const double apk = A[p * n + k];
+					const double aqk = A[q * n + k];
+					A[p * n + k] = c * apk - s * aqk;
+					A[q * n + k] = s * apk + c * aqk;
+				}
+				for (size_t k = 0; k < n; k++) {
+					const double bkp = B[k * n + p];
+					const double bkq = B[k * n + q];
+					B[k * n + p] = c * bkp - s * bkq;
+					B[k * n + q] = s * bkp + c * bkq;
+				}
+			}
+		}
+	}
+
+	// The diagonal of A now contains the eigenvalues
+	d.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		d[i] = A[i * n + i];
+	}
+}
+}
+}
@@ -0,0 +1,411 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file CmaEs.hpp
+ *
+ * Contains a class implementing the Covariance Matrix Adaptation Evolution
+ * Strategy (CMA-ES) by Hansen and Ostermeier.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_CMA_ES_HPP_
+#define _ADEXPSIM_CMA_ES_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <common/Random.hpp>
+#include <common/Types.hpp>
+
+namespace AdExpSim {
+
+namespace CmaEsInternal {
+/**
+ * Calculates the eigen decomposition of the symmetric n x n matrix A (stored
+ * row by row) using the cyclic Jacobi method. The eigenvalues are written to
+ * d, the eigenvectors are written to the columns of B.
+ */
+void eigen(size_t n, std::vector<double> A, std::vector<double> &B,
+           std::vector<double> &d);
+}
+
+/**
+ * Class which implements the CMA-ES algorithm. In contrast to the Simplex
+ * algorithm, each generation consists of a population of independent
+ * candidates, which are evaluated in parallel on all processors. All
+ * dimensions are scaled relative to the initial vector, so the initial step
+ * size is given as fraction of the initial values.
+ *
+ * @tparam Vector is the vector type to which the optimization should be
+ * applied.
+ */
+template <typename Vector>
+class CmaEs {
+private:
+	Vector xInit;
+	std::vector<size_t> dims;
+	size_t lambda;
+	Val sigmaInit;
+	uint64_t seed, stream;
+
+	/**
+	 * Number of threads used to evaluate a population, zero selects one
+	 * thread per hardware thread.
+	 */
+	size_t threadCount;
+
+	/**
+	 * Returns the scale of the given dimension, used to normalize the search
+	 * space.
+	 */
+	Val scale(size_t i) const
+	{
+		const Val v = std::fabs(xInit[dims[i]]);
+		return v == 0.0 ? 1.0 : v;
+	}
+
+	/**
+	 * Converts a point in the normalized search space into a vector.
+	 */
+	Vector toVector(const std::vector<double> &z) const
+	{
+		Vector x = xInit;
+		for (size_t i = 0; i < dims.size(); i++) {
+			x[dims[i]] = xInit[dims[i]] + z[i] * scale(i);
+		}
+		return x;
+	}
+
+	/**
+	 * Evaluates the cost function for all given candidates in parallel, using
+	 * the number of threads set via setThreadCount(). Candidates with a
+	 * non-finite cost are assigned the maximum cost.
+	 */
+	template <typename Function>
+	void evaluate(Function f, const std::vector<Vector> &xs,
+	              std::vector<Val> &costs) const
+	{
+		std::atomic<size_t> next(0);
+		auto worker = [&]() {
+			size_t i;
+			while ((i = next.fetch_add(1)) < xs.size()) {
+				const Val cost = f(xs[i]);
+				costs[i] = std::isfinite(cost) ? cost
+				                               : std::numeric_limits<Val>::max();
+			}
+		};
+
+		const size_t nThreads = std::min<size_t>(
+		    xs.size(),
+		    threadCount > 0
+		        ? threadCount
+		        : std::max<size_t>(1, std::thread::hardware_concurrency()));
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < nThreads; i++) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+	}
+
+public:
+	struct CmaEsResult {
+		/**
+		 * Best vector.
+		 */
+		Vector best;
+
+		/**
+		 * Initial cost value.
+		 */
+		Val costInit;
+
+		/**
+		 * Best cost value.
+		 */
+		Val costBest;
+
+		/**
+		 * Constructor of the CmaEsResult class.
+		 */
+		CmaEsResult(const Vector &best, Val costInit, Val costBest)
+		    : best(best), costInit(costInit), costBest(costBest)
+		{
+		}
+	};
+
+	/**
+	 * Constructor of the CmaEs class.
+	 *
+	 * @param xInit is the initial mean vector.
+	 * @param dims is a vector containing the indices of the dimensions that
+	 * should be optimized.
+	 * @param lambda is the population size. If zero, the default population
+	 * size 4 + 3 * ln(n) is used, where n is the number of dimensions.
+	 * @param sigmaInit is the initial step size relative to the initial
+	 * values.
+	 */
+	CmaEs(const Vector &xInit, const std::vector<size_t> &dims,
+	      size_t lambda = 0, Val sigmaInit = 0.1)
+	    : xInit(xInit),
+	      dims(dims),
+	      lambda(lambda > 0 ? lambda
+	                        : 4 + size_t(3.0 * std::log(std::max<size_t>(
+	                                               1, dims.size())))),
+	      sigmaInit(sigmaInit),
+	      seed(1241249190),
+	      stream(0),
+	      threadCount(0)
+	{
+	}
+
+	/**
+	 * Sets the number of threads used to evaluate each population. Zero (the
+	 * default) selects one thread per hardware thread, one evaluates the
+	 * population on the thread calling run(), e.g. if run() is already called
+	 * from one thread per core.
+	 */
+	void setThreadCount(size_t threadCount)
+	{
+		this->threadCount = threadCount;
+	}
+
+	/**
+	 * Sets the seed and the stream id of the random numbers used to sample
+	 * the population. Two runs with the same seed and stream draw the same
+	 * populations.
+	 */
+	void setSeed(uint64_t seed, uint64_t stream = 0)
+	{
+		this->seed = seed;
+		this->stream = stream;
+	}
+
+	/**
+	 * Runs the optimization.
+	 *
+	 * @tparam Function is the cost function that should be used to evaluate
+	 * the vectors. Must be thread-safe.
+	 * @tparam Callback is a callback function that gets called once per
+	 * generation. Gets three arguments: The current number of generations, the
+	 * number of evaluated candidates and the currently best cost value. Should
+	 * return "false" if the operation is to be aborted, true otherwise.
+	 * @param f is the cost function.
+	 * @param callback is the callback function.
+	 * @param max_it is the maximum number of generations.
+	 * @param epsilon controls the abort condition of the algorithm. If the
+	 * difference between the best and the worst cost of the last generations
+	 * is smaller than epsilon, the algorithm aborts.
+	 * @return the best vector.
+	 */
+	template <typename Function, typename Callback>
+	CmaEsResult run(Function f, Callback callback,
+	                size_t max_it = std::numeric_limits<size_t>::max(),
+	                Val epsilon = 1e-5)
+	{
+		const size_t n = dims.size();
+		const Val costInit = f(xInit);
+		Vector xBest = xInit;
+		Val costBest = costInit;
+		if (n == 0) {
+			return CmaEsResult(xBest, costInit, costBest);
+		}
+
+		// Selection and recombination parameters
+		const size_t mu = lambda / 2;
+		std::vector<double> weights(mu);
+		for (size_t i = 0; i < mu; i++) {
+			weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+		}
+		const double wSum = std::accumulate(weights.begin(), weights.end(), 0.0);
+		double wSqSum = 0.0;
+		for (double &w : weights) {
+			w /= wSum;
+			wSqSum += w * w;
+		}
+		const double mueff = 1.0 / wSqSum;
+
+		// Adaptation parameters
+		const double N = n;
+		const double cc = (4.0 + mueff / N) / (N + 4.0 + 2.0 * mueff / N);
+		const double cs = (mueff + 2.0) / (N + mueff + 5.0);
+		const double c1 = 2.0 / ((N + 1.3) * (N + 1.3) + mueff);
+		const double cmu =
+		    std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) /
+		                           ((N + 2.0) * (N + 2.0) + mueff));
+		const double damps =
+		    1.0 + 2.0 * std::max(0.0, std::sqrt((mueff - 1.0) / (N + 1.0)) - 1.0) +
+		    cs;
+		const double chiN =
+		    std::sqrt(N) * (1.0 - 1.0 / (4.0 * N) + 1.0 / (21.0 * N * N));
+
+		// State: mean, step size, evolution paths and covariance matrix
+		std::vector<double> mean(n, 0.0), pc(n, 0.0), ps(n, 0.0);
+		std::vector<double> C(n * n, 0.0), B(n * n, 0.0), D(n, 1.0);
+		for (size_t i = 0; i < n; i++) {
+			C[i * n + i] = 1.0;
+			B[i * n + i] = 1.0;
+		}
+		double sigma = sigmaInit;
+
+		// Random numbers are drawn from the stream selected by setSeed()
+		RandomStream generator(seed, stream);
+		std::normal_distribution<double> dNorm(0.0, 1.0);
+
+		std::vector<std::vector<double>> dzs(lambda, std::vector<double>(n));
+		std::vector<std::vector<double>> ys(lambda, std::vector<double>(n));
+		std::vector<Vector> xs(lambda, xInit);
+		std::vector<Val> costs(lambda);
+		std::vector<size_t> idx(lambda);
+		std::vector<double> hist;
+		size_t samples = 0;
+
+		for (size_t it = 0; it < max_it; it++) {
+			// Sample the new population: y = B * D * z, x = mean + sigma * y
+			for (size_t k = 0; k < lambda; k++) {
+				std::vector<double> z(n);
+				for (size_t i = 0; i < n; i++) {
+					dzs[k][i] = D[i] * dNorm(generator);
+				}
+				for (size_t i = 0; i < n; i++) {
+					double s = 0.0;
+					for (size_t j = 0; j < n; j++) {
+						s += B[i * n + j] * dzs[k][j];
+					}
+					ys[k][i] = s;
+					z[i] = mean[i] + sigma * s;
+				}
+				xs[k] = toVector(z);
+			}
+
+			// Evaluate the entire generation in parallel and sort by cost
+			evaluate(f, xs, costs);
+			samples += lambda;
+			std::iota(idx.begin(), idx.end(), 0);
+			std::sort(idx.begin(), idx.end(), [&costs](size_t a, size_t b) {
+				return costs[a] < costs[b];
+			});
+			if (costs[idx[0]] < costBest) {
+				costBest = costs[idx[0]];
+				xBest = xs[idx[0]];
+			}
+
+			// Recombination: move the mean towards the best candidates
+			std::vector<double> yw(n, 0.0);
+			for (size_t k = 0; k < mu; k++) {
+				for (size_t i = 0; i < n; i++) {
+					yw[i] += weights[k] * ys[idx[k]][i];
+				}
+			}
+			for (size_t i = 0; i < n; i++) {
+				mean[i] += sigma * yw[i];
+			}
+
+			// Update the evolution paths, C^(-1/2) * yw = B * D^-1 * B^T * yw
+			std::vector<double> btyw(n, 0.0);
+			for (size_t i = 0; i < n; i++) {
+				for (size_t j = 0; j < n; j++) {
+					btyw[i] += B[j * n + i] * yw[j];
+				}
+				btyw[i] /= D[i];
+			}
+			double psNorm = 0.0;
+			for (size_t i = 0; i < n; i++) {
+				double s = 0.0;
+				for (size_t j = 0; j < n; j++) {
+					s += B[i * n + j] * btyw[j];
+				}
+				ps[i] = (1.0 - cs) * ps[i] + std::sqrt(cs * (2.0 - cs) * mueff) * s;
+				psNorm += ps[i] * ps[i];
+			}
+			psNorm = std::sqrt(psNorm);
+			const bool hsig =
+			    psNorm / std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * (it + 1))) /
+			        chiN <
+			    1.4 + 2.0 / (N + 1.0);
+			for (size_t i = 0; i < n; i++) {
+				pc[i] = (1.0 - cc) * pc[i] +
+				        (hsig ? std::sqrt(cc * (2.0 - cc) * mueff) * yw[i] : 0.0);
+			}
+
+			// Rank-one and rank-mu update of the covariance matrix
+			const double c1a = c1 * (hsig ? 1.0 : 1.0 - cc * (2.0 - cc));
+			for (size_t i = 0; i < n; i++) {
+				for (size_t j = 0; j <= i; j++) {
+					double rankMu = 0.0;
+					for (size_t k = 0; k < mu; k++) {
+						rankMu += weights[k] * ys[idx[k]][i] * ys[idx[k]][j];
+					}
+					const double c = (1.0 - c1a - cmu) * C[i * n + j] +
+					                 c1 * pc[i] * pc[j] + cmu * rankMu;
+					C[i * n + j] = c;
+					C[j * n + i] = c;
+				}
+			}
+
+			// Adapt the step size
+			sigma *= std::exp((cs / damps) * (psNorm / chiN - 1.0));
+
+			// Decompose C = B * D^2 * B^T
+			CmaEsInternal::eigen(n, C, B, D);
+			double dMax = 0.0;
+			for (size_t i = 0; i < n; i++) {
+				D[i] = std::sqrt(std::max(D[i], 1e-20));
+				dMax = std::max(dMax, D[i]);
+			}
+
+			// Report the progress
+			if (!callback(it + 1, samples, costBest)) {
+				break;
+			}
+
+			// Abort if the costs of the last generations are flat or the
+			// search distribution has collapsed
+			hist.push_back(costs[idx[0]]);
+			const size_t histLen = 10 + size_t(30.0 * N / lambda);
+			if (hist.size() > histLen) {
+				hist.erase(hist.begin());
+			}
+			const double histRange =
+			    *std::max_element(hist.begin(), hist.end()) -
+			    *std::min_element(hist.begin(), hist.end());
+			const double genRange = costs[idx[lambda - 1]] - costs[idx[0]];
+			if ((hist.size() == histLen && histRange < epsilon &&
+			     genRange < epsilon) ||
+			    sigma * dMax < 1e-12) {
+				break;
+			}
+		}
+
+		// Return the best vector
+		return CmaEsResult(xBest, costInit, costBest);
+	}
+};
+}
+
+#endif /* _ADEXPSIM_CMA_ES_HPP_ */
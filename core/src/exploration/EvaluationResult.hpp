@@ -28,6 +28,10 @@
 #ifndef _ADEXPSIM_EVALUATION_RESULT_HPP_
 #define _ADEXPSIM_EVALUATION_RESULT_HPP_
 
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -72,27 +76,61 @@ enum class EvaluationResultDimension {
  * The EvaluationResult class stores a single result from an evaluation method.
  * It simply consists of an vector of elements of an particular fixed size and
  * provides methods for setting and reading these values. Note that all values
- * need to be interpreted in the scope of an EvaluationResultDescriptor.
+ * need to be interpreted in the scope of an EvaluationResultDescriptor. The
+ * values are stored inline, so creating or copying an EvaluationResult never
+ * allocates memory.
  */
 struct EvaluationResult {
 	/**
-	 * Actual vector of values.
+	 * Maximum number of dimensions of any evaluation result.
 	 */
-	std::vector<Val> values;
+	static constexpr size_t MAX_SIZE = 16;
 
 	/**
-	 * Creates a new EvaluationResult instance with a given size.
+	 * Actual values, only the first n entries are used.
+	 */
+	std::array<Val, MAX_SIZE> values;
+
+	/**
+	 * Number of dimensions in the result vector.
+	 */
+	size_t n;
+
+	/**
+	 * Throws an exception if the given size exceeds MAX_SIZE, returns the size
+	 * otherwise.
+	 */
+	static size_t checkSize(size_t size)
+	{
+		if (size > MAX_SIZE) {
+			throw std::out_of_range("EvaluationResult size exceeds MAX_SIZE");
+		}
+		return size;
+	}
+
+	/**
+	 * Creates a new EvaluationResult instance with a given size. Throws an
+	 * exception if the size exceeds MAX_SIZE.
 	 *
 	 * @param size is the number of dimensions in the result vector.
 	 */
-	EvaluationResult(size_t size = 0) : values(size, Val(0.0)) {}
+	EvaluationResult(size_t size = 0) : n(checkSize(size))
+	{
+		values.fill(0.0);
+	}
 
 	/**
-	 * Creates a new EvaluationResult instance with a given size.
+	 * Creates a new EvaluationResult instance with the given values. Throws an
+	 * exception if more than MAX_SIZE values are given.
 	 *
-	 * @param size is the number of dimensions in the result vector.
+	 * @param init is the list of values.
 	 */
-	EvaluationResult(std::initializer_list<Val> init) : values(init) {}
+	EvaluationResult(std::initializer_list<Val> init)
+	    : n(checkSize(init.size()))
+	{
+		values.fill(0.0);
+		std::copy(init.begin(), init.begin() + n, values.begin());
+	}
 
 	/**
 	 * Returns a const reference at the i-th entry.
@@ -107,7 +145,30 @@ struct EvaluationResult {
 	/**
 	 * Returns the number of dimensions in the result vector.
 	 */
-	size_t size() const { return values.size(); }
+	size_t size() const { return n; }
+
+	/**
+	 * Returns a pointer at the first value. Evaluation classes can write
+	 * directly to this memory using their evaluateInto() method.
+	 */
+	Val *data() { return values.data(); }
+
+	const Val *data() const { return values.data(); }
+
+	const Val *begin() const { return values.data(); }
+
+	const Val *end() const { return values.data() + n; }
+
+	/**
+	 * Appends a value to the result vector.
+	 */
+	void push_back(Val v)
+	{
+		if (n >= MAX_SIZE) {
+			throw std::out_of_range("EvaluationResult is full");
+		}
+		values[n++] = v;
+	}
 };
 
 /**
@@ -188,7 +249,7 @@ public:
 		mNames.push_back(name);
 		mIds.push_back(id);
 		mUnits.push_back(unit);
-		mDefault.values.push_back(defaultValue);
+		mDefault.push_back(defaultValue);
 		mRanges.push_back(range);
 		if (optimize) {
 			mOptimizationDim = mSize;
@@ -23,9 +23,14 @@
 #endif
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #include <vector>
 
+#include <common/ConcurrentQueue.hpp>
+
 #include "Exploration.hpp"
 
 #include "SingleGroupSingleOutEvaluation.hpp"
@@ -36,75 +41,171 @@ namespace AdExpSim {
 
 template <typename Evaluation>
 bool Exploration::run(const Evaluation &evaluation,
-                      const ProgressCallback &progress)
+                      const ProgressCallback &progress,
+                      const TileCallback &tileCallback)
 {
 	// Create the ExplorationMemory instance
 	// Note: It might seem somewhat wasteful to throw away any existing memory
 	// instance and not to reuse it. However, exploration takes significantly
 	// longer than memory allocation.
-	mMem = ExplorationMemory(evaluation.descriptor(), resX(), resY());
+	EvaluationResultDescriptor descr = evaluation.descriptor();
+	if (mCollectStatistics) {
+		descr.add("Cost", "cost", "", 0.0, Range::lowerBound(0.0))
+		    .add("Steps", "nSteps", "", 0.0, Range::lowerBound(0.0))
+		    .add("Rejected Steps", "nRejected", "", 0.0,
+		         Range::lowerBound(0.0));
+	}
+	mMem = ExplorationMemory(descr, resX(), resY(), mStorage);
+	mStatistics.reset();
 
 	// Fetch the total number of evaluations and the number of cores
 	const size_t N = resX() * resY();
-	size_t nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	size_t nThreads =
+	    mThreadCount > 0
+	        ? mThreadCount
+	        : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+	// Divide the grid into tiles, halve the tile size until there are enough
+	// tiles to keep all threads busy
+	size_t tileSize = MAX_TILE_SIZE;
+	auto tileCount = [&](size_t size) -> size_t {
+		return ((resX() + size - 1) / size) * ((resY() + size - 1) / size);
+	};
+	while (tileSize > 1 && tileCount(tileSize) < 4 * nThreads) {
+		tileSize /= 2;
+	}
+	const size_t nTilesX = (resX() + tileSize - 1) / tileSize;
+	const size_t nTiles = tileCount(tileSize);
+
+	// Fetch the thread limit, if any
+	const ThreadLimit *limit = mThreadLimit.get();
+
+	// Fetch the result cache, if any, and the id of the evaluation in the cache
+	ResultCache *cache = mCollectStatistics ? nullptr : mResultCache.get();
+	const uint64_t evaluationId =
+	    cache ? ResultCache::evaluationId(evaluation) : 0;
+
+	// Completed tiles are passed from the worker threads to this thread via a
+	// lock-free queue. The queue is large enough to hold all tiles, so pushing
+	// never fails. The condition variable is only used to wake up this thread.
+	ConcurrentQueue<ExplorationTile> queue(nTiles);
+	std::atomic<size_t> nCompleted(0);
+	std::mutex mutex;
+	std::condition_variable cond;
 
 	// Function containing the actual exploration task
-	auto fun = [&](ExplorationMemory &mem, std::atomic<size_t> &counter,
-	               std::atomic<bool> &abort, size_t idx) -> void {
+	auto fun = [&](std::atomic<size_t> &counter, std::atomic<size_t> &next,
+	               std::atomic<bool> &abort, SimulationStatistics &stats,
+	               size_t idx) -> void {
 		// Copy the parameters
 		Parameters params = fullParams();
 		WorkingParameters p = params;
 
-		// Variable containing the evaluation result
-		EvaluationResult result(mem.descriptor.size());
-
-		// Iterate over all elements
-		size_t i = idx;
-		while (i < N && !abort.load()) {
-			// Calculate the x and y coordinate from the index and update the
-			// parameters according to the given range.
-			const size_t x = i % resX();
-			const size_t y = i / resX();
-
-			// If the full parameter exploration mode is active, update the full
-			// parameter set and convert it to working parameters, otherwise
-			// just use the working parameter set
-			if (useFullParams()) {
-				params[dimX()] = rangeX().value(x);
-				params[dimY()] = rangeY().value(y);
-				p = params;
-			} else {
-				p[dimX()] = rangeX().value(x);
-				p[dimY()] = rangeY().value(y);
+		// Variable containing the evaluation result, the evaluation writes
+		// its values directly into this buffer, the statistics are appended
+		const size_t nEval = evaluation.descriptor().size();
+		const size_t nDims = descr.size();
+		EvaluationResult result(nDims);
+
+		// Iterate over all tiles. The tiles are fetched from a shared counter,
+		// so threads paused by the thread limit do not hold back any part of
+		// the grid.
+		while (!abort.load()) {
+			// Stop once all tiles have been handed out, paused threads would
+			// otherwise never leave the loop
+			if (next.load() >= nTiles) {
+				break;
+			}
+
+			// Pause while the thread limit does not allow this thread to work
+			if (limit && !limit->allows(idx)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				continue;
 			}
 
-			// Check whether the parameters are valid, if not use the default
-			// evaluation result
-			if (p.valid()) {
-				p.update();
-				result = evaluation.evaluate(p);
-			} else {
-				result = descriptor().defaultResult();
+			// Fetch the next tile
+			const size_t t = next++;
+			if (t >= nTiles) {
+				break;
 			}
+			const size_t x0 = (t % nTilesX) * tileSize;
+			const size_t y0 = (t / nTilesX) * tileSize;
+			ExplorationTile tile(x0, y0, std::min(tileSize, resX() - x0),
+			                     std::min(tileSize, resY() - y0), nDims);
 
-			// Store the evaluation result in the matrices
-			mem.store(x, y, result);
+			for (size_t ty = 0; ty < tile.h; ty++) {
+				for (size_t tx = 0; tx < tile.w; tx++) {
+					// Update the parameters according to the given range.
+					const size_t x = x0 + tx;
+					const size_t y = y0 + ty;
 
-			// Increment the counter
-			counter++;
+					// If the full parameter exploration mode is active, update
+					// the full parameter set and convert it to working
+					// parameters, otherwise just use the working parameter set
+					if (useFullParams()) {
+						params[dimX()] = rangeX().value(x);
+						params[dimY()] = rangeY().value(y);
+						p = params;
+					} else {
+						p[dimX()] = rangeX().value(x);
+						p[dimY()] = rangeY().value(y);
+					}
 
-			// Go to the next work item
-			i += nThreads;
+					// Check whether the parameters are valid, if not use the
+					// default evaluation result
+					if (p.valid() && mCollectStatistics) {
+						p.update();
+						SimulationStatistics s;
+						evaluation.evaluateInto(p, result.data(), s);
+						result[nEval] = s.rhsEvaluations;
+						result[nEval + 1] = s.steps;
+						result[nEval + 2] = s.rejectedSteps;
+						stats += s;
+					} else if (p.valid()) {
+						// Only run the simulation if the result is not cached
+						if (!cache ||
+						    !cache->lookup(evaluationId, p, result.data(),
+						                   nEval)) {
+							p.update();
+							evaluation.evaluateInto(p, result.data());
+							if (cache) {
+								cache->store(evaluationId, p, result.data(),
+								             nEval);
+							}
+						}
+					} else {
+						result = descr.defaultResult();
+					}
+
+					// Store the evaluation result in the tile
+					for (size_t i = 0; i < nDims; i++) {
+						tile(tx, ty, i) = result[i];
+					}
+
+					// Increment the counter
+					counter++;
+				}
+			}
+
+			// Hand the tile over and wake up the calling thread
+			queue.push(std::move(tile));
+			nCompleted++;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+			}
+			cond.notify_one();
 		}
 	};
 
 	// Create a thread for each hardware thread
 	std::vector<std::thread> threads;
+	std::vector<SimulationStatistics> stats(nThreads);
 	std::atomic<size_t> counter(0);
+	std::atomic<size_t> next(0);
 	std::atomic<bool> abort(false);
 	for (size_t idx = 0; idx < nThreads; idx++) {
-		threads.emplace_back(fun, std::ref(mMem), std::ref(counter),
-		                     std::ref(abort), idx);
+		threads.emplace_back(fun, std::ref(counter), std::ref(next),
+		                     std::ref(abort), std::ref(stats[idx]), idx);
 #ifdef PTHREAD_SET_PRIORITY
 		// Fetch the native pthread handle
 		auto handle = threads.back().native_handle();
@@ -119,41 +220,62 @@ bool Exploration::run(const Evaluation &evaluation,
 #endif
 	}
 
-	// Wait for all threads to be finished
+	// Store the completed tiles in the memory as soon as they arrive. This
+	// thread is woken up whenever a tile is complete, the timeout only
+	// bounds the interval in which the progress callback is called.
+	size_t nStored = 0;
 	while (true) {
-		// Fetch the current progress
-		size_t totalCount = counter.load();
+		ExplorationTile tile;
+		while (queue.pop(tile)) {
+			mMem.store(tile);
+			nStored++;
+			tileCallback(tile);
+		}
 
 		// Call the progress function
-		if (!progress(Val(totalCount) / Val(N))) {
+		if (!progress(Val(counter.load()) / Val(N))) {
 			abort.store(true);
 			break;
 		}
 
-		// Sleep some time before checking again
-		std::this_thread::sleep_for(std::chrono::milliseconds(20));
-
-		// Abort if the threads are finished
-		if (totalCount >= N) {
+		// Abort if all tiles have been stored
+		if (nStored >= nTiles) {
 			break;
 		}
+
+		// Wait for the next tile
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait_for(lock, std::chrono::milliseconds(20),
+		              [&]() { return nCompleted.load() > nStored; });
 	}
 
-	// Wait for all threads to be finished
+	// Release all threads which are still paused by the thread limit and wait
+	// for them to be finished
+	const bool ok = !abort.load();
+	abort.store(true);
 	for (auto &thread : threads) {
 		thread.join();
 	}
-	return !abort.load();
+
+	// Aggregate the per-thread statistics
+	for (const SimulationStatistics &s : stats) {
+		mStatistics += s;
+	}
+
+	// Release the memory of blocks dropped while compressing the tiles
+	mMem.compact();
+	return ok;
 }
 
 /* Specializations of the "run" method. */
 template bool Exploration::run<SpikeTrainEvaluation>(
-    const SpikeTrainEvaluation &evaluation, const ProgressCallback &progress);
+    const SpikeTrainEvaluation &evaluation, const ProgressCallback &progress,
+    const TileCallback &tileCallback);
 template bool Exploration::run<SingleGroupSingleOutEvaluation>(
     const SingleGroupSingleOutEvaluation &evaluation,
-    const ProgressCallback &progress);
+    const ProgressCallback &progress, const TileCallback &tileCallback);
 template bool Exploration::run<SingleGroupMultiOutEvaluation>(
     const SingleGroupMultiOutEvaluation &evaluation,
-    const ProgressCallback &progress);
+    const ProgressCallback &progress, const TileCallback &tileCallback);
 }
 
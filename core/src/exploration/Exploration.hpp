@@ -28,20 +28,107 @@
 #ifndef _ADEXPSIM_EXPLORATION_HPP_
 #define _ADEXPSIM_EXPLORATION_HPP_
 
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include <simulation/Parameters.hpp>
+#include <simulation/Statistics.hpp>
+#include <common/CompressedMatrix.hpp>
 #include <common/Matrix.hpp>
+#include <common/ThreadLimit.hpp>
 #include <common/Types.hpp>
 
 #include "EvaluationResult.hpp"
+#include "ResultCache.hpp"
 
 namespace AdExpSim {
+/**
+ * The ExplorationTile structure contains the evaluation results for a
+ * rectangular block of the exploration grid. Tiles are the unit of work of the
+ * Exploration class and are handed to the caller as soon as they are complete.
+ */
+struct ExplorationTile {
+	/**
+	 * Grid coordinates of the first cell of the tile.
+	 */
+	size_t x0, y0;
+
+	/**
+	 * Width and height of the tile in grid cells.
+	 */
+	size_t w, h;
+
+	/**
+	 * Number of result dimensions stored in the tile.
+	 */
+	size_t nDims;
+
+	/**
+	 * Evaluation results, stored dimension by dimension and row by row.
+	 */
+	std::vector<Val> values;
+
+	/**
+	 * Default constructor, creates an empty tile.
+	 */
+	ExplorationTile() : x0(0), y0(0), w(0), h(0), nDims(0) {}
+
+	/**
+	 * Creates a new tile of the given extent.
+	 */
+	ExplorationTile(size_t x0, size_t y0, size_t w, size_t h, size_t nDims)
+	    : x0(x0), y0(y0), w(w), h(h), nDims(nDims), values(nDims * w * h)
+	{
+	}
+
+	/**
+	 * Returns a reference at the value of the given dimension at the given
+	 * position relative to the first cell of the tile.
+	 */
+	Val &operator()(size_t x, size_t y, size_t dim)
+	{
+		return values[(dim * h + y) * w + x];
+	}
+
+	/**
+	 * Returns the value of the given dimension at the given position relative
+	 * to the first cell of the tile.
+	 */
+	Val operator()(size_t x, size_t y, size_t dim) const
+	{
+		return values[(dim * h + y) * w + x];
+	}
+};
+
+/**
+ * Specifies how the result dimensions of an exploration are stored.
+ */
+enum class ExplorationStorage : int {
+	/**
+	 * Each dimension is stored as plain Matrix of floating point values.
+	 */
+	FLOAT = 0,
+
+	/**
+	 * Dimensions with a bounded range in the EvaluationResultDescriptor are
+	 * quantized to 16 bits, blocks containing only one or two distinct values
+	 * are compressed.
+	 */
+	QUANTIZED16 = 1,
+
+	/**
+	 * Same as QUANTIZED16, but quantizes the bounded dimensions to 8 bits.
+	 */
+	QUANTIZED8 = 2
+};
+
 /**
  * The ExplorationMemory structure provides the memory for an exploration run of
  * a certain resolution. It allows Exploration objects to access and modify this
  * memory. Copying an ExplorationMemory object is cheap due to copy on write
- * semantics of the underlying Matrix class.
+ * semantics of the underlying Matrix and CompressedMatrix classes.
  */
 struct ExplorationMemory {
 	/**
@@ -60,10 +147,22 @@ struct ExplorationMemory {
 	size_t resY;
 
 	/**
-	 * Vector of matrices containing each result dimension.
+	 * Storage used for the result dimensions.
+	 */
+	ExplorationStorage storage;
+
+	/**
+	 * Vector of matrices containing each result dimension. Empty if a
+	 * compressed storage is used.
 	 */
 	std::vector<Matrix> data;
 
+	/**
+	 * Vector of compressed matrices containing each result dimension. Only
+	 * used if a compressed storage is used.
+	 */
+	std::vector<CompressedMatrix> packed;
+
 	/**
 	 * Vector of ranges containing the min/max values occuring in that
 	 * dimension.
@@ -73,37 +172,63 @@ struct ExplorationMemory {
 	/**
 	 * Default constructor, creates an empty memory instance.
 	 */
-	ExplorationMemory() : resX(0), resY(0) {}
+	ExplorationMemory() : resX(0), resY(0), storage(ExplorationStorage::FLOAT)
+	{
+	}
 
 	/**
 	 * Constructor of the ExplorationMemory class for a certain resolution.
 	 *
 	 * @param resX is the resolution of the memory in X direction.
 	 * @param resY is the resolution of the memory in Y direction.
+	 * @param storage specifies how the result dimensions are stored. The
+	 * encoding of each dimension is chosen based on the range given in the
+	 * descriptor, unbounded dimensions are never quantized.
 	 */
 	ExplorationMemory(const EvaluationResultDescriptor &descriptor, size_t resX,
-	                  size_t resY)
+	                  size_t resY,
+	                  ExplorationStorage storage = ExplorationStorage::FLOAT)
 	    : descriptor(descriptor),
 	      resX(resX),
 	      resY(resY),
-	      data(descriptor.size()),
-	      extrema(descriptor.size())
+	      storage(storage),
+	      extrema(descriptor.size(), Range::invalid())
 	{
+		const MatrixEncoding encoding = (storage == ExplorationStorage::QUANTIZED8)
+		                                    ? MatrixEncoding::QUANTIZED8
+		                                    : MatrixEncoding::QUANTIZED16;
 		for (size_t i = 0; i < descriptor.size(); i++) {
-			data[i].resize(resX, resY);
-			extrema[i] = Range::invalid();
+			if (compressed()) {
+				packed.emplace_back(resX, resY,
+				                    descriptor.bounded(i)
+				                        ? encoding
+				                        : MatrixEncoding::FLOAT32,
+				                    descriptor.range(i));
+			} else {
+				data.emplace_back(resX, resY);
+			}
 		}
 	}
 
+	/**
+	 * Returns true if a compressed storage is used.
+	 */
+	bool compressed() const { return storage != ExplorationStorage::FLOAT; }
+
+	/**
+	 * Returns the number of stored result dimensions.
+	 */
+	size_t size() const { return compressed() ? packed.size() : data.size(); }
+
 	/**
 	 * Returns an evaluation result structure for the matrix entry at the given
 	 * coordinates.
 	 */
 	EvaluationResult operator()(size_t x, size_t y) const
 	{
-		EvaluationResult res(data.size());
-		for (size_t i = 0; i < data.size(); i++) {
-			res[i] = data[i](x, y);
+		EvaluationResult res(size());
+		for (size_t i = 0; i < size(); i++) {
+			res[i] = (*this)(x, y, i);
 		}
 		return res;
 	}
@@ -113,20 +238,95 @@ struct ExplorationMemory {
 	 */
 	Val operator()(size_t x, size_t y, size_t dim) const
 	{
-		return data[dim](x, y);
+		return compressed() ? packed[dim](x, y) : data[dim](x, y);
 	}
 
 	/**
-	 * Stores an EvaluationResult in the memory.
+	 * Stores an EvaluationResult in the memory. Call compact() once all
+	 * results have been stored if a compressed storage is used.
 	 */
 	void store(size_t x, size_t y, const EvaluationResult &res)
 	{
-		for (size_t i = 0; i < std::min(data.size(), res.size()); i++) {
-			data[i](x, y) = res[i];
+		for (size_t i = 0; i < std::min(size(), res.size()); i++) {
+			if (compressed()) {
+				packed[i].set(x, y, res[i]);
+			} else {
+				data[i](x, y) = res[i];
+			}
 			extrema[i].expand(res[i]);
 		}
 	}
 
+	/**
+	 * Stores all results contained in the given tile in the memory.
+	 */
+	void store(const ExplorationTile &tile)
+	{
+		for (size_t i = 0; i < std::min(size(), tile.nDims); i++) {
+			for (size_t y = 0; y < tile.h; y++) {
+				for (size_t x = 0; x < tile.w; x++) {
+					const Val v = tile(x, y, i);
+					if (compressed()) {
+						packed[i].set(tile.x0 + x, tile.y0 + y, v);
+					} else {
+						data[i](tile.x0 + x, tile.y0 + y) = v;
+					}
+					extrema[i].expand(v);
+				}
+			}
+			if (compressed()) {
+				packed[i].compact(tile.x0, tile.y0, tile.x0 + tile.w,
+				                  tile.y0 + tile.h);
+			}
+		}
+	}
+
+	/**
+	 * Compacts the compressed matrices and releases unused memory. Does nothing
+	 * if no compressed storage is used.
+	 */
+	void compact()
+	{
+		for (CompressedMatrix &m : packed) {
+			m.compact();
+		}
+	}
+
+	/**
+	 * Returns the given result dimension as Matrix. Cheap for the FLOAT
+	 * storage, decodes the dimension otherwise.
+	 */
+	Matrix matrix(size_t dim) const
+	{
+		return compressed() ? packed[dim].decode() : data[dim];
+	}
+
+	/**
+	 * Copies the rows y0 to y1 (exclusive) of the given result dimension to
+	 * the memory pointed at by out.
+	 */
+	void copyRows(size_t dim, size_t y0, size_t y1, Val *out) const
+	{
+		if (compressed()) {
+			packed[dim].decodeRows(y0, y1, out);
+		} else {
+			std::copy(data[dim].data() + y0 * resX,
+			          data[dim].data() + y1 * resX, out);
+		}
+	}
+
+	/**
+	 * Returns the number of bytes occupied by the result dimensions.
+	 */
+	size_t memoryUsage() const
+	{
+		size_t res = data.size() * resX * resY * sizeof(Val);
+		for (const CompressedMatrix &m : packed) {
+			res += m.memoryUsage();
+		}
+		return res;
+	}
+
 	/**
 	 * Returns the data range for the given dimension. If an explicitly bounded
 	 * range is specified in the EvaluationResultDescriptor this range is used,
@@ -143,7 +343,7 @@ struct ExplorationMemory {
 	/**
 	 * Returns true if there is actually any data stored inside the memory.
 	 */
-	bool valid() const { return resX > 0 && resY > 0 && data.size() > 0; }
+	bool valid() const { return resX > 0 && resY > 0 && size() > 0; }
 };
 
 /**
@@ -194,6 +394,40 @@ private:
 	 */
 	DiscreteRange mRangeY;
 
+	/**
+	 * If true, the simulation cost of each parameter set is recorded as
+	 * additional result dimensions.
+	 */
+	bool mCollectStatistics;
+
+	/**
+	 * Instrumentation counters aggregated over the entire exploration grid.
+	 */
+	SimulationStatistics mStatistics;
+
+	/**
+	 * Number of threads used by run(). If zero, one thread per hardware thread
+	 * is used.
+	 */
+	size_t mThreadCount;
+
+	/**
+	 * Optional limit on the number of threads which are allowed to work at the
+	 * same time, may be adjusted while run() is in progress.
+	 */
+	std::shared_ptr<const ThreadLimit> mThreadLimit;
+
+	/**
+	 * Storage used for the exploration memory created by run().
+	 */
+	ExplorationStorage mStorage;
+
+	/**
+	 * Optional cache which is consulted before each evaluation and which
+	 * receives all newly calculated results.
+	 */
+	std::shared_ptr<ResultCache> mResultCache;
+
 public:
 	/**
 	 * Callback function used to allow another function to display some kind of
@@ -203,10 +437,30 @@ public:
 	 */
 	using ProgressCallback = std::function<bool(Val)>;
 
+	/**
+	 * Callback function which is called for each completed tile. The callback
+	 * is executed on the thread which called run(), the tile has already been
+	 * written to the exploration memory.
+	 */
+	using TileCallback = std::function<void(const ExplorationTile &)>;
+
+	/**
+	 * Maximum edge length of the tiles the exploration grid is divided into.
+	 * Smaller tiles are used for small grids to keep all threads busy.
+	 */
+	static constexpr size_t MAX_TILE_SIZE = 16;
+
 	/**
 	 * Default constructor. Resulting exploration is invalid.
 	 */
-	Exploration() : mDimX(0), mDimY(1) {}
+	Exploration()
+	    : mDimX(0),
+	      mDimY(1),
+	      mCollectStatistics(false),
+	      mThreadCount(0),
+	      mStorage(ExplorationStorage::FLOAT)
+	{
+	}
 
 	/**
 	 * Creates a new Exploration instance and sets all its parameters.
@@ -227,7 +481,10 @@ public:
 	      mDimX(dimX),
 	      mDimY(dimY),
 	      mRangeX(rangeX),
-	      mRangeY(rangeY){};
+	      mRangeY(rangeY),
+	      mCollectStatistics(false),
+	      mThreadCount(0),
+	      mStorage(ExplorationStorage::FLOAT){};
 
 	/**
 	 * Constructor which allows to construct an exploration instance which
@@ -252,7 +509,40 @@ public:
 	      mDimX(dimX),
 	      mDimY(dimY),
 	      mRangeX(rangeX),
-	      mRangeY(rangeY){};
+	      mRangeY(rangeY),
+	      mCollectStatistics(false),
+	      mThreadCount(0),
+	      mStorage(ExplorationStorage::FLOAT){};
+
+	/**
+	 * Constructor which allows to create an exploration instance from an
+	 * existing ExplorationMemory instance, e.g. a memory that was loaded from
+	 * disk.
+	 *
+	 * @param mem is the memory containing the exploration results.
+	 * @param useFullParams specifies whether the full parameter set was
+	 * explored.
+	 * @param params is the base parameter set.
+	 * @param dimX is the index of the parameter vector entry which is varried
+	 * in x-direction.
+	 * @param dimY is the index of the parameter vector entry which is varried
+	 * @param rangeX is the range descriptor for the X-direction.
+	 * @param rangeY is the range descriptor for the Y-direction.
+	 */
+	Exploration(const ExplorationMemory &mem, bool useFullParams,
+	            const Parameters &params, size_t dimX, size_t dimY,
+	            DiscreteRange rangeX, DiscreteRange rangeY)
+	    : mMem(mem),
+	      mUseFullParams(useFullParams),
+	      mFullParams(params),
+	      mParams(params),
+	      mDimX(dimX),
+	      mDimY(dimY),
+	      mRangeX(rangeX),
+	      mRangeY(rangeY),
+	      mCollectStatistics(false),
+	      mThreadCount(0),
+	      mStorage(mem.storage){};
 
 	/**
 	 * Runs the exploration process, returns true if the process has completed
@@ -263,11 +553,94 @@ public:
 	 * that calculates the actual cost function values.
 	 * @param progress specifies the current progress as a value between zero
 	 * and one.
+	 * @param tileCallback is called for each tile of the exploration grid as
+	 * soon as it is complete.
 	 * @return true if the operation was sucessful, false otherwise.
 	 */
 	template <typename Evaluation>
 	bool run(const Evaluation &evaluation,
-	         const ProgressCallback &progress = [](Val) { return true; });
+	         const ProgressCallback &progress = [](Val) { return true; },
+	         const TileCallback &tileCallback = [](const ExplorationTile &) {});
+
+	/**
+	 * Enables or disables the collection of instrumentation counters in the
+	 * next call to run(). If enabled, the number of derivative evaluations
+	 * ("cost"), accepted and rejected integrator steps are appended to the
+	 * result dimensions of the evaluation.
+	 */
+	void setCollectStatistics(bool collect) { mCollectStatistics = collect; }
+
+	/**
+	 * Returns true if instrumentation counters are collected.
+	 */
+	bool collectStatistics() const { return mCollectStatistics; }
+
+	/**
+	 * Returns the instrumentation counters aggregated over the entire
+	 * exploration grid. Only valid if collectStatistics() is true.
+	 */
+	const SimulationStatistics &statistics() const { return mStatistics; }
+
+	/**
+	 * Sets the number of threads used by run(). Zero (the default) selects one
+	 * thread per hardware thread.
+	 */
+	void setThreadCount(size_t threadCount) { mThreadCount = threadCount; }
+
+	/**
+	 * Returns the number of threads set via setThreadCount().
+	 */
+	size_t threadCount() const { return mThreadCount; }
+
+	/**
+	 * Sets a ThreadLimit instance which is queried by the worker threads of
+	 * run() before each evaluation. Worker threads with an index larger or
+	 * equal to the current limit pause until the limit is raised, which allows
+	 * a scheduler to throttle a running exploration. Pass nullptr (the
+	 * default) to not restrict the number of threads.
+	 */
+	void setThreadLimit(std::shared_ptr<const ThreadLimit> limit)
+	{
+		mThreadLimit = limit;
+	}
+
+	/**
+	 * Returns the ThreadLimit instance set via setThreadLimit().
+	 */
+	std::shared_ptr<const ThreadLimit> threadLimit() const
+	{
+		return mThreadLimit;
+	}
+
+	/**
+	 * Sets a ResultCache instance which is consulted by run() before each
+	 * evaluation, newly calculated results are added to the cache. The cache
+	 * is not used while instrumentation counters are collected, as those
+	 * require the simulation to actually run. Pass nullptr (the default) to
+	 * always run the simulation.
+	 */
+	void setResultCache(std::shared_ptr<ResultCache> cache)
+	{
+		mResultCache = cache;
+	}
+
+	/**
+	 * Returns the ResultCache instance set via setResultCache().
+	 */
+	std::shared_ptr<ResultCache> resultCache() const { return mResultCache; }
+
+	/**
+	 * Sets the storage used for the exploration memory created by run().
+	 * Compressed storages allow very large grids to be kept in memory at the
+	 * cost of quantizing the bounded result dimensions. Defaults to
+	 * ExplorationStorage::FLOAT.
+	 */
+	void setStorage(ExplorationStorage storage) { mStorage = storage; }
+
+	/**
+	 * Returns the storage set via setStorage().
+	 */
+	ExplorationStorage storage() const { return mStorage; }
 
 	/**
 	 * Flag indicating whether the exploration is valid or not.
@@ -279,6 +652,13 @@ public:
 	 */
 	const ExplorationMemory &mem() const { return mMem; }
 
+	/**
+	 * Replaces the exploration memory, e.g. with results that were calculated
+	 * on a remote machine. The resolution of the memory should match resX()
+	 * and resY().
+	 */
+	void setMem(const ExplorationMemory &mem) { mMem = mem; }
+
 	/**
 	 * Returns a reference at the evaluation result descriptor.
 	 */
@@ -237,10 +237,11 @@ static std::pair<SpikeVec, size_t> rebuildInput(const SpikeVec &spikes, Time t,
 	return std::make_pair(res, iCtrl);
 }
 
+template <typename Statistics>
 uint16_t FractionalSpikeCount::minPerturbation(
     const RecordedSpike &spike, const SpikeVec &spikes,
     const WorkingParameters &params, uint16_t vMin, size_t expectedSpikeCount,
-    std::vector<PerturbationAnalysisResult> &results)
+    std::vector<PerturbationAnalysisResult> &results, Statistics stats)
 {
 	// Create a new input spike vector containing a new special
 	// "SET_VOLTAGE" input spike
@@ -272,7 +273,7 @@ uint16_t FractionalSpikeCount::minPerturbation(
 		DormandPrinceIntegrator integrator(eTar);
 		Model::simulate<Model::PROCESS_SPECIAL | Model::FAST_EXP>(
 		    useIfCondExp, input, manager, manager, integrator, params, Time(-1),
-		    MAX_TIME, spike.state, Time(0));
+		    MAX_TIME, spike.state, Time(0), stats);
 
 		// Run the simulation, restrict binary search area according to the
 		// result
@@ -299,8 +300,9 @@ uint16_t FractionalSpikeCount::minPerturbation(
 	return std::min(vMin, curVMax);
 }
 
+template <typename Statistics>
 FractionalSpikeCount::Result FractionalSpikeCount::calculate(
-    const SpikeVec &input, const WorkingParameters &params)
+    const SpikeVec &input, const WorkingParameters &params, Statistics stats)
 {
 	// Fetch some required constants from the parameters
 	const Val eSpikeEff = params.eSpikeEff(useIfCondExp);
@@ -319,7 +321,9 @@ FractionalSpikeCount::Result FractionalSpikeCount::calculate(
 		    maxValueController);
 		DormandPrinceIntegrator integrator(eTar);
 		Model::simulate<Model::FAST_EXP>(useIfCondExp, input, recorder,
-		                                 controller, integrator, params);
+		                                 controller, integrator, params,
+		                                 Time(-1), MAX_TIME, State(), Time(-1),
+		                                 stats);
 
 		// Abort if the MaxOutputSpikeCount controller has tripped
 		if (controller.tripped()) {
@@ -339,7 +343,7 @@ FractionalSpikeCount::Result FractionalSpikeCount::calculate(
 	                                                 params.vMax());
 	for (ssize_t i = outputCount; i >= 0; i--) {
 		vMin = minPerturbation(output[i], input, params, vMin, outputCount - i,
-		                       results);
+		                       results, stats);
 	}
 
 	// Convert vMin into an actual membrane potential
@@ -349,4 +353,12 @@ FractionalSpikeCount::Result FractionalSpikeCount::calculate(
 	const Val eMax = maximumRecorder.global().s.v();
 	return Result(outputCount, eReq, eMax, eNorm, eSpikeEff);
 }
+
+/* Specializations of the "calculate" method. */
+template FractionalSpikeCount::Result FractionalSpikeCount::calculate(
+    const SpikeVec &input, const WorkingParameters &params,
+    NullStatistics stats);
+template FractionalSpikeCount::Result FractionalSpikeCount::calculate(
+    const SpikeVec &input, const WorkingParameters &params,
+    StatisticsCollector stats);
 }
@@ -36,6 +36,7 @@
 #include <simulation/Parameters.hpp>
 #include <simulation/Spike.hpp>
 #include <simulation/Recorder.hpp>
+#include <simulation/Statistics.hpp>
 
 namespace AdExpSim {
 
@@ -153,11 +154,12 @@ private:
 	 * Function performing a binary search in order ot find the minimum
 	 * perturbation membrane potential which causes another spike.
 	 */
+	template <typename Statistics>
 	uint16_t minPerturbation(const RecordedSpike &spike, const SpikeVec &spikes,
 	                         const WorkingParameters &params, uint16_t vMin,
 	                         size_t spikeCount,
-	                         std::vector<PerturbationAnalysisResult> &results);
-
+	                         std::vector<PerturbationAnalysisResult> &results,
+	                         Statistics stats);
 public:
 	/**
 	 * Result structure containing both the fractional spike counter and other
@@ -241,8 +243,13 @@ public:
 	/**
 	 * Calculates the FractionalSpikeCount for the given input spike vector
 	 * and the given set of WorkingParameters.
+	 *
+	 * @param stats is the statistics handle passed to all simulations. Use a
+	 * StatisticsCollector instance to collect instrumentation counters.
 	 */
-	Result calculate(const SpikeVec &spikes, const WorkingParameters &params);
+	template <typename Statistics = NullStatistics>
+	Result calculate(const SpikeVec &spikes, const WorkingParameters &params,
+	                 Statistics stats = Statistics());
 };
 }
 
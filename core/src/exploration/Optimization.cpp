@@ -17,12 +17,21 @@
  */
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <deque>
+#include <random>
 #include <thread>
+#include <unordered_map>
 #include <iostream>
 
+#include <common/Random.hpp>
+
+#include "CmaEs.hpp"
 #include "Optimization.hpp"
 #include "SimplexPool.hpp"
 #include "SingleGroupMultiOutEvaluation.hpp"
@@ -31,9 +40,10 @@
 
 namespace AdExpSim {
 
-// Minimum vector distance for two vectors to be considered disimilar
-static constexpr Val MIN_DIST_INPUT = 0.1;
-static constexpr Val MIN_DIST_OUTPUT = 0.1;
+// Minimum vector distance for two vectors to be considered disimilar. The
+// distance is measured relative to the start parameters of the optimization.
+static constexpr Val MIN_DIST_INPUT = 0.01;
+static constexpr Val MIN_DIST_OUTPUT = 0.01;
 
 // Maximum value that to-be-optimized inputs may be worse than the currently
 // best output
@@ -49,156 +59,942 @@ static constexpr size_t MAX_IT = 10000;
 // Step size of the mixFactor
 static constexpr Val MIX_STEP = 0.2;
 
+// Maximum standard deviation of a surrogate prediction that is used instead of
+// the actual evaluation
+static constexpr Val SURROGATE_MAX_SIGMA = 0.05;
+
+// Number of standard deviations a surrogate prediction must be worse than the
+// currently best result for the actual evaluation to be skipped
+static constexpr Val SURROGATE_KAPPA = 2.0;
+
+// Maximum ratio between the time needed to query the surrogate model and the
+// time needed for the actual evaluation. The surrogate model is bypassed if
+// the evaluation is too cheap.
+static constexpr double SURROGATE_MAX_COST_RATIO = 0.1;
+
+// Number of parameter dimensions used by the grid hash of the spatial index
+static constexpr size_t N_HASH_DIMS = 3;
+
+// Number of independently locked shards of the elite archive
+static constexpr size_t N_SHARDS = 16;
+
+// Number of best elite entries from which idle workers are reseeded
+static constexpr size_t N_RESEED_CANDIDATES = 8;
+
+// Number of times each elite entry may be used to reseed an idle worker
+static constexpr size_t MAX_RESEED = 1;
+
+// Number of recent costs per fidelity level used to decide whether a candidate
+// is promoted to the next level
+static constexpr size_t FIDELITY_WINDOW = 128;
+
+// Number of candidates which are unconditionally promoted on each fidelity
+// level before the promotion threshold is used
+static constexpr size_t FIDELITY_WARMUP = 8;
+
+// Smoothing factor of the running estimate of the cost difference between a
+// fidelity level and the full fidelity evaluation
+static constexpr Val FIDELITY_BIAS_RATE = 0.1;
+
 /**
- * The Pool class holds the input and output parameter pool and manages thread-
- * safe access to these pools.
+ * The SpatialIndex class is a grid hash over (a subset of) the parameter
+ * dimensions which allows to find all parameter vectors within a certain
+ * distance without scanning all stored vectors. All coordinates are normalized
+ * relative to a reference parameter set, as the individual parameters differ
+ * by several orders of magnitude. The cell size equals the distance threshold,
+ * so all vectors closer than the threshold are located in one of the
+ * 3^N_HASH_DIMS neighbouring cells.
  */
-class Pool {
+class SpatialIndex {
 private:
-	mutable std::mutex mutex;
+	/**
+	 * Parameter dimensions used for hashing.
+	 */
+	std::vector<size_t> dims;
+
+	/**
+	 * Reference parameter set and per-dimension scale used for normalization.
+	 */
+	WorkingParameters ref;
+	std::array<Val, WorkingParameters::Size> scale;
 
 	/**
-	 * Tries to find a duplicate of p in the given container, returns the
-	 * index of the duplicate if one is found, or -1 otherwise.
+	 * Cell size.
 	 */
-	template <typename T1, typename T2>
-	static ssize_t findDuplicate(const T1 &list, const T2 &p, const Val thr)
+	Val thr;
+
+	/**
+	 * Map from the cell hash to the ids of the vectors stored in that cell.
+	 */
+	std::unordered_map<uint64_t, std::vector<size_t>> cells;
+
+	/**
+	 * Returns the normalized coordinate of the given parameter.
+	 */
+	Val normalize(const WorkingParameters &p, size_t i) const
 	{
-		// Calculate the minimum distance to any element already in the list
-		Val minDist = std::numeric_limits<Val>::max();
-		size_t minIdx = -1;
-		for (size_t i = 0; i < list.size(); i++) {
-			const T2 &q = list[i];
-			const Val dist = (p.params - q.params).L2Norm();
-			if (dist < minDist) {
-				minDist = dist;
-				minIdx = i;
+		return (p[i] - ref[i]) / scale[i];
+	}
+
+	/**
+	 * Calculates the cell coordinate of a single dimension.
+	 */
+	int64_t coord(const WorkingParameters &p, size_t i) const
+	{
+		const Val v = normalize(p, dims[i]) / thr;
+		return std::isfinite(v) ? int64_t(std::floor(v)) : 0;
+	}
+
+	/**
+	 * Calculates the hash of the given cell coordinates.
+	 */
+	static uint64_t hash(const int64_t *c, size_t n)
+	{
+		uint64_t res = 14695981039346656037ULL;
+		for (size_t i = 0; i < n; i++) {
+			res = (res ^ uint64_t(c[i])) * 1099511628211ULL;
+		}
+		return res;
+	}
+
+public:
+	SpatialIndex(const std::vector<size_t> &dims, const WorkingParameters &ref,
+	             Val thr)
+	    : dims(dims.begin(),
+	           dims.begin() + std::min(dims.size(), N_HASH_DIMS)),
+	      ref(ref),
+	      thr(thr)
+	{
+		for (size_t i = 0; i < ref.size(); i++) {
+			scale[i] = (ref[i] == 0.0) ? 1.0 : std::fabs(ref[i]);
+		}
+	}
+
+	/**
+	 * Returns the normalized L2 distance between p and q. The distance is
+	 * never smaller than the distance in any single dimension, which ensures
+	 * the neighbouring cells contain all vectors closer than the cell size.
+	 */
+	Val distance(const WorkingParameters &p, const WorkingParameters &q) const
+	{
+		Val res = 0.0;
+		for (size_t i = 0; i < p.size(); i++) {
+			const Val d = normalize(p, i) - normalize(q, i);
+			res += d * d;
+		}
+		return std::sqrt(res);
+	}
+
+	/**
+	 * Returns the hash of the cell the given vector is located in.
+	 */
+	uint64_t cell(const WorkingParameters &p) const
+	{
+		int64_t c[N_HASH_DIMS] = {0};
+		for (size_t i = 0; i < dims.size(); i++) {
+			c[i] = coord(p, i);
+		}
+		return hash(c, dims.size());
+	}
+
+	/**
+	 * Calls the given function for the hash of the cell containing p and all
+	 * neighbouring cells.
+	 */
+	template <typename F>
+	void neighbours(const WorkingParameters &p, F f) const
+	{
+		int64_t c0[N_HASH_DIMS] = {0}, c[N_HASH_DIMS] = {0};
+		size_t n = 1;
+		for (size_t i = 0; i < dims.size(); i++) {
+			c0[i] = coord(p, i);
+			n *= 3;
+		}
+		for (size_t k = 0; k < n; k++) {
+			size_t j = k;
+			for (size_t i = 0; i < dims.size(); i++) {
+				c[i] = c0[i] + int64_t(j % 3) - 1;
+				j /= 3;
 			}
+			f(hash(c, dims.size()));
 		}
+	}
 
-		// Only add the element if the distance is larger than some small
-		// threshold
-		if (minDist < thr) {
-			return minIdx;
+	/**
+	 * Returns the ids stored in the cell with the given hash or nullptr if
+	 * the cell is empty.
+	 */
+	const std::vector<size_t> *ids(uint64_t cell) const
+	{
+		auto it = cells.find(cell);
+		return it == cells.end() ? nullptr : &it->second;
+	}
+
+	void insert(uint64_t cell, size_t id) { cells[cell].push_back(id); }
+
+	void remove(uint64_t cell, size_t id)
+	{
+		auto it = cells.find(cell);
+		if (it != cells.end()) {
+			std::vector<size_t> &v = it->second;
+			v.erase(std::remove(v.begin(), v.end(), id), v.end());
+			if (v.empty()) {
+				cells.erase(it);
+			}
 		}
-		return -1;
 	}
+};
+
+/**
+ * Type used for storing the parameters on the input queue.
+ */
+struct InputParameters {
+	WorkingParameters params;
+	Val mixFactor;
 
 	/**
-	 * Returns the currently best evaluation result or zero of no such
-	 * evaluation
-	 * result exists.
+	 * Number of reseeds the optimization run leading to these parameters is
+	 * based on.
 	 */
-	Val bestEval() const { return output.empty() ? 0.0 : output.back().eval; }
+	size_t reseeds;
 
-public:
+	InputParameters() {}
+
+	InputParameters(const WorkingParameters &params, Val mixFactor = 0.0,
+	                size_t reseeds = 0)
+	    : params(params), mixFactor(mixFactor), reseeds(reseeds)
+	{
+	}
+};
+
+/**
+ * The EliteArchive class holds the input queue and the output (elite)
+ * parameter sets. Duplicate detection uses a SpatialIndex. The elite set is
+ * split into shards with individual locks, the currently best evaluation
+ * result can be read without locking. Idle workers can be reseeded with one of
+ * the best elite entries.
+ */
+class EliteArchive {
+private:
 	/**
-	 * Type used for storing the parameters on the input
+	 * Entry of the elite set.
 	 */
-	struct InputParameters {
-		WorkingParameters params;
-		Val mixFactor;
+	struct Elite {
+		OptimizationResult result;
+		size_t id;
+		size_t reseeds;
+
+		Elite(const OptimizationResult &result, size_t id, size_t reseeds)
+		    : result(result), id(id), reseeds(reseeds)
+		{
+		}
+	};
 
-		InputParameters() {}
+	/**
+	 * Independently locked part of the elite set.
+	 */
+	struct Shard {
+		std::mutex mutex;
+		std::vector<Elite> entries;
+		SpatialIndex index;
+
+		Shard(const SpatialIndex &index) : index(index) {}
+	};
+
+	/**
+	 * Location of an elite entry. The index of an entry may change when
+	 * another entry of the shard is erased, so the id is used to check whether
+	 * the entry still exists.
+	 */
+	struct EliteRef {
+		Shard *shard;
+		size_t idx;
+		size_t id;
 
-		InputParameters(const WorkingParameters &params, Val mixFactor = 0.0)
-		    : params(params), mixFactor(mixFactor)
+		Elite *get() const
 		{
+			if (idx < shard->entries.size() &&
+			    shard->entries[idx].id == id) {
+				return &shard->entries[idx];
+			}
+			return nullptr;
 		}
 	};
 
-	std::deque<InputParameters> input;
-	std::vector<OptimizationResult> output;
+	/**
+	 * Spatial index without entries, used to calculate the cell hashes of the
+	 * elite set.
+	 */
+	const SpatialIndex grid;
+
+	/**
+	 * Input queue, stores the ids of the pending input parameters.
+	 */
+	mutable std::mutex inputMutex;
+	std::deque<size_t> inputQueue;
+	std::unordered_map<size_t, InputParameters> inputs;
+	SpatialIndex inputIndex;
+	size_t nextInputId;
+
+	/**
+	 * Number of work items fetched via acquire() which have not been released
+	 * yet. Protected by the input mutex.
+	 */
+	size_t nBusy;
 
 	/**
-	 * Creates a new Pool instance and copies the given parameters onto the
-	 * input pool.
+	 * Elite set. The push mutex serializes pushOutput(), so the duplicate
+	 * search, the removal of the duplicate and the insertion of the new entry
+	 * form a single step. It is locked before any shard mutex.
 	 */
-	Pool(const std::vector<WorkingParameters> &params)
+	std::mutex pushMutex;
+	std::vector<std::unique_ptr<Shard>> shards;
+	std::atomic<size_t> nextEliteId;
+	std::atomic<float> best;
+	std::atomic<bool> dirty;
+
+	/**
+	 * Random seed used to choose the reseeded entries.
+	 */
+	const uint64_t seed;
+
+	/**
+	 * Sorted copy of the elite set as returned by output().
+	 */
+	std::mutex outputMutex;
+	std::vector<OptimizationResult> sortedOutput;
+
+	Shard &shard(uint64_t cell) { return *shards[cell % N_SHARDS]; }
+
+	/**
+	 * Erases the given entry from the shard by moving the last entry into its
+	 * place. The shard mutex must be locked.
+	 */
+	static void erase(Shard &s, size_t idx)
 	{
-		for (const auto &param : params) {
-			input.emplace_back(param, false);
+		const size_t last = s.entries.size() - 1;
+		s.index.remove(s.index.cell(s.entries[idx].result.params), idx);
+		if (idx != last) {
+			const uint64_t cell = s.index.cell(s.entries[last].result.params);
+			s.index.remove(cell, last);
+			s.index.insert(cell, idx);
+			s.entries[idx] = s.entries[last];
+		}
+		s.entries.pop_back();
+	}
+
+	/**
+	 * Returns the currently best evaluation result or zero if no such
+	 * evaluation result exists.
+	 */
+	Val bestEval() const { return best.load(); }
+
+	/**
+	 * Atomically updates the best evaluation result.
+	 */
+	void updateBest(Val eval)
+	{
+		float prev = best.load();
+		while (eval > prev && !best.compare_exchange_weak(prev, eval)) {
+		};
+	}
+
+	/**
+	 * Searches for an elite entry closer than MIN_DIST_OUTPUT to p. Returns
+	 * the location of the closest entry, the shard is nullptr if no such entry
+	 * exists.
+	 */
+	EliteRef findElite(const WorkingParameters &p)
+	{
+		Val minDist = std::numeric_limits<Val>::max();
+		EliteRef res{nullptr, 0, 0};
+		grid.neighbours(p, [&](uint64_t cell) {
+			Shard &s = shard(cell);
+			std::lock_guard<std::mutex> lock(s.mutex);
+			const std::vector<size_t> *ids = s.index.ids(cell);
+			if (!ids) {
+				return;
+			}
+			for (size_t i : *ids) {
+				const Elite &e = s.entries[i];
+				const Val dist = grid.distance(p, e.result.params);
+				if (dist < minDist && dist < MIN_DIST_OUTPUT) {
+					minDist = dist;
+					res = EliteRef{&s, i, e.id};
+				}
+			}
+		});
+		return res;
+	}
+
+	/**
+	 * Checks whether there is an input vector closer than MIN_DIST_INPUT to
+	 * p. The input mutex must be locked.
+	 */
+	bool hasInputDuplicate(const WorkingParameters &p) const
+	{
+		bool res = false;
+		inputIndex.neighbours(p, [&](uint64_t cell) {
+			const std::vector<size_t> *ids = inputIndex.ids(cell);
+			if (!ids || res) {
+				return;
+			}
+			for (size_t id : *ids) {
+				const InputParameters &ip = inputs.find(id)->second;
+				if (inputIndex.distance(p, ip.params) < MIN_DIST_INPUT) {
+					res = true;
+					return;
+				}
+			}
+		});
+		return res;
+	}
+
+	/**
+	 * Appends the given parameters to the input queue. The input mutex must be
+	 * locked.
+	 */
+	void appendInput(const InputParameters &ip)
+	{
+		const size_t id = nextInputId++;
+		inputs.emplace(id, ip);
+		inputQueue.push_back(id);
+		inputIndex.insert(inputIndex.cell(ip.params), id);
+	}
+
+	/**
+	 * Pops an input parameter from the input queue. The input mutex must be
+	 * locked.
+	 */
+	std::pair<bool, InputParameters> popInput()
+	{
+		if (inputQueue.empty()) {
+			return std::make_pair(false, InputParameters());
 		}
+		const size_t id = inputQueue.front();
+		inputQueue.pop_front();
+		auto it = inputs.find(id);
+		auto res = std::make_pair(true, it->second);
+		inputIndex.remove(inputIndex.cell(it->second.params), id);
+		inputs.erase(it);
+		return res;
 	}
 
 	/**
-	 * Returns a lock_guard instance which synchronizes access to the input and
-	 * output parameters.
+	 * Returns true if there is at least one elite entry which can still be
+	 * used to reseed a worker.
 	 */
-	std::unique_lock<std::mutex> lock()
+	bool canReseed()
 	{
-		return std::unique_lock<std::mutex>(mutex);
+		for (auto &s : shards) {
+			std::lock_guard<std::mutex> lock(s->mutex);
+			for (const Elite &e : s->entries) {
+				if (e.reseeds < MAX_RESEED) {
+					return true;
+				}
+			}
+		}
+		return false;
 	}
 
 	/**
-	 * Pops an input parameter from the input pool. This operation atomically
-	 * checks whether an element is available and -- if yes -- returns it.
+	 * Samples one of the best elite entries which has not yet been used to
+	 * reseed a worker. Allows idle workers to start a new optimization run
+	 * instead of waiting for input. The input mutex must be locked.
+	 */
+	std::pair<bool, InputParameters> reseed()
+	{
+		// Collect the best candidates
+		struct Candidate {
+			Val eval;
+			uint64_t stream;
+			EliteRef ref;
+		};
+		std::vector<Candidate> candidates;
+		for (auto &s : shards) {
+			std::lock_guard<std::mutex> lock(s->mutex);
+			for (size_t i = 0; i < s->entries.size(); i++) {
+				const Elite &e = s->entries[i];
+				if (e.reseeds < MAX_RESEED) {
+					candidates.push_back(
+					    {e.result.eval, RandomStream::streamId(e.result.params),
+					     {s.get(), i, e.id}});
+				}
+			}
+		}
+		if (candidates.empty()) {
+			return std::make_pair(false, InputParameters());
+		}
+		const size_t n = std::min(candidates.size(), N_RESEED_CANDIDATES);
+		std::partial_sort(candidates.begin(), candidates.begin() + n,
+		                  candidates.end(),
+		                  [](const Candidate &a, const Candidate &b) {
+			return a.eval > b.eval || (a.eval == b.eval && a.stream < b.stream);
+		});
+
+		// Randomly choose one of the candidates. The random stream is derived
+		// from the candidate parameters instead of a reseed counter, so the
+		// choice does not depend on the order in which the threads reseed.
+		uint64_t stream = 14695981039346656037ULL;
+		for (size_t i = 0; i < n; i++) {
+			stream = (stream ^ candidates[i].stream) * 1099511628211ULL;
+		}
+		RandomStream generator(seed, stream);
+		const Candidate &c =
+		    candidates[std::uniform_int_distribution<size_t>(0, n - 1)(
+		        generator)];
+		std::lock_guard<std::mutex> lock(c.ref.shard->mutex);
+		Elite *e = c.ref.get();
+		if (!e || e->reseeds >= MAX_RESEED) {
+			return std::make_pair(false, InputParameters());
+		}
+		e->reseeds++;
+		return std::make_pair(
+		    true, InputParameters(e->result.params, 0.0, e->reseeds));
+	}
+
+public:
+	/**
+	 * Creates a new EliteArchive instance and copies the given parameters onto
+	 * the input queue.
+	 *
+	 * @param params are the initial input parameters. Distances are measured
+	 * relative to the first parameter set.
+	 * @param dims are the optimized dimensions, the first of these dimensions
+	 * are used for the spatial index.
+	 * @param seed is the random seed used to choose the reseeded entries.
+	 */
+	EliteArchive(const std::vector<WorkingParameters> &params,
+	             const std::vector<size_t> &dims, uint64_t seed)
+	    : grid(dims, params[0], MIN_DIST_OUTPUT),
+	      inputIndex(dims, params[0], MIN_DIST_INPUT),
+	      nextInputId(0),
+	      nBusy(0),
+	      nextEliteId(0),
+	      best(0.0),
+	      dirty(false),
+	      seed(seed)
+	{
+		for (size_t i = 0; i < N_SHARDS; i++) {
+			shards.emplace_back(new Shard(grid));
+		}
+		for (const auto &param : params) {
+			appendInput(InputParameters(param, 0.0));
+		}
+	}
+
+	/**
+	 * Fetches the next work item for a worker: the next input parameter set
+	 * or, if the input queue is empty, one of the elite entries. The worker is
+	 * counted as busy until it calls release(). Both happen in a single step
+	 * under the input mutex, so finished() never observes a worker between
+	 * fetching and starting the work.
 	 *
 	 * @return a pair containing a "valid" flag as first value and the actual
 	 * parameter as second value.
 	 */
-	std::pair<bool, InputParameters> popInput()
+	std::pair<bool, InputParameters> acquire()
 	{
-		auto poolLock = lock();
-		if (input.empty()) {
-			return std::make_pair(false, InputParameters());
+		std::lock_guard<std::mutex> lock(inputMutex);
+		auto res = popInput();
+		if (!res.first) {
+			res = reseed();
+		}
+		if (res.first) {
+			nBusy++;
 		}
-		auto res = std::make_pair(true, input.front());
-		input.pop_front();
 		return res;
 	}
 
 	/**
-	 * Pushes a new parameter onto the input pool, makes sure there are no
-	 * duplicated parameter pairs.
+	 * Marks a work item fetched via acquire() as done. Must be called after
+	 * the results have been pushed.
+	 */
+	void release()
+	{
+		std::lock_guard<std::mutex> lock(inputMutex);
+		nBusy--;
+	}
+
+	/**
+	 * Returns the number of work items currently being processed.
+	 */
+	size_t busy() const
+	{
+		std::lock_guard<std::mutex> lock(inputMutex);
+		return nBusy;
+	}
+
+	/**
+	 * Returns the number of pending input parameters plus the number of work
+	 * items currently being processed.
 	 */
-	void pushInput(const WorkingParameters &p, Val eval, Val nextMf)
+	size_t pending() const
+	{
+		std::lock_guard<std::mutex> lock(inputMutex);
+		return inputQueue.size() + nBusy;
+	}
+
+	/**
+	 * Returns true if no worker is busy, the input queue is empty and no elite
+	 * entry can be used for reseeding, i.e. there is nothing left to do.
+	 */
+	bool finished()
+	{
+		std::lock_guard<std::mutex> lock(inputMutex);
+		return nBusy == 0 && inputQueue.empty() && !canReseed();
+	}
+
+	/**
+	 * Pushes a new parameter onto the input queue, makes sure there are no
+	 * duplicated parameter pairs. The reseed count is inherited from the
+	 * input the parameters were derived from.
+	 */
+	void pushInput(const WorkingParameters &p, Val eval, Val nextMf,
+	               size_t reseeds)
 	{
-		auto poolLock = lock();
 		if (bestEval() - eval < MAX_WORSE) {
-			const InputParameters ip(p, nextMf);
-			if (findDuplicate(input, ip, MIN_DIST_INPUT) == -1) {
-				input.emplace_back(ip);
+			std::lock_guard<std::mutex> lock(inputMutex);
+			if (!hasInputDuplicate(p)) {
+				appendInput(InputParameters(p, nextMf, reseeds));
 			}
 		}
 	}
 
 	/**
-	 * Pushes a new output parameter onto the output pool, makes sure there are
-	 * no duplicated parameter pairs.
+	 * Pushes a new output parameter onto the elite set, makes sure there are
+	 * no duplicated parameter pairs. The new entry inherits the reseed count of
+	 * the input it was derived from and of the entry it replaces, so a chain of
+	 * reseeded optimization runs cannot continue forever.
 	 */
-	void pushOutput(const WorkingParameters &p, Val eval)
+	void pushOutput(const WorkingParameters &p, Val eval, size_t reseeds)
 	{
-		auto poolLock = lock();
-
 		// Make sure the evaluation measure is positive
-		if (eval > MIN_DIFF) {
-			// Push it onto the output list without duplicates
-			const OptimizationResult opr(p, eval);
-			const ssize_t dupIdx = findDuplicate(output, opr, MIN_DIST_OUTPUT);
-			if (eval > bestEval() || dupIdx == -1) {
-				if (dupIdx == -1) {
-					output.push_back(opr);
-				} else {
-					output[dupIdx] = opr;
+		if (eval <= MIN_DIFF) {
+			return;
+		}
+
+		// Replace a duplicate if the new result is the best one so far,
+		// otherwise only add the result if there is no duplicate. Duplicates
+		// are erased and the new entry is re-inserted, as the new parameters
+		// might be located in another cell.
+		std::lock_guard<std::mutex> pushLock(pushMutex);
+		const OptimizationResult opr(p, eval);
+		const EliteRef dup = findElite(p);
+		if (dup.shard) {
+			if (eval <= bestEval()) {
+				return;
+			}
+			std::lock_guard<std::mutex> lock(dup.shard->mutex);
+			if (const Elite *e = dup.get()) {
+				reseeds = std::max(reseeds, e->reseeds);
+				erase(*dup.shard, dup.idx);
+			}
+		}
+
+		const uint64_t cell = grid.cell(p);
+		Shard &s = shard(cell);
+		{
+			std::lock_guard<std::mutex> lock(s.mutex);
+			s.index.insert(cell, s.entries.size());
+			s.entries.emplace_back(opr, nextEliteId++, reseeds);
+		}
+		updateBest(eval);
+		dirty.store(true);
+	}
+
+	/**
+	 * Returns the elite set sorted by ascending evaluation result. The sorted
+	 * copy is only rebuilt if the elite set has changed.
+	 */
+	const std::vector<OptimizationResult> &output()
+	{
+		std::lock_guard<std::mutex> outputLock(outputMutex);
+		if (dirty.exchange(false)) {
+			sortedOutput.clear();
+			for (auto &s : shards) {
+				std::lock_guard<std::mutex> lock(s->mutex);
+				for (const Elite &e : s->entries) {
+					sortedOutput.push_back(e.result);
 				}
-				std::sort(output.begin(), output.end());
 			}
+			std::sort(sortedOutput.begin(), sortedOutput.end());
+		}
+		return sortedOutput;
+	}
+};
+
+/**
+ * The SimulationSlots class bounds the number of simulations running
+ * concurrently within an optimization to the number of threads allowed by the
+ * ThreadLimit. The inner optimization algorithms may run more threads than
+ * that, e.g. if the limit is lowered while they are running, but each
+ * simulation first has to occupy one of the slots.
+ */
+class SimulationSlots {
+private:
+	/**
+	 * Thread limit or nullptr if the number of threads is not limited.
+	 */
+	const ThreadLimit *limit;
+
+	/**
+	 * Number of worker threads of the optimization.
+	 */
+	const size_t nThreads;
+
+	/**
+	 * Mutex and condition variable protecting the number of occupied slots.
+	 */
+	std::mutex mutex;
+	std::condition_variable cond;
+	size_t used;
+
+public:
+	SimulationSlots(const ThreadLimit *limit, size_t nThreads)
+	    : limit(limit), nThreads(nThreads), used(0)
+	{
+	}
+
+	/**
+	 * Returns the number of simulations currently allowed to run.
+	 */
+	size_t allowed() const
+	{
+		return limit ? std::min(nThreads, limit->get()) : nThreads;
+	}
+
+	/**
+	 * Waits for a free slot and occupies it. Once the abort flag is set at
+	 * least one slot is available, so the last evaluations of an aborted run
+	 * finish even if the limit is zero. The limit may be raised without any
+	 * notification, so the condition is checked periodically.
+	 */
+	void acquire(const std::atomic<bool> &abort)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (used >= (abort.load() ? std::max<size_t>(1, allowed())
+		                             : allowed())) {
+			cond.wait_for(lock, std::chrono::milliseconds(20));
+		}
+		used++;
+	}
+
+	/**
+	 * Frees a slot occupied by acquire().
+	 */
+	void release()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			used--;
+		}
+		cond.notify_one();
+	}
+};
+
+/**
+ * The FidelityScheduler class implements an asynchronous variant of successive
+ * halving. Each fidelity level keeps a window of the most recent costs, a
+ * candidate is promoted to the next level if its cost is among the best
+ * promotionRate fraction of this window. The scheduler is shared between all
+ * optimization threads.
+ */
+class FidelityScheduler {
+private:
+	struct Level {
+		/**
+		 * Mutex protecting the level.
+		 */
+		std::mutex mutex;
+
+		/**
+		 * Ring buffer containing the most recent costs.
+		 */
+		std::vector<Val> costs;
+
+		/**
+		 * Next element in the ring buffer which is overwritten.
+		 */
+		size_t next = 0;
+
+		/**
+		 * Number of candidates which have been evaluated with full fidelity
+		 * after passing this level.
+		 */
+		size_t nCalibrated = 0;
+
+		/**
+		 * Running estimate of the difference between the full fidelity cost and
+		 * the cost on this level.
+		 */
+		Val bias = 0.0;
+	};
+
+	/**
+	 * Fraction of the candidates which is promoted to the next level.
+	 */
+	Val promotionRate;
+
+	/**
+	 * State of the individual fidelity levels.
+	 */
+	std::vector<std::unique_ptr<Level>> levels;
+
+public:
+	FidelityScheduler(size_t nLevels, Val promotionRate)
+	    : promotionRate(promotionRate)
+	{
+		for (size_t i = 0; i < nLevels; i++) {
+			levels.emplace_back(new Level());
+		}
+	}
+
+	/**
+	 * Records the cost of a candidate on the given level and returns true if
+	 * the candidate should be promoted to the next level.
+	 */
+	bool promote(size_t i, Val cost)
+	{
+		Level &l = *levels[i];
+		std::lock_guard<std::mutex> lock(l.mutex);
+		if (l.costs.size() < FIDELITY_WINDOW) {
+			l.costs.push_back(cost);
+		} else {
+			l.costs[l.next] = cost;
+			l.next = (l.next + 1) % FIDELITY_WINDOW;
 		}
+		if (l.costs.size() <= FIDELITY_WARMUP) {
+			return true;
+		}
+		const size_t nBetter = std::count_if(l.costs.begin(), l.costs.end(),
+		                                     [cost](Val c) { return c < cost; });
+		return nBetter < promotionRate * l.costs.size();
+	}
+
+	/**
+	 * Updates the estimated cost difference between the given level and the
+	 * full fidelity evaluation.
+	 */
+	void calibrate(size_t i, Val cost, Val fullCost)
+	{
+		Level &l = *levels[i];
+		std::lock_guard<std::mutex> lock(l.mutex);
+		const Val d = fullCost - cost;
+		l.bias = (l.nCalibrated == 0)
+		             ? d
+		             : l.bias + FIDELITY_BIAS_RATE * (d - l.bias);
+		l.nCalibrated++;
+	}
+
+	/**
+	 * Estimates the full fidelity cost of a candidate which has not been
+	 * promoted beyond the given level.
+	 */
+	Val estimate(size_t i, Val cost)
+	{
+		Level &l = *levels[i];
+		std::lock_guard<std::mutex> lock(l.mutex);
+		return std::min<Val>(0.0, cost + l.bias);
+	}
+};
+
+/**
+ * The FidelityEvaluation class evaluates parameter sets on the levels of the
+ * fidelity ladder. The generic implementation is used for evaluations which
+ * do not support multiple fidelities and has no levels.
+ */
+template <typename Evaluation>
+class FidelityEvaluation {
+public:
+	static constexpr bool supported = false;
+
+	FidelityEvaluation(const Evaluation &, const std::vector<FidelityLevel> &,
+	                   bool)
+	{
+	}
+
+	size_t size() const { return 0; }
+
+	void evaluateInto(size_t, const WorkingParameters &, Val *) const {}
+};
+
+/**
+ * Specialization for the SpikeTrainEvaluation, each level evaluates a prefix
+ * of the spike train with the target error of the level.
+ */
+template <>
+class FidelityEvaluation<SpikeTrainEvaluation> {
+private:
+	std::vector<SpikeTrainEvaluation> evals;
+	std::vector<Val> eTars;
+
+public:
+	static constexpr bool supported = true;
+
+	FidelityEvaluation(const SpikeTrainEvaluation &eval,
+	                   const std::vector<FidelityLevel> &ladder,
+	                   bool useIfCondExp)
+	{
+		const SpikeTrain &train = eval.getTrain();
+		const size_t nGroups =
+		    train.getRanges().empty() ? 0 : train.getRanges().size() - 1;
+		for (const FidelityLevel &level : ladder) {
+			const size_t n = std::max<size_t>(
+			    1, size_t(std::ceil(level.trainFraction * nGroups)));
+			evals.emplace_back(train.truncate(n), useIfCondExp);
+			eTars.push_back(level.eTar);
+		}
+	}
+
+	size_t size() const { return evals.size(); }
+
+	void evaluateInto(size_t i, const WorkingParameters &params, Val *out) const
+	{
+		evals[i].evaluateInto(params, out, eTars[i]);
 	}
 };
 
-Optimization::Optimization() : model(ModelType::IF_COND_EXP), hw(nullptr) {}
+Optimization::Optimization()
+    : model(ModelType::IF_COND_EXP),
+      hw(nullptr),
+      strategy(HardwareStrategy::MIX_FACTOR),
+      useSurrogate(false),
+      algorithm(OptimizationAlgorithm::SIMPLEX),
+      seed(DEFAULT_SEED),
+      promotionRate(DEFAULT_PROMOTION_RATE)
+{
+}
 
 Optimization::Optimization(ModelType model, const std::vector<size_t> &dims,
-                           const HardwareParameters &hw)
-    : model(model), dims(filterDims(model, dims)), hw(&hw)
+                           const HardwareParameters &hw,
+                           HardwareStrategy strategy)
+    : model(model),
+      dims(filterDims(model, dims)),
+      hw(&hw),
+      strategy(strategy),
+      useSurrogate(false),
+      algorithm(OptimizationAlgorithm::SIMPLEX),
+      seed(DEFAULT_SEED),
+      promotionRate(DEFAULT_PROMOTION_RATE)
 {
 }
 
 Optimization::Optimization(ModelType model, const std::vector<size_t> &dims)
-    : model(model), dims(filterDims(model, dims)), hw(nullptr)
+    : model(model),
+      dims(filterDims(model, dims)),
+      hw(nullptr),
+      strategy(HardwareStrategy::MIX_FACTOR),
+      useSurrogate(false),
+      algorithm(OptimizationAlgorithm::SIMPLEX),
+      seed(DEFAULT_SEED),
+      promotionRate(DEFAULT_PROMOTION_RATE)
+{
+}
+
+std::vector<FidelityLevel> Optimization::defaultFidelityLadder()
 {
+	return std::vector<FidelityLevel>{FidelityLevel(0.25, 1e-3)};
 }
 
 std::vector<size_t> Optimization::filterDims(ModelType model,
@@ -222,45 +1018,157 @@ std::vector<size_t> Optimization::filterDims(ModelType model,
 
 template <typename Evaluation>
 void Optimization::optimizationThread(const Optimization &optimization,
-                                      const Evaluation &eval, Pool &pool,
+                                      const Evaluation &eval,
+                                      EliteArchive &archive,
+                                      Surrogate *surrogate,
+                                      FidelityScheduler *scheduler,
+                                      SimulationSlots &slots, size_t idx,
                                       std::atomic<bool> &abort,
-                                      std::atomic<size_t> &nIdle,
                                       std::atomic<size_t> &nIt,
                                       std::atomic<float> &gErr)
 {
 	// Flag to be passed to the hardware constraints
 	const bool hasHw = optimization.hw;
 	const bool useIfCondExp = optimization.model == ModelType::IF_COND_EXP;
+	const bool project =
+	    hasHw && optimization.strategy == HardwareStrategy::PROJECTION;
+	const bool mix = hasHw && !project;
+
+	// Returns true if the given parameters can be evaluated
+	auto realisable = [&optimization, hasHw, useIfCondExp](
+	                      const WorkingParameters &p) -> bool {
+		return p.valid() &&
+		       (!hasHw || optimization.hw->possible(p, useIfCondExp));
+	};
+
+	// Fetch the result cache, if any, and the id of the evaluation in the cache
+	ResultCache *cache = optimization.resultCache.get();
+	const uint64_t evaluationId = cache ? ResultCache::evaluationId(eval) : 0;
+
+	// Set to true by the cost function f whenever the simulation was actually
+	// run, only those samples are added to the surrogate model. The cost
+	// function is called from the threads of the inner optimization
+	// algorithms, so each thread has its own flag.
+	static thread_local bool simulated = false;
 
 	// Define the cost function f
-	auto f = [&eval, &optimization, hasHw, useIfCondExp](
-	             const WorkingParameters &p) -> Val {
+	auto f = [&eval, &realisable, &slots, &abort, cache,
+	          evaluationId](const WorkingParameters &p) -> Val {
 		// Return the worst possible cost (zero, as all other costs are
 		// negative) if the parameters are not realisable
-		if (!p.valid() ||
-		    (hasHw && !optimization.hw->possible(p, useIfCondExp))) {
+		if (!realisable(p)) {
 			return 0.0;
 		}
 
-		// Evaluate the parameters, return the negative of the selected
-		// target dimension (the optimization needs a cost and the
-		// evaluation returns a success rate)
-		return -eval.evaluate(p)[eval.descriptor().optimizationDim()];
+		// Evaluate the parameters (unless the result is cached), return the
+		// negative of the selected target dimension (the optimization needs a
+		// cost and the evaluation returns a success rate)
+		Val res[EvaluationResult::MAX_SIZE];
+		const size_t n = eval.descriptor().size();
+		if (!cache || !cache->lookup(evaluationId, p, res, n)) {
+			slots.acquire(abort);
+			eval.evaluateInto(p, res);
+			slots.release();
+			simulated = true;
+			if (cache) {
+				cache->store(evaluationId, p, res, n);
+			}
+		}
+		return -res[eval.descriptor().optimizationDim()];
+	};
+
+	// Updates the globally best cost
+	auto updateErr = [&gErr](Val err) {
+		float prevErr = gErr.load();
+		while (err < prevErr && !gErr.compare_exchange_weak(prevErr, err)) {
+		};
+	};
+
+	// Multi-fidelity cost function. The parameters are evaluated on the levels
+	// of the fidelity ladder, the scheduler only promotes the most promising
+	// candidates to the next level. The full fidelity cost of candidates which
+	// are dropped is estimated from their cost on the last level.
+	const FidelityEvaluation<Evaluation> levels(
+	    eval, scheduler ? optimization.fidelityLadder
+	                    : std::vector<FidelityLevel>(),
+	    useIfCondExp);
+	auto fm = [&](const WorkingParameters &p) -> Val {
+		if (levels.size() == 0 || !realisable(p)) {
+			return f(p);
+		}
+		const size_t dim = eval.descriptor().optimizationDim();
+		std::vector<Val> costs(levels.size());
+		for (size_t i = 0; i < levels.size(); i++) {
+			Val res[EvaluationResult::MAX_SIZE];
+			slots.acquire(abort);
+			levels.evaluateInto(i, p, res);
+			slots.release();
+			costs[i] = -res[dim];
+			if (!scheduler->promote(i, costs[i])) {
+				return scheduler->estimate(i, costs[i]);
+			}
+		}
+		const Val cost = f(p);
+		for (size_t i = 0; i < levels.size(); i++) {
+			scheduler->calibrate(i, costs[i], cost);
+		}
+		updateErr(cost);
+		return cost;
+	};
+
+	// Cost function used by the simplex algorithm. If a surrogate model is
+	// available, the actual evaluation is skipped if the model is certain that
+	// the parameters are not better than the currently best result.
+	auto fs = [&fm, &gErr, surrogate](const WorkingParameters &p) -> Val {
+		using Clock = std::chrono::steady_clock;
+		if (!surrogate) {
+			return fm(p);
+		}
+		if (surrogate->profitable(SURROGATE_MAX_COST_RATIO)) {
+			const auto t0 = Clock::now();
+			const Surrogate::Prediction pred = surrogate->predict(p);
+			const bool hit =
+			    pred.valid && pred.sigma < SURROGATE_MAX_SIGMA &&
+			    pred.mean - SURROGATE_KAPPA * pred.sigma > gErr.load();
+			const std::chrono::duration<double> t = Clock::now() - t0;
+			surrogate->query(t.count(), hit);
+			if (hit) {
+				return pred.mean;
+			}
+		}
+		// Only add samples for which the full simulation was run. Invalid or
+		// unrealisable parameters, cached results and candidates dropped by
+		// the multi-fidelity scheduler would skew both the model and the
+		// timing used to decide whether the surrogate is profitable.
+		simulated = false;
+		const auto t0 = Clock::now();
+		const Val res = fm(p);
+		const std::chrono::duration<double> t = Clock::now() - t0;
+		if (simulated) {
+			surrogate->add(p, res, t.count());
+		}
+		return res;
 	};
 
 	// Repeat until the "abort" flag has been set by the calling code
+	const ThreadLimit *limit = optimization.threadLimit.get();
 	while (!abort.load()) {
+		// Do not fetch any new work while the thread limit does not allow this
+		// thread to run
+		if (limit && !limit->allows(idx)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			continue;
+		}
+
 		// Fetch an input WorkingParameters set, if no input data is available
-		// just sleep
-		const auto in = pool.popInput();
+		// restart the optimization from one of the elite parameter sets. Only
+		// sleep if there is nothing to do at all.
+		const auto in = archive.acquire();
 		if (!in.first) {
 			std::this_thread::sleep_for(std::chrono::milliseconds(20));
 			continue;
 		}
 
-		// We have work to do!
-		nIdle--;
-
 		// Copy the current WorkingParameters and get the current evaluation
 		// measure
 		const WorkingParameters params = in.second.params;
@@ -269,45 +1177,86 @@ void Optimization::optimizationThread(const Optimization &optimization,
 		// Fetch the current and the next mix factor -- the mix factor is used
 		// to interploate between the forced hardware setup and the
 		// current parameters
-		Val curMf = hasHw ? in.second.mixFactor : 0.0;
-		Val nextMf = hasHw ? curMf + MIX_STEP : 0.0;
+		Val curMf = mix ? in.second.mixFactor : 0.0;
+		Val nextMf = mix ? curMf + MIX_STEP : 0.0;
 		if (nextMf > 1.0f) {
 			curMf = 1.0f;
 			nextMf = 0.0f;
 		}
 
-		// Create the simplex algorithm instance, fetch the to-be-optimized
-		// dimensions
-		SimplexPool<WorkingParameters> simplex(
-		    params, optimization.getDims(curMf != 0.0), 10);
-
-		// Run the actual optimization, increment the iteration counter and
-		// abort if the abort flag is read.
-		size_t oldIt = 0;
-		const WorkingParameters optimizedParams =
-		    simplex.run(f, [&](size_t it, size_t, Val err) mutable -> bool {
-			                nIt += (it - oldIt);
-			                oldIt = it;
-			                float prevErr = gErr.load();
-			                while (err < prevErr &&
-			                       !gErr.compare_exchange_weak(prevErr, err)) {
-			                };
-			                return !abort.load();
-			            }).best;
-
-		// If a hardware limitation is present, map the optimized values to
-		// the hardware -- then remap them to WorkingParameters. If there is
-		// no HW limitation just add the optimized params.
+		// Runs the selected optimization algorithm for the cost function g
+		// starting at the given parameters, increments the iteration counter
+		// and aborts if the abort flag is read. The best cost reported by the
+		// algorithm may be an estimate in the multi-fidelity mode, so the
+		// globally best cost is updated by the cost function instead.
+		auto optimize = [&](const WorkingParameters &start,
+		                    const std::vector<size_t> &dims,
+		                    auto g) -> WorkingParameters {
+			size_t oldIt = 0;
+			auto callback = [&](size_t it, size_t, Val err) mutable -> bool {
+				nIt += (it - oldIt);
+				oldIt = it;
+				if (levels.size() == 0) {
+					updateErr(err);
+				}
+				return !abort.load();
+			};
+			// The random numbers only depend on the start parameters, not on
+			// the thread performing the optimization. The threads allowed by
+			// the thread limit are shared among the busy workers, so a single
+			// start vector still uses all of them. The simulation slots keep
+			// the number of running simulations within the limit.
+			const uint64_t stream = RandomStream::streamId(start);
+			const size_t nBusy = std::max<size_t>(1, archive.busy());
+			const size_t nInner =
+			    std::max<size_t>(1, (slots.allowed() + nBusy - 1) / nBusy);
+			if (optimization.algorithm == OptimizationAlgorithm::CMA_ES) {
+				CmaEs<WorkingParameters> cmaEs(start, dims);
+				cmaEs.setSeed(optimization.seed, stream);
+				cmaEs.setThreadCount(nInner);
+				return cmaEs.run(g, callback).best;
+			}
+			SimplexPool<WorkingParameters> pool(start, dims, 10);
+			pool.setSeed(optimization.seed, stream);
+			pool.setThreadCount(nInner);
+			return pool.run(g, callback).best;
+		};
+
+		// If a hardware limitation is present, either map the optimized values
+		// to the hardware and remap them to WorkingParameters, or directly
+		// optimize in the hardware domain. In the latter case the discrete
+		// capacitance and weight are enumerated (only the hardware values next
+		// to the current parameters are considered) and the continuous
+		// parameters are projected onto their valid range in the cost
+		// function. If there is no HW limitation just add the optimized
+		// params.
 		std::vector<WorkingParameters> finalParams;
-		if (hasHw) {
-			std::vector<Parameters> mapped =
-			    optimization.hw->map(optimizedParams, useIfCondExp);
-			for (const Parameters &p : mapped) {
-				finalParams.push_back((optimizedParams * (1.0f - curMf)) +
-				                      (WorkingParameters(p) * curMf));
+		if (project) {
+			for (const Parameters &hwp :
+			     optimization.hw->map(params, useIfCondExp, false)) {
+				const Val cM = hwp.cM();
+				const Val w = hwp.w();
+				auto fProj = [&](const WorkingParameters &p) -> Val {
+					return fs(optimization.hw->project(p, cM, w, useIfCondExp));
+				};
+				finalParams.push_back(optimization.hw->project(
+				    optimize(WorkingParameters(hwp), optimization.getDims(true),
+				             fProj),
+				    cM, w, useIfCondExp));
 			}
 		} else {
-			finalParams.push_back(optimizedParams);
+			const WorkingParameters optimizedParams =
+			    optimize(params, optimization.getDims(curMf != 0.0), fs);
+			if (mix) {
+				std::vector<Parameters> mapped =
+				    optimization.hw->map(optimizedParams, useIfCondExp);
+				for (const Parameters &p : mapped) {
+					finalParams.push_back((optimizedParams * (1.0f - curMf)) +
+					                      (WorkingParameters(p) * curMf));
+				}
+			} else {
+				finalParams.push_back(optimizedParams);
+			}
 		}
 
 		// Check whether the parameters should be added to the output or
@@ -321,14 +1270,14 @@ void Optimization::optimizationThread(const Optimization &optimization,
 			const bool hasSubstantialChange =
 			    fabs(initialEval - eval) > MIN_DIFF;
 			if (abort.load() || (!hasSubstantialChange && nextMf == 0.0f)) {
-				pool.pushOutput(p, -eval);
+				archive.pushOutput(p, -eval, in.second.reseeds);
 			} else {
-				pool.pushInput(p, -eval, nextMf);
+				archive.pushInput(p, -eval, nextMf, in.second.reseeds);
 			}
 		}
 
-		// We're done working, increment the "nIdle" counter
-		nIdle++;
+		// We're done working, the results have been pushed to the archive
+		archive.release();
 	}
 }
 
@@ -345,36 +1294,52 @@ std::vector<OptimizationResult> Optimization::optimize(
 	// Fetch the number of threads to be used
 	size_t nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
 
-	// Copy the given parameters into the parameter pool
-	Pool pool(params);
+	// Copy the given parameters into the input queue of the archive
+	EliteArchive archive(params, dims, seed);
+
+	// Create the surrogate model if requested, normalize all dimensions
+	// relative to the first input parameter set
+	std::unique_ptr<Surrogate> surrogate;
+	if (useSurrogate) {
+		surrogate.reset(new Surrogate(params[0], dims));
+	}
 
-	std::atomic<bool> abort(false);       // Flag used to abort all threads
-	std::atomic<size_t> nIdle(nThreads);  // Number of threads idling
-	std::atomic<size_t> nIt(0);           // Number of iterations performed
+	// Create the fidelity scheduler if the multi-fidelity optimization is
+	// enabled and supported by the evaluation
+	std::unique_ptr<FidelityScheduler> scheduler;
+	if (FidelityEvaluation<Evaluation>::supported && !fidelityLadder.empty()) {
+		scheduler.reset(
+		    new FidelityScheduler(fidelityLadder.size(), promotionRate));
+	}
+
+	// Bound the number of concurrently running simulations by the thread limit
+	SimulationSlots slots(threadLimit.get(), nThreads);
+
+	std::atomic<bool> abort(false);  // Flag used to abort all threads
+	std::atomic<size_t> nIt(0);      // Number of iterations performed
 	std::atomic<float> gErr(std::numeric_limits<float>::max());
 
 	// Create a thread for each hardware thread
 	std::vector<std::thread> threads;
 	for (size_t i = 0; i < nThreads; i++) {
 		threads.emplace_back(optimizationThread<Evaluation>, *this, eval,
-		                     std::ref(pool), std::ref(abort), std::ref(nIdle),
-		                     std::ref(nIt), std::ref(gErr));
+		                     std::ref(archive), surrogate.get(),
+		                     scheduler.get(), std::ref(slots), i,
+		                     std::ref(abort), std::ref(nIt),
+		                     std::ref(gErr));
 	}
 
 	// Wait for all threads to be finished
 	while (true) {
-		{
-			// Abort if all threads idle and the input parameter array is empty
-			// or if the callback returns false
-			auto poolLock = pool.lock();
-			if ((nIdle.load() == nThreads && pool.input.empty()) ||
-			    !callback(nIt.load(),
-			              pool.input.size() + nThreads - nIdle.load(),
-			              -gErr.load(),
-			              pool.output)) {
-				abort.store(true);
-				break;
-			}
+		// Abort if there is nothing left to do or if the callback returns
+		// false
+		if (archive.finished() ||
+		    !callback(nIt.load(), archive.pending(), -gErr.load(),
+		              archive.output(),
+		              surrogate ? surrogate->statistics()
+		                        : SurrogateStatistics())) {
+			abort.store(true);
+			break;
 		}
 
 		// Sleep some time before checking again
@@ -387,7 +1352,7 @@ std::vector<OptimizationResult> Optimization::optimize(
 	}
 
 	// Return the final output parameters
-	return pool.output;
+	return archive.output();
 }
 
 std::vector<size_t> Optimization::getDims(bool clampDiscrete) const
@@ -30,17 +30,24 @@
 #define _ADEXPSIM_OPTIMIZATION_HPP_
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <vector>
 
+#include <common/ThreadLimit.hpp>
 #include <exploration/EvaluationResult.hpp>
+#include <exploration/ResultCache.hpp>
+#include <exploration/Surrogate.hpp>
 #include <simulation/Model.hpp>
 #include <simulation/Parameters.hpp>
 #include <simulation/HardwareParameters.hpp>
 
 namespace AdExpSim {
 
-class Pool;
+class EliteArchive;
+class FidelityScheduler;
+class SimulationSlots;
 
 /**
  * Contains a single result returned by the optimizer.
@@ -70,6 +77,69 @@ struct OptimizationResult {
 	bool operator<(const OptimizationResult &o) { return eval < o.eval; }
 };
 
+/**
+ * Specifies how hardware restrictions are handled by the Optimization class.
+ */
+enum class HardwareStrategy : int {
+	/**
+	 * Optimizes in the unrestricted parameter space, maps the result to the
+	 * hardware and re-optimizes the result in several passes, each pass moving
+	 * the parameters further towards the mapped hardware parameters.
+	 */
+	MIX_FACTOR = 0,
+
+	/**
+	 * Directly optimizes in the hardware domain. The discrete capacitance and
+	 * weight values next to the start parameters are enumerated, the
+	 * continuous parameters are projected onto the valid hardware ranges. Only
+	 * needs a single optimization pass per discrete configuration.
+	 */
+	PROJECTION = 1
+};
+
+/**
+ * Specifies the algorithm used by the Optimization class to optimize the
+ * individual parameter sets.
+ */
+enum class OptimizationAlgorithm : int {
+	/**
+	 * Downhill Simplex algorithm by Nelder and Mead, executed on several
+	 * randomly pertubated start vectors.
+	 */
+	SIMPLEX = 0,
+
+	/**
+	 * Covariance Matrix Adaptation Evolution Strategy. Each generation is
+	 * evaluated in parallel, scales better to many parameter dimensions.
+	 */
+	CMA_ES = 1
+};
+
+/**
+ * Describes a single level of the fidelity ladder used by the multi-fidelity
+ * optimization. Lower levels evaluate the candidates on a prefix of the spike
+ * train and with a looser integrator tolerance.
+ */
+struct FidelityLevel {
+	/**
+	 * Fraction of the spike train groups used for the evaluation.
+	 */
+	Val trainFraction;
+
+	/**
+	 * Target error used in the adaptive stepsize controller.
+	 */
+	Val eTar;
+
+	/**
+	 * Constructor, initializes all members with the given parameters.
+	 */
+	FidelityLevel(Val trainFraction = 1.0, Val eTar = 0.1e-3)
+	    : trainFraction(trainFraction), eTar(eTar)
+	{
+	}
+};
+
 /**
  * The Optimization class performs a threaded optimization.
  */
@@ -91,6 +161,51 @@ private:
 	 */
 	HardwareParameters const *hw;
 
+	/**
+	 * Strategy used to respect the hardware restrictions.
+	 */
+	HardwareStrategy strategy;
+
+	/**
+	 * If true, a surrogate model of the cost function is trained during the
+	 * optimization and used to skip the evaluation of unpromising parameter
+	 * sets.
+	 */
+	bool useSurrogate;
+
+	/**
+	 * Algorithm used to optimize the individual parameter sets.
+	 */
+	OptimizationAlgorithm algorithm;
+
+	/**
+	 * Random seed of the optimization run.
+	 */
+	uint64_t seed;
+
+	/**
+	 * Optional limit on the number of threads which are allowed to work at the
+	 * same time.
+	 */
+	std::shared_ptr<const ThreadLimit> threadLimit;
+
+	/**
+	 * Optional cache for the full fidelity evaluation results.
+	 */
+	std::shared_ptr<ResultCache> resultCache;
+
+	/**
+	 * Fidelity levels each candidate has to pass before it is evaluated with
+	 * full fidelity. Empty if the multi-fidelity optimization is disabled.
+	 */
+	std::vector<FidelityLevel> fidelityLadder;
+
+	/**
+	 * Fraction of the candidates which is promoted from one fidelity level to
+	 * the next.
+	 */
+	Val promotionRate;
+
 	/**
 	 * Filters the to-be-optimized dimensions based on the chosen neuron model.
 	 */
@@ -102,13 +217,23 @@ private:
 	 *
 	 * @param eval is a reference at the object performing the actual evaluation
 	 * @param optimization is a const reference at the optimization instance.
-	 * @param pool is the class holding the input and output parameters.
+	 * @param archive is the class holding the input and output parameters.
+	 * @param surrogate is the surrogate model or nullptr if no surrogate
+	 * model should be used.
+	 * @param scheduler decides which candidates are promoted to the next
+	 * fidelity level or is nullptr if all candidates should be evaluated with
+	 * full fidelity.
+	 * @param slots bounds the number of concurrently running simulations
+	 * according to the thread limit.
+	 * @param idx is the index of the thread, used to check the thread limit.
 	 */
 	template <typename Evaluation>
 	static void optimizationThread(const Optimization &optimization,
-	                               const Evaluation &eval, Pool &pool,
+	                               const Evaluation &eval,
+	                               EliteArchive &archive, Surrogate *surrogate,
+	                               FidelityScheduler *scheduler,
+	                               SimulationSlots &slots, size_t idx,
 	                               std::atomic<bool> &abort,
-	                               std::atomic<size_t> &nIdle,
 	                               std::atomic<size_t> &nIt,
 	                               std::atomic<float> &gErr);
 
@@ -129,9 +254,12 @@ public:
 	 * should be optimized.
 	 * @param hw is a reference at a HardwareParameters object specifying the
 	 * hardware restrictions.
+	 * @param strategy specifies how the hardware restrictions are handled.
+	 * Defaults to the MIX_FACTOR strategy, PROJECTION is opt-in.
 	 */
 	Optimization(ModelType model, const std::vector<size_t> &dims,
-	             const HardwareParameters &hw);
+	             const HardwareParameters &hw,
+	             HardwareStrategy strategy = HardwareStrategy::MIX_FACTOR);
 
 	/**
 	 * Constructor of the Optimization class. This optimization instance will
@@ -147,11 +275,15 @@ public:
 	/**
 	 * Callback function which gets called periodically to inform the calling
 	 * thread that the optimization is still running. Contains a reference at
-	 * the current optimization results. The return value determines whether the
-	 * operation should be aborted (return false), or continued (return true).
+	 * the current optimization results and the surrogate model usage counters
+	 * (all zero if no surrogate model is used). The return value determines
+	 * whether the operation should be aborted (return false), or continued
+	 * (return true).
 	 */
-	using ProgressCallback = std::function<
-	    bool(size_t, size_t, float, const std::vector<OptimizationResult> &)>;
+	using ProgressCallback =
+	    std::function<bool(size_t, size_t, float,
+	                       const std::vector<OptimizationResult> &,
+	                       const SurrogateStatistics &)>;
 
 	/**
 	 * Optimizes the given parameters for the selected model and evaluation
@@ -168,6 +300,139 @@ public:
 	 * the in-hardware discrete parameters are not added to the result.
 	 */
 	std::vector<size_t> getDims(bool clampDiscrete) const;
+
+	/**
+	 * Returns the strategy used to respect the hardware restrictions.
+	 */
+	HardwareStrategy getHardwareStrategy() const { return strategy; }
+
+	/**
+	 * Enables or disables the surrogate model. If enabled, the parameter sets
+	 * visited by the simplex algorithm are only evaluated if a surrogate model
+	 * trained on the previous evaluations predicts them to be promising or is
+	 * uncertain about them. Disabled by default.
+	 */
+	void setUseSurrogate(bool use) { useSurrogate = use; }
+
+	/**
+	 * Returns true if the surrogate model is used.
+	 */
+	bool getUseSurrogate() const { return useSurrogate; }
+
+	/**
+	 * Sets the algorithm used to optimize the individual parameter sets.
+	 * Defaults to OptimizationAlgorithm::SIMPLEX. Note that for CMA_ES the
+	 * iteration counter passed to the ProgressCallback counts generations.
+	 */
+	void setAlgorithm(OptimizationAlgorithm algorithm)
+	{
+		this->algorithm = algorithm;
+	}
+
+	/**
+	 * Returns the algorithm used to optimize the individual parameter sets.
+	 */
+	OptimizationAlgorithm getAlgorithm() const { return algorithm; }
+
+	/**
+	 * Default random seed.
+	 */
+	static constexpr uint64_t DEFAULT_SEED = 1241249190;
+
+	/**
+	 * Sets the random seed of the optimization. The random numbers used by an
+	 * optimization run started at a certain parameter set only depend on the
+	 * seed and the parameter set, not on the executing thread. The same holds
+	 * for the choice of the elite entry an idle thread is reseeded from, which
+	 * only depends on the seed and the current best entries. Note that with
+	 * more than one thread the elite set at the time of a reseed depends on
+	 * the order in which the threads finish, so results can only be
+	 * reproduced exactly if the thread limit allows a single thread.
+	 */
+	void setSeed(uint64_t seed) { this->seed = seed; }
+
+	/**
+	 * Returns the random seed of the optimization.
+	 */
+	uint64_t getSeed() const { return seed; }
+
+	/**
+	 * Sets a ThreadLimit instance which restricts the number of optimization
+	 * threads working at the same time. Paused threads do not fetch new input
+	 * parameter sets, the optimization runs they are currently working on are
+	 * finished first. Pass nullptr (the default) to use all threads.
+	 */
+	void setThreadLimit(std::shared_ptr<const ThreadLimit> limit)
+	{
+		threadLimit = limit;
+	}
+
+	/**
+	 * Returns the ThreadLimit instance set via setThreadLimit().
+	 */
+	std::shared_ptr<const ThreadLimit> getThreadLimit() const
+	{
+		return threadLimit;
+	}
+
+	/**
+	 * Sets a ResultCache instance which is consulted before each full fidelity
+	 * evaluation of the cost function, newly calculated results are added to
+	 * the cache. Pass nullptr (the default) to always run the simulation.
+	 */
+	void setResultCache(std::shared_ptr<ResultCache> cache)
+	{
+		resultCache = cache;
+	}
+
+	/**
+	 * Returns the ResultCache instance set via setResultCache().
+	 */
+	std::shared_ptr<ResultCache> getResultCache() const { return resultCache; }
+
+	/**
+	 * Default fraction of the candidates promoted to the next fidelity level.
+	 */
+	static constexpr Val DEFAULT_PROMOTION_RATE = 0.5;
+
+	/**
+	 * Returns a fidelity ladder which scores the candidates on a quarter of the
+	 * spike train with a ten times looser integrator tolerance before
+	 * evaluating them with full fidelity.
+	 */
+	static std::vector<FidelityLevel> defaultFidelityLadder();
+
+	/**
+	 * Enables the multi-fidelity optimization. Each candidate visited by the
+	 * optimization algorithm is evaluated on the given fidelity levels in
+	 * ascending order, only the given fraction of the candidates seen on a
+	 * level is promoted to the next level (asynchronous successive halving).
+	 * Candidates passing all levels are evaluated with full fidelity, the
+	 * cost of all other candidates is estimated from their last evaluation.
+	 * Pass an empty ladder (the default) to evaluate all candidates with full
+	 * fidelity. Only affects the SpikeTrainEvaluation, the single group
+	 * evaluations do not support multiple fidelities.
+	 */
+	void setFidelityLadder(const std::vector<FidelityLevel> &ladder,
+	                       Val promotionRate = DEFAULT_PROMOTION_RATE)
+	{
+		fidelityLadder = ladder;
+		this->promotionRate = promotionRate;
+	}
+
+	/**
+	 * Returns the fidelity ladder set via setFidelityLadder().
+	 */
+	const std::vector<FidelityLevel> &getFidelityLadder() const
+	{
+		return fidelityLadder;
+	}
+
+	/**
+	 * Returns the fraction of the candidates promoted to the next fidelity
+	 * level.
+	 */
+	Val getPromotionRate() const { return promotionRate; }
 };
 }
 
@@ -0,0 +1,95 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ResultCache.hpp
+ *
+ * Contains the ResultCache interface, which allows the exploration and the
+ * optimization to reuse evaluation results calculated in earlier runs.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_RESULT_CACHE_HPP_
+#define _ADEXPSIM_RESULT_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <common/Hash.hpp>
+#include <simulation/Parameters.hpp>
+
+namespace AdExpSim {
+
+/**
+ * The ResultCache class is the interface of a store for evaluation results.
+ * Results are addressed by an evaluation id, which identifies the evaluation
+ * including all of its inputs, and the evaluated working parameters. Both
+ * methods may be called from multiple threads concurrently. The actual
+ * implementation (e.g. the persistent ResultStore in the io library) is
+ * injected into the Exploration and Optimization classes.
+ */
+class ResultCache {
+public:
+	/**
+	 * Version of the evaluation results. Must be incremented whenever a change
+	 * to the simulation or the evaluation code changes the results, so that
+	 * results calculated by older versions are no longer used.
+	 */
+	static constexpr uint32_t VERSION = 1;
+
+	virtual ~ResultCache() {}
+
+	/**
+	 * Calculates the evaluation id of the given evaluation. The id depends on
+	 * the result version, the evaluation type and the fingerprint of the
+	 * evaluation inputs.
+	 */
+	template <typename Evaluation>
+	static uint64_t evaluationId(const Evaluation &evaluation)
+	{
+		Hash hash;
+		hash << uint32_t(VERSION) << evaluation.descriptor().type()
+		     << evaluation.fingerprint();
+		return hash.value();
+	}
+
+	/**
+	 * Looks up the result of the given evaluation for the given parameters.
+	 *
+	 * @param evaluation is the id of the evaluation as returned by
+	 * evaluationId().
+	 * @param params are the evaluated parameters.
+	 * @param out is the memory the n result values are written to.
+	 * @param n is the number of result values.
+	 * @return true if the result was found, false otherwise. In the latter
+	 * case the content of out is undefined.
+	 */
+	virtual bool lookup(uint64_t evaluation, const WorkingParameters &params,
+	                    Val *out, size_t n) const = 0;
+
+	/**
+	 * Stores the n result values of the given evaluation for the given
+	 * parameters.
+	 */
+	virtual void store(uint64_t evaluation, const WorkingParameters &params,
+	                   const Val *values, size_t n) = 0;
+};
+}
+
+#endif /* _ADEXPSIM_RESULT_CACHE_HPP_ */
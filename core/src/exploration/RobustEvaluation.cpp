@@ -0,0 +1,152 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include "RobustEvaluation.hpp"
+
+namespace AdExpSim {
+
+RobustEvaluation::RobustEvaluation(const SpikeTrain &train, size_t k,
+                                   size_t seed, bool useIfCondExp)
+    : minSamples(8), z(1.96)
+{
+	setThreads(0);
+	evaluations.reserve(k);
+	for (size_t i = 0; i < k; i++) {
+		SpikeTrain realization(train);
+		realization.rebuild(seed + i);
+		evaluations.emplace_back(realization, useIfCondExp);
+	}
+}
+
+void RobustEvaluation::setThreads(size_t n)
+{
+	nThreads = (n == 0)
+	               ? std::max<size_t>(1, std::thread::hardware_concurrency())
+	               : n;
+}
+
+void RobustEvaluation::extend(const WorkingParameters &params,
+                              RobustEvaluationResult &res, size_t end,
+                              Val eTar) const
+{
+	const size_t begin = res.size();
+	end = std::min(end, evaluations.size());
+	if (end <= begin) {
+		return;
+	}
+
+	// Evaluate the realizations in parallel
+	std::vector<EvaluationResult> results(end - begin);
+	std::atomic<size_t> idx(begin);
+	auto worker = [&]() {
+		size_t i;
+		while ((i = idx++) < end) {
+			results[i - begin] = evaluations[i].evaluate(params, eTar);
+		}
+	};
+	const size_t n = std::min(nThreads, end - begin);
+	if (n <= 1) {
+		worker();
+	} else {
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < n; i++) {
+			threads.emplace_back(worker);
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+	}
+
+	// Update the mean, the samples and the standard error
+	const size_t dim = descriptor().optimizationDim();
+	if (res.mean.size() == 0) {
+		res.mean = EvaluationResult(descriptor().size());
+	}
+	for (size_t j = 0; j < res.mean.size(); j++) {
+		double sum = double(res.mean[j]) * begin;
+		for (const EvaluationResult &r : results) {
+			sum += r[j];
+		}
+		res.mean[j] = sum / end;
+	}
+	for (const EvaluationResult &r : results) {
+		res.samples.push_back(r[dim]);
+	}
+	double var = 0.0;
+	for (Val s : res.samples) {
+		var += (s - res.mean[dim]) * (s - res.mean[dim]);
+	}
+	res.stdErr = (end > 1) ? std::sqrt(var / ((end - 1) * end)) : 0.0;
+}
+
+RobustEvaluationResult RobustEvaluation::evaluateRobust(
+    const WorkingParameters &params, Val eTar) const
+{
+	RobustEvaluationResult res;
+	extend(params, res, evaluations.size(), eTar);
+	return res;
+}
+
+void RobustEvaluation::complete(const WorkingParameters &params,
+                                RobustEvaluationResult &res, Val eTar) const
+{
+	extend(params, res, evaluations.size(), eTar);
+}
+
+RobustComparison RobustEvaluation::compare(
+    const WorkingParameters &params, const RobustEvaluationResult &incumbent,
+    RobustEvaluationResult &res, Val eTar) const
+{
+	res = RobustEvaluationResult();
+	const size_t k = std::min(evaluations.size(), incumbent.size());
+	while (res.size() < k) {
+		// Evaluate one realization per thread, but at least minSamples in the
+		// first batch
+		extend(params, res,
+		       std::min(k, std::max(minSamples, res.size() + nThreads)), eTar);
+		const size_t n = res.size();
+		if (n < std::min(minSamples, k)) {
+			continue;
+		}
+
+		// Confidence interval of the mean paired difference
+		double mean = 0.0, var = 0.0;
+		for (size_t i = 0; i < n; i++) {
+			mean += res.samples[i] - incumbent.samples[i];
+		}
+		mean /= n;
+		for (size_t i = 0; i < n; i++) {
+			const double d = res.samples[i] - incumbent.samples[i] - mean;
+			var += d * d;
+		}
+		const double radius =
+		    (n > 1) ? z * std::sqrt(var / ((n - 1) * n)) : 0.0;
+		if (mean - radius > 0.0) {
+			return RobustComparison::BETTER;
+		} else if (mean + radius < 0.0) {
+			return RobustComparison::WORSE;
+		}
+	}
+	return RobustComparison::UNDECIDED;
+}
+}
@@ -0,0 +1,232 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file RobustEvaluation.hpp
+ *
+ * Contains the RobustEvaluation class, which evaluates parameter sets on an
+ * ensemble of noisy spike train realizations.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_ROBUST_EVALUATION_HPP_
+#define _ADEXPSIM_ROBUST_EVALUATION_HPP_
+
+#include <algorithm>
+#include <vector>
+
+#include <common/Types.hpp>
+#include <simulation/Parameters.hpp>
+#include <simulation/SpikeTrain.hpp>
+
+#include "EvaluationResult.hpp"
+#include "SpikeTrainEvaluation.hpp"
+
+namespace AdExpSim {
+
+/**
+ * Result of the comparison between a candidate and an incumbent parameter
+ * set performed by RobustEvaluation::compare.
+ */
+enum class RobustComparison : int {
+	/**
+	 * The candidate is significantly worse than the incumbent.
+	 */
+	WORSE = -1,
+
+	/**
+	 * All realizations have been evaluated without the confidence interval
+	 * separating the candidate from the incumbent.
+	 */
+	UNDECIDED = 0,
+
+	/**
+	 * The candidate is significantly better than the incumbent.
+	 */
+	BETTER = 1
+};
+
+/**
+ * Result of the evaluation of a parameter set on (a prefix of) the spike
+ * train realizations.
+ */
+struct RobustEvaluationResult {
+	/**
+	 * Mean of the evaluation results over all evaluated realizations.
+	 */
+	EvaluationResult mean;
+
+	/**
+	 * Value of the optimization dimension for each evaluated realization, in
+	 * the order of the realizations.
+	 */
+	std::vector<Val> samples;
+
+	/**
+	 * Standard error of the mean of the optimization dimension.
+	 */
+	Val stdErr = 0.0;
+
+	/**
+	 * Returns the number of evaluated realizations.
+	 */
+	size_t size() const { return samples.size(); }
+};
+
+/**
+ * The RobustEvaluation class evaluates a parameter set on K realizations of a
+ * noisy spike train and reports the mean result. The realizations are drawn
+ * once with fixed seeds and are shared by all evaluated parameter sets
+ * (common random numbers), so differences between two parameter sets are not
+ * blurred by different noise. The realizations are evaluated in parallel.
+ *
+ * Larger values of the optimization dimension are considered better. The
+ * compare() method evaluates a candidate realization by realization and stops
+ * as soon as a confidence interval on the paired differences to an incumbent
+ * excludes zero.
+ */
+class RobustEvaluation {
+private:
+	/**
+	 * One evaluation instance per spike train realization.
+	 */
+	std::vector<SpikeTrainEvaluation> evaluations;
+
+	/**
+	 * Number of threads used to evaluate the realizations.
+	 */
+	size_t nThreads;
+
+	/**
+	 * Minimum number of realizations evaluated before compare() may stop.
+	 */
+	size_t minSamples;
+
+	/**
+	 * Width of the confidence interval in standard errors.
+	 */
+	Val z;
+
+	/**
+	 * Evaluates the realizations with indices res.size() up to (excluding)
+	 * end and adds them to the given result.
+	 */
+	void extend(const WorkingParameters &params, RobustEvaluationResult &res,
+	            size_t end, Val eTar) const;
+
+public:
+	/**
+	 * Constructor of the RobustEvaluation class.
+	 *
+	 * @param train is the spike train template. Its noise parameters are used
+	 * to draw the realizations.
+	 * @param k is the number of realizations.
+	 * @param seed is the random seed of the first realization, realization i
+	 * uses seed + i.
+	 * @param useIfCondExp selects the IF_COND_EXP model.
+	 */
+	RobustEvaluation(const SpikeTrain &train, size_t k, size_t seed = 0,
+	                 bool useIfCondExp = false);
+
+	/**
+	 * Evaluates the given parameter set on all realizations and returns the
+	 * mean result. Allows RobustEvaluation to be used in place of the other
+	 * evaluation classes.
+	 */
+	EvaluationResult evaluate(const WorkingParameters &params,
+	                          Val eTar = 0.1e-3) const
+	{
+		return evaluateRobust(params, eTar).mean;
+	}
+
+	/**
+	 * Writes the mean result to the given memory location, see evaluate().
+	 */
+	void evaluateInto(const WorkingParameters &params, Val *out,
+	                  Val eTar = 0.1e-3) const
+	{
+		const EvaluationResult mean = evaluate(params, eTar);
+		std::copy(mean.begin(), mean.end(), out);
+	}
+
+	/**
+	 * Evaluates the given parameter set on all realizations.
+	 */
+	RobustEvaluationResult evaluateRobust(const WorkingParameters &params,
+	                                      Val eTar = 0.1e-3) const;
+
+	/**
+	 * Evaluates the remaining realizations of a result returned by compare().
+	 */
+	void complete(const WorkingParameters &params, RobustEvaluationResult &res,
+	              Val eTar = 0.1e-3) const;
+
+	/**
+	 * Compares the given candidate parameter set to an incumbent. The
+	 * realizations are evaluated in batches until the confidence interval of
+	 * the mean paired difference excludes zero or all realizations the
+	 * incumbent was evaluated on are used up.
+	 *
+	 * @param params is the candidate parameter set.
+	 * @param incumbent is the result of the incumbent parameter set, usually
+	 * obtained from evaluateRobust().
+	 * @param res is the result of the candidate on the evaluated
+	 * realizations.
+	 * @param eTar is the target error used in the adaptive stepsize
+	 * controller.
+	 */
+	RobustComparison compare(const WorkingParameters &params,
+	                         const RobustEvaluationResult &incumbent,
+	                         RobustEvaluationResult &res,
+	                         Val eTar = 0.1e-3) const;
+
+	/**
+	 * Sets the number of threads used to evaluate the realizations. Zero
+	 * selects the number of hardware threads.
+	 */
+	void setThreads(size_t n);
+
+	/**
+	 * Sets the minimum number of realizations evaluated by compare().
+	 */
+	void setMinSamples(size_t n) { minSamples = n; }
+
+	/**
+	 * Sets the width of the confidence interval used by compare() in standard
+	 * errors. Defaults to 1.96 (95% for normally distributed differences).
+	 */
+	void setConfidence(Val z) { this->z = z; }
+
+	/**
+	 * Returns the number of realizations.
+	 */
+	size_t size() const { return evaluations.size(); }
+
+	/**
+	 * Returns the evaluation result descriptor, which is the one of the
+	 * SpikeTrainEvaluation class.
+	 */
+	static const EvaluationResultDescriptor &descriptor()
+	{
+		return SpikeTrainEvaluation::descriptor();
+	}
+};
+}
+
+#endif /* _ADEXPSIM_ROBUST_EVALUATION_HPP_ */
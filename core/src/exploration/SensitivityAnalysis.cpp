@@ -0,0 +1,266 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <common/Random.hpp>
+
+#include "SensitivityAnalysis.hpp"
+
+#include "SingleGroupSingleOutEvaluation.hpp"
+#include "SingleGroupMultiOutEvaluation.hpp"
+#include "SpikeTrainEvaluation.hpp"
+
+namespace AdExpSim {
+
+/**
+ * Number of base samples evaluated by a thread at once.
+ */
+static constexpr size_t BATCH_SIZE = 16;
+
+std::vector<size_t> SensitivityResult::insensitive(size_t resultDim,
+                                                   Val threshold) const
+{
+	std::vector<size_t> res;
+	for (size_t i = 0; i < dims.size(); i++) {
+		const SensitivityIndex &idx = (*this)(resultDim, i);
+		if (idx.total + idx.totalConf < threshold) {
+			res.push_back(dims[i]);
+		}
+	}
+	return res;
+}
+
+SensitivityAnalysis::SensitivityAnalysis(const WorkingParameters &params,
+                                         const std::vector<size_t> &dims,
+                                         const std::vector<Range> &ranges,
+                                         size_t samples)
+    : params(params),
+      dims(dims),
+      ranges(ranges),
+      samples(samples),
+      bootstrap(100),
+      z(1.96),
+      seed(DEFAULT_SEED)
+{
+	setThreads(0);
+}
+
+void SensitivityAnalysis::setThreads(size_t n)
+{
+	nThreads = (n == 0)
+	               ? std::max<size_t>(1, std::thread::hardware_concurrency())
+	               : n;
+}
+
+template <typename Evaluation>
+SensitivityResult SensitivityAnalysis::run(
+    const Evaluation &evaluation, const ProgressCallback &progress) const
+{
+	const size_t d = dims.size();
+	const size_t nRes = evaluation.descriptor().size();
+	const size_t nRows = d + 2;
+	std::vector<Val> f(samples * nRows * nRes);
+
+	// The rows of A and B are the first and second half of a 2d-dimensional
+	// Sobol point. Fall back to pseudo-random numbers if there are too many
+	// dimensions.
+	const bool useSobol = 2 * d <= SobolSequence::MAX_DIMS;
+	const SobolSequence sobol(useSobol ? 2 * d : 0, seed);
+
+	std::atomic<size_t> nextBatch(0);
+	std::atomic<size_t> counter(0);
+	std::atomic<bool> abort(false);
+	auto fun = [&]() -> void {
+		const EvaluationResult &def = evaluation.descriptor().defaultResult();
+		std::vector<Val> u(2 * d);
+		size_t j0;
+		while (!abort.load() && (j0 = BATCH_SIZE * nextBatch++) < samples) {
+			for (size_t j = j0; j < std::min(samples, j0 + BATCH_SIZE); j++) {
+				if (useSobol) {
+					sobol.point(j, u.data());
+				} else {
+					RandomStream(seed, j).uniform(u.data(), u.size());
+				}
+				for (size_t r = 0; r < nRows; r++) {
+					WorkingParameters p = params;
+					for (size_t i = 0; i < d; i++) {
+						const bool fromB = (r == 1) || (r == i + 2);
+						const Val x = u[fromB ? d + i : i];
+						p[dims[i]] =
+						    ranges[i].min + (ranges[i].max - ranges[i].min) * x;
+					}
+					Val *res = &f[(j * nRows + r) * nRes];
+					if (p.valid()) {
+						p.update();
+						evaluation.evaluateInto(p, res);
+					} else {
+						std::copy(def.begin(), def.end(), res);
+					}
+				}
+				counter++;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < std::max<size_t>(1, nThreads); i++) {
+		threads.emplace_back(fun);
+	}
+	while (true) {
+		const size_t totalCount = counter.load();
+		if (!progress(samples > 0 ? Val(totalCount) / Val(samples) : 1.0)) {
+			abort.store(true);
+			break;
+		}
+		if (totalCount >= samples) {
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	if (abort.load()) {
+		return SensitivityResult();
+	}
+	return analyse(evaluation.descriptor(), f);
+}
+
+SensitivityResult SensitivityAnalysis::analyse(
+    const EvaluationResultDescriptor &descriptor,
+    const std::vector<Val> &f) const
+{
+	const size_t d = dims.size();
+	const size_t nRes = descriptor.size();
+	const size_t nRows = d + 2;
+	const size_t n = samples;
+
+	SensitivityResult res;
+	res.descriptor = descriptor;
+	res.dims = dims;
+	res.nEvaluations = n * nRows;
+	res.indices.resize(nRes * d);
+	res.variance.resize(nRes);
+	if (n == 0) {
+		return res;
+	}
+
+	// Calculates the first-order (Saltelli 2010) and total (Jansen 1999)
+	// estimators over the given base samples, writes the result for each
+	// result dimension k and parameter i to s1[k * d + i] and st[k * d + i]
+	auto estimate = [&](const std::vector<size_t> &idx, std::vector<double> &s1,
+	                    std::vector<double> &st, std::vector<double> &var) {
+		for (size_t k = 0; k < nRes; k++) {
+			auto value = [&](size_t j, size_t r) -> double {
+				return f[(j * nRows + r) * nRes + k];
+			};
+			// All rows share the same marginal distribution, so the variance
+			// is estimated over all of them
+			double sum = 0.0, sum2 = 0.0;
+			for (size_t j : idx) {
+				for (size_t r = 0; r < nRows; r++) {
+					sum += value(j, r);
+				}
+			}
+			const double mean = sum / (nRows * n);
+			for (size_t j : idx) {
+				for (size_t r = 0; r < nRows; r++) {
+					sum2 += (value(j, r) - mean) * (value(j, r) - mean);
+				}
+			}
+			var[k] = sum2 / (nRows * n);
+			for (size_t i = 0; i < d; i++) {
+				double a = 0.0, b = 0.0;
+				for (size_t j : idx) {
+					const double fA = value(j, 0), fB = value(j, 1),
+					             fAB = value(j, i + 2);
+					a += fB * (fAB - fA);
+					b += (fA - fAB) * (fA - fAB);
+				}
+				const bool ok = var[k] > 0.0;
+				s1[k * d + i] = ok ? a / (n * var[k]) : 0.0;
+				st[k * d + i] = ok ? b / (2 * n * var[k]) : 0.0;
+			}
+		}
+	};
+
+	// Estimate the indices on all samples
+	std::vector<size_t> idx(n);
+	for (size_t j = 0; j < n; j++) {
+		idx[j] = j;
+	}
+	std::vector<double> s1(nRes * d), st(nRes * d), var(nRes);
+	estimate(idx, s1, st, var);
+	for (size_t k = 0; k < nRes; k++) {
+		res.variance[k] = var[k];
+		for (size_t i = 0; i < d; i++) {
+			res.indices[k * d + i] =
+			    SensitivityIndex(s1[k * d + i], 0.0, st[k * d + i], 0.0);
+		}
+	}
+
+	// Bootstrap the confidence intervals by resampling the base samples
+	if (bootstrap < 2) {
+		return res;
+	}
+	std::vector<double> b1(nRes * d), bt(nRes * d), bVar(nRes);
+	std::vector<double> sum1(nRes * d), sumT(nRes * d), sq1(nRes * d),
+	    sqT(nRes * d);
+	for (size_t b = 0; b < bootstrap; b++) {
+		RandomStream random(seed, b + 1);
+		for (size_t j = 0; j < n; j++) {
+			idx[j] = random() % n;
+		}
+		estimate(idx, b1, bt, bVar);
+		for (size_t l = 0; l < nRes * d; l++) {
+			sum1[l] += b1[l];
+			sq1[l] += b1[l] * b1[l];
+			sumT[l] += bt[l];
+			sqT[l] += bt[l] * bt[l];
+		}
+	}
+	auto stdDev = [&](double sum, double sq) -> Val {
+		const double mean = sum / bootstrap;
+		return std::sqrt(
+		    std::max(0.0, (sq - bootstrap * mean * mean) / (bootstrap - 1)));
+	};
+	for (size_t l = 0; l < nRes * d; l++) {
+		res.indices[l].firstConf = z * stdDev(sum1[l], sq1[l]);
+		res.indices[l].totalConf = z * stdDev(sumT[l], sqT[l]);
+	}
+	return res;
+}
+
+/* Specializations of the "run" method. */
+template SensitivityResult SensitivityAnalysis::run<SpikeTrainEvaluation>(
+    const SpikeTrainEvaluation &evaluation,
+    const ProgressCallback &progress) const;
+template SensitivityResult
+SensitivityAnalysis::run<SingleGroupSingleOutEvaluation>(
+    const SingleGroupSingleOutEvaluation &evaluation,
+    const ProgressCallback &progress) const;
+template SensitivityResult
+SensitivityAnalysis::run<SingleGroupMultiOutEvaluation>(
+    const SingleGroupMultiOutEvaluation &evaluation,
+    const ProgressCallback &progress) const;
+}
@@ -0,0 +1,266 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file SensitivityAnalysis.hpp
+ *
+ * Contains the SensitivityAnalysis class, which calculates the global
+ * sensitivity (Sobol indices) of each evaluation result dimension with respect
+ * to a set of working parameters.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SENSITIVITY_ANALYSIS_HPP_
+#define _ADEXPSIM_SENSITIVITY_ANALYSIS_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <common/Types.hpp>
+#include <simulation/Parameters.hpp>
+
+#include "EvaluationResult.hpp"
+
+namespace AdExpSim {
+
+/**
+ * First-order and total Sobol index of a single parameter with respect to a
+ * single evaluation result dimension, together with the half-width of their
+ * bootstrap confidence intervals.
+ */
+struct SensitivityIndex {
+	/**
+	 * Fraction of the variance caused by the parameter alone.
+	 */
+	Val first;
+
+	/**
+	 * Half-width of the confidence interval of the first-order index.
+	 */
+	Val firstConf;
+
+	/**
+	 * Fraction of the variance caused by the parameter including all its
+	 * interactions with other parameters.
+	 */
+	Val total;
+
+	/**
+	 * Half-width of the confidence interval of the total index.
+	 */
+	Val totalConf;
+
+	SensitivityIndex(Val first = 0.0, Val firstConf = 0.0, Val total = 0.0,
+	                 Val totalConf = 0.0)
+	    : first(first), firstConf(firstConf), total(total), totalConf(totalConf)
+	{
+	}
+};
+
+/**
+ * Result of the SensitivityAnalysis::run method.
+ */
+struct SensitivityResult {
+	/**
+	 * Descriptor of the analysed evaluation.
+	 */
+	EvaluationResultDescriptor descriptor;
+
+	/**
+	 * Indices of the analysed working parameters.
+	 */
+	std::vector<size_t> dims;
+
+	/**
+	 * Sensitivity indices, one row of dims.size() entries per result
+	 * dimension.
+	 */
+	std::vector<SensitivityIndex> indices;
+
+	/**
+	 * Total variance of each result dimension.
+	 */
+	std::vector<Val> variance;
+
+	/**
+	 * Number of performed evaluations.
+	 */
+	size_t nEvaluations;
+
+	SensitivityResult() : nEvaluations(0) {}
+
+	/**
+	 * Returns the sensitivity index of the i-th analysed parameter with
+	 * respect to the given result dimension.
+	 */
+	const SensitivityIndex &operator()(size_t resultDim, size_t i) const
+	{
+		return indices[resultDim * dims.size() + i];
+	}
+
+	/**
+	 * Returns the working parameter indices whose total index with respect to
+	 * the given result dimension is below the threshold, including the upper
+	 * bound of the confidence interval. These parameters can be removed from
+	 * the optimization without notably changing the result.
+	 */
+	std::vector<size_t> insensitive(size_t resultDim,
+	                                Val threshold = 0.01) const;
+
+	/**
+	 * Returns true if the analysis has completed.
+	 */
+	bool valid() const { return !indices.empty(); }
+};
+
+/**
+ * The SensitivityAnalysis class estimates the first-order and total Sobol
+ * indices of every evaluation result dimension using the sampling scheme by
+ * Saltelli et al., "Variance based sensitivity analysis of model output",
+ * 2010. Two independent sample matrices A and B are drawn from a Sobol
+ * sequence, for each parameter a third matrix is formed by replacing the
+ * corresponding column of A with the one of B. This requires N (d + 2)
+ * evaluations for N base samples and d parameters, which are evaluated in
+ * parallel batches. Confidence intervals are obtained by bootstrapping the
+ * base samples.
+ */
+class SensitivityAnalysis {
+private:
+	/**
+	 * Base parameter set, all other parameters are kept at their value.
+	 */
+	WorkingParameters params;
+
+	/**
+	 * Indices of the analysed working parameters.
+	 */
+	std::vector<size_t> dims;
+
+	/**
+	 * Range each analysed parameter is sampled from.
+	 */
+	std::vector<Range> ranges;
+
+	/**
+	 * Number of base samples N.
+	 */
+	size_t samples;
+
+	/**
+	 * Number of bootstrap resamples.
+	 */
+	size_t bootstrap;
+
+	/**
+	 * Width of the confidence intervals in standard deviations.
+	 */
+	Val z;
+
+	/**
+	 * Seed used for the sample positions and the bootstrap.
+	 */
+	uint64_t seed;
+
+	/**
+	 * Number of threads used to evaluate the samples.
+	 */
+	size_t nThreads;
+
+	/**
+	 * Calculates the indices from the evaluation results of all samples. The
+	 * results belonging to the base sample j are stored in the rows j (d + 2)
+	 * (sample from A), j (d + 2) + 1 (sample from B) and j (d + 2) + 2 + i
+	 * (sample from AB_i) of f.
+	 */
+	SensitivityResult analyse(const EvaluationResultDescriptor &descriptor,
+	                          const std::vector<Val> &f) const;
+
+public:
+	/**
+	 * Callback function used to allow another function to display some kind of
+	 * progress indicator, see Exploration::ProgressCallback.
+	 */
+	using ProgressCallback = std::function<bool(Val)>;
+
+	/**
+	 * Default seed used for the sample positions and the bootstrap.
+	 */
+	static constexpr uint64_t DEFAULT_SEED = 1241249190;
+
+	/**
+	 * Constructor of the SensitivityAnalysis class.
+	 *
+	 * @param params is the base parameter set.
+	 * @param dims contains the indices of the analysed working parameters.
+	 * @param ranges contains the range each analysed parameter is sampled
+	 * from.
+	 * @param samples is the number of base samples N. Should be a power of
+	 * two.
+	 */
+	SensitivityAnalysis(const WorkingParameters &params,
+	                    const std::vector<size_t> &dims,
+	                    const std::vector<Range> &ranges,
+	                    size_t samples = 1024);
+
+	/**
+	 * Evaluates all samples and calculates the sensitivity indices. Returns
+	 * an invalid result if aborted by the progress callback.
+	 *
+	 * @param evaluation is a reference at a class with an "evaluateInto"
+	 * method that calculates the actual cost function values.
+	 * @param progress specifies the current progress as a value between zero
+	 * and one.
+	 */
+	template <typename Evaluation>
+	SensitivityResult run(
+	    const Evaluation &evaluation,
+	    const ProgressCallback &progress = [](Val) { return true; }) const;
+
+	/**
+	 * Sets the number of bootstrap resamples, zero disables the confidence
+	 * intervals.
+	 */
+	void setBootstrap(size_t n) { bootstrap = n; }
+
+	/**
+	 * Sets the width of the confidence intervals in standard deviations.
+	 * Defaults to 1.96 (95%).
+	 */
+	void setConfidence(Val z) { this->z = z; }
+
+	/**
+	 * Sets the seed used for the sample positions and the bootstrap.
+	 */
+	void setSeed(uint64_t seed) { this->seed = seed; }
+
+	/**
+	 * Sets the number of threads used to evaluate the samples. Zero selects
+	 * one thread per hardware thread.
+	 */
+	void setThreads(size_t n);
+
+	/**
+	 * Returns the total number of evaluations performed by run().
+	 */
+	size_t evaluations() const { return samples * (dims.size() + 2); }
+};
+}
+
+#endif /* _ADEXPSIM_SENSITIVITY_ANALYSIS_HPP_ */
@@ -31,9 +31,10 @@
 #include <mutex>
 #include <atomic>
 #include <thread>
-#include <random>
 #include <limits>
 
+#include <common/Random.hpp>
+
 #include "Simplex.hpp"
 
 namespace AdExpSim {
@@ -63,28 +64,37 @@ private:
 	 */
 	Val costBest;
 
+	/**
+	 * Seed and stream id of the random numbers used to randomize the samples.
+	 */
+	uint64_t seed, stream;
+
+	/**
+	 * Number of threads used by run(), zero selects one thread per hardware
+	 * thread.
+	 */
+	size_t threadCount;
+
 	/**
 	 * Randomizes the dimensions of the given vector "vec" specified in "dims"
-	 * by either multiplying or dividing by a value between 1.0 and 10.0.
+	 * by either multiplying or dividing by a value between 1.0 and 1.1. Each
+	 * sample uses its own section of the random stream, so the result does
+	 * not depend on the thread the sample is processed in.
 	 *
 	 * @param vec is the vector that should be randomized.
-	 * @param dims is an vector containing the dimensions that should be
-	 * affected by the randomization.
+	 * @param sample is the index of the sample.
 	 * @return the randomized vector.
 	 */
-	static Vector randomize(Vector vec, const std::vector<size_t> &dims)
+	Vector randomize(Vector vec, size_t sample) const
 	{
-		static size_t seed = 1241249190;
-		std::default_random_engine generator(seed++);
-		std::uniform_real_distribution<Val> dFactor(1.0, 1.1);
-//		std::uniform_int_distribution<int> dDim(0, dims.size() - 1);
-		std::uniform_int_distribution<int> dChoice(0, 1);
-//		size_t dim = dims[dDim(generator)];
+		RandomStream generator(seed, stream, sample * 2 * dims.size());
 		for (size_t dim: dims) {
-			if (dChoice(generator)) {
-				vec[dim] *= dFactor(generator);
+			const bool multiply = generator() & 1;
+			const Val factor = 1.0 + 0.1 * generator.uniform();
+			if (multiply) {
+				vec[dim] *= factor;
 			} else {
-				vec[dim] /= dFactor(generator);
+				vec[dim] /= factor;
 			}
 		}
 		return vec;
@@ -104,14 +114,15 @@ private:
 	 * produced until now.
 	 * @param it is a counter counting the global number of iterations.
 	 * @param abort is a flag which aborts the entire optimization process.
+	 * @param poll is called after each simplex step.
 	 */
-	template <typename Function>
+	template <typename Function, typename Poll>
 	static void optimizationThread(SimplexPool<Vector> &pool, Function f,
 	                               size_t max_it, float epsilon,
 	                               std::atomic<size_t> &samples,
 	                               std::atomic<size_t> &it,
 	                               std::atomic<bool> &abort,
-	                               std::atomic<size_t> &done)
+	                               std::atomic<size_t> &done, Poll poll)
 	{
 		while (!abort.load()) {
 			// Abort if all samples have been processed
@@ -122,7 +133,8 @@ private:
 
 			// Create a randomized version of the initial vector -- with the
 			// exception of this being the very first sample.
-			const Vector x = (sample == 0) ? pool.xInit : randomize(pool.xInit, pool.dims);
+			const Vector x =
+			    (sample == 0) ? pool.xInit : pool.randomize(pool.xInit, sample);
 			if (Val(f(x)) >= std::numeric_limits<Val>::max()) {
 				continue;
 			}
@@ -150,6 +162,7 @@ private:
 						pool.costBest = res.bestValue;
 					}
 				}
+				poll();
 			} while (!res.done && !abort.load() && localIt < max_it);
 
 			// If the best vector of the simplex is better than the currently
@@ -224,8 +237,33 @@ public:
 	      alpha(alpha),
 	      gamma(gamma),
 	      rho(rho),
-	      sigma(sigma)
+	      sigma(sigma),
+	      seed(1241249190),
+	      stream(0),
+	      threadCount(0)
+	{
+	}
+
+	/**
+	 * Sets the number of threads used by run(). Zero (the default) selects one
+	 * thread per hardware thread, one runs the optimization on the thread
+	 * calling run(), e.g. if run() is already called from one thread per
+	 * core.
+	 */
+	void setThreadCount(size_t threadCount)
 	{
+		this->threadCount = threadCount;
+	}
+
+	/**
+	 * Sets the seed and the stream id of the random numbers used to randomize
+	 * the samples. Two runs with the same seed and stream draw the same
+	 * samples.
+	 */
+	void setSeed(uint64_t seed, uint64_t stream = 0)
+	{
+		this->seed = seed;
+		this->stream = stream;
 	}
 
 	/**
@@ -262,17 +300,34 @@ public:
 		std::atomic<size_t> done(0);
 		std::atomic<bool> abort(false);
 
-		// Execute thread_fun once per processor
 		// Fetch the number of threads to be used
-		size_t nThreads =
-		    std::max<size_t>(1, std::thread::hardware_concurrency());
+		const size_t nThreads =
+		    threadCount > 0
+		        ? threadCount
+		        : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+		// If only a single thread should be used, run the optimization on the
+		// calling thread and call the callback after each step
+		if (nThreads == 1) {
+			auto poll = [&]() {
+				if (!callback(it.load(), std::min(nSamples, samples.load()),
+				              costBest)) {
+					abort.store(true);
+				}
+			};
+			optimizationThread(*this, f, max_it, epsilon, samples, it, abort,
+			                   done, poll);
+			return SimplexPoolResult(xBest, costInit, costBest);
+		}
 
 		// Create a thread for each hardware thread
+		auto poll = []() {};
 		std::vector<std::thread> threads;
 		for (size_t i = 0; i < nThreads; i++) {
-			threads.emplace_back(optimizationThread<Function>, std::ref(*this),
-			                     f, max_it, epsilon, std::ref(samples),
-			                     std::ref(it), std::ref(abort), std::ref(done));
+			threads.emplace_back(
+			    optimizationThread<Function, decltype(poll)>, std::ref(*this),
+			    f, max_it, epsilon, std::ref(samples), std::ref(it),
+			    std::ref(abort), std::ref(done), poll);
 		}
 
 		// Wait for all threads to be finished
@@ -28,6 +28,7 @@
 #ifndef _ADEXPSIM_SINGLE_GROUP_EVALUATION_BASE_HPP_
 #define _ADEXPSIM_SINGLE_GROUP_EVALUATION_BASE_HPP_
 
+#include <common/Hash.hpp>
 #include <simulation/SpikeTrain.hpp>
 
 namespace AdExpSim {
@@ -86,6 +87,28 @@ public:
 	      eTar(eTar)
 	{
 	}
+
+	/**
+	 * Returns a hash over all inputs of the evaluation, i.e. the model, the
+	 * spike train environment, the input spikes and the target error. Two
+	 * evaluations with the same fingerprint produce the same results for the
+	 * same parameters.
+	 */
+	uint64_t fingerprint() const
+	{
+		Hash hash;
+		hash << useIfCondExp << eTar;
+		hash << uint64_t(env.burstSize) << env.T << env.sigmaTOffs << env.sigmaT
+		     << env.deltaT << env.sigmaW;
+		hash << uint64_t(spikeData.n) << uint64_t(spikeData.nM1);
+		for (const SpikeVec *spikes : {&sN, &sNM1}) {
+			hash << uint64_t(spikes->size());
+			for (const Spike &s : *spikes) {
+				hash << s.t << s.w;
+			}
+		}
+		return hash.value();
+	}
 };
 }
 
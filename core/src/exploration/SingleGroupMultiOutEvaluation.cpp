@@ -43,14 +43,15 @@ static Val correct(Val x)
 	return x < 1.0 ? std::pow(x, 5.0f) : x;
 }
 
-EvaluationResult SingleGroupMultiOutEvaluation::evaluate(
-    const WorkingParameters &params) const
+template <typename Statistics>
+void SingleGroupMultiOutEvaluation::evaluateInternal(
+    const WorkingParameters &params, Val *out, Statistics stats) const
 {
 	// Calculate the fractional spike count
 	const Val nOut = spikeData.nOut * env.burstSize;
 	FractionalSpikeCount eval(useIfCondExp, eTar, nOut * 10);
-	auto resN = eval.calculate(sN, params);
-	auto resNM1 = eval.calculate(sNM1, params);
+	auto resN = eval.calculate(sN, params, stats);
+	auto resNM1 = eval.calculate(sNM1, params, stats);
 
 	// Run a short simulation to get the state the neuron is in at time T
 	NullController controller;
@@ -59,7 +60,7 @@ EvaluationResult SingleGroupMultiOutEvaluation::evaluate(
 	Model::simulate<Model::FAST_EXP | Model::DISABLE_SPIKING |
 	                Model::CLAMP_ITH>(useIfCondExp, sN, recorder, controller,
 	                                  integrator, params, Time(-1),
-	                                  env.T);
+	                                  env.T, State(), Time(-1), stats);
 
 	// Calculate the
 	const State sRescale = State(100.0, 0.1, 0.1, 0.1);
@@ -71,8 +72,50 @@ EvaluationResult SingleGroupMultiOutEvaluation::evaluate(
 	const Val pN = dist(correct(resN.fracSpikeCount()), nOut + 0.3, nu);
 	const Val pNM1 = dist(correct(resNM1.fracSpikeCount()), 0.0, nu);
 	const Val pBin = ((resN.spikeCount == nOut) && (resNM1.spikeCount == 0));
-	return EvaluationResult({pN * pNM1 * pReset, pBin, pN, pNM1, pReset,
-	                         resN.fracSpikeCount(), resNM1.fracSpikeCount()});
+	out[0] = pN * pNM1 * pReset;
+	out[1] = pBin;
+	out[2] = pN;
+	out[3] = pNM1;
+	out[4] = pReset;
+	out[5] = resN.fracSpikeCount();
+	out[6] = resNM1.fracSpikeCount();
+}
+
+void SingleGroupMultiOutEvaluation::evaluateInto(
+    const WorkingParameters &params, Val *out) const
+{
+	evaluateInternal(params, out, NullStatistics());
+}
+
+void SingleGroupMultiOutEvaluation::evaluateInto(
+    const WorkingParameters &params, Val *out,
+    SimulationStatistics &stats) const
+{
+	evaluateInternal(params, out, StatisticsCollector(stats));
+}
+
+EvaluationResult SingleGroupMultiOutEvaluation::evaluate(
+    const WorkingParameters &params) const
+{
+	EvaluationResult res(descr.size());
+	evaluateInto(params, res.data());
+	return res;
+}
+
+EvaluationResult SingleGroupMultiOutEvaluation::evaluate(
+    const WorkingParameters &params, SimulationStatistics &stats) const
+{
+	EvaluationResult res(descr.size());
+	evaluateInto(params, res.data(), stats);
+	return res;
+}
+
+uint64_t SingleGroupMultiOutEvaluation::fingerprint() const
+{
+	Hash hash;
+	hash << SingleGroupEvaluationBase::fingerprint();
+	hash << uint64_t(spikeData.nOut);
+	return hash.value();
 }
 
 const EvaluationResultDescriptor SingleGroupMultiOutEvaluation::descr =
@@ -29,6 +29,7 @@
 #define _ADEXPSIM_SINGLE_GROUP_MULTI_OUT_EVALUATION_HPP_
 
 #include <simulation/Parameters.hpp>
+#include <simulation/Statistics.hpp>
 
 #include "EvaluationResult.hpp"
 #include "SingleGroupEvaluationBase.hpp"
@@ -43,6 +44,14 @@ class SingleGroupMultiOutEvaluation
 private:
 	static const EvaluationResultDescriptor descr;
 
+	/**
+	 * Actual implementation of the evaluate method, passes the given
+	 * statistics handle to all simulations.
+	 */
+	template <typename Statistics>
+	void evaluateInternal(const WorkingParameters &params, Val *out,
+	                      Statistics stats) const;
+
 public:
 	using SingleGroupEvaluationBase<
 	    SingleGroupMultiOutDescriptor>::SingleGroupEvaluationBase;
@@ -56,6 +65,41 @@ public:
 	 */
 	EvaluationResult evaluate(const WorkingParameters &params) const;
 
+	/**
+	 * Evaluates the given parameter set and adds the instrumentation counters
+	 * of all simulations to the given statistics instance.
+	 *
+	 * @param params is a reference at the parameter set that should be
+	 * evaluated. Automatically updates the derived values of the parameter set.
+	 * @param stats is the statistics instance the counters are added to.
+	 */
+	EvaluationResult evaluate(const WorkingParameters &params,
+	                          SimulationStatistics &stats) const;
+
+	/**
+	 * Evaluates the given parameter set and writes the descriptor().size()
+	 * result values to the given memory location. In contrast to evaluate()
+	 * this method does not create an EvaluationResult instance.
+	 *
+	 * @param params is a reference at the parameter set that should be
+	 * evaluated. Automatically updates the derived values of the parameter set.
+	 * @param out points at the memory the result values are written to.
+	 */
+	void evaluateInto(const WorkingParameters &params, Val *out) const;
+
+	/**
+	 * Same as above, but additionally adds the instrumentation counters of all
+	 * simulations to the given statistics instance.
+	 */
+	void evaluateInto(const WorkingParameters &params, Val *out,
+	                  SimulationStatistics &stats) const;
+
+	/**
+	 * Returns a hash over all inputs of the evaluation, additionally includes
+	 * the expected number of output spikes.
+	 */
+	uint64_t fingerprint() const;
+
 	/**
 	 * Returns the evaluation result descriptor for the SingleGroupEvaluation
 	 * class.
@@ -58,8 +58,9 @@ static constexpr Val TAU_RANGE = 0.002;    // 2mV
 static constexpr Val TAU_RANGE_VAL = 0.2;  // sigma(eEff - TAU_RANGE)
 static const LongTailSigmoid<true> sigmaV(TAU_RANGE, TAU_RANGE_VAL);
 
-EvaluationResult SingleGroupSingleOutEvaluation::evaluate(
-    const WorkingParameters &params) const
+template <typename Statistics>
+void SingleGroupSingleOutEvaluation::evaluateInternal(
+    const WorkingParameters &params, Val *out, Statistics stats) const
 {
 	// Do not record any result
 	NullRecorder n;
@@ -73,22 +74,24 @@ EvaluationResult SingleGroupSingleOutEvaluation::evaluate(
 	// Simulate for both the sXi and the sXiM1 input spike train
 	if (useIfCondExp) {
 		Model::simulate<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
-		    sN, n, cN, iN, params, Time(-1), env.T);
+		    sN, n, cN, iN, params, Time(-1), env.T, State(), Time(-1), stats);
 		Model::simulate<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
-		    sNM1, n, cNM1, iNM1, params, Time(-1), env.T);
+		    sNM1, n, cNM1, iNM1, params, Time(-1), env.T, State(), Time(-1),
+		    stats);
 		Model::simulate<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
 		    sN, n, cNS, iNS, params, Time(-1), env.T,
-		    State(params.eReset()), Time(0));
+		    State(params.eReset()), Time(0), stats);
 	} else {
 		Model::simulate<Model::CLAMP_ITH | Model::DISABLE_SPIKING |
 		                Model::FAST_EXP>(sN, n, cN, iN, params, Time(-1),
-		                                 env.T);
+		                                 env.T, State(), Time(-1), stats);
 		Model::simulate<Model::CLAMP_ITH | Model::DISABLE_SPIKING |
 		                Model::FAST_EXP>(sNM1, n, cNM1, iNM1, params, Time(-1),
-		                                 env.T);
+		                                 env.T, State(), Time(-1), stats);
 		Model::simulate<Model::CLAMP_ITH | Model::DISABLE_SPIKING |
 		                Model::FAST_EXP>(sN, n, cNS, iNS, params, Time(-1),
-		                                 env.T, State(params.eReset()));
+		                                 env.T, State(params.eReset()),
+		                                 Time(-1), stats);
 	}
 
 	const Val th = params.eSpikeEff(useIfCondExp);
@@ -103,7 +106,40 @@ EvaluationResult SingleGroupSingleOutEvaluation::evaluate(
 	const Val eDiffS = ((sInit - cNS.state) * sRescale).sqrL2Norm();
 	const Val pReset = exp(-((eDiff + eDiffM1 + eDiffS) * 0.333333f));
 	const Val pSoft = pTrueNegative * pTruePositive * pReset;
-	return EvaluationResult({pSoft, pOk, pTruePositive, pTrueNegative, pReset});
+	out[0] = pSoft;
+	out[1] = pOk;
+	out[2] = pTruePositive;
+	out[3] = pTrueNegative;
+	out[4] = pReset;
+}
+
+void SingleGroupSingleOutEvaluation::evaluateInto(
+    const WorkingParameters &params, Val *out) const
+{
+	evaluateInternal(params, out, NullStatistics());
+}
+
+void SingleGroupSingleOutEvaluation::evaluateInto(
+    const WorkingParameters &params, Val *out,
+    SimulationStatistics &stats) const
+{
+	evaluateInternal(params, out, StatisticsCollector(stats));
+}
+
+EvaluationResult SingleGroupSingleOutEvaluation::evaluate(
+    const WorkingParameters &params) const
+{
+	EvaluationResult res(descr.size());
+	evaluateInto(params, res.data());
+	return res;
+}
+
+EvaluationResult SingleGroupSingleOutEvaluation::evaluate(
+    const WorkingParameters &params, SimulationStatistics &stats) const
+{
+	EvaluationResult res(descr.size());
+	evaluateInto(params, res.data(), stats);
+	return res;
 }
 
 const EvaluationResultDescriptor SingleGroupSingleOutEvaluation::descr =
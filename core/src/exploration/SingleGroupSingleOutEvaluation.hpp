@@ -31,6 +31,7 @@
 
 #include <simulation/Parameters.hpp>
 #include <simulation/SpikeTrain.hpp>
+#include <simulation/Statistics.hpp>
 #include <common/Types.hpp>
 
 #include "EvaluationResult.hpp"
@@ -46,6 +47,14 @@ class SingleGroupSingleOutEvaluation
 private:
 	static const EvaluationResultDescriptor descr;
 
+	/**
+	 * Actual implementation of the evaluate method, passes the given
+	 * statistics handle to all simulations.
+	 */
+	template <typename Statistics>
+	void evaluateInternal(const WorkingParameters &params, Val *out,
+	                      Statistics stats) const;
+
 public:
 	using SingleGroupEvaluationBase<
 	    SingleGroupSingleOutDescriptor>::SingleGroupEvaluationBase;
@@ -58,6 +67,35 @@ public:
 	 */
 	EvaluationResult evaluate(const WorkingParameters &params) const;
 
+	/**
+	 * Evaluates the given parameter set and adds the instrumentation counters
+	 * of all simulations to the given statistics instance.
+	 *
+	 * @param params is a reference at the parameter set that should be
+	 * evaluated. Automatically updates the derived values of the parameter set.
+	 * @param stats is the statistics instance the counters are added to.
+	 */
+	EvaluationResult evaluate(const WorkingParameters &params,
+	                          SimulationStatistics &stats) const;
+
+	/**
+	 * Evaluates the given parameter set and writes the descriptor().size()
+	 * result values to the given memory location. In contrast to evaluate()
+	 * this method does not create an EvaluationResult instance.
+	 *
+	 * @param params is a reference at the parameter set that should be
+	 * evaluated. Automatically updates the derived values of the parameter set.
+	 * @param out points at the memory the result values are written to.
+	 */
+	void evaluateInto(const WorkingParameters &params, Val *out) const;
+
+	/**
+	 * Same as above, but additionally adds the instrumentation counters of all
+	 * simulations to the given statistics instance.
+	 */
+	void evaluateInto(const WorkingParameters &params, Val *out,
+	                  SimulationStatistics &stats) const;
+
 	/**
 	 * Returns the evaluation result descriptor for the SingleGroupEvaluation
 	 * class.
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 
+#include <common/Hash.hpp>
 #include <simulation/DormandPrinceIntegrator.hpp>
 #include <simulation/Model.hpp>
 
@@ -145,10 +146,11 @@ Val SpikeTrainEvaluation::sigma(Val x, const WorkingParameters &params,
 	return invert ? 1.0 - res : res;
 }
 
+template <typename Statistics>
 SpikeTrainEvaluation::MaxPotentialResult
 SpikeTrainEvaluation::trackMaxPotential(const WorkingParameters &params,
                                         const RecordedSpike &s0, Time tEnd,
-                                        Val eTar) const
+                                        Val eTar, Statistics stats) const
 {
 	// Fetch the time range
 	const Time tStart = s0.t;
@@ -176,12 +178,13 @@ SpikeTrainEvaluation::trackMaxPotential(const WorkingParameters &params,
 	if (useIfCondExp) {
 		Model::simulate<Model::IF_COND_EXP | Model::DISABLE_SPIKING>(
 		    inputSpikes, recorder, controller, integrator, params, Time(-1),
-		    tLen, s0.state);
+		    tLen, s0.state, Time(-1), stats);
 	} else {
 		Model::simulate<Model::FAST_EXP | Model::CLAMP_ITH |
 		                Model::DISABLE_SPIKING>(inputSpikes, recorder,
 		                                        controller, integrator, params,
-		                                        Time(-1), tLen, s0.state);
+		                                        Time(-1), tLen, s0.state,
+		                                        Time(-1), stats);
 	}
 
 	// Return the tracked maximum membrane potential
@@ -189,14 +192,18 @@ SpikeTrainEvaluation::trackMaxPotential(const WorkingParameters &params,
 	    controller.vMax, std::min(controller.tVMax, controller.tSpike), tLen);
 }
 
-template <typename F1, typename F2>
-EvaluationResult SpikeTrainEvaluation::evaluateInternal(
-    const WorkingParameters &params, Val eTar, F1 recordOutputSpike,
-    F2 recordOutputGroup) const
+template <typename F1, typename F2, typename Statistics>
+void SpikeTrainEvaluation::evaluateInternal(const WorkingParameters &params,
+                                            Val eTar, Val *out,
+                                            F1 recordOutputSpike,
+                                            F2 recordOutputGroup,
+                                            Statistics stats) const
 {
 	// Return an empty result if the input spike train contains no spikes
 	if (train.getRanges().empty()) {
-		return descr.defaultResult();
+		std::copy(descr.defaultResult().begin(), descr.defaultResult().end(),
+		          out);
+		return;
 	}
 
 	// Run the simulation on the spike train with the given parameters and
@@ -210,16 +217,20 @@ EvaluationResult SpikeTrainEvaluation::evaluateInternal(
 	if (useIfCondExp) {
 		Model::simulate<Model::IF_COND_EXP>(train.getSpikes(), recorder,
 		                                    controller, integrator, params,
-		                                    Time(-1), T);
+		                                    Time(-1), T, State(), Time(-1),
+		                                    stats);
 	} else {
 		Model::simulate<Model::FAST_EXP>(train.getSpikes(), recorder,
 		                                 controller, integrator, params,
-		                                 Time(-1), T);
+		                                 Time(-1), T, State(), Time(-1),
+		                                 stats);
 	}
 
 	// Abort if the maximum spike count controller has tripped.
 	if (controller.tripped()) {
-		return descr.defaultResult();
+		std::copy(descr.defaultResult().begin(), descr.defaultResult().end(),
+		          out);
+		return;
 	}
 
 	// Iterate over all ranges described in the spike train and adapt the result
@@ -310,7 +321,7 @@ EvaluationResult SpikeTrainEvaluation::evaluateInternal(
 			// Track the maximum potential between the current spike and the
 			// next output spike
 			const auto simRes =
-			    trackMaxPotential(params, *curSpike, it->t, eTar);
+			    trackMaxPotential(params, *curSpike, it->t, eTar, stats);
 
 			// Adapt the softExpectationRatio
 			pSoft += sigma(simRes.vMax, params) * simRes.tLen.sec() /* *
@@ -326,7 +337,7 @@ EvaluationResult SpikeTrainEvaluation::evaluateInternal(
 		// spikes were expected, the sigma function has to be inverted (because
 		// lower potentials are better).
 		const auto simRes =
-		    trackMaxPotential(params, *curSpike, rangeEnd, eTar);
+		    trackMaxPotential(params, *curSpike, rangeEnd, eTar, stats);
 		pSoft += sigma(simRes.vMax, params, nSpikesExpected == 0) *
 		         simRes.tLen.sec();
 	}
@@ -345,17 +356,46 @@ EvaluationResult SpikeTrainEvaluation::evaluateInternal(
 	    Val(nGroups);
 	pSoft = pSoft / T.sec();
 
-	return EvaluationResult(
-	    {pSoft, pBinary, 1.0f - pFalsePositive, 1.0f - pFalseNegative});
+	out[0] = pSoft;
+	out[1] = pBinary;
+	out[2] = 1.0f - pFalsePositive;
+	out[3] = 1.0f - pFalseNegative;
 }
 
-EvaluationResult SpikeTrainEvaluation::evaluate(const WorkingParameters &params,
-                                                Val eTar) const
+void SpikeTrainEvaluation::evaluateInto(const WorkingParameters &params,
+                                        Val *out, Val eTar) const
 {
 	// Call the evaluateInternal template with two empty functions, thus
 	// removing all of the recording code.
-	return evaluateInternal(params, eTar, [](const OutputSpike &) -> void {},
-	                        [](const OutputGroup &) -> void {});
+	evaluateInternal(params, eTar, out, [](const OutputSpike &) -> void {},
+	                 [](const OutputGroup &) -> void {}, NullStatistics());
+}
+
+void SpikeTrainEvaluation::evaluateInto(const WorkingParameters &params,
+                                        Val *out, SimulationStatistics &stats,
+                                        Val eTar) const
+{
+	// Same as above, but collect the instrumentation counters
+	evaluateInternal(params, eTar, out, [](const OutputSpike &) -> void {},
+	                 [](const OutputGroup &) -> void {},
+	                 StatisticsCollector(stats));
+}
+
+EvaluationResult SpikeTrainEvaluation::evaluate(const WorkingParameters &params,
+                                                Val eTar) const
+{
+	EvaluationResult res(descr.size());
+	evaluateInto(params, res.data(), eTar);
+	return res;
+}
+
+EvaluationResult SpikeTrainEvaluation::evaluate(const WorkingParameters &params,
+                                                SimulationStatistics &stats,
+                                                Val eTar) const
+{
+	EvaluationResult res(descr.size());
+	evaluateInto(params, res.data(), stats, eTar);
+	return res;
 }
 
 EvaluationResult SpikeTrainEvaluation::evaluate(
@@ -364,11 +404,33 @@ EvaluationResult SpikeTrainEvaluation::evaluate(
 {
 	// Call the evaluateInternal template with record callbacks storing the
 	// to be recorded objects in the given lists.
-	return evaluateInternal(params, eTar,
-	                        [&outputSpikes](const OutputSpike &spike)
-	                            -> void { outputSpikes.emplace_back(spike); },
-	                        [&outputGroups](const OutputGroup &group)
-	                            -> void { outputGroups.emplace_back(group); });
+	EvaluationResult res(descr.size());
+	evaluateInternal(params, eTar, res.data(),
+	                 [&outputSpikes](const OutputSpike &spike)
+	                     -> void { outputSpikes.emplace_back(spike); },
+	                 [&outputGroups](const OutputGroup &group)
+	                     -> void { outputGroups.emplace_back(group); },
+	                 NullStatistics());
+	return res;
+}
+
+uint64_t SpikeTrainEvaluation::fingerprint(Val eTar) const
+{
+	Hash hash;
+	hash << useIfCondExp << eTar;
+	hash << uint64_t(train.getSpikes().size());
+	for (const Spike &s : train.getSpikes()) {
+		hash << s.t << s.w;
+	}
+	hash << uint64_t(train.getRanges().size());
+	for (const SpikeTrain::Range &r : train.getRanges()) {
+		hash << r.start << uint64_t(r.group) << uint64_t(r.descrIdx)
+		     << uint64_t(r.nOut);
+	}
+	for (size_t idx : train.getRangeStartSpikes()) {
+		hash << uint64_t(idx);
+	}
+	return hash.value();
 }
 
 const EvaluationResultDescriptor SpikeTrainEvaluation::descr =
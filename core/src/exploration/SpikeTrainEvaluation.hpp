@@ -30,6 +30,7 @@
 
 #include <simulation/Parameters.hpp>
 #include <simulation/SpikeTrain.hpp>
+#include <simulation/Statistics.hpp>
 #include <common/Types.hpp>
 
 #include "EvaluationResult.hpp"
@@ -84,14 +85,15 @@ private:
 	 * Measures the theoretically reached, maximum mebrance potential for the
 	 * given range. This measurement deactivates the spiking mechanism.
 	 */
+	template <typename Statistics>
 	MaxPotentialResult trackMaxPotential(const WorkingParameters &params,
 	                                     const RecordedSpike &s0, Time tEnd,
-	                                     Val eTar) const;
+	                                     Val eTar, Statistics stats) const;
 
-	template <typename F1, typename F2>
-	EvaluationResult evaluateInternal(const WorkingParameters &params, Val eTar,
-	                                  F1 recordOutputSpike,
-	                                  F2 recordOutputGroup) const;
+	template <typename F1, typename F2, typename Statistics>
+	void evaluateInternal(const WorkingParameters &params, Val eTar, Val *out,
+	                      F1 recordOutputSpike, F2 recordOutputGroup,
+	                      Statistics stats) const;
 
 public:
 	/**
@@ -215,6 +217,49 @@ public:
 	                          std::vector<OutputGroup> &outputGroups,
 	                          Val eTar = 0.1e-3) const;
 
+	/**
+	 * Evaluates the given parameter set and adds the instrumentation counters
+	 * of all simulations to the given statistics instance.
+	 *
+	 * @param params is a reference at the parameter set that should be
+	 * evaluated. Automatically updates the derived values of the parameter set.
+	 * @param stats is the statistics instance the counters are added to.
+	 * @param eTar is the target error used in the adaptive stepsize controller.
+	 */
+	EvaluationResult evaluate(const WorkingParameters &params,
+	                          SimulationStatistics &stats,
+	                          Val eTar = 0.1e-3) const;
+
+	/**
+	 * Evaluates the given parameter set and writes the descriptor().size()
+	 * result values to the given memory location. In contrast to evaluate()
+	 * this method does not create an EvaluationResult instance.
+	 *
+	 * @param params is a reference at the parameter set that should be
+	 * evaluated. Automatically updates the derived values of the parameter set.
+	 * @param out points at the memory the result values are written to.
+	 * @param eTar is the target error used in the adaptive stepsize controller.
+	 */
+	void evaluateInto(const WorkingParameters &params, Val *out,
+	                  Val eTar = 0.1e-3) const;
+
+	/**
+	 * Same as above, but additionally adds the instrumentation counters of all
+	 * simulations to the given statistics instance.
+	 */
+	void evaluateInto(const WorkingParameters &params, Val *out,
+	                  SimulationStatistics &stats, Val eTar = 0.1e-3) const;
+
+	/**
+	 * Returns a hash over all inputs of the evaluation, i.e. the model, the
+	 * spike train and the given target error. Two evaluations with the same
+	 * fingerprint produce the same results for the same parameters.
+	 *
+	 * @param eTar is the target error the evaluation is going to be called
+	 * with.
+	 */
+	uint64_t fingerprint(Val eTar = 0.1e-3) const;
+
 	/**
 	 * Returns a reference at the internally used spike train instance.
 	 */
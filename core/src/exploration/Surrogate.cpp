@@ -0,0 +1,206 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "Surrogate.hpp"
+
+namespace AdExpSim {
+
+// Lower bound for the signal variance of the local model
+static constexpr double MIN_VARIANCE = 1e-6;
+
+Surrogate::Surrogate(const WorkingParameters &reference,
+                     const std::vector<size_t> &dims, size_t capacity,
+                     size_t neighbours, Val lengthScale, Val noise)
+    : reference(reference),
+      dims(dims),
+      capacity(std::max<size_t>(1, capacity)),
+      neighbours(std::max<size_t>(1, std::min(neighbours, capacity))),
+      lengthScale(lengthScale),
+      noise(noise),
+      next(0)
+{
+}
+
+void Surrogate::normalize(const WorkingParameters &p, Val *x) const
+{
+	for (size_t i = 0; i < dims.size(); i++) {
+		const Val ref = reference[dims[i]];
+		const Val scale = (ref == 0.0) ? 1.0 : std::fabs(ref);
+		x[i] = (p[dims[i]] - ref) / scale;
+	}
+}
+
+Surrogate::Prediction Surrogate::predict(const WorkingParameters &p) const
+{
+	const size_t d = dims.size();
+	std::vector<Val> q(d);
+	normalize(p, q.data());
+
+	// Copy the nearest samples, only this step requires the lock
+	const size_t k = neighbours;
+	std::vector<Val> nx(k * d), ny(k);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const size_t n = ys.size();
+		if (n < k) {
+			return Prediction();
+		}
+		std::vector<Val> dists(n);
+		for (size_t i = 0; i < n; i++) {
+			Val dist = 0.0;
+			for (size_t j = 0; j < d; j++) {
+				const Val delta = xs[i * d + j] - q[j];
+				dist += delta * delta;
+			}
+			dists[i] = dist;
+		}
+		std::vector<size_t> idx(n);
+		std::iota(idx.begin(), idx.end(), 0);
+		std::nth_element(idx.begin(), idx.begin() + (k - 1), idx.end(),
+		                 [&dists](size_t a, size_t b) {
+			                 return dists[a] < dists[b];
+			             });
+		for (size_t i = 0; i < k; i++) {
+			std::copy(xs.begin() + idx[i] * d, xs.begin() + (idx[i] + 1) * d,
+			          nx.begin() + i * d);
+			ny[i] = ys[idx[i]];
+		}
+	}
+
+	// Use the mean and variance of the neighbours as prior
+	double mu = 0.0, s2 = 0.0;
+	for (size_t i = 0; i < k; i++) {
+		mu += ny[i];
+	}
+	mu /= k;
+	for (size_t i = 0; i < k; i++) {
+		s2 += (ny[i] - mu) * (ny[i] - mu);
+	}
+	s2 = std::max(MIN_VARIANCE, s2 / k);
+
+	// Squared exponential kernel
+	const double f = -0.5 / (double(lengthScale) * double(lengthScale));
+	auto kernel = [&](const Val *a, const Val *b) -> double {
+		double dist = 0.0;
+		for (size_t j = 0; j < d; j++) {
+			dist += (a[j] - b[j]) * (a[j] - b[j]);
+		}
+		return s2 * std::exp(f * dist);
+	};
+
+	// Build the kernel matrix and calculate its Cholesky decomposition
+	std::vector<double> L(k * k, 0.0);
+	for (size_t i = 0; i < k; i++) {
+		for (size_t j = 0; j <= i; j++) {
+			L[i * k + j] = kernel(&nx[i * d], &nx[j * d]);
+		}
+		L[i * k + i] += noise;
+	}
+	for (size_t j = 0; j < k; j++) {
+		double sum = L[j * k + j];
+		for (size_t l = 0; l < j; l++) {
+			sum -= L[j * k + l] * L[j * k + l];
+		}
+		if (sum <= 0.0) {
+			return Prediction();
+		}
+		L[j * k + j] = std::sqrt(sum);
+		for (size_t i = j + 1; i < k; i++) {
+			double s = L[i * k + j];
+			for (size_t l = 0; l < j; l++) {
+				s -= L[i * k + l] * L[j * k + l];
+			}
+			L[i * k + j] = s / L[j * k + j];
+		}
+	}
+
+	// Solve L * v = kq and L * a = y - mu by forward substitution, the
+	// posterior mean is mu + v * a, the posterior variance is s2 - v * v
+	std::vector<double> v(k), a(k);
+	for (size_t i = 0; i < k; i++) {
+		double sv = kernel(&nx[i * d], q.data());
+		double sa = ny[i] - mu;
+		for (size_t l = 0; l < i; l++) {
+			sv -= L[i * k + l] * v[l];
+			sa -= L[i * k + l] * a[l];
+		}
+		v[i] = sv / L[i * k + i];
+		a[i] = sa / L[i * k + i];
+	}
+	double mean = mu, var = s2;
+	for (size_t i = 0; i < k; i++) {
+		mean += v[i] * a[i];
+		var -= v[i] * v[i];
+	}
+	return Prediction(mean, std::sqrt(std::max(0.0, var)));
+}
+
+void Surrogate::add(const WorkingParameters &p, Val cost, double time)
+{
+	const size_t d = dims.size();
+	std::vector<Val> x(d);
+	normalize(p, x.data());
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (ys.size() < capacity) {
+		xs.insert(xs.end(), x.begin(), x.end());
+		ys.push_back(cost);
+	} else {
+		std::copy(x.begin(), x.end(), xs.begin() + next * d);
+		ys[next] = cost;
+		next = (next + 1) % capacity;
+	}
+	stats.evaluations++;
+	stats.evaluationTime += time;
+}
+
+void Surrogate::query(double time, bool hit)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	stats.queries++;
+	stats.queryTime += time;
+	if (hit) {
+		stats.predictions++;
+	}
+}
+
+bool Surrogate::profitable(double maxCostRatio) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (stats.queries == 0 || stats.evaluations == 0) {
+		return true;
+	}
+	return stats.meanQueryTime() < maxCostRatio * stats.meanEvaluationTime();
+}
+
+size_t Surrogate::size() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return ys.size();
+}
+
+SurrogateStatistics Surrogate::statistics() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+}
@@ -0,0 +1,282 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Surrogate.hpp
+ *
+ * Contains a cheap surrogate model of the cost function, which is used by the
+ * Optimization class to skip the evaluation of parameter sets that are very
+ * likely not promising.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SURROGATE_HPP_
+#define _ADEXPSIM_SURROGATE_HPP_
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <common/Types.hpp>
+#include <simulation/Parameters.hpp>
+
+namespace AdExpSim {
+
+/**
+ * Counters describing how often the surrogate model was used instead of the
+ * actual evaluation.
+ */
+struct SurrogateStatistics {
+	/**
+	 * Number of cost function calls answered by the surrogate model.
+	 */
+	uint64_t predictions;
+
+	/**
+	 * Number of cost function calls which ran the actual evaluation.
+	 */
+	uint64_t evaluations;
+
+	/**
+	 * Number of queries of the surrogate model, including those for which the
+	 * actual evaluation was run afterwards.
+	 */
+	uint64_t queries;
+
+	/**
+	 * Total wall time spent in the actual evaluations in seconds.
+	 */
+	double evaluationTime;
+
+	/**
+	 * Total wall time spent querying the surrogate model in seconds.
+	 */
+	double queryTime;
+
+	/**
+	 * Default constructor, resets all counters to zero.
+	 */
+	SurrogateStatistics()
+	    : predictions(0),
+	      evaluations(0),
+	      queries(0),
+	      evaluationTime(0),
+	      queryTime(0)
+	{
+	}
+
+	/**
+	 * Returns the mean wall time of an actual evaluation in seconds.
+	 */
+	double meanEvaluationTime() const
+	{
+		return evaluations == 0 ? 0.0 : evaluationTime / double(evaluations);
+	}
+
+	/**
+	 * Returns the mean wall time of a surrogate model query in seconds.
+	 */
+	double meanQueryTime() const
+	{
+		return queries == 0 ? 0.0 : queryTime / double(queries);
+	}
+
+	/**
+	 * Returns the fraction of cost function calls answered by the surrogate
+	 * model.
+	 */
+	double hitRate() const
+	{
+		const uint64_t n = predictions + evaluations;
+		return n == 0 ? 0.0 : double(predictions) / double(n);
+	}
+
+	/**
+	 * Returns an estimate of the wall time saved by the surrogate model in
+	 * seconds, based on the mean time of an actual evaluation. The time spent
+	 * querying the model is subtracted, so the result may be negative.
+	 */
+	double savedTime() const
+	{
+		return double(predictions) * meanEvaluationTime() - queryTime;
+	}
+};
+
+/**
+ * The Surrogate class is a local Gaussian process model of the cost function.
+ * It is trained online from completed evaluations. A prediction only uses the
+ * samples nearest to the query point, so the cost of a prediction is bounded
+ * independent of the number of stored samples. All parameter dimensions are
+ * normalized relative to a reference parameter set. This class is
+ * thread-safe.
+ */
+class Surrogate {
+public:
+	/**
+	 * Result of a prediction.
+	 */
+	struct Prediction {
+		/**
+		 * Predicted cost.
+		 */
+		Val mean;
+
+		/**
+		 * Standard deviation of the prediction.
+		 */
+		Val sigma;
+
+		/**
+		 * False if not enough samples were available for the prediction.
+		 */
+		bool valid;
+
+		Prediction() : mean(0.0), sigma(0.0), valid(false) {}
+
+		Prediction(Val mean, Val sigma) : mean(mean), sigma(sigma), valid(true)
+		{
+		}
+	};
+
+private:
+	/**
+	 * Mutex protecting all members below.
+	 */
+	mutable std::mutex mutex;
+
+	/**
+	 * Reference parameter set, used for normalization.
+	 */
+	WorkingParameters reference;
+
+	/**
+	 * Dimensions used as input of the model.
+	 */
+	std::vector<size_t> dims;
+
+	/**
+	 * Maximum number of stored samples, older samples are overwritten.
+	 */
+	size_t capacity;
+
+	/**
+	 * Number of nearest samples used for a prediction.
+	 */
+	size_t neighbours;
+
+	/**
+	 * Length scale of the squared exponential kernel in normalized units.
+	 */
+	Val lengthScale;
+
+	/**
+	 * Variance of the observation noise.
+	 */
+	Val noise;
+
+	/**
+	 * Normalized sample coordinates, stored sample by sample.
+	 */
+	std::vector<Val> xs;
+
+	/**
+	 * Cost of each sample.
+	 */
+	std::vector<Val> ys;
+
+	/**
+	 * Index of the next sample that is overwritten once the capacity is
+	 * reached.
+	 */
+	size_t next;
+
+	/**
+	 * Usage counters.
+	 */
+	SurrogateStatistics stats;
+
+	/**
+	 * Writes the normalized coordinates of p to x.
+	 */
+	void normalize(const WorkingParameters &p, Val *x) const;
+
+public:
+	/**
+	 * Constructor of the Surrogate class.
+	 *
+	 * @param reference is the parameter set relative to which all dimensions
+	 * are normalized.
+	 * @param dims are the parameter dimensions used as input of the model.
+	 * @param capacity is the maximum number of stored samples.
+	 * @param neighbours is the number of nearest samples used for a
+	 * prediction.
+	 * @param lengthScale is the length scale of the kernel, relative to the
+	 * reference parameters.
+	 * @param noise is the variance of the observation noise.
+	 */
+	Surrogate(const WorkingParameters &reference,
+	          const std::vector<size_t> &dims, size_t capacity = 2048,
+	          size_t neighbours = 16, Val lengthScale = 0.1,
+	          Val noise = 1e-4);
+
+	/**
+	 * Predicts the cost of the given parameter set.
+	 */
+	Prediction predict(const WorkingParameters &p) const;
+
+	/**
+	 * Adds the result of an actual evaluation to the model.
+	 *
+	 * @param p is the evaluated parameter set.
+	 * @param cost is the result of the evaluation.
+	 * @param time is the wall time needed for the evaluation in seconds.
+	 */
+	void add(const WorkingParameters &p, Val cost, double time);
+
+	/**
+	 * Records a query of the model.
+	 *
+	 * @param time is the wall time needed for the query in seconds.
+	 * @param hit is true if the query result was used instead of the actual
+	 * evaluation.
+	 */
+	void query(double time, bool hit);
+
+	/**
+	 * Returns true if querying the model is considerably cheaper than the
+	 * actual evaluation, or if this is not known yet.
+	 *
+	 * @param maxCostRatio is the maximum ratio between the mean query time and
+	 * the mean evaluation time.
+	 */
+	bool profitable(double maxCostRatio) const;
+
+	/**
+	 * Returns the number of stored samples.
+	 */
+	size_t size() const;
+
+	/**
+	 * Returns a copy of the usage counters.
+	 */
+	SurrogateStatistics statistics() const;
+};
+}
+
+#endif /* _ADEXPSIM_SURROGATE_HPP_ */
@@ -0,0 +1,252 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#include <common/Random.hpp>
+
+#include "Sweep.hpp"
+
+#include "SingleGroupSingleOutEvaluation.hpp"
+#include "SingleGroupMultiOutEvaluation.hpp"
+#include "SpikeTrainEvaluation.hpp"
+
+namespace AdExpSim {
+
+void Sweep::sample()
+{
+	const size_t d = mDims.size();
+	const size_t n = mSamples;
+	if (mSampling == SweepSampling::SOBOL && d <= SobolSequence::MAX_DIMS) {
+		SobolSequence sobol(d, mSeed);
+		std::vector<Val> u(d);
+		for (size_t i = 0; i < n; i++) {
+			sobol.point(i, u.data());
+			Val *x = mMem.coords(i);
+			for (size_t k = 0; k < d; k++) {
+				const Range &r = mRanges[k];
+				x[k] = r.min + (r.max - r.min) * u[k];
+			}
+		}
+	} else {
+		// Randomly permute the strata of each dimension and place each sample
+		// at a random position within its stratum
+		std::vector<size_t> perm(n);
+		for (size_t k = 0; k < d; k++) {
+			RandomStream random(mSeed, k);
+			std::iota(perm.begin(), perm.end(), 0);
+			for (size_t i = n; i > 1; i--) {
+				std::swap(perm[i - 1], perm[random() % i]);
+			}
+			const Val scale = (mRanges[k].max - mRanges[k].min) / Val(n);
+			for (size_t i = 0; i < n; i++) {
+				mMem.coords(i)[k] =
+				    mRanges[k].min + scale * (perm[i] + random.uniform());
+			}
+		}
+	}
+}
+
+template <typename Evaluation>
+bool Sweep::run(const Evaluation &evaluation, const ProgressCallback &progress,
+                const ChunkCallback &chunk)
+{
+	mMem = SweepMemory(evaluation.descriptor(), mDims.size(), mSamples);
+	sample();
+
+	const size_t nChunks = mMem.chunkCount();
+	const size_t nThreads = std::min(
+	    std::max<size_t>(1, nChunks),
+	    mThreadCount > 0
+	        ? mThreadCount
+	        : std::max<size_t>(1, std::thread::hardware_concurrency()));
+
+	// Completed chunks which have not been passed to the callback yet. The
+	// condition variable is used to wake up the calling thread.
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::vector<size_t> completed;
+
+	// Each thread fetches the next chunk and evaluates all samples in it,
+	// the results are written directly into the chunk memory
+	std::atomic<size_t> nextChunk(0);
+	std::atomic<size_t> counter(0);
+	std::atomic<bool> abort(false);
+	auto fun = [&]() -> void {
+		Parameters params = fullParams();
+		WorkingParameters p = params;
+		const EvaluationResult &def = evaluation.descriptor().defaultResult();
+		size_t c;
+		while (!abort.load() && (c = nextChunk++) < nChunks) {
+			for (size_t i = mMem.chunkBegin(c); i < mMem.chunkEnd(c); i++) {
+				const Val *x = mMem.coords(i);
+				if (useFullParams()) {
+					for (size_t k = 0; k < mDims.size(); k++) {
+						params[mDims[k]] = x[k];
+					}
+					p = params;
+				} else {
+					for (size_t k = 0; k < mDims.size(); k++) {
+						p[mDims[k]] = x[k];
+					}
+				}
+				if (p.valid()) {
+					p.update();
+					evaluation.evaluateInto(p, mMem.result(i));
+				} else {
+					std::copy(def.begin(), def.end(), mMem.result(i));
+				}
+				counter++;
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				completed.push_back(c);
+			}
+			cond.notify_one();
+		}
+	};
+
+	// Passes all completed chunks to the chunk callback, returns the number of
+	// chunks passed
+	auto flush = [&]() -> size_t {
+		std::vector<size_t> cs;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			std::swap(cs, completed);
+		}
+		for (size_t c : cs) {
+			chunk(mMem, c);
+		}
+		return cs.size();
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t idx = 0; idx < nThreads; idx++) {
+		threads.emplace_back(fun);
+	}
+
+	// Pass the completed chunks to the callback as soon as they arrive. This
+	// thread is woken up whenever a chunk is complete, the timeout only
+	// bounds the interval in which the progress callback is called.
+	size_t nFlushed = 0;
+	while (true) {
+		nFlushed += flush();
+
+		// Call the progress function
+		const size_t totalCount = counter.load();
+		if (!progress(mSamples > 0 ? Val(totalCount) / Val(mSamples) : 1.0)) {
+			abort.store(true);
+			break;
+		}
+
+		// Abort if all chunks have been passed to the callback
+		if (nFlushed >= nChunks) {
+			break;
+		}
+
+		// Wait for the next chunk
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait_for(lock, std::chrono::milliseconds(20),
+		              [&]() { return !completed.empty(); });
+	}
+
+	// Wait for all threads to be finished, the chunks completed in the
+	// meantime are still passed to the callback
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	flush();
+	return !abort.load();
+}
+
+Exploration Sweep::project(size_t i, size_t j, size_t resX, size_t resY,
+                           SweepProjection mode) const
+{
+	if (i >= mDims.size() || j >= mDims.size()) {
+		throw std::out_of_range("Sweep dimension index out of range");
+	}
+	if (!valid() || resX == 0 || resY == 0) {
+		return Exploration();
+	}
+
+	const EvaluationResultDescriptor &descr = descriptor();
+	const size_t nRes = descr.size();
+	const DiscreteRange rangeX(mRanges[i].min, mRanges[i].max, resX);
+	const DiscreteRange rangeY(mRanges[j].min, mRanges[j].max, resY);
+
+	// Combine all samples falling into the same cell
+	std::vector<double> acc(resX * resY * nRes,
+	                        mode == SweepProjection::MAX
+	                            ? -std::numeric_limits<double>::infinity()
+	                            : 0.0);
+	std::vector<size_t> count(resX * resY, 0);
+	auto cell = [](const DiscreteRange &range, Val v) -> size_t {
+		const Val idx = std::floor(range.index(v));
+		return size_t(std::min(Val(range.steps - 1), std::max(Val(0.0), idx)));
+	};
+	for (size_t s = 0; s < mMem.nSamples; s++) {
+		const Val *x = mMem.coords(s);
+		const Val *res = mMem.result(s);
+		const size_t c = cell(rangeY, x[j]) * resX + cell(rangeX, x[i]);
+		for (size_t k = 0; k < nRes; k++) {
+			double &a = acc[c * nRes + k];
+			a = (mode == SweepProjection::MAX) ? std::max(a, double(res[k]))
+			                                   : a + res[k];
+		}
+		count[c]++;
+	}
+
+	// Write the combined results to a new exploration memory
+	ExplorationMemory mem(descr, resX, resY);
+	for (size_t y = 0; y < resY; y++) {
+		for (size_t x = 0; x < resX; x++) {
+			const size_t c = y * resX + x;
+			EvaluationResult res = descr.defaultResult();
+			if (count[c] > 0) {
+				for (size_t k = 0; k < nRes; k++) {
+					res[k] = (mode == SweepProjection::MAX)
+					             ? acc[c * nRes + k]
+					             : acc[c * nRes + k] / count[c];
+				}
+			}
+			mem.store(x, y, res);
+		}
+	}
+	return Exploration(mem, mUseFullParams, mFullParams, mDims[i], mDims[j],
+	                   rangeX, rangeY);
+}
+
+/* Specializations of the "run" method. */
+template bool Sweep::run<SpikeTrainEvaluation>(
+    const SpikeTrainEvaluation &evaluation, const ProgressCallback &progress,
+    const ChunkCallback &chunk);
+template bool Sweep::run<SingleGroupSingleOutEvaluation>(
+    const SingleGroupSingleOutEvaluation &evaluation,
+    const ProgressCallback &progress, const ChunkCallback &chunk);
+template bool Sweep::run<SingleGroupMultiOutEvaluation>(
+    const SingleGroupMultiOutEvaluation &evaluation,
+    const ProgressCallback &progress, const ChunkCallback &chunk);
+}
@@ -0,0 +1,447 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Sweep.hpp
+ *
+ * Implements the Sweep process, which samples an N-dimensional parameter space
+ * with a fixed budget of quasi-random samples instead of a dense grid.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SWEEP_HPP_
+#define _ADEXPSIM_SWEEP_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <simulation/Parameters.hpp>
+#include <common/Types.hpp>
+
+#include "EvaluationResult.hpp"
+#include "Exploration.hpp"
+
+namespace AdExpSim {
+
+/**
+ * Method used to distribute the samples in the parameter space.
+ */
+enum class SweepSampling {
+	/**
+	 * Points of the (randomly shifted) Sobol sequence. Gives the most even
+	 * coverage if the number of samples is a power of two.
+	 */
+	SOBOL,
+
+	/**
+	 * Latin hypercube sampling, each dimension is divided into as many strata
+	 * as there are samples and each stratum contains exactly one sample.
+	 */
+	LATIN_HYPERCUBE
+};
+
+/**
+ * Method used to combine the samples falling into the same cell when
+ * projecting a sweep onto two dimensions.
+ */
+enum class SweepProjection {
+	/**
+	 * Mean of all samples in the cell.
+	 */
+	MEAN,
+
+	/**
+	 * Maximum of all samples in the cell, i.e. the best result that can be
+	 * reached by varying the hidden dimensions.
+	 */
+	MAX
+};
+
+/**
+ * The SweepMemory structure stores the coordinates and evaluation results of
+ * all samples of a sweep. The samples are divided into chunks of CHUNK_SIZE
+ * samples, each chunk is a single allocation in which the coordinates of a
+ * sample are directly followed by its evaluation result. Chunks are the unit
+ * of work for the sweep threads and are handed out to a callback once they
+ * are complete, which allows to stream the results while the sweep is still
+ * running.
+ */
+struct SweepMemory {
+	/**
+	 * Number of samples per chunk.
+	 */
+	static constexpr size_t CHUNK_SIZE = 1024;
+
+	/**
+	 * Copy of the evaluation result descriptor.
+	 */
+	EvaluationResultDescriptor descriptor;
+
+	/**
+	 * Number of swept parameter dimensions.
+	 */
+	size_t nDims;
+
+	/**
+	 * Total number of samples.
+	 */
+	size_t nSamples;
+
+	/**
+	 * Memory of the individual chunks.
+	 */
+	std::vector<std::vector<Val>> chunks;
+
+	/**
+	 * Default constructor, creates an empty memory instance.
+	 */
+	SweepMemory() : nDims(0), nSamples(0) {}
+
+	/**
+	 * Constructor of the SweepMemory class.
+	 *
+	 * @param descriptor is the evaluation result descriptor.
+	 * @param nDims is the number of swept parameter dimensions.
+	 * @param nSamples is the total number of samples.
+	 */
+	SweepMemory(const EvaluationResultDescriptor &descriptor, size_t nDims,
+	            size_t nSamples)
+	    : descriptor(descriptor),
+	      nDims(nDims),
+	      nSamples(nSamples),
+	      chunks((nSamples + CHUNK_SIZE - 1) / CHUNK_SIZE)
+	{
+		for (size_t c = 0; c < chunks.size(); c++) {
+			chunks[c].resize((chunkEnd(c) - chunkBegin(c)) * stride());
+		}
+	}
+
+	/**
+	 * Number of values stored per sample.
+	 */
+	size_t stride() const { return nDims + descriptor.size(); }
+
+	/**
+	 * Returns the number of chunks.
+	 */
+	size_t chunkCount() const { return chunks.size(); }
+
+	/**
+	 * Returns the index of the first sample in the given chunk.
+	 */
+	size_t chunkBegin(size_t c) const { return c * CHUNK_SIZE; }
+
+	/**
+	 * Returns the index after the last sample in the given chunk.
+	 */
+	size_t chunkEnd(size_t c) const
+	{
+		return std::min(nSamples, (c + 1) * CHUNK_SIZE);
+	}
+
+	/**
+	 * Returns a pointer at the coordinates of the i-th sample.
+	 */
+	Val *coords(size_t i)
+	{
+		return &chunks[i / CHUNK_SIZE][(i % CHUNK_SIZE) * stride()];
+	}
+
+	const Val *coords(size_t i) const
+	{
+		return &chunks[i / CHUNK_SIZE][(i % CHUNK_SIZE) * stride()];
+	}
+
+	/**
+	 * Returns a pointer at the evaluation result of the i-th sample.
+	 */
+	Val *result(size_t i) { return coords(i) + nDims; }
+
+	const Val *result(size_t i) const { return coords(i) + nDims; }
+
+	/**
+	 * Returns the value of the evaluation of the i-th sample.
+	 */
+	Val operator()(size_t i, size_t dim) const { return result(i)[dim]; }
+
+	/**
+	 * Returns true if there is actually any data stored inside the memory.
+	 */
+	bool valid() const { return nSamples > 0; }
+};
+
+/**
+ * The Sweep class evaluates a fixed number of samples distributed over an
+ * arbitrary number of parameter dimensions. In contrast to the Exploration
+ * class, whose cost grows with the power of the number of dimensions, the cost
+ * of a sweep only depends on the number of samples. The result can be
+ * projected onto any pair of swept dimensions, which yields an Exploration
+ * instance that can be displayed or stored like a regular exploration.
+ */
+class Sweep {
+private:
+	/**
+	 * SweepMemory instance on which the sweep is working.
+	 */
+	SweepMemory mMem;
+
+	/**
+	 * Explore working parameters or full parameters?
+	 */
+	bool mUseFullParams;
+
+	/**
+	 * Base parameter set.
+	 */
+	Parameters mFullParams;
+
+	/**
+	 * Base working parameters set.
+	 */
+	WorkingParameters mParams;
+
+	/**
+	 * Indices of the swept parameter dimensions.
+	 */
+	std::vector<size_t> mDims;
+
+	/**
+	 * Parameter range of each swept dimension.
+	 */
+	std::vector<Range> mRanges;
+
+	/**
+	 * Total number of samples.
+	 */
+	size_t mSamples;
+
+	/**
+	 * Method used to distribute the samples.
+	 */
+	SweepSampling mSampling;
+
+	/**
+	 * Seed used to randomize the sample positions.
+	 */
+	uint64_t mSeed;
+
+	/**
+	 * Number of threads used by run(). If zero, one thread per hardware thread
+	 * is used.
+	 */
+	size_t mThreadCount;
+
+	/**
+	 * Writes the coordinates of all samples to the memory.
+	 */
+	void sample();
+
+public:
+	/**
+	 * Callback function used to allow another function to display some kind of
+	 * progress indicator, see Exploration::ProgressCallback.
+	 */
+	using ProgressCallback = std::function<bool(Val)>;
+
+	/**
+	 * Callback function which is called from the thread calling run() once a
+	 * chunk is complete. Receives the memory and the index of the chunk.
+	 */
+	using ChunkCallback = std::function<void(const SweepMemory &, size_t)>;
+
+	/**
+	 * Default seed used to randomize the sample positions.
+	 */
+	static constexpr uint64_t DEFAULT_SEED = 1241249190;
+
+	/**
+	 * Default constructor. Resulting sweep is invalid.
+	 */
+	Sweep()
+	    : mUseFullParams(false),
+	      mSamples(0),
+	      mSampling(SweepSampling::SOBOL),
+	      mSeed(DEFAULT_SEED),
+	      mThreadCount(0)
+	{
+	}
+
+	/**
+	 * Creates a new Sweep instance over the working parameters.
+	 *
+	 * @param params is the base parameter set.
+	 * @param dims contains the indices of the swept parameter dimensions.
+	 * @param ranges contains the range of each swept dimension.
+	 * @param samples is the total number of samples.
+	 * @param sampling is the method used to distribute the samples.
+	 */
+	Sweep(const WorkingParameters &params, const std::vector<size_t> &dims,
+	      const std::vector<Range> &ranges, size_t samples,
+	      SweepSampling sampling = SweepSampling::SOBOL)
+	    : mUseFullParams(false),
+	      mFullParams(params.toParameters(DefaultParameters::cM,
+	                                      DefaultParameters::eL)),
+	      mParams(params),
+	      mDims(dims),
+	      mRanges(ranges),
+	      mSamples(samples),
+	      mSampling(sampling),
+	      mSeed(DEFAULT_SEED),
+	      mThreadCount(0)
+	{
+	}
+
+	/**
+	 * Constructor which allows to sweep the full parameter space instead of
+	 * the limited, DoF reduced working parameter space.
+	 *
+	 * @param useFullParams if true, the full parameter set is used, if false
+	 * the given parameters are converted to the DoF reduced parameter set
+	 * first.
+	 * @param params is the base parameter set.
+	 * @param dims contains the indices of the swept parameter dimensions.
+	 * @param ranges contains the range of each swept dimension.
+	 * @param samples is the total number of samples.
+	 * @param sampling is the method used to distribute the samples.
+	 */
+	Sweep(bool useFullParams, const Parameters &params,
+	      const std::vector<size_t> &dims, const std::vector<Range> &ranges,
+	      size_t samples, SweepSampling sampling = SweepSampling::SOBOL)
+	    : mUseFullParams(useFullParams),
+	      mFullParams(params),
+	      mParams(params),
+	      mDims(dims),
+	      mRanges(ranges),
+	      mSamples(samples),
+	      mSampling(sampling),
+	      mSeed(DEFAULT_SEED),
+	      mThreadCount(0)
+	{
+	}
+
+	/**
+	 * Runs the sweep, returns true if the process has completed successfully,
+	 * false if it was aborted by the "progress" function returning false.
+	 *
+	 * @param evaluation is a reference at a class with an "evaluateInto"
+	 * method that calculates the actual cost function values.
+	 * @param progress specifies the current progress as a value between zero
+	 * and one.
+	 * @param chunk is called for each completed chunk, including the chunks
+	 * that were completed before the sweep was aborted.
+	 * @return true if the operation was sucessful, false otherwise.
+	 */
+	template <typename Evaluation>
+	bool run(const Evaluation &evaluation,
+	         const ProgressCallback &progress = [](Val) { return true; },
+	         const ChunkCallback &chunk = [](const SweepMemory &, size_t) {});
+
+	/**
+	 * Projects the samples onto the two given swept dimensions. All samples
+	 * falling into the same cell of the resX times resY grid are combined
+	 * according to the given mode, empty cells contain the default result.
+	 *
+	 * @param i is the index of the swept dimension used as x-axis.
+	 * @param j is the index of the swept dimension used as y-axis.
+	 * @param resX is the resolution in x-direction.
+	 * @param resY is the resolution in y-direction.
+	 * @param mode specifies how samples in the same cell are combined.
+	 */
+	Exploration project(size_t i, size_t j, size_t resX, size_t resY,
+	                    SweepProjection mode = SweepProjection::MAX) const;
+
+	/**
+	 * Sets the seed used to randomize the sample positions.
+	 */
+	void setSeed(uint64_t seed) { mSeed = seed; }
+
+	/**
+	 * Returns the seed used to randomize the sample positions.
+	 */
+	uint64_t seed() const { return mSeed; }
+
+	/**
+	 * Sets the number of threads used by run(). Zero (the default) selects one
+	 * thread per hardware thread.
+	 */
+	void setThreadCount(size_t threadCount) { mThreadCount = threadCount; }
+
+	/**
+	 * Returns the number of threads set via setThreadCount().
+	 */
+	size_t threadCount() const { return mThreadCount; }
+
+	/**
+	 * Flag indicating whether the sweep is valid or not.
+	 */
+	bool valid() const { return mMem.valid(); }
+
+	/**
+	 * Returns a reference at the sweep memory.
+	 */
+	const SweepMemory &mem() const { return mMem; }
+
+	/**
+	 * Returns a reference at the evaluation result descriptor.
+	 */
+	const EvaluationResultDescriptor &descriptor() const
+	{
+		return mMem.descriptor;
+	}
+
+	/**
+	 * Returns a reference at the base working parameters.
+	 */
+	const WorkingParameters &params() const { return mParams; }
+
+	/**
+	 * Returns a reference at the base parameters.
+	 */
+	const Parameters &fullParams() const { return mFullParams; }
+
+	/**
+	 * Flag indicating whether the full parameter set should be used.
+	 */
+	bool useFullParams() const { return mUseFullParams; }
+
+	/**
+	 * Returns the indices of the swept parameter dimensions.
+	 */
+	const std::vector<size_t> &dims() const { return mDims; }
+
+	/**
+	 * Returns the ranges of the swept parameter dimensions.
+	 */
+	const std::vector<Range> &ranges() const { return mRanges; }
+
+	/**
+	 * Returns the total number of samples.
+	 */
+	size_t samples() const { return mSamples; }
+
+	/**
+	 * Returns the method used to distribute the samples.
+	 */
+	SweepSampling sampling() const { return mSampling; }
+};
+}
+
+#endif /* _ADEXPSIM_SWEEP_HPP_ */
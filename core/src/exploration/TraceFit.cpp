@@ -0,0 +1,169 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <simulation/Sensitivity.hpp>
+
+#include "TraceFit.hpp"
+
+namespace AdExpSim {
+
+TraceFit::TraceFit(const TraceVec &reference, const SpikeVec &spikes,
+                   const std::vector<size_t> &dims, Val eL, bool useIfCondExp,
+                   Time tDelta)
+    : reference(reference),
+      spikes(spikes),
+      dims(dims),
+      eL(eL),
+      useIfCondExp(useIfCondExp),
+      tDelta(tDelta)
+{
+}
+
+double TraceFit::evaluate(const WorkingParameters &p,
+                          const std::vector<size_t> &dims,
+                          std::vector<double> &jtj,
+                          std::vector<double> &jtr) const
+{
+	const size_t n = dims.size();
+	const size_t nRef = reference.size();
+	std::fill(jtj.begin(), jtj.end(), 0.0);
+	std::fill(jtr.begin(), jtr.end(), 0.0);
+	if (nRef == 0) {
+		return 0.0;
+	}
+
+	// Accumulates the residual of the next reference sample, given the
+	// simulated membrane potential and its derivatives
+	double sum = 0.0;
+	size_t idx = 0;
+	std::vector<Val> dv(n);
+	auto accumulate = [&](Val v) {
+		const double r = double(v) + eL - reference[idx++].v;
+		sum += r * r;
+		for (size_t i = 0; i < n; i++) {
+			jtr[i] += dv[i] * r;
+			for (size_t j = 0; j <= i; j++) {
+				jtj[i * n + j] += double(dv[i]) * dv[j];
+			}
+		}
+	};
+
+	// Linearly interpolate the state between two integration steps for all
+	// reference samples in between
+	Time tPrev(-1);
+	State sPrev;
+	std::vector<State> dsPrev(n);
+	auto callback = [&](Time t, const State &s, const std::vector<State> &ds) {
+		const double ts = t.sec();
+		while (idx < nRef && reference[idx].t <= ts) {
+			Val alpha = 1.0;
+			if (tPrev >= Time(0) && t > tPrev) {
+				alpha = std::max(0.0, (reference[idx].t - tPrev.sec()) /
+				                          (ts - tPrev.sec()));
+			}
+			for (size_t i = 0; i < n; i++) {
+				dv[i] = dsPrev[i].v() + alpha * (ds[i].v() - dsPrev[i].v());
+			}
+			accumulate(sPrev.v() + alpha * (s.v() - sPrev.v()));
+		}
+		tPrev = t;
+		sPrev = s;
+		std::copy(ds.begin(), ds.end(), dsPrev.begin());
+	};
+
+	const Time dt = timestep(p);
+	const Time tEnd = Time::sec(reference.back().t) + dt;
+	Sensitivity::simulate<Model::DISABLE_SPIKING | Model::CLAMP_ITH>(
+	    useIfCondExp, spikes, dims, callback, p, dt, tEnd);
+
+	// Samples after the end of the simulation use the last state
+	for (size_t i = 0; i < n; i++) {
+		dv[i] = dsPrev[i].v();
+	}
+	while (idx < nRef) {
+		accumulate(sPrev.v());
+	}
+
+	// Only the lower triangle of JtJ has been calculated
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = i + 1; j < n; j++) {
+			jtj[i * n + j] = jtj[j * n + i];
+		}
+	}
+	return sum;
+}
+
+bool TraceFit::solve(size_t n, std::vector<double> A, std::vector<double> b,
+                     std::vector<double> &x)
+{
+	// Cholesky decomposition, the factor L is stored in the lower triangle
+	for (size_t j = 0; j < n; j++) {
+		double sum = A[j * n + j];
+		for (size_t k = 0; k < j; k++) {
+			sum -= A[j * n + k] * A[j * n + k];
+		}
+		if (!(sum > 0.0)) {
+			return false;
+		}
+		A[j * n + j] = std::sqrt(sum);
+		for (size_t i = j + 1; i < n; i++) {
+			double s = A[i * n + j];
+			for (size_t k = 0; k < j; k++) {
+				s -= A[i * n + k] * A[j * n + k];
+			}
+			A[i * n + j] = s / A[j * n + j];
+		}
+	}
+
+	// Forward and backward substitution
+	for (size_t i = 0; i < n; i++) {
+		for (size_t k = 0; k < i; k++) {
+			b[i] -= A[i * n + k] * b[k];
+		}
+		b[i] /= A[i * n + i];
+	}
+	for (size_t i = n; i-- > 0;) {
+		for (size_t k = i + 1; k < n; k++) {
+			b[i] -= A[k * n + i] * b[k];
+		}
+		b[i] /= A[i * n + i];
+	}
+	x = b;
+	return true;
+}
+
+Val TraceFit::cost(const WorkingParameters &p) const
+{
+	if (!p.valid()) {
+		return std::numeric_limits<Val>::max();
+	}
+	if (reference.empty()) {
+		return 0.0;
+	}
+	TraceErrorRecorder recorder(reference, eL);
+	NullController controller;
+	RungeKuttaIntegrator integrator;
+	const Time dt = timestep(p);
+	Model::simulate<Model::DISABLE_SPIKING | Model::CLAMP_ITH>(
+	    useIfCondExp, spikes, recorder, controller, integrator, p, dt,
+	    Time::sec(reference.back().t) + dt);
+	recorder.finish();
+	const Val res = recorder.rmse();
+	return std::isfinite(res) ? res : std::numeric_limits<Val>::max();
+}
+}
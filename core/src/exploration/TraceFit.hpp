@@ -0,0 +1,304 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file TraceFit.hpp
+ *
+ * Contains the TraceFit class, which fits the working parameters of the
+ * neuron model to a recorded membrane potential trace using the
+ * Levenberg-Marquardt algorithm.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_TRACE_FIT_HPP_
+#define _ADEXPSIM_TRACE_FIT_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <common/Types.hpp>
+#include <simulation/Parameters.hpp>
+#include <simulation/Recorder.hpp>
+#include <simulation/Spike.hpp>
+
+namespace AdExpSim {
+
+/**
+ * Result of the TraceFit::run method.
+ */
+struct TraceFitResult {
+	/**
+	 * Best parameter set.
+	 */
+	WorkingParameters best;
+
+	/**
+	 * Initial root mean square error in volts.
+	 */
+	Val costInit;
+
+	/**
+	 * Best root mean square error in volts.
+	 */
+	Val costBest;
+
+	/**
+	 * Number of performed iterations.
+	 */
+	size_t nIt;
+
+	/**
+	 * Number of performed simulations.
+	 */
+	size_t nSimulations;
+
+	TraceFitResult(const WorkingParameters &best, Val costInit, Val costBest,
+	               size_t nIt, size_t nSimulations)
+	    : best(best),
+	      costInit(costInit),
+	      costBest(costBest),
+	      nIt(nIt),
+	      nSimulations(nSimulations)
+	{
+	}
+};
+
+/**
+ * The TraceFit class fits a subset of the working parameters to a recorded
+ * membrane potential trace. The neuron is simulated without the spike
+ * mechanism. Each simulation integrates the forward sensitivities of the
+ * membrane potential, which provide the exact Jacobian of the residuals for
+ * the Levenberg-Marquardt algorithm. The simulated trace is compared to the
+ * reference while it is being simulated and is never stored.
+ */
+class TraceFit {
+private:
+	/**
+	 * Recorded reference trace.
+	 */
+	TraceVec reference;
+
+	/**
+	 * Input spikes fed into the neuron.
+	 */
+	SpikeVec spikes;
+
+	/**
+	 * Indices of the working parameters that should be fitted.
+	 */
+	std::vector<size_t> dims;
+
+	/**
+	 * Leak reversal potential, added to the simulated membrane potential.
+	 */
+	Val eL;
+
+	/**
+	 * If true, the IF_COND_EXP model is used.
+	 */
+	bool useIfCondExp;
+
+	/**
+	 * Fixed simulation timestep. If smaller or equal to zero, the timestep is
+	 * chosen automatically from the parameters.
+	 */
+	Time tDelta;
+
+	/**
+	 * Returns the timestep used for the given parameters.
+	 */
+	Time timestep(const WorkingParameters &p) const
+	{
+		return tDelta > Time(0) ? tDelta : Time::sec(p.tDelta());
+	}
+
+	/**
+	 * Simulates the neuron and calculates the sum of the squared residuals.
+	 * If dims is not empty, additionally calculates the matrix JtJ and the
+	 * vector Jtr, where J is the Jacobian of the residuals r with respect to
+	 * the parameters listed in dims.
+	 */
+	double evaluate(const WorkingParameters &p, const std::vector<size_t> &dims,
+	                std::vector<double> &jtj, std::vector<double> &jtr) const;
+
+	/**
+	 * Solves the symmetric positive definite system A x = b using the Cholesky
+	 * decomposition. Returns false if A is not positive definite.
+	 */
+	static bool solve(size_t n, std::vector<double> A, std::vector<double> b,
+	                  std::vector<double> &x);
+
+	/**
+	 * Converts a sum of squared residuals to the root mean square error.
+	 */
+	Val rmse(double sum) const
+	{
+		return reference.empty() ? 0.0 : std::sqrt(sum / reference.size());
+	}
+
+public:
+	/**
+	 * Constructor of the TraceFit class.
+	 *
+	 * @param reference is the recorded membrane potential trace.
+	 * @param spikes are the input spikes that caused the recorded trace.
+	 * @param dims contains the indices of the working parameters that should
+	 * be fitted.
+	 * @param eL is the leak reversal potential.
+	 * @param useIfCondExp selects the IF_COND_EXP model.
+	 * @param tDelta is the fixed simulation timestep. If set to a value smaller
+	 * or equal to zero, the timestep is chosen automatically, as in
+	 * Model::simulate().
+	 */
+	TraceFit(const TraceVec &reference, const SpikeVec &spikes,
+	         const std::vector<size_t> &dims, Val eL, bool useIfCondExp = true,
+	         Time tDelta = Time(-1));
+
+	/**
+	 * Returns the root mean square error between the reference trace and the
+	 * simulated trace for the given parameters, or the maximum Val if the
+	 * parameters are invalid.
+	 */
+	Val cost(const WorkingParameters &p) const;
+
+	/**
+	 * Runs the Levenberg-Marquardt algorithm. The fitted dimensions are
+	 * rescaled relative to the initial parameters.
+	 *
+	 * @param params is the initial parameter set.
+	 * @param callback is called once per iteration with the number of
+	 * iterations, the number of simulations and the current error. Should
+	 * return false if the fit is to be aborted.
+	 * @param max_it is the maximum number of iterations.
+	 * @param epsilon is the minimum relative improvement of the squared error
+	 * and the minimum relative parameter step for the fit to continue.
+	 */
+	template <typename Callback>
+	TraceFitResult run(const WorkingParameters &params, Callback callback,
+	                   size_t max_it = 100, Val epsilon = 1e-6) const
+	{
+		static constexpr double MIN_LAMBDA = 1e-12;
+		static constexpr double MAX_LAMBDA = 1e12;
+
+		const size_t n = dims.size();
+		std::vector<double> scale(n);
+		for (size_t i = 0; i < n; i++) {
+			const Val v = params[dims[i]];
+			scale[i] = (v == 0.0) ? 1.0 : std::fabs(v);
+		}
+
+		// Evaluates the parameters and rescales JtJ and Jtr
+		size_t nSimulations = 0;
+		auto f = [&](const WorkingParameters &p, std::vector<double> &jtj,
+		             std::vector<double> &jtr) -> double {
+			nSimulations++;
+			if (!p.valid()) {
+				return std::numeric_limits<double>::max();
+			}
+			const double res = evaluate(p, dims, jtj, jtr);
+			for (size_t i = 0; i < n; i++) {
+				jtr[i] *= scale[i];
+				for (size_t j = 0; j < n; j++) {
+					jtj[i * n + j] *= scale[i] * scale[j];
+				}
+			}
+			return std::isfinite(res) ? res
+			                          : std::numeric_limits<double>::max();
+		};
+
+		WorkingParameters p = params;
+		std::vector<double> jtj(n * n), jtr(n), jtjNew(n * n), jtrNew(n),
+		    A(n * n), b(n), delta(n);
+		double c = f(p, jtj, jtr);
+		const Val costInit = rmse(c);
+		if (c == std::numeric_limits<double>::max()) {
+			return TraceFitResult(p, std::numeric_limits<Val>::max(),
+			                      std::numeric_limits<Val>::max(), 0,
+			                      nSimulations);
+		}
+
+		double lambda = 1e-3;
+		size_t it = 0;
+		while (it < max_it && callback(it, nSimulations, rmse(c))) {
+			it++;
+
+			// Increase the damping until a step reduces the error
+			bool accepted = false;
+			double improvement = 0.0;
+			while (!accepted && lambda < MAX_LAMBDA) {
+				A = jtj;
+				for (size_t i = 0; i < n; i++) {
+					A[i * n + i] += lambda * std::max(jtj[i * n + i], 1e-30);
+					b[i] = -jtr[i];
+				}
+				if (!solve(n, A, b, delta)) {
+					lambda *= 10.0;
+					continue;
+				}
+
+				// Abort once the steps become negligible
+				double stepMax = 0.0;
+				for (size_t i = 0; i < n; i++) {
+					stepMax = std::max(stepMax, std::fabs(delta[i]));
+				}
+				if (stepMax < epsilon) {
+					break;
+				}
+
+				WorkingParameters pNew = p;
+				for (size_t i = 0; i < n; i++) {
+					pNew[dims[i]] += delta[i] * scale[i];
+				}
+				pNew.update();
+
+				const double cNew = f(pNew, jtjNew, jtrNew);
+				if (cNew < c) {
+					improvement = (c - cNew) / c;
+					p = pNew;
+					c = cNew;
+					std::swap(jtj, jtjNew);
+					std::swap(jtr, jtrNew);
+					lambda = std::max(MIN_LAMBDA, lambda * 0.1);
+					accepted = true;
+				} else {
+					lambda *= 10.0;
+				}
+			}
+			if (!accepted || improvement < epsilon) {
+				break;
+			}
+		}
+		return TraceFitResult(p, costInit, rmse(c), it, nSimulations);
+	}
+
+	/**
+	 * Returns the reference trace.
+	 */
+	const TraceVec &getReference() const { return reference; }
+
+	/**
+	 * Returns the fitted dimensions.
+	 */
+	const std::vector<size_t> &getDims() const { return dims; }
+};
+}
+
+#endif /* _ADEXPSIM_TRACE_FIT_HPP_ */
@@ -89,7 +89,7 @@ static inline K RungeKuttaEval(Coeffs c, size_t i, const K &k)
 template <typename Coeffs, typename K, typename... KS>
 static inline K RungeKuttaEval(Coeffs c, size_t i, const K &k, const KS &... ks)
 {
-	return c(i) * k + RungeKuttaEval(c, i + 1, ks...);
+	return fmadd(c(i), k, RungeKuttaEval(c, i + 1, ks...));
 }
 
 /*
@@ -105,7 +105,7 @@ static inline Vector RungeKuttaStepInner(Val h, const Vector &y, size_t step,
 	auto c = [step](size_t j) { return a(step, j); };
 
 	// Fold over all ks
-	return y + h * RungeKuttaEval(c, 1, ks...);
+	return fmadd(h, RungeKuttaEval(c, 1, ks...), y);
 }
 
 /*
@@ -172,6 +172,12 @@ private:
 	 */
 	Val hOld;
 
+	/**
+	 * Number of steps which had to be repeated with a smaller stepsize since
+	 * the last reset.
+	 */
+	size_t nRejected;
+
 	/**
 	 * Calculates a single error vector form the error vector. Calculates the
 	 * L2-norm of the vector.
@@ -190,7 +196,16 @@ public:
 	/**
 	 * Resets the integrator to its initial state.
 	 */
-	void reset() { hOld = 0.0f; }
+	void reset()
+	{
+		hOld = 0.0f;
+		nRejected = 0;
+	}
+
+	/**
+	 * Returns the number of rejected steps since the last reset.
+	 */
+	size_t rejectedSteps() const { return nRejected; }
 
 	/**
 	 * Implements an integrator with adaptive step size.
@@ -267,6 +282,7 @@ public:
 
 			// Use the new h in the next iteration
 			h = hNew;
+			nRejected++;
 		}
 
 		// Copy current stepsize
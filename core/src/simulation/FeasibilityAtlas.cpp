@@ -0,0 +1,143 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <list>
+#include <mutex>
+
+#include "FeasibilityAtlas.hpp"
+
+namespace AdExpSim {
+
+// Maximum number of atlases kept in the cache
+static constexpr size_t CACHE_SIZE = 8;
+
+/**
+ * Returns the index of the grid point nearest to v or -1 if v is outside of
+ * the given range.
+ */
+static ssize_t nearestIndex(const DiscreteRange &range, Val v)
+{
+	if (!range.contains(v)) {
+		return -1;
+	}
+	const Val scale = range.getScale();
+	const ssize_t i = scale == 0.0 ? 0 : ssize_t(std::round(range.index(v)));
+	return std::max<ssize_t>(0, std::min<ssize_t>(range.steps - 1, i));
+}
+
+/**
+ * Returns true if the given ranges are equal.
+ */
+static bool equal(const DiscreteRange &r1, const DiscreteRange &r2)
+{
+	return r1.min == r2.min && r1.max == r2.max && r1.steps == r2.steps;
+}
+
+FeasibilityAtlas::FeasibilityAtlas(const HardwareParameters &hw,
+                                   const WorkingParameters &params,
+                                   size_t dimX, size_t dimY,
+                                   const DiscreteRange &rangeX,
+                                   const DiscreteRange &rangeY,
+                                   bool useIfCondExp)
+    : mHw(&hw),
+      mParams(params),
+      mDimX(dimX),
+      mDimY(dimY),
+      mRangeX(rangeX),
+      mRangeY(rangeY),
+      mUseIfCondExp(useIfCondExp),
+      mMask(rangeX.steps, rangeY.steps)
+{
+	WorkingParameters p = params;
+	for (size_t y = 0; y < rangeY.steps; y++) {
+		p[dimY] = rangeY.value(y);
+		for (size_t x = 0; x < rangeX.steps; x++) {
+			p[dimX] = rangeX.value(x);
+			mMask(x, y) = hw.possible(p, useIfCondExp);
+		}
+	}
+}
+
+std::shared_ptr<const FeasibilityAtlas> FeasibilityAtlas::get(
+    const HardwareParameters &hw, const WorkingParameters &params, size_t dimX,
+    size_t dimY, const DiscreteRange &rangeX, const DiscreteRange &rangeY,
+    bool useIfCondExp)
+{
+	static std::mutex mutex;
+	static std::list<std::shared_ptr<const FeasibilityAtlas>> cache;
+
+	// Search the atlas in the cache, move it to the front if it is found
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto it = cache.begin(); it != cache.end(); it++) {
+			if ((*it)->matches(hw, params, dimX, dimY, rangeX, rangeY,
+			                   useIfCondExp)) {
+				cache.splice(cache.begin(), cache, it);
+				return cache.front();
+			}
+		}
+	}
+
+	// Calculate a new atlas without holding the lock, insert it into the cache
+	auto res = std::make_shared<const FeasibilityAtlas>(
+	    hw, params, dimX, dimY, rangeX, rangeY, useIfCondExp);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		cache.push_front(res);
+		if (cache.size() > CACHE_SIZE) {
+			cache.pop_back();
+		}
+	}
+	return res;
+}
+
+bool FeasibilityAtlas::matches(const HardwareParameters &hw,
+                               const WorkingParameters &params, size_t dimX,
+                               size_t dimY, const DiscreteRange &rangeX,
+                               const DiscreteRange &rangeY,
+                               bool useIfCondExp) const
+{
+	if (&hw != mHw || dimX != mDimX || dimY != mDimY ||
+	    useIfCondExp != mUseIfCondExp || !equal(rangeX, mRangeX) ||
+	    !equal(rangeY, mRangeY)) {
+		return false;
+	}
+	for (size_t i = 0; i < params.size(); i++) {
+		if (i != dimX && i != dimY && params[i] != mParams[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool FeasibilityAtlas::possible(const WorkingParameters &params) const
+{
+	// Check whether the parameters are inside the slice covered by the atlas
+	bool inSlice = true;
+	for (size_t i = 0; i < params.size() && inSlice; i++) {
+		inSlice = i == mDimX || i == mDimY || params[i] == mParams[i];
+	}
+	const ssize_t x = nearestIndex(mRangeX, params[mDimX]);
+	const ssize_t y = nearestIndex(mRangeY, params[mDimY]);
+	if (inSlice && x >= 0 && y >= 0) {
+		return mMask(x, y);
+	}
+	return mHw->possible(params, mUseIfCondExp);
+}
+}
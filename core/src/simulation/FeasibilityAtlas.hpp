@@ -0,0 +1,162 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file FeasibilityAtlas.hpp
+ *
+ * Contains the FeasibilityAtlas class, which stores the result of
+ * HardwareParameters::possible for a two dimensional slice of the working
+ * parameter space.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_FEASIBILITY_ATLAS_HPP_
+#define _ADEXPSIM_FEASIBILITY_ATLAS_HPP_
+
+#include <memory>
+
+#include <common/Matrix.hpp>
+#include <common/Types.hpp>
+
+#include "HardwareParameters.hpp"
+#include "Parameters.hpp"
+
+namespace AdExpSim {
+
+/**
+ * The FeasibilityAtlas class contains a precomputed mask which specifies for
+ * each point of a two dimensional grid in the working parameter space whether
+ * the parameters can be mapped to the hardware. All parameter dimensions except
+ * for dimX and dimY are set to the values of the base parameter set.
+ */
+class FeasibilityAtlas {
+private:
+	/**
+	 * Hardware the atlas was calculated for.
+	 */
+	HardwareParameters const *mHw;
+
+	/**
+	 * Base parameter set.
+	 */
+	WorkingParameters mParams;
+
+	/**
+	 * Dimensions varied along the x- and y-axis.
+	 */
+	size_t mDimX, mDimY;
+
+	/**
+	 * Ranges along the x- and y-axis.
+	 */
+	DiscreteRange mRangeX, mRangeY;
+
+	/**
+	 * Whether the IfCondExp model was used.
+	 */
+	bool mUseIfCondExp;
+
+	/**
+	 * Mask containing the result of HardwareParameters::possible for each grid
+	 * point.
+	 */
+	MatrixBase<bool> mMask;
+
+public:
+	/**
+	 * Calculates the atlas for the given hardware and the given slice of the
+	 * parameter space.
+	 *
+	 * @param hw is the hardware for which the atlas should be calculated.
+	 * @param params is the base parameter set.
+	 * @param dimX is the working parameter dimension varied in x-direction.
+	 * @param dimY is the working parameter dimension varied in y-direction.
+	 * @param rangeX is the range and resolution in x-direction.
+	 * @param rangeY is the range and resolution in y-direction.
+	 * @param useIfCondExp specifies whether the IfCondExp model is used.
+	 */
+	FeasibilityAtlas(const HardwareParameters &hw,
+	                 const WorkingParameters &params, size_t dimX, size_t dimY,
+	                 const DiscreteRange &rangeX, const DiscreteRange &rangeY,
+	                 bool useIfCondExp = false);
+
+	/**
+	 * Returns a (possibly cached) atlas for the given parameters. The cache
+	 * holds the most recently used atlases, so repeated requests for the same
+	 * slice (e.g. when redrawing a plot) do not recalculate the atlas. This
+	 * function is thread-safe.
+	 */
+	static std::shared_ptr<const FeasibilityAtlas> get(
+	    const HardwareParameters &hw, const WorkingParameters &params,
+	    size_t dimX, size_t dimY, const DiscreteRange &rangeX,
+	    const DiscreteRange &rangeY, bool useIfCondExp = false);
+
+	/**
+	 * Returns true if this atlas was calculated for the given parameters.
+	 */
+	bool matches(const HardwareParameters &hw, const WorkingParameters &params,
+	             size_t dimX, size_t dimY, const DiscreteRange &rangeX,
+	             const DiscreteRange &rangeY, bool useIfCondExp) const;
+
+	/**
+	 * Returns true if the parameters at the given grid point can be mapped to
+	 * the hardware.
+	 */
+	bool operator()(size_t x, size_t y) const { return mMask(x, y); }
+
+	/**
+	 * Returns the feasibility of the given parameters. If the parameters lie
+	 * in the slice covered by the atlas, the value of the nearest grid point
+	 * is returned, otherwise HardwareParameters::possible is called.
+	 */
+	bool possible(const WorkingParameters &params) const;
+
+	/**
+	 * Returns the mask containing the feasibility of each grid point.
+	 */
+	const MatrixBase<bool> &mask() const { return mMask; }
+
+	/**
+	 * Returns the base parameters.
+	 */
+	const WorkingParameters &params() const { return mParams; }
+
+	/**
+	 * Returns the x-dimension.
+	 */
+	size_t dimX() const { return mDimX; }
+
+	/**
+	 * Returns the y-dimension.
+	 */
+	size_t dimY() const { return mDimY; }
+
+	/**
+	 * Returns a reference at the x-range.
+	 */
+	const DiscreteRange &rangeX() const { return mRangeX; }
+
+	/**
+	 * Returns a reference at the y-range.
+	 */
+	const DiscreteRange &rangeY() const { return mRangeY; }
+};
+}
+
+#endif /* _ADEXPSIM_FEASIBILITY_ATLAS_HPP_ */
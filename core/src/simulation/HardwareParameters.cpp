@@ -23,6 +23,9 @@
 
 namespace AdExpSim {
 
+// Leak potential used when mapping WorkingParameters to hardware parameters
+static constexpr Val MAP_EL = -50e-3;
+
 // Maps from index in the ranges list at corresponding parameter indices
 static const std::vector<std::vector<size_t>> adExpRangeParamMap = {
     {Parameters::idx_eTh, Parameters::idx_eSpike, Parameters::idx_eReset},
@@ -83,31 +86,38 @@ static bool contains(Val v, const T &vs)
 	return false;
 }
 
-const std::vector<const Range *> HardwareParameters::ranges() const
+std::array<const Range *, 12> HardwareParameters::ranges() const
 {
-	return {&rE,    &rEL,   &rEE, &rEI, &rGL,      &rTau,
-	        &rTauW, &rTauRef, &rA,  &rB,  &rDeltaTh, &rW};
+	return {{&rE,    &rEL,     &rEE, &rEI, &rGL,      &rTau,
+	         &rTauW, &rTauRef, &rA,  &rB,  &rDeltaTh, &rW}};
 }
 
-bool HardwareParameters::valid(const Parameters &params,
-                               bool useIfCondExp) const
+bool HardwareParameters::validRanges(const Parameters &params,
+                                     bool useIfCondExp) const
 {
-	// Check whether the discrete parameters are ok
-	bool ok = contains(params.cM(), cMs) && contains(params.w(), ws);
-
 	// Fetch pointers at all ranged available in this class and the correct
 	// mapping between these ranges and the parameter indices
-	const std::vector<const Range *> rs = ranges();
+	const std::array<const Range *, 12> rs = ranges();
 	const std::vector<std::vector<size_t>> &rangeParamMap =
 	    useIfCondExp ? ifCondExpRangeParamMap : adExpRangeParamMap;
 
 	// Iterate over all ranges to check whether the parameters match
 	for (size_t i = 0; i < rangeParamMap.size(); i++) {
 		for (size_t j = 0; j < rangeParamMap[i].size(); j++) {
-			ok = ok && rs[i]->contains(params[rangeParamMap[i][j]]);
+			if (!rs[i]->contains(params[rangeParamMap[i][j]])) {
+				return false;
+			}
 		}
 	}
-	return ok;
+	return true;
+}
+
+bool HardwareParameters::valid(const Parameters &params,
+                               bool useIfCondExp) const
+{
+	// Check whether the discrete parameters are ok, then check the ranges
+	return contains(params.cM(), cMs) && contains(params.w(), ws) &&
+	       validRanges(params, useIfCondExp);
 }
 
 bool HardwareParameters::clamp(Parameters &params, bool useIfCondExp) const
@@ -118,7 +128,7 @@ bool HardwareParameters::clamp(Parameters &params, bool useIfCondExp) const
 
 	// Fetch pointers at all ranged available in this class and the correct
 	// mapping between these ranges and the parameter indices
-	const std::vector<const Range *> rs = ranges();
+	const std::array<const Range *, 12> rs = ranges();
 	const std::vector<std::vector<size_t>> &rangeParamMap =
 	    useIfCondExp ? ifCondExpRangeParamMap : adExpRangeParamMap;
 
@@ -158,7 +168,7 @@ std::vector<Val> HardwareParameters::nextWeights(Val w) const
 Parameters HardwareParameters::fixParameters(const Parameters &p,
                                              bool useIfCondExp) const
 {
-	const std::vector<const Range *> rs = ranges();
+	const std::array<const Range *, 12> rs = ranges();
 	const std::vector<std::vector<size_t>> &rangeParamMap =
 	    useIfCondExp ? ifCondExpRangeParamMap : adExpRangeParamMap;
 
@@ -203,7 +213,7 @@ std::vector<Parameters> HardwareParameters::map(const WorkingParameters &params,
 	    const Val cRE1 = (rE.max + rE.min) / 2.0;
 	    const Val cRE2 = (eMax + eMin) / 2.0;
 	    const Val eL = cRE1 - cRE2;*/
-	const Val eL = -50e-3;
+	const Val eL = MAP_EL;
 
 	// Calculate parameters for the membrane potentials and select the two
 	// nearest available weights
@@ -234,7 +244,35 @@ std::vector<Parameters> HardwareParameters::map(const WorkingParameters &params,
 bool HardwareParameters::possible(const WorkingParameters &params,
                                   bool useIfCondExp, bool strict) const
 {
-	return map(params, useIfCondExp, strict).size() > 0;
+	// The weights returned by nextWeights are always valid hardware weights
+	// and only differ in w, which is not part of the range check. So map()
+	// returns a result iff there is at least one weight and one capacitance
+	// for which the weight and the remaining parameters are in range. In the
+	// non-strict mode all parameters are clamped, so any capacitance works.
+	if (ws.empty()) {
+		return false;
+	}
+	if (!strict) {
+		return !cMs.empty();
+	}
+	for (Val cM : cMs) {
+		const Parameters p =
+		    fixParameters(params.toParameters(cM, MAP_EL), useIfCondExp);
+		if (rW.contains(p.w()) && validRanges(p, useIfCondExp)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+WorkingParameters HardwareParameters::project(const WorkingParameters &params,
+                                              Val cM, Val w,
+                                              bool useIfCondExp) const
+{
+	Parameters p = params.toParameters(cM, MAP_EL);
+	p.w() = w;
+	clamp(p, useIfCondExp);
+	return WorkingParameters(p);
 }
 
 const BrainScaleSParameters BrainScaleSParameters::inst;
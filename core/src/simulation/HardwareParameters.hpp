@@ -28,6 +28,7 @@
 #ifndef _ADEXPSIM_HARDWARE_PARAMETERS_HPP_
 #define _ADEXPSIM_HARDWARE_PARAMETERS_HPP_
 
+#include <array>
 #include <limits>
 #include <vector>
 #include <unordered_set>
@@ -114,10 +115,16 @@ protected:
 	Range rW;
 
 	/**
-	 * Returns a vector containing pointers at all range instances of this
+	 * Returns an array containing pointers at all range instances of this
 	 * class.
 	 */
-	const std::vector<const Range *> ranges() const;
+	std::array<const Range *, 12> ranges() const;
+
+	/**
+	 * Returns true if all continuous parameters are within the valid ranges.
+	 * Does not check the discrete parameters cM and w.
+	 */
+	bool validRanges(const Parameters &params, bool useIfCondExp) const;
 
 	/**
 	 * Makes sure parameters with empty range do not deviate from their value
@@ -162,10 +169,30 @@ public:
 
 	/**
 	 * Returns true if the map function returns at least one result for the
-	 * given parameters.
+	 * given parameters. Does not call map() and does not allocate any memory,
+	 * so it is cheap enough to be called in the cost function of an
+	 * optimization.
 	 */
 	bool possible(const WorkingParameters &params, bool useIfCondExp = false,
 	              bool strict = true) const;
+
+	/**
+	 * Projects the given working parameters onto the hardware configuration
+	 * with the given capacitance and weight. All continuous parameters are
+	 * clamped to the valid ranges, so the result is always accepted by
+	 * possible(). Use map() with strict set to false to enumerate the
+	 * capacitance/weight combinations near a parameter set.
+	 *
+	 * @param params is the set of WorkingParameters that should be projected.
+	 * @param cM is the membrane capacitance, should be one of the capacitances
+	 * supported by the hardware.
+	 * @param w is the synapse weight, should be one of the weights supported by
+	 * the hardware.
+	 * @param useIfCondExp if true, ignores the parameters that are only
+	 * available in the ifCondExp model.
+	 */
+	WorkingParameters project(const WorkingParameters &params, Val cM, Val w,
+	                          bool useIfCondExp = false) const;
 };
 
 /**
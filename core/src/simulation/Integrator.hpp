@@ -55,7 +55,7 @@ public:
 	                                        Deriv df)
 	{
 		const Val h = tDelta.sec();
-		return std::pair<State, Time>(s + h * df(s), tDelta);
+		return std::pair<State, Time>(fmadd(h, df(s), s), tDelta);
 	}
 };
 
@@ -81,7 +81,7 @@ public:
 	{
 		const Val h = tDelta.sec();
 		const State k1 = h * df(s);
-		const State k2 = h * df(s + 0.5f * k1);
+		const State k2 = h * df(fmadd(0.5f, k1, s));
 
 		return std::pair<State, Time>(s + k2, tDelta);
 	}
@@ -109,12 +109,12 @@ public:
 	{
 		const Val h = tDelta.sec();
 		const State k1 = h * df(s);
-		const State k2 = h * df(s + 0.5f * k1);
-		const State k3 = h * df(s + 0.5f * k2);
+		const State k2 = h * df(fmadd(0.5f, k1, s));
+		const State k3 = h * df(fmadd(0.5f, k2, s));
 		const State k4 = h * df(s + k3);
 
-		return std::pair<State, Time>(s + (k1 + 2.0f * (k2 + k3) + k4) / 6.0f,
-		                              tDelta);
+		return std::pair<State, Time>(
+		    fmadd(1.0f / 6.0f, fmadd(2.0f, k2 + k3, k1 + k4), s), tDelta);
 	}
 };
 }
@@ -41,8 +41,11 @@
 #include "Recorder.hpp"
 #include "Spike.hpp"
 #include "State.hpp"
+#include "Statistics.hpp"
 
 namespace AdExpSim {
+class Sensitivity;
+
 /**
  * The ModelType enum defines the model that should be used in the simulation.
  */
@@ -112,6 +115,11 @@ public:
 	static constexpr uint8_t PROCESS_SPECIAL = (1 << 6);
 
 private:
+	/**
+	 * The Sensitivity class reuses the model equations defined below.
+	 */
+	friend class Sensitivity;
+
 	/**
 	 * Calculates the current auxiliary state. This function is the bottleneck
 	 * of the simulation, with the "exp" for the threshold current taking more
@@ -283,15 +291,20 @@ public:
 	 * than zero correspond to "there has been no last spike". This parameter is
 	 * important if a neuron simulation is restarted from a certain point in
 	 * time.
+	 * @param stats is the object which receives the instrumentation counters.
+	 * Use an instance of StatisticsCollector to collect the counters, the
+	 * default NullStatistics instance does not produce any overhead.
 	 */
 	template <uint8_t Flags = 0, typename Recorder = NullRecorder,
 	          typename Integrator = RungeKuttaIntegrator,
-	          typename Controller = DefaultController>
+	          typename Controller = DefaultController,
+	          typename Statistics = NullStatistics>
 	static void simulate(const SpikeVec &spikes, Recorder &recorder,
 	                     Controller &controller, Integrator &integrator,
 	                     const WorkingParameters &p = WorkingParameters(),
 	                     Time tDelta = Time(-1), Time tEnd = MAX_TIME,
-	                     const State &s0 = State(), Time tLastSpike = Time(-1))
+	                     const State &s0 = State(), Time tLastSpike = Time(-1),
+	                     Statistics stats = Statistics())
 	{
 		// Use the automatically calculated tDelta if no user-defined value is
 		// given
@@ -315,6 +328,11 @@ public:
 		// Start with state s0
 		State s = s0;
 
+		// Reason for the simulation to end, overwritten if the controller
+		// decides to end the simulation
+		stats.begin(integrator);
+		TerminationReason reason = TerminationReason::END_TIME;
+
 		// Iterate over all time slices. Make sure t does not overflow!
 		Time t;
 		while (t < tEnd && t >= Time(0)) {
@@ -348,6 +366,7 @@ public:
 				}
 
 				// Record the new values
+				stats.inputSpike();
 				recorder.inputSpike(t, s);
 				recorder.record(t, s, aux<Flags>(s, p), true);
 				continue;
@@ -370,9 +389,11 @@ public:
 			// Perform the actual integration
 			std::pair<State, Time> res =
 			    integrator.integrate(std::min(tDelta, tDeltaMax), tDeltaMax, s,
-			                         [&p, inRefrac](const State &s) {
+			                         [&p, inRefrac, &stats](const State &s) {
+				    stats.rhs();
 				    return df<Flags>(s, aux<Flags>(s, p), p, inRefrac);
 				});
+			stats.step();
 
 			// Copy the result and advance the time by the performed
 			// timestep
@@ -385,6 +406,7 @@ public:
 			// Reset the neuron if the spike potential is reached
 			if (!(Flags & DISABLE_SPIKING) &&
 			    s.v() > ((Flags & IF_COND_EXP) ? p.eTh() : p.eSpike())) {
+				stats.outputSpike();
 				generateOutputSpike<Flags>(t, s, tLastSpike, recorder, p);
 			}
 
@@ -398,28 +420,39 @@ public:
 			if (cres == ControllerResult::ABORT ||
 			    (cres == ControllerResult::MAY_CONTINUE &&
 			     spikeIdx >= nSpikes)) {
+				reason = (cres == ControllerResult::ABORT)
+				             ? TerminationReason::CONTROLLER_ABORT
+				             : TerminationReason::CONTROLLER_SETTLED;
 				break;
 			}
 		}
+
+		// Pass the termination reason to the statistics
+		if (t < Time(0)) {
+			reason = TerminationReason::TIME_OVERFLOW;
+		}
+		stats.end(integrator, reason);
 	}
 
 	template <uint8_t Flags = 0, typename Recorder = NullRecorder,
 	          typename Integrator = RungeKuttaIntegrator,
-	          typename Controller = DefaultController>
+	          typename Controller = DefaultController,
+	          typename Statistics = NullStatistics>
 	static void simulate(bool useIfCondExp, const SpikeVec &spikes,
 	                     Recorder &recorder, Controller &controller,
 	                     Integrator &integrator,
 	                     const WorkingParameters &p = WorkingParameters(),
 	                     Time tDelta = Time(-1), Time tEnd = MAX_TIME,
-	                     const State &s0 = State(), Time tLastSpike = Time(-1))
+	                     const State &s0 = State(), Time tLastSpike = Time(-1),
+	                     Statistics stats = Statistics())
 	{
 		if (useIfCondExp) {
 			simulate<Flags | IF_COND_EXP>(spikes, recorder, controller,
 			                              integrator, p, tDelta, tEnd, s0,
-			                              tLastSpike);
+			                              tLastSpike, stats);
 		} else {
 			simulate<Flags>(spikes, recorder, controller, integrator, p, tDelta,
-			                tEnd, s0, tLastSpike);
+			                tEnd, s0, tLastSpike, stats);
 		}
 	}
 };
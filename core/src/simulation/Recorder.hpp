@@ -29,9 +29,11 @@
 #define _ADEXPSIM_RECORDER_HPP_
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 #include <common/Types.hpp>
 
@@ -973,6 +975,150 @@ public:
 	}
 };
 
+/**
+ * A single sample of a recorded membrane potential trace.
+ */
+struct TraceSample {
+	/**
+	 * Time of the sample in seconds.
+	 */
+	Val t;
+
+	/**
+	 * Absolute membrane potential in volts.
+	 */
+	Val v;
+
+	TraceSample(Val t = 0.0, Val v = 0.0) : t(t), v(v) {}
+};
+
+/**
+ * Vector of trace samples, sorted by time.
+ */
+using TraceVec = std::vector<TraceSample>;
+
+/**
+ * Recorder which compares the simulated membrane potential to a reference
+ * trace while the simulation is running. The membrane potential is linearly
+ * interpolated between two regular integration steps, the simulated trace
+ * itself is never stored. Only meaningful for simulations without output
+ * spikes, as the reset is interpolated as well.
+ */
+class TraceErrorRecorder : public NullRecorder {
+private:
+	/**
+	 * Pointer at the reference trace.
+	 */
+	const TraceVec *reference;
+
+	/**
+	 * Leak reversal potential, added to the simulated membrane potential.
+	 */
+	Val eL;
+
+	/**
+	 * Initial state of the neuron.
+	 */
+	State s0;
+
+	/**
+	 * Index of the next reference sample.
+	 */
+	size_t idx;
+
+	/**
+	 * Sum of the squared errors of all processed reference samples.
+	 */
+	double sum;
+
+	/**
+	 * Time and state from the last regular call to "record".
+	 */
+	Time lastTime;
+	State lastState;
+
+	/**
+	 * Adds the squared error of the next reference sample.
+	 */
+	void accumulate(Val v)
+	{
+		const double r = double(v) + eL - (*reference)[idx++].v;
+		sum += r * r;
+	}
+
+public:
+	/**
+	 * Constructor of the TraceErrorRecorder class.
+	 *
+	 * @param reference is the reference trace. Must outlive the recorder.
+	 * @param eL is the leak reversal potential.
+	 * @param s0 is the initial state of the simulation.
+	 */
+	TraceErrorRecorder(const TraceVec &reference, Val eL,
+	                   const State &s0 = State())
+	    : reference(&reference), eL(eL), s0(s0)
+	{
+		reset();
+	}
+
+	/**
+	 * Resets the recorder to its initial state.
+	 */
+	void reset()
+	{
+		idx = 0;
+		sum = 0.0;
+		lastTime = Time(0);
+		lastState = s0;
+	}
+
+	/**
+	 * Processes all reference samples up to the current time. Input spikes
+	 * do not change the membrane potential, so special events are ignored.
+	 */
+	void record(Time t, const State &s, const AuxiliaryState &, bool special)
+	{
+		if (special) {
+			return;
+		}
+		const size_t n = reference->size();
+		const double ts = t.sec();
+		const double t0 = lastTime.sec();
+		while (idx < n && (*reference)[idx].t <= ts) {
+			const Val alpha =
+			    (ts > t0) ? std::max(0.0, ((*reference)[idx].t - t0) / (ts - t0))
+			              : 1.0;
+			accumulate(lastState.v() + alpha * (s.v() - lastState.v()));
+		}
+		lastTime = t;
+		lastState = s;
+	}
+
+	/**
+	 * Processes the reference samples after the end of the simulation using
+	 * the last state. Call once the simulation has finished.
+	 */
+	void finish()
+	{
+		while (idx < reference->size()) {
+			accumulate(lastState.v());
+		}
+	}
+
+	/**
+	 * Returns the sum of the squared errors in V^2.
+	 */
+	double sumSquaredError() const { return sum; }
+
+	/**
+	 * Returns the root mean square error in volts.
+	 */
+	Val rmse() const
+	{
+		return reference->empty() ? 0.0 : std::sqrt(sum / reference->size());
+	}
+};
+
 template <typename... Recorders>
 class MultiRecorder : public NullRecorder {
 };
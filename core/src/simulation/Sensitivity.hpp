@@ -0,0 +1,279 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Sensitivity.hpp
+ *
+ * Contains a variant of the model simulation which additionally integrates the
+ * forward sensitivity equations, i.e. the derivatives of the neuron state with
+ * respect to a subset of the working parameters.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SENSITIVITY_HPP_
+#define _ADEXPSIM_SENSITIVITY_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <common/FastMath.hpp>
+
+#include "Model.hpp"
+
+namespace AdExpSim {
+/**
+ * The Sensitivity class contains the static function "simulate", which
+ * simulates the neuron in the same way as Model::simulate and additionally
+ * integrates the derivatives dState/dp for the given working parameter
+ * dimensions p. The sensitivities are integrated with the same fixed-step
+ * fourth-order Runge-Kutta scheme as the state itself, so they are the exact
+ * derivatives of the discretized solution.
+ *
+ * Only the subthreshold dynamics are supported: the model must be simulated
+ * with the DISABLE_SPIKING flag and special input spikes are not processed.
+ * The dependency of the derived parameters maxIThExponent and eSpikeEffRed on
+ * the other parameters is neglected.
+ */
+class Sensitivity {
+private:
+	/**
+	 * Calculates the derivative of the state and of all sensitivities.
+	 *
+	 * @param s is the current state.
+	 * @param ds points at the current sensitivities, one per dimension.
+	 * @param res points at the array the sensitivity derivatives are written
+	 * to.
+	 * @param p is the working parameter set.
+	 * @param dims contains the indices of the parameters the sensitivities
+	 * belong to.
+	 * @return the derivative of the state.
+	 */
+	template <uint8_t Flags>
+	static State df(const State &s, const State *ds, State *res,
+	                const WorkingParameters &p, const std::vector<size_t> &dims)
+	{
+		constexpr bool useITh =
+		    !((Flags & Model::DISABLE_ITH) || (Flags & Model::IF_COND_EXP));
+		constexpr bool useAdaptation = !(Flags & Model::IF_COND_EXP);
+
+		// Calculate the derivative of the state itself
+		const AuxiliaryState as = Model::aux<Flags>(s, p);
+		const State f = Model::df<Flags>(s, as, p, false);
+
+		// Partial derivatives of dvTh, which is proportional to
+		// exp((v - eTh) / deltaTh). The derivative with respect to v vanishes
+		// wherever the exponent is clamped.
+		Val dvThDv = 0.0, dvThDlL = 0.0, dvThDeTh = 0.0, dvThDDeltaTh = 0.0;
+		if (useITh) {
+			const Val exponent = (s.v() - p.eTh()) * p.invDeltaTh();
+			const bool clamped = (Flags & Model::CLAMP_ITH)
+			                         ? s.v() > p.eSpikeEffRed()
+			                         : exponent > p.maxIThExponent();
+			const Val x = (Flags & Model::CLAMP_ITH)
+			                  ? (std::min(p.eSpikeEffRed(), s.v()) - p.eTh()) *
+			                        p.invDeltaTh()
+			                  : std::min(p.maxIThExponent(), exponent);
+			const Val e = (Flags & Model::FAST_EXP) ? fast::exp(x) : exp(x);
+			const Val dvTh = as.dvTh();
+			dvThDlL = -p.deltaTh() * e;
+			if (!clamped) {
+				dvThDv = dvTh * p.invDeltaTh();
+			}
+			if (!clamped || (Flags & Model::CLAMP_ITH)) {
+				dvThDeTh = -dvTh * p.invDeltaTh();
+				dvThDDeltaTh = dvTh * p.invDeltaTh() * (Val(1.0) - x);
+			} else {
+				dvThDDeltaTh = dvTh * p.invDeltaTh();
+			}
+		}
+
+		// Calculate the derivative of each sensitivity: the Jacobian of the
+		// state derivative applied to the sensitivity plus the partial
+		// derivative of the state derivative with respect to the parameter
+		const Val dvDv = -(p.lL() + s.lE() + s.lI() + dvThDv);
+		const Val dvDlE = -(s.v() - p.eE());
+		const Val dvDlI = -(s.v() - p.eI());
+		for (size_t k = 0; k < dims.size(); k++) {
+			const State &d = ds[k];
+			State r(dvDv * d.v() + dvDlE * d.lE() + dvDlI * d.lI() - d.dvW(),
+			        -p.lE() * d.lE(), -p.lI() * d.lI(),
+			        useAdaptation ? (p.lA() * d.v() - d.dvW()) * p.lW() : 0.0);
+			switch (dims[k]) {
+				case WorkingParameters::idx_lL:
+					r.v() -= s.v() + dvThDlL;
+					break;
+				case WorkingParameters::idx_lE:
+					r.lE() -= s.lE();
+					break;
+				case WorkingParameters::idx_lI:
+					r.lI() -= s.lI();
+					break;
+				case WorkingParameters::idx_lW:
+					if (useAdaptation) {
+						r.dvW() -= s.dvW() - p.lA() * s.v();
+					}
+					break;
+				case WorkingParameters::idx_eE:
+					r.v() += s.lE();
+					break;
+				case WorkingParameters::idx_eI:
+					r.v() += s.lI();
+					break;
+				case WorkingParameters::idx_eTh:
+					r.v() -= dvThDeTh;
+					break;
+				case WorkingParameters::idx_deltaTh:
+					r.v() -= dvThDDeltaTh;
+					break;
+				case WorkingParameters::idx_lA:
+					if (useAdaptation) {
+						r.dvW() += s.v() * p.lW();
+					}
+					break;
+			}
+			res[k] = r;
+		}
+		return f;
+	}
+
+public:
+	/**
+	 * Performs a single neuron simulation and integrates the sensitivities of
+	 * the state with respect to the given parameter dimensions.
+	 *
+	 * @param spikes is a vector containing the input spikes, sorted by time.
+	 * @param dims contains the indices of the working parameters for which the
+	 * sensitivities should be calculated.
+	 * @param callback is called with the current time, the current state and
+	 * a reference at the vector containing the current sensitivities (one
+	 * State instance per dimension) for the initial state and after each
+	 * integration step.
+	 * @param p contains the working parameters.
+	 * @param tDelta is the fixed timestep that should be used. If set to a
+	 * value smaller or equal to zero, the timestep is chosen automatically.
+	 * @param tEnd is the time at which the simulation will end.
+	 * @param s0 is the initial state of the neuron.
+	 */
+	template <uint8_t Flags, typename Callback>
+	static void simulate(const SpikeVec &spikes,
+	                     const std::vector<size_t> &dims, Callback callback,
+	                     const WorkingParameters &p, Time tDelta, Time tEnd,
+	                     const State &s0 = State())
+	{
+		static_assert(Flags & Model::DISABLE_SPIKING,
+		              "Sensitivity::simulate requires DISABLE_SPIKING");
+		static_assert(!(Flags & Model::PROCESS_SPECIAL),
+		              "Sensitivity::simulate cannot process special spikes");
+
+		if (tDelta <= Time(0)) {
+			tDelta = Time::sec(p.tDelta());
+		}
+
+		// Allocate the sensitivities and the Runge-Kutta stages once
+		const size_t nDims = dims.size();
+		std::vector<State> ds(nDims), dsTmp(nDims), k1(nDims), k2(nDims),
+		    k3(nDims), k4(nDims);
+
+		const size_t nSpikes = spikes.size();
+		size_t spikeIdx = 0;
+
+		State s = s0;
+		Time t;
+		callback(t, s, ds);
+		while (t < tEnd && t >= Time(0)) {
+			// Handle incomming spikes. Only the sensitivity with respect to
+			// the weight w jumps, as the increment is spike.w * p.w()
+			Time nextSpikeTime =
+			    (spikeIdx < nSpikes) ? spikes[spikeIdx].t : tEnd;
+			if (nextSpikeTime <= t) {
+				const Spike &spike = spikes[spikeIdx++];
+				const Val w = spike.w * p.w();
+				if (w > 0) {
+					s.lE() += w;
+				} else {
+					s.lI() -= w;
+				}
+				for (size_t k = 0; k < nDims; k++) {
+					if (dims[k] == WorkingParameters::idx_w) {
+						if (w > 0) {
+							ds[k].lE() += spike.w;
+						} else {
+							ds[k].lI() -= spike.w;
+						}
+					}
+				}
+				continue;
+			}
+
+			// Perform a fourth-order Runge-Kutta step of the augmented system
+			const Time tStep = std::min(tDelta, nextSpikeTime - t);
+			const Val h = tStep.sec();
+			const State f1 = h * df<Flags>(s, ds.data(), k1.data(), p, dims);
+			for (size_t k = 0; k < nDims; k++) {
+				k1[k] = h * k1[k];
+				dsTmp[k] = fmadd(0.5f, k1[k], ds[k]);
+			}
+			const State f2 = h * df<Flags>(fmadd(0.5f, f1, s), dsTmp.data(),
+			                               k2.data(), p, dims);
+			for (size_t k = 0; k < nDims; k++) {
+				k2[k] = h * k2[k];
+				dsTmp[k] = fmadd(0.5f, k2[k], ds[k]);
+			}
+			const State f3 = h * df<Flags>(fmadd(0.5f, f2, s), dsTmp.data(),
+			                               k3.data(), p, dims);
+			for (size_t k = 0; k < nDims; k++) {
+				k3[k] = h * k3[k];
+				dsTmp[k] = ds[k] + k3[k];
+			}
+			const State f4 =
+			    h * df<Flags>(s + f3, dsTmp.data(), k4.data(), p, dims);
+			s = fmadd(1.0f / 6.0f, fmadd(2.0f, f2 + f3, f1 + f4), s);
+			for (size_t k = 0; k < nDims; k++) {
+				ds[k] = fmadd(1.0f / 6.0f,
+				              fmadd(2.0f, k2[k] + k3[k], fmadd(h, k4[k], k1[k])),
+				              ds[k]);
+			}
+			t += tStep;
+
+			callback(t, s, ds);
+		}
+	}
+
+	/**
+	 * Runs simulate() with or without the IF_COND_EXP flag, depending on the
+	 * value of useIfCondExp.
+	 */
+	template <uint8_t Flags, typename Callback>
+	static void simulate(bool useIfCondExp, const SpikeVec &spikes,
+	                     const std::vector<size_t> &dims, Callback callback,
+	                     const WorkingParameters &p, Time tDelta, Time tEnd,
+	                     const State &s0 = State())
+	{
+		if (useIfCondExp) {
+			simulate<Flags | Model::IF_COND_EXP>(spikes, dims, callback, p,
+			                                     tDelta, tEnd, s0);
+		} else {
+			simulate<Flags>(spikes, dims, callback, p, tDelta, tEnd, s0);
+		}
+	}
+};
+}
+
+#endif /* _ADEXPSIM_SENSITIVITY_HPP_ */
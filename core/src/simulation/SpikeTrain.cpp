@@ -17,7 +17,11 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <random>
+#include <vector>
+
+#include <common/Random.hpp>
 
 #include "SpikeTrain.hpp"
 
@@ -26,19 +30,22 @@ namespace AdExpSim {
 /* Static functions */
 
 /**
- * Used internally to initialize a default_random_engine instance with the value
- * at the given seed.
+ * Used internally to initialize a RandomStream instance with the value at the
+ * given seed. If seed is nullptr, a global seed is used. Either seed is
+ * advanced, so subsequent calls use different streams.
  */
-static std::default_random_engine initializeRandomEngine(size_t *seed)
+static RandomStream initializeRandomStream(size_t *seed)
 {
-	std::default_random_engine gen;
-
-	static size_t internalSeed = 22294529;
-	seed = seed ? seed : &internalSeed;
-	gen.seed(*seed);
-	*seed += 4781536;  // Advance the seed by some number
+	static std::atomic<size_t> internalSeed(22294529);
 
-	return gen;
+	// Advance the seed by some number
+	static constexpr size_t SEED_STEP = 4781536;
+	if (!seed) {
+		return RandomStream(internalSeed.fetch_add(SEED_STEP));
+	}
+	const size_t res = *seed;
+	*seed += SEED_STEP;
+	return RandomStream(res);
 }
 
 /**
@@ -79,30 +86,34 @@ SpikeVec &buildSpikeGroup(SpikeVec &spikes, Val w, size_t nBursts,
 	const Time deltaTEqn = Time(2 * (env.sigmaT.t + env.sigmaTOffs.t) /
 	                            std::max<size_t>(1, nBursts));
 
-	// Random number generator
-	std::default_random_engine gen = initializeRandomEngine(seed);
-	std::normal_distribution<> distT(0, env.sigmaT.sec());
-	std::normal_distribution<> distTOffs(0, env.sigmaTOffs.sec());
-	std::normal_distribution<> distW(w, env.sigmaW);
+	// Draw all random numbers at once
+	RandomStream gen = initializeRandomStream(seed);
+	const size_t nSpikes = env.burstSize * nBursts;
+	std::vector<Val> tOffs(env.burstSize), tJitter(nSpikes), ws(nSpikes);
+	if (!equidistant) {
+		gen.normal(tOffs.data(), tOffs.size(), 0.0, env.sigmaTOffs.sec());
+		gen.normal(tJitter.data(), tJitter.size(), 0.0, env.sigmaT.sec());
+	}
+	gen.normal(ws.data(), ws.size(), w, env.sigmaW);
 
 	// Iterate over each spike in the burst
 	for (size_t i = 0; i < env.burstSize; i++) {
 		// Realise each spike nBursts times, either adding some jitter or
 		// distributing them equidistantly
-		const Time tOffs = equidistant ? 0_s : Time::sec(distTOffs(gen));
-		const Time tBase = t0 + tOffs + Time(env.deltaT.t * i);
+		const Time tBase = t0 + Time::sec(tOffs[i]) + Time(env.deltaT.t * i);
 		for (size_t j = 0; j < nBursts; j++) {
 			// Choose a spike time
+			const size_t k = i * nBursts + j;
 			Time t;
 			if (equidistant) {
 				t = tBase + Time(deltaTEqn.t * j);
 			} else {
-				t = tBase + Time::sec(distT(gen));
+				t = tBase + Time::sec(tJitter[k]);
 			}
 			updateMinMax(t, tMin, tMax);
 
 			// Insert the spike into the list
-			spikes.emplace_back(t, distW(gen));
+			spikes.emplace_back(t, ws[k]);
 		}
 	}
 
@@ -150,7 +161,7 @@ SpikeVec &SingleGroupSingleOutDescriptor::build(
 
 /* Class SpikeTrain */
 
-void SpikeTrain::rebuild()
+void SpikeTrain::build(size_t *seed)
 {
 	// Clear all internal lists
 	spikes.clear();
@@ -167,7 +178,7 @@ void SpikeTrain::rebuild()
 	}
 
 	// Distribution used to fetch the descriptors
-	std::default_random_engine gen = initializeRandomEngine(nullptr);
+	RandomStream gen = initializeRandomStream(seed);
 	std::uniform_int_distribution<> distDescr(0, nDescrs - 1);
 
 	// Iterate over all spike trains that should be generated
@@ -182,9 +193,9 @@ void SpikeTrain::rebuild()
 		// Generate the inhibitory and the excitatory spikes
 		Time tMin = MAX_TIME, tMax = MIN_TIME;
 		descr.build(spikes, Spike::Type::EXCITATORY, env, equidistant, t, &tMin,
-		            &tMax);
+		            &tMax, seed);
 		descr.build(spikes, Spike::Type::INHIBITORY, env, equidistant, t, &tMin,
-		            &tMax);
+		            &tMax, seed);
 
 		// Remember the first spike as a "range start spike", add a range for
 		// the group
@@ -211,6 +222,26 @@ void SpikeTrain::rebuild()
 	}
 }
 
+SpikeTrain SpikeTrain::truncate(size_t n) const
+{
+	// Return a plain copy if all groups should be kept
+	if (ranges.empty() || n + 1 >= ranges.size()) {
+		return *this;
+	}
+
+	// Copy the ranges and spikes of the first n groups, terminate the ranges
+	// with the start of the first removed group
+	const size_t nSpikes = rangeStartSpikes[n];
+	SpikeTrain res(*this);
+	res.spikes.assign(spikes.begin(), spikes.begin() + nSpikes);
+	res.ranges.assign(ranges.begin(), ranges.begin() + n);
+	res.ranges.emplace_back(ranges[n].start, n, 0, 0);
+	res.rangeStartSpikes.assign(rangeStartSpikes.begin(),
+	                            rangeStartSpikes.begin() + n);
+	res.n = n;
+	return res;
+}
+
 size_t SpikeTrain::getExpectedOutputSpikeCount() const
 {
 	size_t res = 0;
@@ -328,6 +328,13 @@ private:
 	 */
 	bool equidistant;
 
+	/**
+	 * Builds a new spike train using the parameters given in the constructor.
+	 * If seed is nullptr, an internal random seed is used. Otherwise the
+	 * random number generators are initialized with the given seed.
+	 */
+	void build(size_t *seed);
+
 public:
 	/**
 	 * Default constructor. Creates an empty spike train.
@@ -378,7 +385,15 @@ public:
 	/**
 	 * Builds a new spike train using the parameters given in the constructor.
 	 */
-	void rebuild();
+	void rebuild() { build(nullptr); }
+
+	/**
+	 * Builds a new spike train using the parameters given in the constructor
+	 * and the given random seed. Rebuilding with the same seed always results
+	 * in the same spike train, which allows to evaluate different parameter
+	 * sets on the same noise realization.
+	 */
+	void rebuild(size_t seed) { build(&seed); }
 
 	/**
 	 * Returns the spike train group descriptors.
@@ -464,6 +479,27 @@ public:
 		return rangeStartSpikes;
 	}
 
+	/**
+	 * Replaces the generated spikes and ranges with the given data, e.g. to
+	 * restore a spike train that was generated in another process. The data
+	 * must have been obtained from an instance with the same descriptors.
+	 */
+	void restore(const SpikeVec &spikes, const std::vector<Range> &ranges,
+	             const std::vector<size_t> &rangeStartSpikes)
+	{
+		this->spikes = spikes;
+		this->ranges = ranges;
+		this->rangeStartSpikes = rangeStartSpikes;
+	}
+
+	/**
+	 * Returns a copy of this spike train which only contains the first n spike
+	 * groups. The last range of the copy ends at the start of the first
+	 * removed group, the remaining groups are evaluated in the same time
+	 * windows as in the complete spike train.
+	 */
+	SpikeTrain truncate(size_t n) const;
+
 	/**
 	 * Returns the number of expected output spikes.
 	 */
@@ -0,0 +1,250 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file Statistics.hpp
+ *
+ * Contains classes which can be passed to Model::simulate in order to collect
+ * instrumentation counters (number of integrator steps, derivative evaluations,
+ * spikes and the reason the simulation ended). The default NullStatistics class
+ * consists of empty inline functions only, so the instrumentation code is
+ * completely removed by the compiler if statistics are not requested.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_STATISTICS_HPP_
+#define _ADEXPSIM_STATISTICS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace AdExpSim {
+
+/**
+ * Reason why a simulation ended.
+ */
+enum class TerminationReason : int {
+	/**
+	 * The simulation reached the end time tEnd.
+	 */
+	END_TIME = 0,
+
+	/**
+	 * The controller returned ABORT.
+	 */
+	CONTROLLER_ABORT = 1,
+
+	/**
+	 * The controller returned MAY_CONTINUE and all input spikes have been
+	 * processed.
+	 */
+	CONTROLLER_SETTLED = 2,
+
+	/**
+	 * The simulation time overflowed.
+	 */
+	TIME_OVERFLOW = 3
+};
+
+/**
+ * Structure holding the counters collected for one or more simulations.
+ */
+struct SimulationStatistics {
+	/**
+	 * Number of termination reasons.
+	 */
+	static constexpr size_t N_TERMINATION_REASONS = 4;
+
+	/**
+	 * Number of simulations that have been run.
+	 */
+	uint64_t simulations;
+
+	/**
+	 * Number of accepted integrator steps.
+	 */
+	uint64_t steps;
+
+	/**
+	 * Number of steps rejected by an adaptive stepsize integrator.
+	 */
+	uint64_t rejectedSteps;
+
+	/**
+	 * Number of evaluations of the right-hand side of the differential
+	 * equation. This is the best measure for the computational cost of a
+	 * simulation.
+	 */
+	uint64_t rhsEvaluations;
+
+	/**
+	 * Number of processed input spikes.
+	 */
+	uint64_t inputSpikes;
+
+	/**
+	 * Number of generated output spikes.
+	 */
+	uint64_t outputSpikes;
+
+	/**
+	 * Number of simulations which ended for each of the TerminationReason
+	 * values.
+	 */
+	std::array<uint64_t, N_TERMINATION_REASONS> terminations;
+
+	/**
+	 * Default constructor, resets all counters to zero.
+	 */
+	SimulationStatistics() { reset(); }
+
+	/**
+	 * Resets all counters to zero.
+	 */
+	void reset()
+	{
+		simulations = 0;
+		steps = 0;
+		rejectedSteps = 0;
+		rhsEvaluations = 0;
+		inputSpikes = 0;
+		outputSpikes = 0;
+		terminations.fill(0);
+	}
+
+	/**
+	 * Returns the number of simulations that ended for the given reason.
+	 */
+	uint64_t termination(TerminationReason reason) const
+	{
+		return terminations[size_t(reason)];
+	}
+
+	/**
+	 * Adds the counters of another statistics instance to this instance.
+	 */
+	SimulationStatistics &operator+=(const SimulationStatistics &o)
+	{
+		simulations += o.simulations;
+		steps += o.steps;
+		rejectedSteps += o.rejectedSteps;
+		rhsEvaluations += o.rhsEvaluations;
+		inputSpikes += o.inputSpikes;
+		outputSpikes += o.outputSpikes;
+		for (size_t i = 0; i < N_TERMINATION_REASONS; i++) {
+			terminations[i] += o.terminations[i];
+		}
+		return *this;
+	}
+};
+
+namespace StatisticsInternal {
+/*
+ * Fetches the number of rejected steps from an integrator, if the integrator
+ * provides a "rejectedSteps" method, otherwise returns zero.
+ */
+
+template <typename Integrator>
+static inline auto rejectedSteps(const Integrator &integrator, int)
+    -> decltype(uint64_t(integrator.rejectedSteps()))
+{
+	return integrator.rejectedSteps();
+}
+
+template <typename Integrator>
+static inline uint64_t rejectedSteps(const Integrator &, long)
+{
+	return 0;
+}
+}
+
+/**
+ * The NullStatistics class is the default statistics sink used by
+ * Model::simulate. All methods are empty and are optimized away.
+ */
+class NullStatistics {
+public:
+	template <typename Integrator>
+	void begin(const Integrator &)
+	{
+	}
+
+	void step() {}
+	void rhs() {}
+	void inputSpike() {}
+	void outputSpike() {}
+
+	template <typename Integrator>
+	void end(const Integrator &, TerminationReason)
+	{
+	}
+};
+
+/**
+ * The StatisticsCollector class is a lightweight handle (it is passed by value
+ * to Model::simulate) which adds the counters of each simulation to a
+ * SimulationStatistics instance.
+ */
+class StatisticsCollector {
+private:
+	/**
+	 * Statistics instance to which the counters are added.
+	 */
+	SimulationStatistics *stats;
+
+	/**
+	 * Number of rejected steps reported by the integrator at the beginning of
+	 * the simulation.
+	 */
+	uint64_t rejectedSteps0;
+
+public:
+	/**
+	 * Creates a new StatisticsCollector which writes to the given statistics
+	 * instance.
+	 */
+	StatisticsCollector(SimulationStatistics &stats)
+	    : stats(&stats), rejectedSteps0(0)
+	{
+	}
+
+	template <typename Integrator>
+	void begin(const Integrator &integrator)
+	{
+		rejectedSteps0 = StatisticsInternal::rejectedSteps(integrator, 0);
+		stats->simulations++;
+	}
+
+	void step() { stats->steps++; }
+	void rhs() { stats->rhsEvaluations++; }
+	void inputSpike() { stats->inputSpikes++; }
+	void outputSpike() { stats->outputSpikes++; }
+
+	template <typename Integrator>
+	void end(const Integrator &integrator, TerminationReason reason)
+	{
+		stats->rejectedSteps +=
+		    StatisticsInternal::rejectedSteps(integrator, 0) - rejectedSteps0;
+		stats->terminations[size_t(reason)]++;
+	}
+};
+}
+
+#endif /* _ADEXPSIM_STATISTICS_HPP_ */
@@ -18,6 +18,7 @@
 
 #include <QAction>
 #include <QComboBox>
+#include <QEvent>
 #include <QFileDialog>
 #include <QVBoxLayout>
 #include <QToolBar>
@@ -114,6 +115,10 @@ void ExplorationWindow::createWidgets()
 	        SLOT(handleUpdateRange(size_t, size_t, Val, Val, Val, Val)));
 	connect(incrementalExploration, SIGNAL(progress(float, bool)), this,
 	        SLOT(handleProgress(float, bool)));
+	connect(incrementalExploration,
+	        SIGNAL(tile(ExplorationTile, DiscreteRange, DiscreteRange)),
+	        explorationWidget,
+	        SLOT(addTile(ExplorationTile, DiscreteRange, DiscreteRange)));
 
 	// Connect the actions
 	connect(actLockView, SIGNAL(triggered(bool)), this,
@@ -238,6 +243,38 @@ void ExplorationWindow::unlock()
 
 bool ExplorationWindow::isLocked() { return actLockView->isChecked(); }
 
+void ExplorationWindow::updatePriority()
+{
+	if (!isVisible() || isMinimized()) {
+		incrementalExploration->setPriority(JobPriority::HIDDEN);
+	} else if (isActiveWindow()) {
+		incrementalExploration->setPriority(JobPriority::FOCUSED);
+	} else {
+		incrementalExploration->setPriority(JobPriority::VISIBLE);
+	}
+}
+
+void ExplorationWindow::changeEvent(QEvent *event)
+{
+	AbstractViewerWindow::changeEvent(event);
+	if (event->type() == QEvent::ActivationChange ||
+	    event->type() == QEvent::WindowStateChange) {
+		updatePriority();
+	}
+}
+
+void ExplorationWindow::showEvent(QShowEvent *event)
+{
+	AbstractViewerWindow::showEvent(event);
+	updatePriority();
+}
+
+void ExplorationWindow::hideEvent(QHideEvent *event)
+{
+	AbstractViewerWindow::hideEvent(event);
+	incrementalExploration->setPriority(JobPriority::HIDDEN);
+}
+
 void ExplorationWindow::handleSavePdf()
 {
 	QString fileName = QFileDialog::getSaveFileName(this, "Save PDF", QString(),
@@ -35,6 +35,9 @@
 class QAction;
 class QToolbar;
 class QComboBox;
+class QEvent;
+class QHideEvent;
+class QShowEvent;
 
 namespace AdExpSim {
 
@@ -77,6 +80,12 @@ private:
 	void createModel();
 	void createWidgets();
 
+	/**
+	 * Updates the scheduling priority of the incremental exploration according
+	 * to the current focus and visibility of the window.
+	 */
+	void updatePriority();
+
 private slots:
 	/**
 	 * Called whenever new Exploration data is available from the
@@ -122,6 +131,11 @@ private slots:
 	 */
 	void handle3DSurfacePlot();
 
+protected:
+	void changeEvent(QEvent *event) override;
+	void showEvent(QShowEvent *event) override;
+	void hideEvent(QHideEvent *event) override;
+
 public slots:
 	void lock();
 	void unlock();
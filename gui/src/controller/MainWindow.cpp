@@ -22,6 +22,7 @@
 #include <QAction>
 #include <QComboBox>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMenu>
 #include <QMenuBar>
 #include <QMessageBox>
@@ -34,6 +35,7 @@
 #include <QVBoxLayout>
 
 #include <io/JsonIo.hpp>
+#include <model/ComputeBackend.hpp>
 #include <simulation/Parameters.hpp>
 #include <simulation/Spike.hpp>
 #include <utils/ParameterCollection.hpp>
@@ -108,6 +110,11 @@ void MainWindow::createActions()
 	connect(actExportPyNNESS, SIGNAL(triggered()), this,
 	        SLOT(handleExportPyNNESS()));
 
+	actComputeServer = new QAction(QIcon::fromTheme("network-server"),
+	                               tr("Compute server..."), this);
+	connect(actComputeServer, SIGNAL(triggered()), this,
+	        SLOT(handleComputeServer()));
+
 	actExit = new QAction(tr("Exit"), this);
 	connect(actExit, SIGNAL(triggered()), this, SLOT(close()));
 }
@@ -125,6 +132,8 @@ void MainWindow::createMenus()
 	fileMenu->addAction(actSaveParameters);
 	fileMenu->addAction(actSaveExploration);
 	fileMenu->addSeparator();
+	fileMenu->addAction(actComputeServer);
+	fileMenu->addSeparator();
 	fileMenu->addAction(actExit);
 
 	QMenu *exportMenu = new QMenu(tr("&Export"), this);
@@ -354,5 +363,18 @@ void MainWindow::handleExportPyNN(bool nest)
 void MainWindow::handleExportPyNNESS() { handleExportPyNN(false); }
 
 void MainWindow::handleExportPyNNNest() { handleExportPyNN(true); }
-}
 
+void MainWindow::handleComputeServer()
+{
+	ComputeBackend &backend = ComputeBackend::inst();
+	bool ok;
+	QString address = QInputDialog::getText(
+	    this, tr("Compute server"),
+	    tr("Server address (unix:PATH or HOST:PORT), leave empty to compute "
+	       "locally:"),
+	    QLineEdit::Normal, QString::fromStdString(backend.address()), &ok);
+	if (ok) {
+		backend.setAddress(address.trimmed().toStdString());
+	}
+}
+}
@@ -68,6 +68,7 @@ private:
 	QAction *actSaveParameters;
 	QAction *actExportPyNNNest;
 	QAction *actExportPyNNESS;
+	QAction *actComputeServer;
 	QAction *actExit;
 
 	/* Experiment parameters */
@@ -104,6 +105,7 @@ private slots:
 	void handleExportPyNNNest();
 	void handleExportPyNNESS();
 	void handleExportPyNN(bool nest);
+	void handleComputeServer();
 
 protected:
 	void closeEvent(QCloseEvent *event) override;
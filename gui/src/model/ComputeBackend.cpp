@@ -0,0 +1,49 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+
+#include <io/ResultStore.hpp>
+
+#include "ComputeBackend.hpp"
+
+namespace AdExpSim {
+
+ComputeBackend::ComputeBackend()
+{
+	const char *address = getenv("ADEXPSIM_SERVER");
+	if (address != nullptr) {
+		mAddress = address;
+	}
+
+	// Open the persistent result store
+	const std::string filename = ResultStore::defaultFilename();
+	if (!filename.empty()) {
+		auto resultStore = std::make_shared<ResultStore>(filename);
+		if (resultStore->good()) {
+			mResultCache = resultStore;
+		}
+	}
+}
+
+ComputeBackend &ComputeBackend::inst()
+{
+	static ComputeBackend instance;
+	return instance;
+}
+}
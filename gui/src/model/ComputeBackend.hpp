@@ -0,0 +1,100 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ComputeBackend.hpp
+ *
+ * Contains the ComputeBackend class, which selects whether explorations and
+ * optimizations are computed locally or on a remote compute server.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_COMPUTE_BACKEND_HPP_
+#define _ADEXPSIM_COMPUTE_BACKEND_HPP_
+
+#include <memory>
+#include <string>
+
+namespace AdExpSim {
+
+// Forward declaration
+class ResultCache;
+
+/**
+ * The ComputeBackend class is the application-wide setting specifying where
+ * background jobs are computed. If a server address is set, new explorations
+ * and optimizations are sent to the AdExpServer instance listening on that
+ * address, otherwise (or if the server is not reachable) they are computed
+ * locally. The initial address is read from the ADEXPSIM_SERVER environment
+ * variable.
+ *
+ * Locally computed results are kept in a persistent result store, so that
+ * rerunning an exploration or optimization with the same settings (e.g. after
+ * loading a preset) is nearly instant. The store is opt-in, it is only used if
+ * the ADEXPSIM_RESULT_STORE environment variable contains its path.
+ *
+ * All methods must be called from the GUI thread.
+ */
+class ComputeBackend {
+private:
+	/**
+	 * Address of the compute server, empty for local computation.
+	 */
+	std::string mAddress;
+
+	/**
+	 * Persistent result store shared by all local jobs, nullptr if disabled.
+	 */
+	std::shared_ptr<ResultCache> mResultCache;
+
+	ComputeBackend();
+
+public:
+	/**
+	 * Returns the application-wide ComputeBackend instance.
+	 */
+	static ComputeBackend &inst();
+
+	/**
+	 * Sets the address of the compute server, see RemoteConnection::connect()
+	 * for the format. An empty string selects local computation. Only affects
+	 * jobs which are started afterwards.
+	 */
+	void setAddress(const std::string &address) { mAddress = address; }
+
+	/**
+	 * Returns the address of the compute server, empty if jobs are computed
+	 * locally.
+	 */
+	const std::string &address() const { return mAddress; }
+
+	/**
+	 * Returns true if jobs should be sent to a compute server.
+	 */
+	bool remote() const { return !mAddress.empty(); }
+
+	/**
+	 * Returns the result cache which should be passed to locally computed
+	 * jobs, nullptr if the result store is disabled or could not be opened.
+	 */
+	std::shared_ptr<ResultCache> resultCache() const { return mResultCache; }
+};
+}
+
+#endif /* _ADEXPSIM_COMPUTE_BACKEND_HPP_ */
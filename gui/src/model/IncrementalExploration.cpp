@@ -25,8 +25,10 @@
 #include <exploration/SpikeTrainEvaluation.hpp>
 #include <exploration/SingleGroupSingleOutEvaluation.hpp>
 #include <exploration/SingleGroupMultiOutEvaluation.hpp>
+#include <io/RemoteIo.hpp>
 #include <utils/ParameterCollection.hpp>
 
+#include "ComputeBackend.hpp"
 #include "IncrementalExploration.hpp"
 
 namespace AdExpSim {
@@ -37,7 +39,10 @@ namespace AdExpSim {
 
 IncrementalExplorationRunner::IncrementalExplorationRunner(
     Exploration &exploration, std::shared_ptr<ParameterCollection> params)
-    : aborted(false), exploration(exploration), params(params)
+    : aborted(false),
+      exploration(exploration),
+      params(params),
+      server(ComputeBackend::inst().address())
 {
 	setAutoDelete(false);
 }
@@ -54,25 +59,44 @@ void IncrementalExplorationRunner::run()
 		emit progress(p);
 		return !aborted.load();
 	};
+	auto tileCallback = [&](const ExplorationTile &t) {
+		if (!aborted.load()) {
+			emit tile(t);
+		}
+	};
+
+	// Run the exploration on the compute server if one is configured, fall
+	// back to local computation if it cannot be reached
+	if (!server.empty()) {
+		RemoteClient client(server);
+		if (client.good()) {
+			ok = client.explore(exploration, *params, progressCallback,
+			                    tileCallback);
+			emit done(ok && !aborted.load());
+			return;
+		}
+		std::cerr << "Cannot connect to compute server " << server
+		          << ", exploring locally" << std::endl;
+	}
 
 	switch (params->evaluation) {
 		case EvaluationType::SPIKE_TRAIN:
 			ok = exploration.run(
 			    SpikeTrainEvaluation(params->train,
 			                         params->model == ModelType::IF_COND_EXP),
-			    progressCallback);
+			    progressCallback, tileCallback);
 			break;
 		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
 			ok = exploration.run(SingleGroupSingleOutEvaluation(
 			                         params->environment, params->singleGroup,
 			                         params->model == ModelType::IF_COND_EXP),
-			                     progressCallback);
+			                     progressCallback, tileCallback);
 			break;
 		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
 			ok = exploration.run(SingleGroupMultiOutEvaluation(
 			                         params->environment, params->singleGroup,
 			                         params->model == ModelType::IF_COND_EXP),
-			                     progressCallback);
+			                     progressCallback, tileCallback);
 			break;
 	}
 
@@ -94,6 +118,7 @@ IncrementalExploration::IncrementalExploration(
     std::shared_ptr<ParameterCollection> params, QObject *parent)
     : QObject(parent),
       pool(new QThreadPool(this)),
+      job(JobScheduler::inst().registerJob()),
       maxLevel(MAX_LEVEL_INITIAL),
       dimX(0),
       dimY(1),
@@ -107,6 +132,8 @@ IncrementalExploration::IncrementalExploration(
       inEmitData(false),
       currentRunner(nullptr)
 {
+	qRegisterMetaType<ExplorationTile>("ExplorationTile");
+
 	updateTimer = new QTimer(this);
 	connect(updateTimer, SIGNAL(timeout()), this, SLOT(updateTimeout()));
 }
@@ -117,6 +144,7 @@ IncrementalExploration::~IncrementalExploration()
 		currentRunner->abort();
 	}
 	pool->waitForDone();
+	JobScheduler::inst().unregisterJob(job);
 }
 
 bool IncrementalExploration::isActive() const
@@ -143,6 +171,11 @@ void IncrementalExploration::setMaxLevel(int maxLevel)
 	}
 }
 
+void IncrementalExploration::setPriority(JobPriority priority)
+{
+	JobScheduler::inst().setPriority(job, priority);
+}
+
 void IncrementalExploration::start()
 {
 	// Create a new Exploration instance
@@ -150,12 +183,21 @@ void IncrementalExploration::start()
 	exploration =
 	    Exploration(params->params, dimX, dimY, DiscreteRange(minX, maxX, res),
 	                DiscreteRange(minY, maxY, res));
+	exploration.setThreadLimit(job);
+	exploration.setResultCache(ComputeBackend::inst().resultCache());
+
+	// Inform the scheduler about the level we're working on
+	JobScheduler &scheduler = JobScheduler::inst();
+	scheduler.setLevel(job, level);
+	scheduler.setActive(job, true);
 
 	// Create a new IncrementExplorationRunner and connect all signals
 	currentRunner = new IncrementalExplorationRunner(exploration, params);
 	connect(currentRunner, SIGNAL(progress(float)), this,
 	        SLOT(runnerProgress(float)));
 	connect(currentRunner, SIGNAL(done(bool)), this, SLOT(runnerDone(bool)));
+	connect(currentRunner, SIGNAL(tile(ExplorationTile)), this,
+	        SLOT(runnerTile(ExplorationTile)));
 
 	// Reset the restart flag and increment the level counter
 	restart = false;
@@ -232,10 +274,21 @@ void IncrementalExploration::runnerDone(bool ok)
 		emit progress(1.0, false);
 	}
 
-	// Start the next iteration
+	// Start the next iteration, otherwise release the threads
 	if ((level <= maxLevel && ok) || restart) {
 		start();
+	} else {
+		JobScheduler::inst().setActive(job, false);
+	}
+}
+
+void IncrementalExploration::runnerTile(ExplorationTile tile)
+{
+	// Discard tiles of a runner which is about to be restarted
+	if (restart) {
+		return;
 	}
+	emit this->tile(tile, exploration.rangeX(), exploration.rangeY());
 }
 
 void IncrementalExploration::updateRange(size_t dimX, size_t dimY, Val minX,
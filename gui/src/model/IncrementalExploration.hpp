@@ -30,10 +30,12 @@
 
 #include <atomic>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <exploration/Exploration.hpp>
 #include <common/Types.hpp>
+#include <model/JobScheduler.hpp>
 
 #include <QRunnable>
 #include <QObject>
@@ -67,6 +69,12 @@ private:
 	 */
 	std::shared_ptr<ParameterCollection> params;
 
+	/**
+	 * Address of the compute server, empty if the exploration should run
+	 * locally.
+	 */
+	std::string server;
+
 	/**
 	 * Task code, runs the exploration, triggers the done and progress signals.
 	 */
@@ -74,7 +82,8 @@ private:
 
 public:
 	/**
-	 * Constructor of the IncrementalExplorationRunner class.
+	 * Constructor of the IncrementalExplorationRunner class. Must be called
+	 * from the GUI thread, as it reads the current ComputeBackend setting.
 	 *
 	 * @param exploration is a reference at the exploration instance that should
 	 * run.
@@ -99,6 +108,13 @@ signals:
 	 */
 	void progress(float p);
 
+	/**
+	 * Signal emitted whenever a tile of the exploration grid is complete.
+	 *
+	 * @param tile contains the results for the completed part of the grid.
+	 */
+	void tile(ExplorationTile tile);
+
 	/**
 	 * Signal emitted whenever the exploration has finished.
 	 *
@@ -136,6 +152,11 @@ private:
 	 */
 	QThreadPool *pool;
 
+	/**
+	 * Handle of this exploration at the application-wide JobScheduler.
+	 */
+	JobScheduler::Handle job;
+
 	/**
 	 * Timer used to defer the calls to "update".
 	 */
@@ -209,6 +230,13 @@ private slots:
 	 */
 	void runnerDone(bool ok);
 
+	/**
+	 * Slot used to relay the tiles completed by the runner.
+	 *
+	 * @param tile contains the results for the completed part of the grid.
+	 */
+	void runnerTile(ExplorationTile tile);
+
 	/**
 	 * Method call whenever the update timer fires.
 	 */
@@ -243,6 +271,13 @@ public:
 	 */
 	int getMaxLevel() { return maxLevel; }
 
+	/**
+	 * Sets the scheduling priority of the exploration, should be updated
+	 * whenever the window showing the exploration gains or loses the focus or
+	 * is hidden.
+	 */
+	void setPriority(JobPriority priority);
+
 public slots:
 	/**
 	 * Should be called whenever the range of the exploration or the exploration
@@ -273,6 +308,17 @@ signals:
 	 * finished.
 	 */
 	void data(Exploration exploration);
+
+	/**
+	 * Signal emitted whenever a tile of the currently running resolution level
+	 * is complete. Allows to display the results before the entire level has
+	 * finished.
+	 *
+	 * @param tile contains the results for the completed part of the grid.
+	 * @param rangeX is the x-range of the grid the tile belongs to.
+	 * @param rangeY is the y-range of the grid the tile belongs to.
+	 */
+	void tile(ExplorationTile tile, DiscreteRange rangeX, DiscreteRange rangeY);
 };
 }
 
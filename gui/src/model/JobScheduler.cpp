@@ -0,0 +1,143 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "JobScheduler.hpp"
+
+namespace AdExpSim {
+
+JobScheduler::JobScheduler() { setBudget(0); }
+
+JobScheduler &JobScheduler::inst()
+{
+	static JobScheduler instance;
+	return instance;
+}
+
+JobScheduler::Job *JobScheduler::find(const Handle &handle)
+{
+	for (Job &job : jobs) {
+		if (job.limit == handle) {
+			return &job;
+		}
+	}
+	return nullptr;
+}
+
+void JobScheduler::rebalance()
+{
+	// Collect all active jobs, inactive jobs keep a single thread so they do
+	// not stall if they are started before being marked as active
+	std::vector<Job *> active;
+	for (Job &job : jobs) {
+		if (job.active) {
+			active.push_back(&job);
+		} else {
+			job.limit->set(1);
+		}
+	}
+	if (active.empty()) {
+		return;
+	}
+
+	// Sort the jobs by priority class and refinement level
+	std::stable_sort(active.begin(), active.end(),
+	                 [](const Job *a, const Job *b) {
+		return a->priority < b->priority ||
+		       (a->priority == b->priority && a->level < b->level);
+	});
+
+	// Give each job a single thread as long as the budget permits, pause all
+	// other jobs
+	size_t remaining = budget;
+	for (Job *job : active) {
+		const size_t n = std::min<size_t>(1, remaining);
+		job->limit->set(n);
+		remaining -= n;
+	}
+
+	// Split the remaining threads between the jobs of the highest priority
+	// class, hidden jobs are not granted any additional threads
+	if (active[0]->priority == JobPriority::HIDDEN) {
+		return;
+	}
+	size_t nTop = 0;
+	while (nTop < active.size() &&
+	       active[nTop]->priority == active[0]->priority) {
+		nTop++;
+	}
+	for (size_t i = 0; i < nTop; i++) {
+		const size_t n = remaining / nTop + ((i < remaining % nTop) ? 1 : 0);
+		active[i]->limit->set(active[i]->limit->get() + n);
+	}
+}
+
+JobScheduler::Handle JobScheduler::registerJob(JobPriority priority)
+{
+	Handle handle = std::make_shared<ThreadLimit>(1);
+	jobs.push_back(Job{handle, priority, 0, false});
+	return handle;
+}
+
+void JobScheduler::unregisterJob(const Handle &handle)
+{
+	jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+	                          [&handle](const Job &job) {
+		           return job.limit == handle;
+		       }),
+	           jobs.end());
+	rebalance();
+}
+
+void JobScheduler::setActive(const Handle &handle, bool active)
+{
+	Job *job = find(handle);
+	if (job != nullptr && job->active != active) {
+		job->active = active;
+		rebalance();
+	}
+}
+
+void JobScheduler::setPriority(const Handle &handle, JobPriority priority)
+{
+	Job *job = find(handle);
+	if (job != nullptr && job->priority != priority) {
+		job->priority = priority;
+		rebalance();
+	}
+}
+
+void JobScheduler::setLevel(const Handle &handle, int level)
+{
+	Job *job = find(handle);
+	if (job != nullptr && job->level != level) {
+		job->level = level;
+		rebalance();
+	}
+}
+
+void JobScheduler::setBudget(size_t budget)
+{
+	this->budget =
+	    budget > 0 ? budget
+	               : std::max<size_t>(1, std::thread::hardware_concurrency());
+	rebalance();
+}
+}
@@ -0,0 +1,168 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file JobScheduler.hpp
+ *
+ * Contains the JobScheduler class, which distributes a global CPU budget
+ * between all background jobs of the application.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_JOB_SCHEDULER_HPP_
+#define _ADEXPSIM_JOB_SCHEDULER_HPP_
+
+#include <memory>
+#include <vector>
+
+#include <common/ThreadLimit.hpp>
+
+namespace AdExpSim {
+
+/**
+ * Priority class of a job, usually derived from the state of the window the
+ * job belongs to.
+ */
+enum class JobPriority : int {
+	/**
+	 * The job belongs to the window which currently has the focus.
+	 */
+	FOCUSED = 0,
+
+	/**
+	 * The job belongs to a window which is visible on screen.
+	 */
+	VISIBLE = 1,
+
+	/**
+	 * The job belongs to a window which is minimized or hidden.
+	 */
+	HIDDEN = 2
+};
+
+/**
+ * The JobScheduler class is the application-wide instance distributing the
+ * available worker threads between the background jobs (explorations and
+ * optimizations). Each job is represented by a ThreadLimit instance which is
+ * passed to the underlying Exploration or Optimization instance. Whenever the
+ * state of a job changes, the limits of all jobs are recalculated: each
+ * active job receives one thread as long as the budget permits, jobs with a
+ * lower priority or a higher refinement level are paused once the budget is
+ * exhausted. The remaining threads are split between the jobs of the highest
+ * priority class, where jobs with a lower refinement level are preferred.
+ * Hidden jobs never receive more than one thread.
+ *
+ * All methods must be called from the GUI thread.
+ */
+class JobScheduler {
+public:
+	/**
+	 * Handle used to refer to a registered job.
+	 */
+	using Handle = std::shared_ptr<ThreadLimit>;
+
+private:
+	/**
+	 * Internal structure describing a single job.
+	 */
+	struct Job {
+		Handle limit;
+		JobPriority priority;
+		int level;
+		bool active;
+	};
+
+	/**
+	 * Total number of threads that may work at the same time.
+	 */
+	size_t budget;
+
+	/**
+	 * List of all registered jobs.
+	 */
+	std::vector<Job> jobs;
+
+	/**
+	 * Returns a pointer at the job belonging to the given handle or nullptr if
+	 * the job is not registered.
+	 */
+	Job *find(const Handle &handle);
+
+	/**
+	 * Recalculates the thread limits of all jobs.
+	 */
+	void rebalance();
+
+	/**
+	 * Private constructor, use JobScheduler::inst() to access the instance.
+	 */
+	JobScheduler();
+
+public:
+	/**
+	 * Returns the application-wide JobScheduler instance.
+	 */
+	static JobScheduler &inst();
+
+	/**
+	 * Registers a new, inactive job and returns the handle which is used to
+	 * refer to it. The ThreadLimit referenced by the handle should be passed
+	 * to the Exploration or Optimization instance run by the job.
+	 *
+	 * @param priority is the initial priority of the job.
+	 */
+	Handle registerJob(JobPriority priority = JobPriority::VISIBLE);
+
+	/**
+	 * Removes the given job from the scheduler.
+	 */
+	void unregisterJob(const Handle &handle);
+
+	/**
+	 * Marks the given job as active or inactive. Only active jobs receive a
+	 * share of the budget.
+	 */
+	void setActive(const Handle &handle, bool active);
+
+	/**
+	 * Sets the priority class of the given job.
+	 */
+	void setPriority(const Handle &handle, JobPriority priority);
+
+	/**
+	 * Sets the refinement level the given job is currently working on. Jobs
+	 * working on a coarser level are preferred, as their results are
+	 * available sooner.
+	 */
+	void setLevel(const Handle &handle, int level);
+
+	/**
+	 * Sets the total number of threads that may work at the same time. Zero
+	 * selects one thread per hardware thread (the default).
+	 */
+	void setBudget(size_t budget);
+
+	/**
+	 * Returns the total number of threads that may work at the same time.
+	 */
+	size_t getBudget() const { return budget; }
+};
+}
+
+#endif /* _ADEXPSIM_JOB_SCHEDULER_HPP_ */
@@ -16,14 +16,18 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <iostream>
+
 #include <QThreadPool>
 
 #include <exploration/SingleGroupSingleOutEvaluation.hpp>
 #include <exploration/SingleGroupMultiOutEvaluation.hpp>
 #include <exploration/SpikeTrainEvaluation.hpp>
+#include <io/RemoteIo.hpp>
 #include <utils/ParameterCollection.hpp>
 #include <simulation/HardwareParameters.hpp>
 
+#include "ComputeBackend.hpp"
 #include "OptimizationJob.hpp"
 
 namespace AdExpSim {
@@ -33,8 +37,14 @@ namespace AdExpSim {
  */
 
 OptimizationJobRunner::OptimizationJobRunner(
-    bool limitToHw, std::shared_ptr<ParameterCollection> params)
-    : aborted(false), params(params)
+    bool limitToHw, OptimizationAlgorithm algorithm,
+    std::shared_ptr<ParameterCollection> params,
+    std::shared_ptr<const ThreadLimit> limit)
+    : aborted(false),
+      params(params),
+      limitToHw(limitToHw),
+      algorithm(algorithm),
+      server(ComputeBackend::inst().address())
 {
 	// Fetch the to-be-optimized dimensions
 	const std::vector<size_t> dims = params->optimizationDims();
@@ -47,6 +57,9 @@ OptimizationJobRunner::OptimizationJobRunner(
 	} else {
 		optimization = Optimization(params->model, dims);
 	}
+	optimization.setAlgorithm(algorithm);
+	optimization.setThreadLimit(limit);
+	optimization.setResultCache(ComputeBackend::inst().resultCache());
 
 	// Do not automatically free this object once it is done
 	setAutoDelete(false);
@@ -67,14 +80,29 @@ void OptimizationJobRunner::run()
 	size_t it = 0;
 	auto progressCallback =
 	    [&](size_t nIt, size_t nInput, float eval,
-	        const std::vector<OptimizationResult> &output) -> bool {
+	        const std::vector<OptimizationResult> &output,
+	        const SurrogateStatistics &) -> bool {
 		it = nIt;
 		emit progress(false, nIt, nInput, eval, output);
 		return !aborted.load();
 	};
 
-	// Optimize either using the SPIKE_TRAIN or the SINGLE_GROUP evaluation
+	// Run the optimization on the compute server if one is configured, fall
+	// back to local computation if it cannot be reached
 	std::vector<OptimizationResult> res;
+	if (!server.empty()) {
+		RemoteClient client(server);
+		if (client.good()) {
+			res = client.optimize(*params, limitToHw, algorithm,
+			                      progressCallback);
+			emit progress(true, it, 0, 0.0, res);
+			return;
+		}
+		std::cerr << "Cannot connect to compute server " << server
+		          << ", optimizing locally" << std::endl;
+	}
+
+	// Optimize either using the SPIKE_TRAIN or the SINGLE_GROUP evaluation
 	switch (params->evaluation) {
 		case EvaluationType::SPIKE_TRAIN:
 			res = optimization.optimize(
@@ -113,6 +141,7 @@ OptimizationJob::OptimizationJob(std::shared_ptr<ParameterCollection> params,
                                  QObject *parent)
     : QObject(parent),
       pool(new QThreadPool(this)),
+      job(JobScheduler::inst().registerJob()),
       params(params),
       currentRunner(nullptr)
 {
@@ -121,7 +150,11 @@ OptimizationJob::OptimizationJob(std::shared_ptr<ParameterCollection> params,
 	    "std::vector<OptimizationResult>");
 }
 
-OptimizationJob::~OptimizationJob() { abort(); }
+OptimizationJob::~OptimizationJob()
+{
+	abort();
+	JobScheduler::inst().unregisterJob(job);
+}
 
 void OptimizationJob::handleProgress(bool done, size_t nIt, size_t nInput,
                                      float eval,
@@ -131,6 +164,7 @@ void OptimizationJob::handleProgress(bool done, size_t nIt, size_t nInput,
 	if (done) {
 		pool->waitForDone();
 		currentRunner = nullptr;
+		JobScheduler::inst().setActive(job, false);
 	}
 
 	// Relay the progress
@@ -149,23 +183,25 @@ void OptimizationJob::abort()
 	// Wait for the thread to be finished
 	pool->waitForDone();
 
-	// Free the runner
+	// Free the runner and release the threads
 	currentRunner = nullptr;
+	JobScheduler::inst().setActive(job, false);
 }
 
-void OptimizationJob::start(bool limitToHw)
+void OptimizationJob::start(bool limitToHw, OptimizationAlgorithm algorithm)
 {
 	// Cancel any running optimization first
 	abort();
 
 	// Start a new optimization, pass the progress signal through
 	currentRunner = std::unique_ptr<OptimizationJobRunner>(
-	    new OptimizationJobRunner(limitToHw, params));
+	    new OptimizationJobRunner(limitToHw, algorithm, params, job));
 	connect(
 	    currentRunner.get(),
 	    SIGNAL(progress(bool, size_t, size_t, float, std::vector<OptimizationResult>)),
 	    this, SLOT(handleProgress(bool, size_t, size_t, float,
 	                              std::vector<OptimizationResult>)));
+	JobScheduler::inst().setActive(job, true);
 	pool->start(currentRunner.get());
 }
 }
@@ -30,9 +30,11 @@
 
 #include <atomic>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <exploration/Optimization.hpp>
+#include <model/JobScheduler.hpp>
 
 #include <QRunnable>
 #include <QObject>
@@ -65,6 +67,18 @@ private:
 	 */
 	std::shared_ptr<ParameterCollection> params;
 
+	/**
+	 * Settings passed to the compute server.
+	 */
+	bool limitToHw;
+	OptimizationAlgorithm algorithm;
+
+	/**
+	 * Address of the compute server, empty if the optimization should run
+	 * locally.
+	 */
+	std::string server;
+
 	/**
 	 * Task code, runs the exploration, triggers the done and progress signals.
 	 */
@@ -72,15 +86,19 @@ private:
 
 public:
 	/**
-	 * Constructor of the OptimizationJobRunner class.
+	 * Constructor of the OptimizationJobRunner class. Must be called from the
+	 * GUI thread, as it reads the current ComputeBackend setting.
 	 *
 	 * @param limitToHw is set to true if the optimizer should try to optimize
 	 * according to the hardware constraints.
+	 * @param algorithm is the optimization algorithm that should be used.
 	 * @param params contains the params the exploration instance should be fed
 	 * with.
+	 * @param limit is the ThreadLimit assigned to the job by the JobScheduler.
 	 */
-	OptimizationJobRunner(bool limitToHw,
-	                      std::shared_ptr<ParameterCollection> params);
+	OptimizationJobRunner(bool limitToHw, OptimizationAlgorithm algorithm,
+	                      std::shared_ptr<ParameterCollection> params,
+	                      std::shared_ptr<const ThreadLimit> limit);
 
 	~OptimizationJobRunner() override;
 
@@ -110,6 +128,11 @@ private:
 	 */
 	QThreadPool *pool;
 
+	/**
+	 * Handle of this job at the application-wide JobScheduler.
+	 */
+	JobScheduler::Handle job;
+
 	/**
 	 * Current neuron parameters.
 	 */
@@ -148,8 +171,13 @@ public:
 
 	/**
 	 * Starts a new optimization.
+	 *
+	 * @param limitToHw is set to true if the optimizer should try to optimize
+	 * according to the hardware constraints.
+	 * @param algorithm is the optimization algorithm that should be used.
 	 */
-	void start(bool limitToHw);
+	void start(bool limitToHw, OptimizationAlgorithm algorithm =
+	                               OptimizationAlgorithm::SIMPLEX);
 
 signals:
 	/**
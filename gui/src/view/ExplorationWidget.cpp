@@ -20,10 +20,13 @@
 #include <QComboBox>
 #include <QProgressBar>
 #include <QStatusBar>
+#include <QThreadPool>
+#include <QTimer>
 #include <QToolBar>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -33,15 +36,22 @@
 #include <exploration/EvaluationResult.hpp>
 #include <exploration/Exploration.hpp>
 #include <utils/ParameterCollection.hpp>
+#include <simulation/FeasibilityAtlas.hpp>
 #include <simulation/HardwareParameters.hpp>
 
 #include "ExplorationWidget.hpp"
 #include "ExplorationWidgetGradients.hpp"
+#include "ExplorationWidgetImage.hpp"
 #include "ExplorationWidgetInvalidOverlay.hpp"
 #include "PlotMarker.hpp"
 
 namespace AdExpSim {
 
+static bool sameRange(const DiscreteRange &a, const DiscreteRange &b)
+{
+	return a.min == b.min && a.max == b.max && a.steps == b.steps;
+}
+
 static void fillDimensionCombobox(QComboBox *box)
 {
 	for (size_t i = 0; i < WorkingParameters::Size; i++) {
@@ -66,8 +76,17 @@ ExplorationWidget::ExplorationWidget(
     std::shared_ptr<ParameterCollection> params,
     std::shared_ptr<Exploration> exploration, QToolBar *toolbar,
     QWidget *parent)
-    : params(params), exploration(exploration), curEvaluationType(-1)
+    : params(params),
+      exploration(exploration),
+      curEvaluationType(-1),
+      rasterGeneration(0),
+      tileDimZ(0)
 {
+	// Create the thread pool used to rasterize the exploration data. Only one
+	// thread is used, outdated images are discarded in rasterizerDone
+	rasterPool = new QThreadPool(this);
+	rasterPool->setMaxThreadCount(1);
+
 	// Create the layout widget
 	layout = new QVBoxLayout(this);
 
@@ -143,6 +162,23 @@ ExplorationWidget::ExplorationWidget(
 	pltExploration->moveLayer(pltExploration->layer("grid"),
 	                          pltExploration->layer("main"));
 
+	// Add the image displaying the exploration data
+	image = new ExplorationWidgetImage(pltExploration);
+	pltExploration->addItem(image);
+	image->setLayer("main");
+
+	// Add the image displaying the tiles of a running exploration on top of
+	// the current results
+	tileImage = new ExplorationWidgetImage(pltExploration);
+	pltExploration->addItem(tileImage);
+	tileImage->setLayer("main");
+
+	// Timer used to limit the rate at which the plot is redrawn while tiles
+	// are arriving
+	tileTimer = new QTimer(this);
+	tileTimer->setSingleShot(true);
+	connect(tileTimer, SIGNAL(timeout()), pltExploration, SLOT(replot()));
+
 	// Add the crosshair and the "invalid overlay"
 	overlay = new ExplorationWidgetInvalidOverlay(pltExploration);
 	overlayHW = new ExplorationWidgetInvalidOverlay(pltExploration);
@@ -225,7 +261,8 @@ ExplorationWidget::ExplorationWidget(
 
 ExplorationWidget::~ExplorationWidget()
 {
-	// Only needed for unique_ptr
+	// Wait for the rasterizer, it holds a pointer at this instance
+	rasterPool->waitForDone();
 }
 
 size_t ExplorationWidget::getDimX()
@@ -466,16 +503,6 @@ void ExplorationWidget::progress(float p, bool show)
  * Main draw function
  */
 
-template <typename Fun>
-static void fillColorMap(QCPColorMap *map, size_t nx, size_t ny, Fun f)
-{
-	for (size_t x = 0; x < nx; x++) {
-		for (size_t y = 0; y < ny; y++) {
-			map->data()->setCell(x, y, f(x, y));
-		}
-	}
-}
-
 void ExplorationWidget::updateCrosshair()
 {
 	const Parameters &p = params->params;
@@ -533,13 +560,17 @@ void ExplorationWidget::updateInvalidRegionsOverlay()
 				wp[dimX] = rEX.value(x);
 				wp[dimY] = rEY.value(y);
 				mask(x, y) = wp.valid();
-				if (showHWOverlay) {
-					maskHW(x, y) = BrainScaleSParameters::inst.possible(
-					    wp, params->model == ModelType::IF_COND_EXP);
-				}
 			}
 		}
 
+		// Fetch the hardware feasibility mask from the atlas cache, it only
+		// has to be recalculated if the base parameters or the view changed
+		if (showHWOverlay) {
+			maskHW = FeasibilityAtlas::get(
+			             BrainScaleSParameters::inst, wp, dimX, dimY, rEX, rEY,
+			             params->model == ModelType::IF_COND_EXP)->mask();
+		}
+
 		// Update the overlay
 		QPointF min = workingParametersToPlot(rX.min, rY.min);
 		QPointF max = workingParametersToPlot(rX.max, rY.max);
@@ -560,9 +591,13 @@ void ExplorationWidget::refresh()
 	// Check whether the function selection combobox has to be rebuilt
 	rebuildDimensionWidgets();
 
-	// Clear the graph
-	pltExploration->setCurrentLayer("main");
-	pltExploration->clearPlottables();
+	// Invalidate all images which are currently being rasterized
+	rasterGeneration++;
+
+	// Discard the tiles if another function is displayed now
+	if (getDimZ() != tileDimZ) {
+		clearTiles();
+	}
 
 	// Update the x- and y- axis labels
 	pltExploration->xAxis->setLabel(
@@ -580,24 +615,21 @@ void ExplorationWidget::refresh()
 		QPointF min = workingParametersToPlot(rX.min, rY.min);
 		QPointF max = workingParametersToPlot(rX.max, rY.max);
 
-		// Create a "plottable" for the data
-		QCPColorMap *map =
-		    new QCPColorMap(pltExploration->xAxis, pltExploration->yAxis);
-		pltExploration->addPlottable(map);
-		map->data()->setSize(rX.steps, rY.steps);
-		map->data()->setRange(QCPRange(min.x(), max.x()),
-		                      QCPRange(min.y(), max.y()));
+		rasterRangeX = DiscreteRange(min.x(), max.x(), rX.steps);
+		rasterRangeY = DiscreteRange(min.y(), max.y(), rY.steps);
 
-		// Fill the plot data
+		// Convert the data to an image in the background, the matrix is
+		// copied by reference (copy on write), so this is cheap. The image
+		// is swapped in once the rasterizer is done.
 		const ExplorationMemory &mem = exploration->mem();
-		const Matrix &mat = mem.data[getDimZ()];
-		fillColorMap(map, mat.getWidth(), mat.getHeight(),
-		             [&mat](size_t x, size_t y) { return mat(x, y); });
-		map->setGradient(ExplorationWidgetGradients::blue());
-
-		// Set the value range
 		const Range valueRange = mem.range(getDimZ());
-		map->setDataRange(QCPRange(valueRange.min, valueRange.max));
+		rasterPool->start(new ExplorationWidgetRasterizer(
+		    mem.matrix(getDimZ()), QCPRange(valueRange.min, valueRange.max),
+		    ExplorationWidgetGradients::blue(), this, rasterGeneration));
+	} else {
+		image->setImage(DiscreteRange(0, 0, 0), DiscreteRange(0, 0, 0),
+		                QImage());
+		clearTiles();
 	}
 
 	updateInvalidRegionsOverlay();
@@ -607,9 +639,98 @@ void ExplorationWidget::refresh()
 	pltExploration->replot();
 }
 
+void ExplorationWidget::rasterizerDone(QImage img, quint64 generation)
+{
+	// Discard images belonging to an outdated refresh() call
+	if (generation != rasterGeneration) {
+		return;
+	}
+	image->setImage(rasterRangeX, rasterRangeY, img);
+
+	// The tiles are no longer needed once the complete results for the same
+	// grid are displayed
+	if (sameRange(tileRangeX, rasterRangeX) &&
+	    sameRange(tileRangeY, rasterRangeY)) {
+		clearTiles();
+	}
+	pltExploration->replot();
+}
+
+void ExplorationWidget::clearTiles()
+{
+	tileImage->setImage(DiscreteRange(0, 0, 0), DiscreteRange(0, 0, 0),
+	                    QImage());
+	tileRangeX = DiscreteRange(0, 0, 0);
+	tileRangeY = DiscreteRange(0, 0, 0);
+}
+
+void ExplorationWidget::addTile(ExplorationTile tile, DiscreteRange rangeX,
+                                DiscreteRange rangeY)
+{
+	const size_t dimZ = getDimZ();
+	if (dimZ >= tile.nDims || tile.w == 0 || tile.h == 0) {
+		return;
+	}
+
+	// Transform the range of the grid the tile belongs to
+	const QPointF min = workingParametersToPlot(rangeX.min, rangeY.min);
+	const QPointF max = workingParametersToPlot(rangeX.max, rangeY.max);
+	const DiscreteRange rX(min.x(), max.x(), rangeX.steps);
+	const DiscreteRange rY(min.y(), max.y(), rangeY.steps);
+
+	// Start with a new, transparent image if the tile belongs to another grid
+	// or another function is displayed
+	if (!tileImage->valid() || dimZ != tileDimZ ||
+	    !sameRange(rX, tileRangeX) || !sameRange(rY, tileRangeY)) {
+		QImage img(rangeX.steps, rangeY.steps,
+		           QImage::Format_ARGB32_Premultiplied);
+		img.fill(Qt::transparent);
+		tileImage->setImage(rX, rY, img);
+		tileDimZ = dimZ;
+		tileRangeX = rX;
+		tileRangeY = rY;
+	}
+
+	// Use the value range of the currently displayed results so the colors
+	// match, fall back to the value range of the tile itself
+	Range valueRange = Range::invalid();
+	if (exploration->valid() && dimZ < exploration->descriptor().size()) {
+		valueRange = exploration->mem().range(dimZ);
+	} else {
+		for (size_t y = 0; y < tile.h; y++) {
+			for (size_t x = 0; x < tile.w; x++) {
+				valueRange.expand(tile(x, y, dimZ));
+			}
+		}
+	}
+
+	// Rasterize the tile and copy it into the image, the first row of the
+	// grid is the bottom row of the image
+	Matrix mat(tile.w, tile.h);
+	const Val *src = tile.values.data() + dimZ * tile.w * tile.h;
+	std::copy(src, src + tile.w * tile.h, mat.data());
+	QCPColorGradient gradient = ExplorationWidgetGradients::blue();
+	tileImage->setTile(tile.x0, rangeY.steps - tile.y0 - tile.h,
+	                   ExplorationWidgetRasterizer::rasterize(
+	                       mat, QCPRange(valueRange.min, valueRange.max),
+	                       gradient));
+
+	// Redraw the plot, but at most every 40 msec
+	if (!tileTimer->isActive()) {
+		tileTimer->start(40);
+	}
+}
+
 void ExplorationWidget::fitView()
 {
-	pltExploration->rescaleAxes();
+	if (exploration->valid()) {
+		const DiscreteRange &rX = exploration->rangeX();
+		const DiscreteRange &rY = exploration->rangeY();
+		QPointF min = workingParametersToPlot(rX.min, rY.min);
+		QPointF max = workingParametersToPlot(rX.max, rY.max);
+		pltExploration->xAxis->setRange(QCPRange(min.x(), max.x()));
+		pltExploration->yAxis->setRange(QCPRange(min.y(), max.y()));
+	}
 	pltExploration->replot();
 }
 }
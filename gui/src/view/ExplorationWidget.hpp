@@ -22,10 +22,12 @@
 #include <memory>
 #include <set>
 
+#include <QImage>
 #include <QWidget>
 
 #include <common/Types.hpp>
 #include <exploration/EvaluationResult.hpp>
+#include <exploration/Exploration.hpp>
 
 class QAction;
 class QComboBox;
@@ -34,6 +36,8 @@ class QProgressBar;
 class QCustomPlot;
 class QCPAxis;
 class QStatusBar;
+class QThreadPool;
+class QTimer;
 class QToolBar;
 class QVBoxLayout;
 
@@ -41,7 +45,7 @@ namespace AdExpSim {
 
 class ParameterCollection;
 class PlotMarker;
-class Exploration;
+class ExplorationWidgetImage;
 class ExplorationWidgetInvalidOverlay;
 
 /**
@@ -68,14 +72,23 @@ private:
 	PlotMarker *crosshair;
 	PlotMarker *crosshairHW1;
 	PlotMarker *crosshairHW2;
+	ExplorationWidgetImage *image;
 	ExplorationWidgetInvalidOverlay *overlay;
 	ExplorationWidgetInvalidOverlay *overlayHW;
 	std::shared_ptr<ParameterCollection> params;
 	std::shared_ptr<Exploration> exploration;
 	int curEvaluationType;
+	QThreadPool *rasterPool;
+	quint64 rasterGeneration;
+	DiscreteRange rasterRangeX, rasterRangeY;
+	ExplorationWidgetImage *tileImage;
+	QTimer *tileTimer;
+	size_t tileDimZ;
+	DiscreteRange tileRangeX, tileRangeY;
 
 	void dimensionChanged();
 	void rebuildDimensionWidgets();
+	void clearTiles();
 
 	QPointF workingParametersToPlot(Val x, Val y);
 	QPointF parametersToPlot(Val x, Val y);
@@ -93,6 +106,7 @@ private slots:
 	void updateInvalidRegionsOverlay();
 	void plotDoubleClick(QMouseEvent *event);
 	void handleRestrictZoom();
+	void rasterizerDone(QImage img, quint64 generation);
 
 public:
 	/**
@@ -140,6 +154,19 @@ public slots:
 	 */
 	void refresh();
 
+	/**
+	 * Draws a single completed tile of a running exploration on top of the
+	 * current results. Only the pixels belonging to the tile are rasterized,
+	 * the tiles are discarded once the results of the corresponding
+	 * exploration are passed to refresh().
+	 *
+	 * @param tile contains the results for a part of the exploration grid.
+	 * @param rangeX is the x-range of the grid the tile belongs to.
+	 * @param rangeY is the y-range of the grid the tile belongs to.
+	 */
+	void addTile(ExplorationTile tile, DiscreteRange rangeX,
+	             DiscreteRange rangeY);
+
 	/**
 	 * Centers the view according to the current parameters.
 	 */
@@ -0,0 +1,136 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <QMetaObject>
+#include <QPainter>
+
+#include "ExplorationWidgetImage.hpp"
+
+namespace AdExpSim {
+
+/*
+ * Class ExplorationWidgetRasterizer
+ */
+
+ExplorationWidgetRasterizer::ExplorationWidgetRasterizer(
+    const Matrix &mat, const QCPRange &dataRange,
+    const QCPColorGradient &gradient, QObject *receiver, quint64 generation)
+    : mat(mat),
+      dataRange(dataRange),
+      gradient(gradient),
+      receiver(receiver),
+      generation(generation)
+{
+	setAutoDelete(true);
+}
+
+QImage ExplorationWidgetRasterizer::rasterize(const Matrix &mat,
+                                              const QCPRange &dataRange,
+                                              QCPColorGradient &gradient)
+{
+	const int w = mat.getWidth();
+	const int h = mat.getHeight();
+	if (w == 0 || h == 0) {
+		return QImage();
+	}
+
+	// Use the same fallback as QCPColorMap if the data range is degenerate
+	const QCPRange range = QCPRange::validRange(dataRange)
+	                           ? dataRange.sanitizedForLinScale()
+	                           : QCPRange(0, 1);
+
+	// The matrix is stored row by row, so each matrix row can be converted
+	// into an image scanline in a single pass
+	QImage res(w, h, QImage::Format_ARGB32_Premultiplied);
+	std::vector<double> row(w);
+	const Val *src = mat.data();
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			row[x] = *(src++);
+		}
+		gradient.colorize(row.data(), range,
+		                  reinterpret_cast<QRgb *>(res.scanLine(h - 1 - y)), w);
+	}
+	return res;
+}
+
+void ExplorationWidgetRasterizer::run()
+{
+	QImage res = rasterize(mat, dataRange, gradient);
+	QMetaObject::invokeMethod(receiver, "rasterizerDone", Qt::QueuedConnection,
+	                          Q_ARG(QImage, res), Q_ARG(quint64, generation));
+}
+
+/*
+ * Class ExplorationWidgetImage
+ */
+
+ExplorationWidgetImage::ExplorationWidgetImage(QCustomPlot *parentPlot)
+    : QCPAbstractItem(parentPlot), rangeDimX(0, 0, 0), rangeDimY(0, 0, 0)
+{
+}
+
+ExplorationWidgetImage::~ExplorationWidgetImage() {}
+
+void ExplorationWidgetImage::draw(QCPPainter *painter)
+{
+	if (image.isNull()) {
+		return;
+	}
+
+	// Transform the given coordinates to pixel coordinates and draw the image,
+	// the cost of this operation only depends on the size of the plot
+	double x0 = mParentPlot->xAxis->coordToPixel(rangeDimX.min);
+	double x1 = mParentPlot->xAxis->coordToPixel(rangeDimX.max);
+	double y0 = mParentPlot->yAxis->coordToPixel(rangeDimY.min);
+	double y1 = mParentPlot->yAxis->coordToPixel(rangeDimY.max);
+	painter->save();
+	painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+	painter->drawImage(QRectF(x0, y1, x1 - x0, y0 - y1), image);
+	painter->restore();
+}
+
+double ExplorationWidgetImage::selectTest(const QPointF &pos,
+                                          bool onlySelectable,
+                                          QVariant *details) const
+{
+	return -1.0;
+}
+
+void ExplorationWidgetImage::setImage(DiscreteRange rangeDimX,
+                                      DiscreteRange rangeDimY,
+                                      const QImage &image)
+{
+	this->rangeDimX = rangeDimX;
+	this->rangeDimY = rangeDimY;
+	this->image = image;
+}
+
+void ExplorationWidgetImage::setTile(int x, int y, const QImage &tile)
+{
+	// Overwrite the given region of the image, the pixels of the tile replace
+	// the existing pixels instead of being blended with them
+	if (!image.isNull()) {
+		QPainter painter(&image);
+		painter.setCompositionMode(QPainter::CompositionMode_Source);
+		painter.drawImage(x, y, tile);
+	}
+}
+}
@@ -0,0 +1,128 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ADEXPSIM_EXPLORATION_WIDGET_IMAGE_HPP_
+#define _ADEXPSIM_EXPLORATION_WIDGET_IMAGE_HPP_
+
+#include <QImage>
+#include <QRunnable>
+#include <qcustomplot.h>
+
+#include <common/Types.hpp>
+#include <common/Matrix.hpp>
+
+namespace AdExpSim {
+/**
+ * The ExplorationWidgetRasterizer converts a single exploration result matrix
+ * into a colored image. It is meant to run in a background thread, the
+ * finished image is passed to the "rasterizerDone(QImage, quint64)" slot of
+ * the receiver object via a queued connection.
+ */
+class ExplorationWidgetRasterizer : public QRunnable {
+private:
+	/**
+	 * Copy of the matrix that should be rasterized. As the Matrix class has
+	 * copy on write semantics, this copy is cheap and stays valid even if the
+	 * original exploration is modified or destroyed.
+	 */
+	Matrix mat;
+
+	/**
+	 * Value range mapped onto the color gradient.
+	 */
+	QCPRange dataRange;
+
+	/**
+	 * Copy of the color gradient.
+	 */
+	QCPColorGradient gradient;
+
+	/**
+	 * Object to which the result is sent.
+	 */
+	QObject *receiver;
+
+	/**
+	 * Generation counter passed back to the receiver, allows the receiver to
+	 * discard outdated images.
+	 */
+	quint64 generation;
+
+	/**
+	 * Creates the image and sends it to the receiver.
+	 */
+	void run() override;
+
+public:
+	/**
+	 * Constructor of the ExplorationWidgetRasterizer class.
+	 *
+	 * @param mat is the matrix that should be converted to an image.
+	 * @param dataRange is the value range mapped onto the gradient.
+	 * @param gradient is the color gradient that should be used.
+	 * @param receiver is the object the finished image is sent to. Must
+	 * outlive the rasterizer.
+	 * @param generation is an arbitrary number which is passed back to the
+	 * receiver alongside the image.
+	 */
+	ExplorationWidgetRasterizer(const Matrix &mat, const QCPRange &dataRange,
+	                            const QCPColorGradient &gradient,
+	                            QObject *receiver, quint64 generation);
+
+	/**
+	 * Converts the given matrix into an image. The x-axis of the matrix is
+	 * mapped onto the image columns, the y-axis is flipped so the first matrix
+	 * row is the bottom row of the image.
+	 */
+	static QImage rasterize(const Matrix &mat, const QCPRange &dataRange,
+	                        QCPColorGradient &gradient);
+};
+
+/**
+ * The ExplorationWidgetImage class is used to draw a prerendered exploration
+ * image into the given plot coordinates. In contrast to QCPColorMap, drawing
+ * does not depend on the resolution of the underlying data.
+ */
+class ExplorationWidgetImage : public QCPAbstractItem {
+	Q_OBJECT
+
+private:
+	DiscreteRange rangeDimX, rangeDimY;
+	QImage image;
+
+protected:
+	void draw(QCPPainter *painter) override;
+
+public:
+	ExplorationWidgetImage(QCustomPlot *parentPlot);
+	virtual ~ExplorationWidgetImage();
+
+	double selectTest(const QPointF &pos, bool onlySelectable,
+	                  QVariant *details = 0) const override;
+
+	void setImage(DiscreteRange rangeDimX, DiscreteRange rangeDimY,
+	              const QImage &image);
+	void setTile(int x, int y, const QImage &tile);
+
+	bool valid() const { return !image.isNull(); }
+	const DiscreteRange &getRangeDimX() const { return rangeDimX; }
+	const DiscreteRange &getRangeDimY() const { return rangeDimY; }
+};
+}
+
+#endif /* _ADEXPSIM_EXPLORATION_WIDGET_IMAGE_HPP_ */
@@ -17,6 +17,7 @@
  */
 
 #include <QCheckBox>
+#include <QComboBox>
 #include <QHeaderView>
 #include <QLabel>
 #include <QPushButton>
@@ -69,6 +70,10 @@ OptimizationWidget::OptimizationWidget(
 	// Create the other components
 	chkOptimizeHw = new QCheckBox("Apply hardware constraints", this);
 	chkOptimizeHw->setChecked(true);
+	comboAlgorithm = new QComboBox(this);
+	comboAlgorithm->addItem("Simplex (Nelder-Mead)",
+	                        int(OptimizationAlgorithm::SIMPLEX));
+	comboAlgorithm->addItem("CMA-ES", int(OptimizationAlgorithm::CMA_ES));
 	lblNIt = new QLabel("nIt:", this);
 	lblNInput = new QLabel("nInput:", this);
 	lblEval = new QLabel("eval:", this);
@@ -81,6 +86,7 @@ OptimizationWidget::OptimizationWidget(
 	QVBoxLayout *layout = new QVBoxLayout(this);
 	layout->addWidget(tableWidget);
 	layout->addWidget(chkOptimizeHw);
+	layout->addWidget(comboAlgorithm);
 	layout->addWidget(lblNIt);
 	layout->addWidget(lblNInput);
 	layout->addWidget(lblEval);
@@ -104,7 +110,10 @@ void OptimizationWidget::handleCellDoubleClicked(int row, int column)
 void OptimizationWidget::handleOptimizeClicked()
 {
 	if (!job->isActive()) {
-		job->start(chkOptimizeHw->isChecked());
+		job->start(chkOptimizeHw->isChecked(),
+		           OptimizationAlgorithm(
+		               comboAlgorithm->itemData(comboAlgorithm->currentIndex())
+		                   .toInt()));
 	} else {
 		job->abort();
 	}
@@ -27,6 +27,7 @@
 #include <model/OptimizationJob.hpp>
 
 class QCheckBox;
+class QComboBox;
 class QLabel;
 class QPushButton;
 class QTableWidget;
@@ -49,6 +50,7 @@ private:
 	QTimer *updateTimer;
 	QTableWidget *tableWidget;
 	QCheckBox *chkOptimizeHw;
+	QComboBox *comboAlgorithm;
 	QLabel *lblNIt;
 	QLabel *lblNInput;
 	QLabel *lblEval;
@@ -0,0 +1,387 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+#include "ExplorationIo.hpp"
+
+namespace AdExpSim {
+
+static_assert(sizeof(Val) == sizeof(float),
+              "Binary exploration format requires Val to be float");
+
+static const char MAGIC[8] = {'A', 'D', 'X', 'E', 'X', 'P', 'L', '\0'};
+static const uint32_t VERSION = 1;
+static const size_t ALIGNMENT = 64;
+
+/*
+ * Helper functions for serializing the variable sized header part.
+ */
+
+static void appendRaw(std::string &buf, const void *data, size_t size)
+{
+	buf.append(static_cast<const char *>(data), size);
+}
+
+static void appendString(std::string &buf, const std::string &s)
+{
+	uint32_t len = s.size();
+	appendRaw(buf, &len, sizeof(len));
+	buf.append(s);
+}
+
+static bool readRaw(const char *&p, const char *end, void *data, size_t size)
+{
+	if (size_t(end - p) < size) {
+		return false;
+	}
+	memcpy(data, p, size);
+	p += size;
+	return true;
+}
+
+static bool readString(const char *&p, const char *end, std::string &s)
+{
+	uint32_t len;
+	if (!readRaw(p, end, &len, sizeof(len)) || size_t(end - p) < len) {
+		return false;
+	}
+	s.assign(p, len);
+	p += len;
+	return true;
+}
+
+/**
+ * Serializes the complete header, including the parameters and the result
+ * descriptor.
+ */
+static std::string buildHeader(const Exploration &exploration,
+                               const EvaluationResultDescriptor &descriptor)
+{
+	// Serialize the variable part
+	std::string var;
+	const Parameters &params = exploration.fullParams();
+	for (size_t i = 0; i < params.size(); i++) {
+		float v = params[i];
+		appendRaw(var, &v, sizeof(v));
+	}
+	for (size_t i = 0; i < descriptor.size(); i++) {
+		float v[3] = {descriptor.defaultResult()[i], descriptor.range(i).min,
+		              descriptor.range(i).max};
+		appendRaw(var, v, sizeof(v));
+		appendString(var, descriptor.id(i));
+		appendString(var, descriptor.name(i));
+		appendString(var, descriptor.unit(i));
+	}
+
+	// Fill the fixed size header
+	ExplorationFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.dataOffset =
+	    ((sizeof(header) + var.size() + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+	header.evaluationType = int32_t(descriptor.type());
+	header.useFullParams = exploration.useFullParams() ? 1 : 0;
+	header.dimX = exploration.dimX();
+	header.dimY = exploration.dimY();
+	header.resX = exploration.resX();
+	header.resY = exploration.resY();
+	header.nDims = descriptor.size();
+	header.optimizationDim = descriptor.optimizationDim();
+	header.rangeXMin = exploration.rangeX().min;
+	header.rangeXMax = exploration.rangeX().max;
+	header.rangeYMin = exploration.rangeY().min;
+	header.rangeYMax = exploration.rangeY().max;
+
+	std::string res;
+	appendRaw(res, &header, sizeof(header));
+	res.append(var);
+	res.resize(header.dataOffset, '\0');
+	return res;
+}
+
+/*
+ * Class ExplorationWriter
+ */
+
+ExplorationWriter::ExplorationWriter(
+    const std::string &filename, const Exploration &exploration,
+    const EvaluationResultDescriptor &descriptor)
+    : fd(-1),
+      dataOffset(0),
+      resX(exploration.resX()),
+      resY(exploration.resY()),
+      nDims(descriptor.size()),
+      rowCells(resY, 0),
+      rowsComplete(0)
+{
+	fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return;
+	}
+
+	// Write the header and preallocate the file
+	const std::string header = buildHeader(exploration, descriptor);
+	dataOffset = header.size();
+	if (!write(0, header.data(), header.size()) ||
+	    ftruncate(fd, dataOffset + resX * resY * nDims * sizeof(float)) != 0) {
+		close();
+	}
+}
+
+ExplorationWriter::~ExplorationWriter() { close(); }
+
+bool ExplorationWriter::write(size_t offs, const void *data, size_t size)
+{
+	const char *p = static_cast<const char *>(data);
+	while (size > 0) {
+		ssize_t n = pwrite(fd, p, size, offs);
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		offs += n;
+		size -= n;
+	}
+	return true;
+}
+
+bool ExplorationWriter::storeTile(const ExplorationTile &tile)
+{
+	if (fd < 0 || tile.x0 + tile.w > resX || tile.y0 + tile.h > resY) {
+		return false;
+	}
+
+	// Write the tile row by row
+	const size_t n = std::min(nDims, tile.nDims);
+	for (size_t i = 0; i < n; i++) {
+		for (size_t y = 0; y < tile.h; y++) {
+			const size_t offs =
+			    dataOffset +
+			    ((i * resY + tile.y0 + y) * resX + tile.x0) * sizeof(float);
+			if (!write(offs, &tile.values[(i * tile.h + y) * tile.w],
+			           tile.w * sizeof(float))) {
+				return false;
+			}
+		}
+	}
+
+	// Update the number of leading rows which are complete
+	for (size_t y = 0; y < tile.h; y++) {
+		rowCells[tile.y0 + y] += tile.w;
+	}
+	const size_t oldRowsComplete = rowsComplete;
+	while (rowsComplete < resY && rowCells[rowsComplete] >= resX) {
+		rowsComplete++;
+	}
+	return rowsComplete == oldRowsComplete || markRowsValid(rowsComplete);
+}
+
+bool ExplorationWriter::storeRows(const ExplorationMemory &mem, size_t y0,
+                                  size_t y1)
+{
+	if (fd < 0 || mem.resX != resX || y1 > resY || y0 >= y1) {
+		return false;
+	}
+	const size_t n = std::min(nDims, mem.size());
+	std::vector<float> buf(mem.compressed() ? (y1 - y0) * resX : 0);
+	for (size_t i = 0; i < n; i++) {
+		// Compressed dimensions are decoded to a temporary buffer first
+		const float *src = buf.data();
+		if (mem.compressed()) {
+			mem.copyRows(i, y0, y1, buf.data());
+		} else {
+			src = mem.data[i].data() + y0 * resX;
+		}
+		const size_t offs =
+		    dataOffset + ((i * resY + y0) * resX) * sizeof(float);
+		if (!write(offs, src, (y1 - y0) * resX * sizeof(float))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ExplorationWriter::markRowsValid(size_t rows)
+{
+	if (fd < 0) {
+		return false;
+	}
+	uint32_t v = std::min(rows, resY);
+	return write(offsetof(ExplorationFileHeader, rowsValid), &v, sizeof(v));
+}
+
+void ExplorationWriter::close()
+{
+	if (fd >= 0) {
+		fsync(fd);
+		::close(fd);
+		fd = -1;
+	}
+}
+
+/*
+ * Class ExplorationMap
+ */
+
+ExplorationMap::ExplorationMap(const std::string &filename)
+    : ptr(nullptr), size(0)
+{
+	// Open the file and map it into memory
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(ExplorationFileHeader)) {
+		::close(fd);
+		return;
+	}
+	size = st.st_size;
+	void *p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) {
+		return;
+	}
+	ptr = p;
+
+	// Check the header
+	const ExplorationFileHeader &h = header();
+	const size_t dataSize = size_t(h.resX) * h.resY * h.nDims * sizeof(float);
+	bool ok = memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+	          h.version == VERSION && h.dataOffset >= sizeof(h) &&
+	          h.dataOffset + dataSize <= size &&
+	          h.evaluationType >= 0 && h.evaluationType <= 2 &&
+	          h.dimX < Parameters::Size && h.dimY < Parameters::Size;
+
+	// Read the variable header part
+	const char *begin = static_cast<const char *>(ptr);
+	const char *cur = begin + sizeof(h);
+	const char *end = begin + (ok ? h.dataOffset : sizeof(h));
+	for (size_t i = 0; ok && i < mParams.size(); i++) {
+		float v = 0.0f;
+		ok = readRaw(cur, end, &v, sizeof(v));
+		mParams[i] = v;
+	}
+	mDescriptor = EvaluationResultDescriptor(EvaluationType(h.evaluationType));
+	for (size_t i = 0; ok && i < h.nDims; i++) {
+		float v[3];
+		std::string id, name, unit;
+		ok = readRaw(cur, end, v, sizeof(v)) && readString(cur, end, id) &&
+		     readString(cur, end, name) && readString(cur, end, unit);
+		if (ok) {
+			mDescriptor.add(name, id, unit, v[0], Range(v[1], v[2]),
+			                i == h.optimizationDim);
+		}
+	}
+
+	if (!ok) {
+		munmap(ptr, size);
+		ptr = nullptr;
+	}
+}
+
+ExplorationMap::~ExplorationMap()
+{
+	if (ptr) {
+		munmap(ptr, size);
+	}
+}
+
+const float *ExplorationMap::layer(size_t dim) const
+{
+	const ExplorationFileHeader &h = header();
+	return reinterpret_cast<const float *>(static_cast<const char *>(ptr) +
+	                                       h.dataOffset) +
+	       dim * h.resX * h.resY;
+}
+
+Exploration ExplorationMap::exploration() const
+{
+	// Only use the rows which have been written completely, the file might
+	// still be written to
+	const ExplorationFileHeader &h = header();
+	ExplorationMemory mem(mDescriptor, h.resX, h.resY);
+	const size_t n = size_t(h.resX) * h.resY;
+	const size_t nValid = size_t(h.resX) * std::min(h.rowsValid, h.resY);
+	for (size_t i = 0; i < h.nDims; i++) {
+		const float *src = layer(i);
+		float *tar = mem.data[i].data();
+		memcpy(tar, src, nValid * sizeof(float));
+		std::fill(tar + nValid, tar + n, mDescriptor.defaultResult()[i]);
+		for (size_t j = 0; j < nValid; j++) {
+			mem.extrema[i].expand(src[j]);
+		}
+	}
+	return Exploration(mem, h.useFullParams != 0, mParams, h.dimX, h.dimY,
+	                   DiscreteRange(h.rangeXMin, h.rangeXMax, h.resX),
+	                   DiscreteRange(h.rangeYMin, h.rangeYMax, h.resY));
+}
+
+/*
+ * Class ExplorationIo
+ */
+
+bool ExplorationIo::storeExploration(const std::string &filename,
+                                     const Exploration &exploration)
+{
+	const ExplorationMemory &mem = exploration.mem();
+	ExplorationWriter writer(filename, exploration, mem.descriptor);
+	if (!writer.good() || !writer.storeRows(mem, 0, mem.resY) ||
+	    !writer.markRowsValid(mem.resY)) {
+		return false;
+	}
+	writer.close();
+	return true;
+}
+
+void ExplorationIo::storeGnuPlotMatrix(std::ostream &os,
+                                       const Exploration &exploration,
+                                       size_t dim)
+{
+	const ExplorationMemory &mem = exploration.mem();
+	const size_t resX = mem.resX, resY = mem.resY;
+
+	// First row: number of columns followed by the x-coordinates
+	std::vector<float> row(resX + 1);
+	row[0] = resX;
+	for (size_t x = 0; x < resX; x++) {
+		row[x + 1] = exploration.rangeX().value(x);
+	}
+	os.write(reinterpret_cast<const char *>(row.data()),
+	         row.size() * sizeof(float));
+
+	// Each following row: y-coordinate followed by the data
+	for (size_t y = 0; y < resY; y++) {
+		row[0] = exploration.rangeY().value(y);
+		mem.copyRows(dim, y, y + 1, &row[1]);
+		os.write(reinterpret_cast<const char *>(row.data()),
+		         row.size() * sizeof(float));
+	}
+}
+}
@@ -0,0 +1,307 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ExplorationIo.hpp
+ *
+ * Contains functions for storing and loading exploration results in a compact,
+ * binary, columnar file format. The file consists of a small header (storing
+ * the evaluation type, the explored ranges, the base parameters and the result
+ * descriptor) followed by one float32 matrix per result dimension. The matrices
+ * are stored in the same row-major layout as used by the Matrix class, so they
+ * can be memory mapped and used without any conversion.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_EXPLORATION_IO_HPP_
+#define _ADEXPSIM_EXPLORATION_IO_HPP_
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <exploration/Exploration.hpp>
+
+namespace AdExpSim {
+
+/**
+ * Fixed size header at the beginning of each binary exploration file. All
+ * values are stored in the native byte order.
+ */
+struct ExplorationFileHeader {
+	/**
+	 * Magic byte sequence identifying the file type.
+	 */
+	char magic[8];
+
+	/**
+	 * File format version.
+	 */
+	uint32_t version;
+
+	/**
+	 * Size of the complete header (including the variable sized descriptor
+	 * part) in bytes. This is the offset of the first data matrix, it is a
+	 * multiple of 64 bytes.
+	 */
+	uint32_t dataOffset;
+
+	/**
+	 * EvaluationType the data was generated with.
+	 */
+	int32_t evaluationType;
+
+	/**
+	 * Set to one if the full parameter set was explored.
+	 */
+	uint32_t useFullParams;
+
+	/**
+	 * Explored parameter dimensions.
+	 */
+	uint32_t dimX, dimY;
+
+	/**
+	 * Resolution in x and y direction.
+	 */
+	uint32_t resX, resY;
+
+	/**
+	 * Number of result dimensions (matrices) stored in the file.
+	 */
+	uint32_t nDims;
+
+	/**
+	 * Index of the result dimension which should be optimized.
+	 */
+	uint32_t optimizationDim;
+
+	/**
+	 * Number of rows which have been completely written. Allows readers to
+	 * access files which are still being written.
+	 */
+	uint32_t rowsValid;
+
+	/**
+	 * Reserved for future use, always zero.
+	 */
+	uint32_t reserved;
+
+	/**
+	 * Explored parameter ranges.
+	 */
+	float rangeXMin, rangeXMax, rangeYMin, rangeYMax;
+};
+
+/**
+ * The ExplorationWriter class allows to write an exploration file
+ * incrementally. The file is preallocated when the writer is opened, afterwards
+ * tiles or complete rows can be written in an arbitrary order. This allows to
+ * write the tiles from the tile callback of Exploration::run() as soon as they
+ * are available.
+ */
+class ExplorationWriter {
+private:
+	/**
+	 * File descriptor of the output file, -1 if no file is open.
+	 */
+	int fd;
+
+	/**
+	 * Offset of the first data matrix.
+	 */
+	size_t dataOffset;
+
+	/**
+	 * Resolution and number of result dimensions.
+	 */
+	size_t resX, resY, nDims;
+
+	/**
+	 * Number of cells written by storeTile() in each row and number of leading
+	 * rows which are complete.
+	 */
+	std::vector<size_t> rowCells;
+	size_t rowsComplete;
+
+	/**
+	 * Writes the given data block at the given file offset.
+	 */
+	bool write(size_t offs, const void *data, size_t size);
+
+public:
+	/**
+	 * Creates a new ExplorationWriter instance and writes the header
+	 * corresponding to the given exploration. The exploration itself does not
+	 * need to contain any data.
+	 *
+	 * @param filename is the name of the file that should be written.
+	 * @param exploration is the exploration instance from which the header
+	 * information (ranges, dimensions and descriptor) should be read.
+	 * @param descriptor is the descriptor of the evaluation that is used.
+	 */
+	ExplorationWriter(const std::string &filename,
+	                  const Exploration &exploration,
+	                  const EvaluationResultDescriptor &descriptor);
+
+	/**
+	 * Closes the file.
+	 */
+	~ExplorationWriter();
+
+	ExplorationWriter(const ExplorationWriter &) = delete;
+	ExplorationWriter &operator=(const ExplorationWriter &) = delete;
+
+	/**
+	 * Returns true if the file was successfully opened.
+	 */
+	bool good() const { return fd >= 0; }
+
+	/**
+	 * Stores the given tile. Once all rows up to a certain row have been
+	 * written completely, the number of valid rows in the header is updated.
+	 */
+	bool storeTile(const ExplorationTile &tile);
+
+	/**
+	 * Copies the rows y0 to y1 (exclusive) from the given exploration memory
+	 * to the file.
+	 */
+	bool storeRows(const ExplorationMemory &mem, size_t y0, size_t y1);
+
+	/**
+	 * Sets the number of completely written rows in the header.
+	 */
+	bool markRowsValid(size_t rows);
+
+	/**
+	 * Flushes the file contents to the disk and closes the file.
+	 */
+	void close();
+};
+
+/**
+ * The ExplorationMap class provides read-only access to a memory mapped
+ * exploration file.
+ */
+class ExplorationMap {
+private:
+	/**
+	 * Pointer at the mapped file and its size.
+	 */
+	void *ptr;
+	size_t size;
+
+	/**
+	 * Descriptor reconstructed from the header.
+	 */
+	EvaluationResultDescriptor mDescriptor;
+
+	/**
+	 * Base parameters stored in the header.
+	 */
+	Parameters mParams;
+
+public:
+	/**
+	 * Maps the given file into memory. Use good() to check whether the
+	 * operation was successful.
+	 */
+	ExplorationMap(const std::string &filename);
+
+	/**
+	 * Unmaps the file.
+	 */
+	~ExplorationMap();
+
+	ExplorationMap(const ExplorationMap &) = delete;
+	ExplorationMap &operator=(const ExplorationMap &) = delete;
+
+	/**
+	 * Returns true if the file was mapped and has a valid header.
+	 */
+	bool good() const { return ptr != nullptr; }
+
+	/**
+	 * Returns a reference at the file header.
+	 */
+	const ExplorationFileHeader &header() const
+	{
+		return *static_cast<const ExplorationFileHeader *>(ptr);
+	}
+
+	/**
+	 * Returns the descriptor stored in the file.
+	 */
+	const EvaluationResultDescriptor &descriptor() const
+	{
+		return mDescriptor;
+	}
+
+	/**
+	 * Returns the base parameters stored in the file.
+	 */
+	const Parameters &params() const { return mParams; }
+
+	/**
+	 * Returns a pointer at the row-major data matrix of the given result
+	 * dimension.
+	 */
+	const float *layer(size_t dim) const;
+
+	/**
+	 * Converts the mapped data to an Exploration instance. Only the rows marked
+	 * as valid in the header are copied, all other rows are filled with the
+	 * default result.
+	 */
+	Exploration exploration() const;
+};
+
+/**
+ * The ExplorationIo class contains static functions for storing and loading
+ * exploration results in the binary format.
+ */
+class ExplorationIo {
+public:
+	/**
+	 * Stores the given exploration in the given file.
+	 *
+	 * @param filename is the target file name.
+	 * @param exploration is the exploration that should be stored.
+	 * @return true if the operation was successful, false otherwise.
+	 */
+	static bool storeExploration(const std::string &filename,
+	                             const Exploration &exploration);
+
+	/**
+	 * Writes the given result dimension in the gnuplot "binary matrix" format
+	 * to the given stream. This allows to stream the data to gnuplot via
+	 * "splot '-' binary matrix".
+	 *
+	 * @param os is the output stream the data should be written to.
+	 * @param exploration is the exploration containing the data.
+	 * @param dim is the result dimension that should be written.
+	 */
+	static void storeGnuPlotMatrix(std::ostream &os,
+	                               const Exploration &exploration, size_t dim);
+};
+}
+
+#endif /* _ADEXPSIM_EXPLORATION_IO_HPP_ */
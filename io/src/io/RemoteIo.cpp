@@ -0,0 +1,727 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <sstream>
+
+#include <exploration/SpikeTrainEvaluation.hpp>
+#include <exploration/SingleGroupSingleOutEvaluation.hpp>
+#include <exploration/SingleGroupMultiOutEvaluation.hpp>
+
+#include "JsonIo.hpp"
+#include "RemoteIo.hpp"
+
+namespace AdExpSim {
+
+/*
+ * Socket helper functions
+ */
+
+/**
+ * Size of the message header: payload size and message type.
+ */
+static constexpr size_t HEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t);
+
+/**
+ * Maximum accepted payload size, protects against corrupted streams.
+ */
+static constexpr uint32_t MAX_PAYLOAD_SIZE = 256 * 1024 * 1024;
+
+/**
+ * Maximum accepted exploration resolution per axis.
+ */
+static constexpr uint32_t MAX_EXPLORATION_STEPS = 4096;
+
+static bool isUnixAddress(const std::string &address)
+{
+	return address.compare(0, 5, "unix:") == 0;
+}
+
+static bool unixAddress(const std::string &address, sockaddr_un &addr)
+{
+	const std::string path = address.substr(5);
+	if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+		return false;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	return true;
+}
+
+static addrinfo *tcpAddress(const std::string &address, bool passive)
+{
+	const size_t sep = address.rfind(':');
+	if (sep == std::string::npos) {
+		return nullptr;
+	}
+	const std::string host = address.substr(0, sep);
+	const std::string port = address.substr(sep + 1);
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+	addrinfo *res = nullptr;
+	if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(),
+	                &hints, &res) != 0) {
+		return nullptr;
+	}
+	return res;
+}
+
+static void setNoDelay(int fd)
+{
+	int flag = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+static bool writeAll(int fd, const char *data, size_t size)
+{
+	while (size > 0) {
+		const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+
+static bool readAll(int fd, char *data, size_t size)
+{
+	while (size > 0) {
+		const ssize_t n = ::recv(fd, data, size, 0);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return false;
+		}
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+
+/*
+ * Class RemoteConnection
+ */
+
+RemoteConnection::~RemoteConnection()
+{
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+std::unique_ptr<RemoteConnection> RemoteConnection::connect(
+    const std::string &address)
+{
+	int fd = -1;
+	if (isUnixAddress(address)) {
+		sockaddr_un addr;
+		if (unixAddress(address, addr)) {
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd >= 0 &&
+			    ::connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+				close(fd);
+				fd = -1;
+			}
+		}
+	} else {
+		addrinfo *res = tcpAddress(address, false);
+		for (addrinfo *ai = res; ai != nullptr && fd < 0; ai = ai->ai_next) {
+			fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+			if (fd >= 0 && ::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+				close(fd);
+				fd = -1;
+			}
+		}
+		if (res != nullptr) {
+			freeaddrinfo(res);
+		}
+		if (fd >= 0) {
+			setNoDelay(fd);
+		}
+	}
+	return std::unique_ptr<RemoteConnection>(new RemoteConnection(fd));
+}
+
+bool RemoteConnection::send(const RemoteMessage &msg)
+{
+	if (fd < 0 || msg.mData.size() > MAX_PAYLOAD_SIZE) {
+		return false;
+	}
+
+	// Assemble header and payload, so small messages require a single call
+	std::string buf;
+	buf.reserve(HEADER_SIZE + msg.mData.size());
+	const uint32_t size = msg.mData.size();
+	const uint8_t type = uint8_t(msg.mType);
+	buf.append((const char *)&size, sizeof(size));
+	buf.append((const char *)&type, sizeof(type));
+	buf.append(msg.mData);
+
+	std::lock_guard<std::mutex> lock(sendMutex);
+	return writeAll(fd, buf.data(), buf.size());
+}
+
+bool RemoteConnection::receive(RemoteMessage &msg)
+{
+	char header[HEADER_SIZE];
+	if (fd < 0 || !readAll(fd, header, HEADER_SIZE)) {
+		return false;
+	}
+
+	uint32_t size;
+	memcpy(&size, header, sizeof(size));
+	if (size > MAX_PAYLOAD_SIZE) {
+		return false;
+	}
+
+	msg.mType = RemoteMessageType(uint8_t(header[sizeof(size)]));
+	msg.mData.resize(size);
+	msg.mPos = 0;
+	return readAll(fd, &msg.mData[0], size);
+}
+
+bool RemoteConnection::wait(int timeoutMs)
+{
+	if (fd < 0) {
+		return true;  // receive() returns immediately
+	}
+	pollfd pfd{fd, POLLIN, 0};
+	return poll(&pfd, 1, timeoutMs) != 0;
+}
+
+/*
+ * Class RemoteListener
+ */
+
+RemoteListener::RemoteListener(const std::string &address) : fd(-1)
+{
+	if (isUnixAddress(address)) {
+		sockaddr_un addr;
+		if (unixAddress(address, addr)) {
+			// Remove stale sockets of previous server instances
+			unlink(addr.sun_path);
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd >= 0 &&
+			    (bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0 ||
+			     listen(fd, 16) != 0)) {
+				close(fd);
+				fd = -1;
+			}
+			if (fd >= 0) {
+				path = addr.sun_path;
+			}
+		}
+	} else {
+		addrinfo *res = tcpAddress(address, true);
+		for (addrinfo *ai = res; ai != nullptr && fd < 0; ai = ai->ai_next) {
+			fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+			if (fd < 0) {
+				continue;
+			}
+			int flag = 1;
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+			if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 ||
+			    listen(fd, 16) != 0) {
+				close(fd);
+				fd = -1;
+			}
+		}
+		if (res != nullptr) {
+			freeaddrinfo(res);
+		}
+	}
+}
+
+RemoteListener::~RemoteListener()
+{
+	if (fd >= 0) {
+		close(fd);
+	}
+	if (!path.empty()) {
+		unlink(path.c_str());
+	}
+}
+
+std::unique_ptr<RemoteConnection> RemoteListener::accept()
+{
+	int cfd;
+	do {
+		cfd = ::accept(fd, nullptr, nullptr);
+	} while (cfd < 0 && errno == EINTR);
+	if (cfd < 0) {
+		return nullptr;
+	}
+	if (path.empty()) {
+		setNoDelay(cfd);
+	}
+	return std::unique_ptr<RemoteConnection>(new RemoteConnection(cfd));
+}
+
+/*
+ * Class RemoteIo
+ */
+
+const std::string RemoteIo::DEFAULT_ADDRESS = "unix:/tmp/adexpsim.sock";
+
+template <typename Vec>
+static void writeVector(RemoteMessage &msg, const Vec &vec)
+{
+	for (size_t i = 0; i < Vec::Size; i++) {
+		msg.write(float(vec[i]));
+	}
+}
+
+template <typename Vec>
+static bool readVector(RemoteMessage &msg, Vec &vec)
+{
+	for (size_t i = 0; i < Vec::Size; i++) {
+		float v;
+		if (!msg.read(v)) {
+			return false;
+		}
+		vec[i] = v;
+	}
+	return true;
+}
+
+template <typename T>
+static void writeArray(RemoteMessage &msg, const std::vector<T> &vec)
+{
+	msg.write(uint32_t(vec.size()));
+	msg.writeRaw(vec.data(), vec.size() * sizeof(T));
+}
+
+template <typename T>
+static bool readArray(RemoteMessage &msg, std::vector<T> &vec)
+{
+	// Make sure the payload actually contains the announced number of
+	// elements before allocating memory for them
+	uint32_t size;
+	if (!msg.read(size) || size > msg.remaining() / sizeof(T)) {
+		return false;
+	}
+	vec.resize(size);
+	return msg.readRaw(vec.data(), size * sizeof(T));
+}
+
+/**
+ * Writes the given ParameterCollection as JSON, followed by the generated
+ * spikes of the spike train. The latter is required as the spike train would
+ * be randomly regenerated when it is deserialized.
+ */
+static void writeCollection(RemoteMessage &msg,
+                            const ParameterCollection &collection)
+{
+	std::stringstream ss;
+	JsonIo::storeParameters(ss, collection);
+	msg.writeString(ss.str());
+
+	const SpikeTrain &train = collection.train;
+	writeArray(msg, train.getSpikes());
+	writeArray(msg, train.getRanges());
+	writeArray(msg, train.getRangeStartSpikes());
+}
+
+/**
+ * Checks whether the given spike train data is consistent, i.e. whether the
+ * SpikeTrainEvaluation can safely evaluate a spike train restored from it.
+ * Each range (except for a final range marking the end of the last group)
+ * must start at an input spike, the indices of these spikes must be strictly
+ * increasing.
+ */
+static bool validTrain(const SpikeVec &spikes,
+                       const std::vector<SpikeTrain::Range> &ranges,
+                       const std::vector<size_t> &rangeStartSpikes)
+{
+	if (ranges.empty() && (!spikes.empty() || !rangeStartSpikes.empty())) {
+		return false;
+	}
+	if (rangeStartSpikes.size() > ranges.size() ||
+	    rangeStartSpikes.size() + 1 < ranges.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < rangeStartSpikes.size(); i++) {
+		if (rangeStartSpikes[i] >= spikes.size() ||
+		    (i > 0 && rangeStartSpikes[i] <= rangeStartSpikes[i - 1])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool readCollection(RemoteMessage &msg, ParameterCollection &collection)
+{
+	std::string json;
+	SpikeVec spikes;
+	std::vector<SpikeTrain::Range> ranges;
+	std::vector<size_t> rangeStartSpikes;
+	if (!msg.readString(json) || !readArray(msg, spikes) ||
+	    !readArray(msg, ranges) || !readArray(msg, rangeStartSpikes) ||
+	    !validTrain(spikes, ranges, rangeStartSpikes)) {
+		return false;
+	}
+
+	std::stringstream ss(json);
+	if (!JsonIo::loadParameters(ss, collection)) {
+		return false;
+	}
+
+	// Each range must refer to one of the spike train descriptors, the
+	// SpikeTrainEvaluation uses the index to access them
+	const size_t nDescrs = collection.train.getDescrs().size();
+	for (const SpikeTrain::Range &range : ranges) {
+		if (range.descrIdx >= nDescrs) {
+			return false;
+		}
+	}
+	collection.train.restore(spikes, ranges, rangeStartSpikes);
+	return true;
+}
+
+RemoteMessage RemoteIo::encodeExplore(const ExploreJob &job)
+{
+	RemoteMessage msg(RemoteMessageType::EXPLORE);
+	msg.write(job.id).write(uint8_t(job.useFullParams));
+	writeVector(msg, job.fullParams);
+	writeVector(msg, job.params);
+	msg.write(uint32_t(job.dimX)).write(uint32_t(job.dimY));
+	msg.write(float(job.rangeX.min))
+	    .write(float(job.rangeX.max))
+	    .write(uint32_t(job.rangeX.steps));
+	msg.write(float(job.rangeY.min))
+	    .write(float(job.rangeY.max))
+	    .write(uint32_t(job.rangeY.steps));
+	writeCollection(msg, job.collection);
+	return msg;
+}
+
+bool RemoteIo::decodeExplore(RemoteMessage &msg, ExploreJob &job)
+{
+	uint8_t useFullParams;
+	uint32_t dimX, dimY, stepsX, stepsY;
+	float minX, maxX, minY, maxY;
+	if (!msg.read(job.id) || !msg.read(useFullParams) ||
+	    !readVector(msg, job.fullParams) || !readVector(msg, job.params) ||
+	    !msg.read(dimX) || !msg.read(dimY) || !msg.read(minX) ||
+	    !msg.read(maxX) || !msg.read(stepsX) || !msg.read(minY) ||
+	    !msg.read(maxY) || !msg.read(stepsY) ||
+	    !readCollection(msg, job.collection)) {
+		return false;
+	}
+	job.params.update();
+	job.useFullParams = useFullParams;
+	job.dimX = dimX;
+	job.dimY = dimY;
+
+	// The dimensions either index the full or the working parameters
+	const size_t nDims = useFullParams ? size_t(Parameters::Size)
+	                                   : size_t(WorkingParameters::Size);
+	if (dimX >= nDims || dimY >= nDims || dimX == dimY || stepsX == 0 || stepsX > MAX_EXPLORATION_STEPS || stepsY == 0 ||
+	    stepsY > MAX_EXPLORATION_STEPS) {
+		return false;
+	}
+	job.rangeX = DiscreteRange(minX, maxX, stepsX);
+	job.rangeY = DiscreteRange(minY, maxY, stepsY);
+	return true;
+}
+
+RemoteMessage RemoteIo::encodeOptimize(const OptimizeJob &job)
+{
+	RemoteMessage msg(RemoteMessageType::OPTIMIZE);
+	msg.write(job.id)
+	    .write(uint8_t(job.limitToHw))
+	    .write(int32_t(job.algorithm));
+	writeCollection(msg, job.collection);
+	return msg;
+}
+
+bool RemoteIo::decodeOptimize(RemoteMessage &msg, OptimizeJob &job)
+{
+	uint8_t limitToHw;
+	int32_t algorithm;
+	if (!msg.read(job.id) || !msg.read(limitToHw) || !msg.read(algorithm) ||
+	    !readCollection(msg, job.collection)) {
+		return false;
+	}
+	if (algorithm != int32_t(OptimizationAlgorithm::SIMPLEX) &&
+	    algorithm != int32_t(OptimizationAlgorithm::CMA_ES)) {
+		return false;
+	}
+	job.limitToHw = limitToHw;
+	job.algorithm = OptimizationAlgorithm(algorithm);
+	return true;
+}
+
+RemoteMessage RemoteIo::encodeCancel(uint32_t id)
+{
+	RemoteMessage msg(RemoteMessageType::CANCEL);
+	msg.write(id);
+	return msg;
+}
+
+RemoteMessage RemoteIo::encodeProgress(uint32_t id, float progress)
+{
+	RemoteMessage msg(RemoteMessageType::PROGRESS);
+	msg.write(id).write(progress);
+	return msg;
+}
+
+RemoteMessage RemoteIo::encodeDone(uint32_t id, bool ok)
+{
+	RemoteMessage msg(RemoteMessageType::DONE);
+	msg.write(id).write(uint8_t(ok));
+	return msg;
+}
+
+RemoteMessage RemoteIo::encodeTile(uint32_t id, const ExplorationTile &tile)
+{
+	RemoteMessage msg(RemoteMessageType::TILE);
+	msg.write(id)
+	    .write(uint32_t(tile.x0))
+	    .write(uint32_t(tile.y0))
+	    .write(uint32_t(tile.w))
+	    .write(uint32_t(tile.h))
+	    .write(uint32_t(tile.nDims));
+	static_assert(sizeof(Val) == sizeof(float), "Val must be a float");
+	msg.writeRaw(tile.values.data(), tile.values.size() * sizeof(Val));
+	return msg;
+}
+
+bool RemoteIo::decodeTile(RemoteMessage &msg, ExplorationTile &tile)
+{
+	uint32_t id, x0, y0, w, h, nDims;
+	if (!msg.read(id) || !msg.read(x0) || !msg.read(y0) || !msg.read(w) ||
+	    !msg.read(h) || !msg.read(nDims)) {
+		return false;
+	}
+
+	// Make sure the payload actually contains the announced tile before
+	// allocating memory for it
+	if (nDims > EvaluationResult::MAX_SIZE ||
+	    uint64_t(w) * h * nDims > msg.remaining() / sizeof(Val)) {
+		return false;
+	}
+	tile = ExplorationTile(x0, y0, w, h, nDims);
+	return msg.readRaw(tile.values.data(), tile.values.size() * sizeof(Val));
+}
+
+RemoteMessage RemoteIo::encodeOptimization(const OptimizationState &state)
+{
+	RemoteMessage msg(RemoteMessageType::OPTIMIZATION);
+	msg.write(state.id)
+	    .write(uint8_t(state.done))
+	    .write(uint64_t(state.nIt))
+	    .write(uint64_t(state.nInput))
+	    .write(state.eval)
+	    .write(uint32_t(state.output.size()));
+	for (const OptimizationResult &res : state.output) {
+		writeVector(msg, res.params);
+		msg.write(float(res.eval));
+	}
+	return msg;
+}
+
+bool RemoteIo::decodeOptimization(RemoteMessage &msg, OptimizationState &state)
+{
+	uint8_t done;
+	uint64_t nIt, nInput;
+	uint32_t n;
+	if (!msg.read(state.id) || !msg.read(done) || !msg.read(nIt) || !msg.read(nInput) ||
+	    !msg.read(state.eval) || !msg.read(n)) {
+		return false;
+	}
+	state.done = done;
+	state.nIt = nIt;
+	state.nInput = nInput;
+	state.output.clear();
+	for (size_t i = 0; i < n; i++) {
+		WorkingParameters params;
+		float eval;
+		if (!readVector(msg, params) || !msg.read(eval)) {
+			return false;
+		}
+		params.update();
+		state.output.emplace_back(params, eval);
+	}
+	return true;
+}
+
+/*
+ * Class RemoteClient
+ */
+
+RemoteClient::RemoteClient(const std::string &address)
+    : connection(RemoteConnection::connect(address)), nextId(1)
+{
+}
+
+/**
+ * Returns the descriptor of the evaluation selected in the given
+ * ParameterCollection.
+ */
+static EvaluationResultDescriptor evaluationDescriptor(
+    const ParameterCollection &params)
+{
+	const bool useIfCondExp = params.model == ModelType::IF_COND_EXP;
+	switch (params.evaluation) {
+		case EvaluationType::SPIKE_TRAIN:
+			return SpikeTrainEvaluation(params.train, useIfCondExp)
+			    .descriptor();
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			return SingleGroupSingleOutEvaluation(
+			           params.environment, params.singleGroup, useIfCondExp)
+			    .descriptor();
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			return SingleGroupMultiOutEvaluation(
+			           params.environment, params.singleGroup, useIfCondExp)
+			    .descriptor();
+	}
+	return EvaluationResultDescriptor();
+}
+
+bool RemoteClient::explore(Exploration &exploration,
+                           const ParameterCollection &params,
+                           const Exploration::ProgressCallback &progress,
+                           const Exploration::TileCallback &tileCallback)
+{
+	const uint32_t id = nextId++;
+	const RemoteIo::ExploreJob job{id,
+	                               exploration.useFullParams(),
+	                               exploration.fullParams(),
+	                               exploration.params(),
+	                               exploration.dimX(),
+	                               exploration.dimY(),
+	                               exploration.rangeX(),
+	                               exploration.rangeY(),
+	                               params};
+	if (!good() || !connection->send(RemoteIo::encodeExplore(job))) {
+		return false;
+	}
+
+	// Collect the incomming tiles in a new memory instance
+	ExplorationMemory mem(evaluationDescriptor(params), exploration.resX(),
+	                      exploration.resY(), exploration.storage());
+	exploration.setMem(mem);
+
+	bool cancelled = false;
+	Val lastProgress = 0.0;
+	auto cancel = [&]() {
+		if (!cancelled) {
+			cancelled = true;
+			connection->send(RemoteIo::encodeCancel(id));
+		}
+	};
+
+	RemoteMessage msg;
+	while (true) {
+		// Poll the progress callback while waiting, so aborting does not
+		// depend on the server sending data
+		if (!connection->wait(100)) {
+			if (!progress(lastProgress)) {
+				cancel();
+			}
+			continue;
+		}
+		if (!connection->receive(msg)) {
+			return false;
+		}
+
+		uint32_t msgId;
+		if (msg.type() == RemoteMessageType::TILE) {
+			ExplorationTile tile;
+			if (!RemoteIo::decodeTile(msg, tile) ||
+			    tile.x0 + tile.w > mem.resX || tile.y0 + tile.h > mem.resY) {
+				return false;
+			}
+			mem.store(tile);
+			tileCallback(tile);
+		} else if (msg.type() == RemoteMessageType::PROGRESS) {
+			float p;
+			if (RemoteIo::decodeJobValue(msg, msgId, p) && msgId == id) {
+				lastProgress = p;
+				if (!progress(p)) {
+					cancel();
+				}
+			}
+		} else if (msg.type() == RemoteMessageType::DONE) {
+			uint8_t ok;
+			if (RemoteIo::decodeJobValue(msg, msgId, ok) && msgId == id) {
+				mem.compact();
+				exploration.setMem(mem);
+				return ok && !cancelled;
+			}
+		}
+	}
+}
+
+std::vector<OptimizationResult> RemoteClient::optimize(
+    const ParameterCollection &params, bool limitToHw,
+    OptimizationAlgorithm algorithm, Optimization::ProgressCallback callback)
+{
+	const uint32_t id = nextId++;
+	const RemoteIo::OptimizeJob job{id, limitToHw, algorithm, params};
+	if (!good() || !connection->send(RemoteIo::encodeOptimize(job))) {
+		return std::vector<OptimizationResult>{};
+	}
+
+	bool cancelled = false;
+	RemoteIo::OptimizationState state;
+	RemoteMessage msg;
+	while (connection->receive(msg)) {
+		uint32_t msgId;
+		if (msg.type() == RemoteMessageType::OPTIMIZATION) {
+			if (!RemoteIo::decodeOptimization(msg, state)) {
+				break;
+			}
+			if (state.id == id && !state.done && !cancelled &&
+			    !callback(state.nIt, state.nInput, state.eval, state.output,
+			              SurrogateStatistics())) {
+				cancelled = true;
+				connection->send(RemoteIo::encodeCancel(id));
+			}
+		} else if (msg.type() == RemoteMessageType::DONE) {
+			uint8_t ok;
+			if (RemoteIo::decodeJobValue(msg, msgId, ok) && msgId == id) {
+				break;
+			}
+		}
+	}
+	return state.output;
+}
+}
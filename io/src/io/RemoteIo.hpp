@@ -0,0 +1,438 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file RemoteIo.hpp
+ *
+ * Contains the binary protocol and the socket handling used to run
+ * explorations and optimizations on a remote compute server.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_REMOTE_IO_HPP_
+#define _ADEXPSIM_REMOTE_IO_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <exploration/Exploration.hpp>
+#include <exploration/Optimization.hpp>
+#include <utils/ParameterCollection.hpp>
+
+namespace AdExpSim {
+
+/**
+ * Types of the messages exchanged between the client and the compute server.
+ */
+enum class RemoteMessageType : uint8_t {
+	/**
+	 * Client to server: starts an exploration. Contains the job id, the
+	 * exploration setup and the serialized ParameterCollection.
+	 */
+	EXPLORE = 1,
+
+	/**
+	 * Client to server: starts an optimization. Contains the job id, the
+	 * optimization settings and the serialized ParameterCollection.
+	 */
+	OPTIMIZE = 2,
+
+	/**
+	 * Client to server: aborts the job with the given id.
+	 */
+	CANCEL = 3,
+
+	/**
+	 * Server to client: progress of an exploration between zero and one.
+	 */
+	PROGRESS = 16,
+
+	/**
+	 * Server to client: a completed exploration tile.
+	 */
+	TILE = 17,
+
+	/**
+	 * Server to client: the current results of an optimization.
+	 */
+	OPTIMIZATION = 18,
+
+	/**
+	 * Server to client: the job has finished, contains a success flag.
+	 */
+	DONE = 19
+};
+
+/**
+ * The RemoteMessage class represents a single message of the remote protocol.
+ * The payload is a sequence of fixed size values in host byte order and
+ * length-prefixed strings, which are appended and read back in the same
+ * order.
+ */
+class RemoteMessage {
+private:
+	/**
+	 * Type of the message.
+	 */
+	RemoteMessageType mType;
+
+	/**
+	 * Payload of the message.
+	 */
+	std::string mData;
+
+	/**
+	 * Current read position within the payload.
+	 */
+	size_t mPos;
+
+	friend class RemoteConnection;
+
+public:
+	/**
+	 * Creates an empty message of the given type.
+	 */
+	explicit RemoteMessage(
+	    RemoteMessageType type = RemoteMessageType::DONE)
+	    : mType(type), mPos(0)
+	{
+	}
+
+	/**
+	 * Returns the type of the message.
+	 */
+	RemoteMessageType type() const { return mType; }
+
+	/**
+	 * Appends the given raw data to the payload.
+	 */
+	RemoteMessage &writeRaw(const void *data, size_t size)
+	{
+		mData.append(static_cast<const char *>(data), size);
+		return *this;
+	}
+
+	/**
+	 * Appends a single value of a trivially copyable type to the payload.
+	 */
+	template <typename T>
+	RemoteMessage &write(const T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value,
+		              "Only trivially copyable types can be written");
+		return writeRaw(&value, sizeof(T));
+	}
+
+	/**
+	 * Appends a length-prefixed string to the payload.
+	 */
+	RemoteMessage &writeString(const std::string &s)
+	{
+		write(uint32_t(s.size()));
+		return writeRaw(s.data(), s.size());
+	}
+
+	/**
+	 * Returns the number of payload bytes which have not been read yet.
+	 */
+	size_t remaining() const { return mData.size() - mPos; }
+
+	/**
+	 * Reads the given number of bytes from the payload. Returns false if the
+	 * payload is too short.
+	 */
+	bool readRaw(void *data, size_t size)
+	{
+		if (mData.size() - mPos < size) {
+			return false;
+		}
+		memcpy(data, mData.data() + mPos, size);
+		mPos += size;
+		return true;
+	}
+
+	/**
+	 * Reads a single value of a trivially copyable type from the payload.
+	 */
+	template <typename T>
+	bool read(T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value,
+		              "Only trivially copyable types can be read");
+		return readRaw(&value, sizeof(T));
+	}
+
+	/**
+	 * Reads a length-prefixed string from the payload.
+	 */
+	bool readString(std::string &s)
+	{
+		uint32_t len;
+		if (!read(len) || mData.size() - mPos < len) {
+			return false;
+		}
+		s.assign(mData.data() + mPos, len);
+		mPos += len;
+		return true;
+	}
+};
+
+/**
+ * The RemoteConnection class wraps a connected stream socket and transfers
+ * RemoteMessage instances. Each message is preceded by a header containing
+ * the payload size and the message type. Sending is thread safe, receiving
+ * must only be done by a single thread.
+ */
+class RemoteConnection {
+private:
+	/**
+	 * Socket file descriptor, -1 if the connection is closed.
+	 */
+	int fd;
+
+	/**
+	 * Mutex serializing the send() calls of multiple threads.
+	 */
+	std::mutex sendMutex;
+
+public:
+	/**
+	 * Creates a new connection for the given connected socket. The connection
+	 * takes ownership of the file descriptor.
+	 */
+	explicit RemoteConnection(int fd = -1) : fd(fd) {}
+
+	/**
+	 * Closes the socket.
+	 */
+	~RemoteConnection();
+
+	RemoteConnection(const RemoteConnection &) = delete;
+	RemoteConnection &operator=(const RemoteConnection &) = delete;
+
+	/**
+	 * Connects to the server at the given address. Addresses of the form
+	 * "unix:PATH" refer to a Unix domain socket, addresses of the form
+	 * "HOST:PORT" to a TCP socket. Check good() to see whether the connection
+	 * was established.
+	 */
+	static std::unique_ptr<RemoteConnection> connect(
+	    const std::string &address);
+
+	/**
+	 * Returns true if the socket is open.
+	 */
+	bool good() const { return fd >= 0; }
+
+	/**
+	 * Sends the given message, returns false if the connection is broken.
+	 */
+	bool send(const RemoteMessage &msg);
+
+	/**
+	 * Blocks until a complete message has been received. Returns false if the
+	 * connection was closed or is broken.
+	 */
+	bool receive(RemoteMessage &msg);
+
+	/**
+	 * Waits at most the given time for incoming data. Returns true if a call
+	 * to receive() will not block.
+	 */
+	bool wait(int timeoutMs);
+};
+
+/**
+ * The RemoteListener class opens a listening socket the compute server
+ * accepts connections on.
+ */
+class RemoteListener {
+private:
+	/**
+	 * Listening socket file descriptor, -1 if not listening.
+	 */
+	int fd;
+
+	/**
+	 * Path of the Unix domain socket, removed once the listener is closed.
+	 */
+	std::string path;
+
+public:
+	/**
+	 * Opens a listening socket on the given address, see
+	 * RemoteConnection::connect() for the address format. For TCP addresses
+	 * the host part may be empty to listen on all interfaces.
+	 */
+	explicit RemoteListener(const std::string &address);
+
+	/**
+	 * Closes the listening socket.
+	 */
+	~RemoteListener();
+
+	RemoteListener(const RemoteListener &) = delete;
+	RemoteListener &operator=(const RemoteListener &) = delete;
+
+	/**
+	 * Returns true if the socket is listening.
+	 */
+	bool good() const { return fd >= 0; }
+
+	/**
+	 * Blocks until a client connects and returns the new connection, returns
+	 * nullptr on error.
+	 */
+	std::unique_ptr<RemoteConnection> accept();
+};
+
+/**
+ * The RemoteIo class contains the functions used to encode and decode the
+ * individual messages of the remote protocol.
+ */
+class RemoteIo {
+public:
+	/**
+	 * Default address of the compute server.
+	 */
+	static const std::string DEFAULT_ADDRESS;
+
+	/**
+	 * Settings of an exploration job.
+	 */
+	struct ExploreJob {
+		uint32_t id;
+		bool useFullParams;
+		Parameters fullParams;
+		WorkingParameters params;
+		size_t dimX, dimY;
+		DiscreteRange rangeX, rangeY;
+		ParameterCollection collection;
+	};
+
+	/**
+	 * Settings of an optimization job.
+	 */
+	struct OptimizeJob {
+		uint32_t id;
+		bool limitToHw;
+		OptimizationAlgorithm algorithm;
+		ParameterCollection collection;
+	};
+
+	/**
+	 * Current state of an optimization job.
+	 */
+	struct OptimizationState {
+		uint32_t id;
+		bool done;
+		size_t nIt, nInput;
+		float eval;
+		std::vector<OptimizationResult> output;
+	};
+
+	static RemoteMessage encodeExplore(const ExploreJob &job);
+	static bool decodeExplore(RemoteMessage &msg, ExploreJob &job);
+
+	static RemoteMessage encodeOptimize(const OptimizeJob &job);
+	static bool decodeOptimize(RemoteMessage &msg, OptimizeJob &job);
+
+	static RemoteMessage encodeTile(uint32_t id, const ExplorationTile &tile);
+	static bool decodeTile(RemoteMessage &msg, ExplorationTile &tile);
+
+	static RemoteMessage encodeOptimization(const OptimizationState &state);
+	static bool decodeOptimization(RemoteMessage &msg,
+	                               OptimizationState &state);
+
+	static RemoteMessage encodeCancel(uint32_t id);
+	static RemoteMessage encodeProgress(uint32_t id, float progress);
+	static RemoteMessage encodeDone(uint32_t id, bool ok);
+
+	/**
+	 * Decodes the job id and value of a PROGRESS or DONE message.
+	 */
+	template <typename T>
+	static bool decodeJobValue(RemoteMessage &msg, uint32_t &id, T &value)
+	{
+		return msg.read(id) && msg.read(value);
+	}
+};
+
+/**
+ * The RemoteClient class runs explorations and optimizations on a compute
+ * server. Its methods mirror Exploration::run() and Optimization::optimize(),
+ * including the callbacks, so a job can be transparently moved to the server.
+ */
+class RemoteClient {
+private:
+	/**
+	 * Connection to the server.
+	 */
+	std::unique_ptr<RemoteConnection> connection;
+
+	/**
+	 * Id of the next job.
+	 */
+	uint32_t nextId;
+
+public:
+	/**
+	 * Connects to the compute server at the given address.
+	 */
+	explicit RemoteClient(const std::string &address);
+
+	/**
+	 * Returns true if the connection to the server was established.
+	 */
+	bool good() const { return connection && connection->good(); }
+
+	/**
+	 * Runs the given exploration on the server. The tiles are stored in the
+	 * exploration memory as they arrive, the evaluation is selected according
+	 * to the given ParameterCollection. Instrumentation counters are not
+	 * transferred, the thread count and thread limit are ignored.
+	 *
+	 * @return true if the exploration completed, false if it was aborted or
+	 * the connection failed.
+	 */
+	bool explore(Exploration &exploration, const ParameterCollection &params,
+	             const Exploration::ProgressCallback &progress =
+	                 [](Val) { return true; },
+	             const Exploration::TileCallback &tileCallback =
+	                 [](const ExplorationTile &) {});
+
+	/**
+	 * Runs an optimization starting at the parameters of the given
+	 * ParameterCollection on the server.
+	 *
+	 * @return the final optimization results.
+	 */
+	std::vector<OptimizationResult> optimize(
+	    const ParameterCollection &params, bool limitToHw,
+	    OptimizationAlgorithm algorithm,
+	    Optimization::ProgressCallback callback);
+};
+}
+
+#endif /* _ADEXPSIM_REMOTE_IO_HPP_ */
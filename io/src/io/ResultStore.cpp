@@ -0,0 +1,297 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <common/Hash.hpp>
+#include <exploration/EvaluationResult.hpp>
+
+#include "ResultStore.hpp"
+
+namespace AdExpSim {
+
+static_assert(sizeof(Val) == sizeof(float),
+              "Result store format requires Val to be float");
+
+static const char MAGIC[8] = {'A', 'D', 'X', 'R', 'S', 'L', 'T', '\0'};
+static const uint32_t FORMAT_VERSION = 1;
+
+/*
+ * Layout of the file: the header consists of the magic byte sequence, the file
+ * format version and the result version (all in native byte order). It is
+ * followed by the records, each consisting of the evaluation id (uint64), the
+ * number of parameters and result values (uint32 each), the parameters and
+ * values (float32 each) and the checksum of all preceding bytes of the record
+ * (uint64).
+ */
+static constexpr size_t HEADER_SIZE = 16;
+static constexpr size_t RECORD_HEADER_SIZE = 16;
+static constexpr size_t CHECKSUM_SIZE = 8;
+static constexpr size_t N_PARAMS = WorkingParameters::Size;
+static constexpr size_t MAX_RECORD_SIZE =
+    RECORD_HEADER_SIZE + (N_PARAMS + EvaluationResult::MAX_SIZE) * sizeof(Val) +
+    CHECKSUM_SIZE;
+
+/**
+ * Size of the file blocks read while scanning the log.
+ */
+static constexpr size_t READ_BLOCK_SIZE = 1 << 20;
+
+static size_t recordSize(size_t nValues)
+{
+	return RECORD_HEADER_SIZE + (N_PARAMS + nValues) * sizeof(Val) +
+	       CHECKSUM_SIZE;
+}
+
+static uint64_t keyHash(uint64_t evaluation, const Val *params)
+{
+	Hash hash;
+	hash << evaluation;
+	return hash.add(params, N_PARAMS * sizeof(Val)).value();
+}
+
+static bool readFully(int fd, void *data, size_t size, uint64_t offs)
+{
+	char *p = static_cast<char *>(data);
+	while (size > 0) {
+		ssize_t res = pread(fd, p, size, offs);
+		if (res <= 0) {
+			return false;
+		}
+		p += res;
+		offs += res;
+		size -= res;
+	}
+	return true;
+}
+
+static bool writeFully(int fd, const void *data, size_t size, uint64_t offs)
+{
+	const char *p = static_cast<const char *>(data);
+	while (size > 0) {
+		ssize_t res = pwrite(fd, p, size, offs);
+		if (res <= 0) {
+			return false;
+		}
+		p += res;
+		offs += res;
+		size -= res;
+	}
+	return true;
+}
+
+constexpr uint64_t ResultStore::DEFAULT_MAX_SIZE;
+
+ResultStore::ResultStore(const std::string &filename, uint64_t maxSize)
+    : fd(-1),
+      writable(false),
+      endOffset(HEADER_SIZE),
+      maxSize(maxSize),
+      nHits(0),
+      nLookups(0)
+{
+	// Open the file for writing, fall back to read-only access if this is not
+	// possible. Only the process holding the lock appends to the log.
+	fd = open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd >= 0) {
+		writable = flock(fd, LOCK_EX | LOCK_NB) == 0;
+	} else {
+		fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+	}
+	if (fd >= 0 && !load()) {
+		close(fd);
+		fd = -1;
+		writable = false;
+	}
+}
+
+ResultStore::~ResultStore()
+{
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+std::string ResultStore::defaultFilename()
+{
+	const char *filename = getenv("ADEXPSIM_RESULT_STORE");
+	return filename == nullptr ? std::string() : std::string(filename);
+}
+
+bool ResultStore::load()
+{
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		return false;
+	}
+	const uint64_t size = st.st_size;
+
+	// Check the header, start with an empty log if it does not match
+	char header[HEADER_SIZE];
+	const uint32_t versions[2] = {FORMAT_VERSION, ResultCache::VERSION};
+	if (size < HEADER_SIZE || !readFully(fd, header, HEADER_SIZE, 0) ||
+	    memcmp(header, MAGIC, sizeof(MAGIC)) != 0 ||
+	    memcmp(header + sizeof(MAGIC), versions, sizeof(versions)) != 0) {
+		if (!writable) {
+			return true;
+		}
+		memcpy(header, MAGIC, sizeof(MAGIC));
+		memcpy(header + sizeof(MAGIC), versions, sizeof(versions));
+		return ftruncate(fd, 0) == 0 &&
+		       writeFully(fd, header, HEADER_SIZE, 0);
+	}
+
+	// Scan the records block by block. Returns a pointer at the given range
+	// of the file or nullptr if the file ends before.
+	std::vector<char> block;
+	uint64_t blockOffs = 0;
+	auto fetch = [&](uint64_t offs, size_t len) -> const char * {
+		if (offs < blockOffs || offs + len > blockOffs + block.size()) {
+			if (offs + len > size) {
+				return nullptr;
+			}
+			block.resize(std::min<uint64_t>(READ_BLOCK_SIZE, size - offs));
+			blockOffs = offs;
+			if (!readFully(fd, block.data(), block.size(), offs)) {
+				block.clear();
+				return nullptr;
+			}
+		}
+		return block.data() + (offs - blockOffs);
+	};
+
+	// Add all valid records to the index, stop at the first invalid record
+	uint64_t offs = HEADER_SIZE;
+	while (const char *p = fetch(offs, RECORD_HEADER_SIZE)) {
+		uint64_t evaluation;
+		uint32_t nParams, nValues;
+		memcpy(&evaluation, p, sizeof(evaluation));
+		memcpy(&nParams, p + 8, sizeof(nParams));
+		memcpy(&nValues, p + 12, sizeof(nValues));
+		if (nParams != N_PARAMS || nValues > EvaluationResult::MAX_SIZE) {
+			break;
+		}
+
+		const size_t len = recordSize(nValues);
+		p = fetch(offs, len);
+		if (!p) {
+			break;
+		}
+		uint64_t checksum;
+		memcpy(&checksum, p + len - CHECKSUM_SIZE, sizeof(checksum));
+		if (Hash().add(p, len - CHECKSUM_SIZE).value() != checksum) {
+			break;
+		}
+
+		Val params[N_PARAMS];
+		memcpy(params, p + RECORD_HEADER_SIZE, sizeof(params));
+		index[keyHash(evaluation, params)] = offs;
+		offs += len;
+	}
+
+	// Discard the invalid tail of the log, new records are appended after the
+	// last valid record
+	endOffset = offs;
+	if (writable && offs < size) {
+		return ftruncate(fd, offs) == 0;
+	}
+	return true;
+}
+
+size_t ResultStore::size() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return index.size();
+}
+
+bool ResultStore::lookup(uint64_t evaluation, const WorkingParameters &params,
+                         Val *out, size_t n) const
+{
+	// Search the record offset in the index
+	nLookups++;
+	const uint64_t key = keyHash(evaluation, params.begin());
+	uint64_t offs;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = index.find(key);
+		if (it == index.end()) {
+			return false;
+		}
+		offs = it->second;
+	}
+
+	// Records are never modified once they are in the index, so they can be
+	// read without holding the lock. Make sure the record actually belongs to
+	// the given key.
+	char record[MAX_RECORD_SIZE];
+	const size_t len = recordSize(n);
+	if (n > EvaluationResult::MAX_SIZE ||
+	    !readFully(fd, record, len, offs)) {
+		return false;
+	}
+	const uint32_t head[2] = {uint32_t(N_PARAMS), uint32_t(n)};
+	if (memcmp(record, &evaluation, sizeof(evaluation)) != 0 ||
+	    memcmp(record + 8, head, sizeof(head)) != 0 ||
+	    memcmp(record + RECORD_HEADER_SIZE, params.begin(),
+	           N_PARAMS * sizeof(Val)) != 0) {
+		return false;
+	}
+	memcpy(out, record + RECORD_HEADER_SIZE + N_PARAMS * sizeof(Val),
+	       n * sizeof(Val));
+	nHits++;
+	return true;
+}
+
+void ResultStore::store(uint64_t evaluation, const WorkingParameters &params,
+                        const Val *values, size_t n)
+{
+	if (!writable || n > EvaluationResult::MAX_SIZE) {
+		return;
+	}
+	const size_t len = recordSize(n);
+
+	// Serialize the record
+	char record[MAX_RECORD_SIZE];
+	const uint32_t head[2] = {uint32_t(N_PARAMS), uint32_t(n)};
+	memcpy(record, &evaluation, sizeof(evaluation));
+	memcpy(record + 8, head, sizeof(head));
+	memcpy(record + RECORD_HEADER_SIZE, params.begin(), N_PARAMS * sizeof(Val));
+	memcpy(record + RECORD_HEADER_SIZE + N_PARAMS * sizeof(Val), values,
+	       n * sizeof(Val));
+	const uint64_t checksum = Hash().add(record, len - CHECKSUM_SIZE).value();
+	memcpy(record + len - CHECKSUM_SIZE, &checksum, sizeof(checksum));
+
+	// Append the record to the log, a record which failed to be written is
+	// overwritten by the next one
+	const uint64_t key = keyHash(evaluation, params.begin());
+	std::lock_guard<std::mutex> lock(mutex);
+	if (endOffset + len <= maxSize && index.count(key) == 0 &&
+	    writeFully(fd, record, len, endOffset)) {
+		index.emplace(key, endOffset);
+		endOffset += len;
+	}
+}
+}
@@ -0,0 +1,162 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ResultStore.hpp
+ *
+ * Contains the ResultStore class, a persistent, content addressed store for
+ * evaluation results which is shared between program runs.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_RESULT_STORE_HPP_
+#define _ADEXPSIM_RESULT_STORE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <exploration/ResultCache.hpp>
+
+namespace AdExpSim {
+
+/**
+ * The ResultStore class implements the ResultCache interface on top of an
+ * append-only log file. Each record contains the evaluation id, the evaluated
+ * working parameters, the result values and a checksum. When the store is
+ * opened, the log is scanned once and an in-memory index mapping the hash of
+ * each key to the file offset of its record is built, lookups read the record
+ * from the file and verify the complete key. A partially written record at
+ * the end of the log (e.g. after a crash) is discarded. Only one process may
+ * write to the store at a time, all other processes open it read-only.
+ */
+class ResultStore : public ResultCache {
+private:
+	/**
+	 * File descriptor of the log file, -1 if no file is open.
+	 */
+	int fd;
+
+	/**
+	 * Set to true if records can be appended to the log file.
+	 */
+	bool writable;
+
+	/**
+	 * Offset at which the next record is appended.
+	 */
+	uint64_t endOffset;
+
+	/**
+	 * Maximum size of the log file in bytes, no records are appended once
+	 * this size is reached.
+	 */
+	uint64_t maxSize;
+
+	/**
+	 * Maps the hash of the key of each record to the record offset.
+	 */
+	std::unordered_map<uint64_t, uint64_t> index;
+
+	/**
+	 * Mutex protecting the index and the end offset of the log.
+	 */
+	mutable std::mutex mutex;
+
+	/**
+	 * Number of successful lookups and of lookups in total.
+	 */
+	mutable std::atomic<uint64_t> nHits, nLookups;
+
+	/**
+	 * Scans the log file and builds the index, truncates the log after the
+	 * last valid record.
+	 */
+	bool load();
+
+public:
+	/**
+	 * Default maximum size of the log file in bytes (about one million
+	 * records).
+	 */
+	static constexpr uint64_t DEFAULT_MAX_SIZE = 128 << 20;
+
+	/**
+	 * Opens the store with the given file name, creates the file if it does
+	 * not exist yet. Existing files written with a different result version
+	 * are cleared.
+	 *
+	 * @param maxSize is the maximum size of the log file in bytes. Once the
+	 * log has reached this size, new results are no longer stored, which also
+	 * bounds the memory used by the index.
+	 */
+	ResultStore(const std::string &filename,
+	            uint64_t maxSize = DEFAULT_MAX_SIZE);
+
+	/**
+	 * Closes the file.
+	 */
+	~ResultStore() override;
+
+	/**
+	 * Returns the file name of the result store shared by the applications.
+	 * The store is opt-in, the file name is read from the
+	 * ADEXPSIM_RESULT_STORE environment variable. An empty string is returned
+	 * if the store is disabled (the variable is not set or empty).
+	 */
+	static std::string defaultFilename();
+
+	ResultStore(const ResultStore &) = delete;
+	ResultStore &operator=(const ResultStore &) = delete;
+
+	/**
+	 * Returns true if the file was successfully opened.
+	 */
+	bool good() const { return fd >= 0; }
+
+	/**
+	 * Returns true if new results are appended to the file, false if another
+	 * process is writing to the store. Results are silently dropped once the
+	 * maximum size has been reached.
+	 */
+	bool isWritable() const { return writable; }
+
+	/**
+	 * Returns the number of results in the store.
+	 */
+	size_t size() const;
+
+	/**
+	 * Returns the number of successful lookups and the total number of
+	 * lookups since the store was opened.
+	 */
+	uint64_t hits() const { return nHits.load(); }
+	uint64_t lookups() const { return nLookups.load(); }
+
+	bool lookup(uint64_t evaluation, const WorkingParameters &params, Val *out,
+	            size_t n) const override;
+
+	void store(uint64_t evaluation, const WorkingParameters &params,
+	           const Val *values, size_t n) override;
+};
+}
+
+#endif /* _ADEXPSIM_RESULT_STORE_HPP_ */
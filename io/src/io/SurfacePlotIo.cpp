@@ -25,6 +25,7 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include "ExplorationIo.hpp"
 #include "SurfacePlotIo.hpp"
 
 namespace AdExpSim {
@@ -140,9 +141,9 @@ void SurfacePlotIo::runGnuPlot(const Parameters &params,
 			  "set cbrange [" << r.max << ":" << r.min << "]; "
 			  "set zrange [" << r.max << ":" << r.min << "]; "
 			  "set view 0, 0; "
-			  "splot '-' with pm3d"
+			  "splot '-' binary matrix with pm3d"
 		   << std::endl;
-		storeSurfacePlot(os, exploration, dim);
+		ExplorationIo::storeGnuPlotMatrix(os, exploration, dim);
 	}
 }
 }
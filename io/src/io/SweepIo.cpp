@@ -0,0 +1,188 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "SweepIo.hpp"
+
+namespace AdExpSim {
+
+static_assert(sizeof(Val) == sizeof(float),
+              "Binary sweep format requires Val to be float");
+
+static const char MAGIC[8] = {'A', 'D', 'X', 'S', 'W', 'E', 'P', '\0'};
+static const uint32_t VERSION = 1;
+static const size_t ALIGNMENT = 64;
+
+/*
+ * Helper functions for serializing the variable sized header part.
+ */
+
+static void appendRaw(std::string &buf, const void *data, size_t size)
+{
+	buf.append(static_cast<const char *>(data), size);
+}
+
+static void appendString(std::string &buf, const std::string &s)
+{
+	uint32_t len = s.size();
+	appendRaw(buf, &len, sizeof(len));
+	buf.append(s);
+}
+
+/**
+ * Serializes the complete header, including the parameters, the swept
+ * dimensions and the result descriptor.
+ */
+static std::string buildHeader(const Sweep &sweep,
+                               const EvaluationResultDescriptor &descriptor)
+{
+	// Serialize the variable part
+	std::string var;
+	const Parameters &params = sweep.fullParams();
+	for (size_t i = 0; i < params.size(); i++) {
+		float v = params[i];
+		appendRaw(var, &v, sizeof(v));
+	}
+	for (size_t k = 0; k < sweep.dims().size(); k++) {
+		uint32_t dim = sweep.dims()[k];
+		float v[2] = {sweep.ranges()[k].min, sweep.ranges()[k].max};
+		appendRaw(var, &dim, sizeof(dim));
+		appendRaw(var, v, sizeof(v));
+	}
+	for (size_t i = 0; i < descriptor.size(); i++) {
+		float v[3] = {descriptor.defaultResult()[i], descriptor.range(i).min,
+		              descriptor.range(i).max};
+		appendRaw(var, v, sizeof(v));
+		appendString(var, descriptor.id(i));
+		appendString(var, descriptor.name(i));
+		appendString(var, descriptor.unit(i));
+	}
+
+	// Fill the fixed size header
+	SweepFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.dataOffset =
+	    ((sizeof(header) + var.size() + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+	header.evaluationType = int32_t(descriptor.type());
+	header.useFullParams = sweep.useFullParams() ? 1 : 0;
+	header.sampling = uint32_t(sweep.sampling());
+	header.nDims = sweep.dims().size();
+	header.nResults = descriptor.size();
+	header.optimizationDim = descriptor.optimizationDim();
+	header.nSamples = sweep.samples();
+	header.seed = sweep.seed();
+
+	std::string res;
+	appendRaw(res, &header, sizeof(header));
+	res.append(var);
+	res.resize(header.dataOffset, '\0');
+	return res;
+}
+
+/*
+ * Class SweepWriter
+ */
+
+SweepWriter::SweepWriter(const std::string &filename, const Sweep &sweep,
+                         const EvaluationResultDescriptor &descriptor)
+    : fd(-1),
+      dataOffset(0),
+      nSamples(sweep.samples()),
+      stride(sweep.dims().size() + descriptor.size()),
+      chunkWritten((nSamples + SweepMemory::CHUNK_SIZE - 1) /
+                   SweepMemory::CHUNK_SIZE),
+      chunksComplete(0)
+{
+	fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return;
+	}
+
+	// Write the header and preallocate the file
+	const std::string header = buildHeader(sweep, descriptor);
+	dataOffset = header.size();
+	if (!write(0, header.data(), header.size()) ||
+	    ftruncate(fd, dataOffset + nSamples * stride * sizeof(float)) != 0) {
+		close();
+	}
+}
+
+SweepWriter::~SweepWriter() { close(); }
+
+bool SweepWriter::write(size_t offs, const void *data, size_t size)
+{
+	const char *p = static_cast<const char *>(data);
+	while (size > 0) {
+		ssize_t n = pwrite(fd, p, size, offs);
+		if (n <= 0) {
+			return false;
+		}
+		p += n;
+		offs += n;
+		size -= n;
+	}
+	return true;
+}
+
+bool SweepWriter::storeChunk(const SweepMemory &mem, size_t c)
+{
+	if (fd < 0 || mem.nSamples != nSamples || mem.stride() != stride ||
+	    c >= chunkWritten.size()) {
+		return false;
+	}
+
+	// The chunk memory has the same layout as the sample table
+	const size_t i0 = mem.chunkBegin(c);
+	const size_t n = mem.chunkEnd(c) - i0;
+	if (!write(dataOffset + i0 * stride * sizeof(float), mem.coords(i0),
+	           n * stride * sizeof(float))) {
+		return false;
+	}
+
+	// Update the number of leading samples which are complete
+	chunkWritten[c] = true;
+	const size_t oldChunksComplete = chunksComplete;
+	while (chunksComplete < chunkWritten.size() &&
+	       chunkWritten[chunksComplete]) {
+		chunksComplete++;
+	}
+	if (chunksComplete == oldChunksComplete) {
+		return true;
+	}
+	uint32_t v =
+	    std::min(nSamples, chunksComplete * SweepMemory::CHUNK_SIZE);
+	return write(offsetof(SweepFileHeader, samplesValid), &v, sizeof(v));
+}
+
+void SweepWriter::close()
+{
+	if (fd >= 0) {
+		fsync(fd);
+		::close(fd);
+		fd = -1;
+	}
+}
+}
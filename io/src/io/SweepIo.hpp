@@ -0,0 +1,187 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file SweepIo.hpp
+ *
+ * Contains a writer for the binary sweep file format. The file consists of a
+ * small header (storing the evaluation type, the sampling method, the base
+ * parameters, the swept dimensions and the result descriptor) followed by a
+ * float32 table with one row per sample. Each row contains the coordinates of
+ * the sample directly followed by its evaluation result, which is the layout
+ * used by the SweepMemory chunks.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_SWEEP_IO_HPP_
+#define _ADEXPSIM_SWEEP_IO_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <exploration/Sweep.hpp>
+
+namespace AdExpSim {
+
+/**
+ * Fixed size header at the beginning of each binary sweep file. All values are
+ * stored in the native byte order.
+ */
+struct SweepFileHeader {
+	/**
+	 * Magic byte sequence identifying the file type.
+	 */
+	char magic[8];
+
+	/**
+	 * File format version.
+	 */
+	uint32_t version;
+
+	/**
+	 * Size of the complete header (including the variable sized part) in
+	 * bytes. This is the offset of the sample table, it is a multiple of 64
+	 * bytes.
+	 */
+	uint32_t dataOffset;
+
+	/**
+	 * EvaluationType the data was generated with.
+	 */
+	int32_t evaluationType;
+
+	/**
+	 * Set to one if the full parameter set was swept.
+	 */
+	uint32_t useFullParams;
+
+	/**
+	 * SweepSampling method used to place the samples.
+	 */
+	uint32_t sampling;
+
+	/**
+	 * Number of swept parameter dimensions.
+	 */
+	uint32_t nDims;
+
+	/**
+	 * Number of result dimensions stored per sample.
+	 */
+	uint32_t nResults;
+
+	/**
+	 * Index of the result dimension which should be optimized.
+	 */
+	uint32_t optimizationDim;
+
+	/**
+	 * Total number of samples.
+	 */
+	uint32_t nSamples;
+
+	/**
+	 * Number of leading samples which have been completely written. Allows
+	 * readers to access files which are still being written.
+	 */
+	uint32_t samplesValid;
+
+	/**
+	 * Seed used to randomize the sample positions.
+	 */
+	uint64_t seed;
+};
+
+/**
+ * The SweepWriter class allows to write a sweep file incrementally. The file is
+ * preallocated when the writer is opened, afterwards the chunks of the sweep
+ * memory can be written in an arbitrary order. This allows to write the chunks
+ * from the chunk callback of Sweep::run() as soon as they are available.
+ */
+class SweepWriter {
+private:
+	/**
+	 * File descriptor of the output file, -1 if no file is open.
+	 */
+	int fd;
+
+	/**
+	 * Offset of the sample table.
+	 */
+	size_t dataOffset;
+
+	/**
+	 * Number of samples and number of values stored per sample.
+	 */
+	size_t nSamples, stride;
+
+	/**
+	 * Flags indicating which chunks have been written and number of leading
+	 * chunks which are complete.
+	 */
+	std::vector<bool> chunkWritten;
+	size_t chunksComplete;
+
+	/**
+	 * Writes the given data block at the given file offset.
+	 */
+	bool write(size_t offs, const void *data, size_t size);
+
+public:
+	/**
+	 * Creates a new SweepWriter instance and writes the header corresponding
+	 * to the given sweep. The sweep itself does not need to contain any data.
+	 *
+	 * @param filename is the name of the file that should be written.
+	 * @param sweep is the sweep instance from which the header information
+	 * (sampling, dimensions and ranges) should be read.
+	 * @param descriptor is the descriptor of the evaluation that is used.
+	 */
+	SweepWriter(const std::string &filename, const Sweep &sweep,
+	            const EvaluationResultDescriptor &descriptor);
+
+	/**
+	 * Closes the file.
+	 */
+	~SweepWriter();
+
+	SweepWriter(const SweepWriter &) = delete;
+	SweepWriter &operator=(const SweepWriter &) = delete;
+
+	/**
+	 * Returns true if the file was successfully opened.
+	 */
+	bool good() const { return fd >= 0; }
+
+	/**
+	 * Stores the given chunk of the sweep memory. Once all chunks up to a
+	 * certain chunk have been written, the number of valid samples in the
+	 * header is updated.
+	 */
+	bool storeChunk(const SweepMemory &mem, size_t c);
+
+	/**
+	 * Flushes the file contents to the disk and closes the file.
+	 */
+	void close();
+};
+}
+
+#endif /* _ADEXPSIM_SWEEP_IO_HPP_ */
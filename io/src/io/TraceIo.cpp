@@ -0,0 +1,199 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "TraceIo.hpp"
+
+namespace AdExpSim {
+
+/**
+ * Powers of ten which are exactly representable as double.
+ */
+static const double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                               1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                               1e18, 1e19, 1e20, 1e21, 1e22};
+
+static double powerOfTen(int e)
+{
+	if (e >= 0 && e <= 22) {
+		return POW10[e];
+	}
+	if (e < 0 && e >= -22) {
+		return 1.0 / POW10[-e];
+	}
+	return std::pow(10.0, e);
+}
+
+/**
+ * Parses a decimal floating point number starting at p without copying the
+ * input. Leading spaces are skipped. Advances p past the number and returns
+ * true on success.
+ */
+static bool parseNumber(const char *&p, const char *end, double &res)
+{
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		p++;
+	}
+
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+
+	// Read up to 19 significant digits into an integer mantissa, further
+	// digits only affect the exponent
+	uint64_t mantissa = 0;
+	int digits = 0, exponent = 0;
+	bool any = false;
+	for (; p < end && *p >= '0' && *p <= '9'; p++, any = true) {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			digits += mantissa > 0;
+		} else {
+			exponent++;
+		}
+	}
+	if (p < end && *p == '.') {
+		p++;
+		for (; p < end && *p >= '0' && *p <= '9'; p++, any = true) {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += mantissa > 0;
+				exponent--;
+			}
+		}
+	}
+	if (!any) {
+		return false;
+	}
+
+	// Optional exponent
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char *q = p + 1;
+		bool negativeExp = false;
+		if (q < end && (*q == '-' || *q == '+')) {
+			negativeExp = *q == '-';
+			q++;
+		}
+		if (q < end && *q >= '0' && *q <= '9') {
+			int e = 0;
+			for (; q < end && *q >= '0' && *q <= '9'; q++) {
+				e = std::min(e * 10 + (*q - '0'), 10000);
+			}
+			exponent += negativeExp ? -e : e;
+			p = q;
+		}
+	}
+
+	res = double(mantissa);
+	if (exponent < 0) {
+		res /= powerOfTen(-exponent);
+	} else {
+		res *= powerOfTen(exponent);
+	}
+	if (negative) {
+		res = -res;
+	}
+	return true;
+}
+
+void TraceIo::parseTrace(const char *begin, const char *end, TraceVec &trace,
+                         Val timeScale, Val voltageScale)
+{
+	const size_t offs = trace.size();
+	const char *p = begin;
+	while (p < end) {
+		// Parse the two columns, the line is valid if nothing but whitespace
+		// follows
+		double t, v;
+		bool ok = parseNumber(p, end, t);
+		while (p < end && (*p == ' ' || *p == '\t')) {
+			p++;
+		}
+		ok = ok && p < end && *(p++) == ',' && parseNumber(p, end, v);
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+			p++;
+		}
+		ok = ok && (p == end || *p == '\n');
+		if (ok) {
+			trace.emplace_back(t * timeScale, v * voltageScale);
+		}
+
+		// Advance to the next line
+		while (p < end && *(p++) != '\n') {
+		}
+	}
+
+	// Make sure the trace is sorted
+	if (!std::is_sorted(trace.begin() + offs, trace.end(),
+	                    [](const TraceSample &a, const TraceSample &b) {
+		                    return a.t < b.t;
+		                })) {
+		std::stable_sort(trace.begin() + offs, trace.end(),
+		                 [](const TraceSample &a, const TraceSample &b) {
+			                 return a.t < b.t;
+			             });
+	}
+}
+
+bool TraceIo::loadTrace(const std::string &filename, TraceVec &trace,
+                        Val timeScale, Val voltageScale)
+{
+	trace.clear();
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		return false;
+	}
+	const size_t size = st.st_size;
+	if (size == 0) {
+		::close(fd);
+		return true;
+	}
+	void *ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (ptr == MAP_FAILED) {
+		return false;
+	}
+	madvise(ptr, size, MADV_SEQUENTIAL);
+
+	// Reserve memory for the samples, assuming at least ten bytes per line
+	const char *begin = static_cast<const char *>(ptr);
+	trace.reserve(size / 10);
+	parseTrace(begin, begin + size, trace, timeScale, voltageScale);
+	trace.shrink_to_fit();
+
+	munmap(ptr, size);
+	return true;
+}
+}
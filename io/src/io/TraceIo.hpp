@@ -0,0 +1,76 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @file TraceIo.hpp
+ *
+ * Contains functions for loading recorded membrane potential traces from CSV
+ * files. The files are memory mapped and parsed in place.
+ *
+ * @author Andreas Stöckel
+ */
+
+#ifndef _ADEXPSIM_TRACE_IO_HPP_
+#define _ADEXPSIM_TRACE_IO_HPP_
+
+#include <string>
+
+#include <simulation/Recorder.hpp>
+
+namespace AdExpSim {
+
+/**
+ * The TraceIo class contains static functions for loading membrane potential
+ * traces.
+ */
+class TraceIo {
+public:
+	/**
+	 * Parses a CSV trace stored in the given memory region. Each line consists
+	 * of a time and a membrane potential, separated by a comma. Lines which
+	 * cannot be parsed (such as headers or empty lines) are skipped. The
+	 * resulting trace is sorted by time.
+	 *
+	 * @param begin is a pointer at the first character.
+	 * @param end is a pointer one past the last character.
+	 * @param trace is the vector the samples are appended to.
+	 * @param timeScale is the factor converting the time column to seconds.
+	 * @param voltageScale is the factor converting the voltage column to
+	 * volts.
+	 */
+	static void parseTrace(const char *begin, const char *end, TraceVec &trace,
+	                       Val timeScale = 1e-3, Val voltageScale = 1e-3);
+
+	/**
+	 * Loads a CSV trace from the given file, see parseTrace() for the format.
+	 * By default the file is expected to contain milliseconds and millivolts.
+	 *
+	 * @param filename is the file that should be read.
+	 * @param trace is the target trace, previous content is discarded.
+	 * @param timeScale is the factor converting the time column to seconds.
+	 * @param voltageScale is the factor converting the voltage column to
+	 * volts.
+	 * @return true if the operation was successful, false otherwise.
+	 */
+	static bool loadTrace(const std::string &filename, TraceVec &trace,
+	                      Val timeScale = 1e-3, Val voltageScale = 1e-3);
+};
+}
+
+#endif /* _ADEXPSIM_TRACE_IO_HPP_ */
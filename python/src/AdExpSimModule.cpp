@@ -0,0 +1,964 @@
+/*
+ *  AdExpSim -- Simulator for the AdExp model
+ *  Copyright (C) 2015  Andreas Stöckel
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file AdExpSimModule.cpp
+ *
+ * Python extension module "adexpsim" providing access to the neuron
+ * simulation, the evaluations and the parameter space exploration. Input
+ * arrays are accepted from any object supporting the buffer protocol (e.g.
+ * NumPy arrays) or from nested sequences. Results are returned as memoryview
+ * objects referring to the buffers the C++ code wrote to, numpy.asarray()
+ * wraps them without copying. The GIL is released while the computations are
+ * running.
+ *
+ * @author Andreas Stöckel
+ */
+
+#include <Python.h>
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <exploration/Exploration.hpp>
+#include <exploration/SpikeTrainEvaluation.hpp>
+#include <exploration/SingleGroupSingleOutEvaluation.hpp>
+#include <exploration/SingleGroupMultiOutEvaluation.hpp>
+#include <io/JsonIo.hpp>
+#include <simulation/Controller.hpp>
+#include <simulation/DormandPrinceIntegrator.hpp>
+#include <simulation/Model.hpp>
+#include <simulation/Recorder.hpp>
+#include <utils/ParameterCollection.hpp>
+
+namespace AdExpSim {
+
+/*
+ * Output arrays
+ */
+
+/**
+ * Describes the memory layout of a C-contiguous array and owns the memory.
+ * Arrays are exposed to Python via the buffer protocol of the ArrayObject
+ * type.
+ */
+class ArrayStorage {
+public:
+	void *data;
+	const char *format;
+	Py_ssize_t itemsize;
+	Py_ssize_t len;
+	int ndim;
+	Py_ssize_t shape[2];
+	Py_ssize_t strides[2];
+
+	virtual ~ArrayStorage() {}
+
+	/**
+	 * Sets the shape of the array and calculates the strides, the array is
+	 * one-dimensional if h is zero.
+	 */
+	void setShape(size_t w, size_t h = 0)
+	{
+		ndim = h > 0 ? 2 : 1;
+		shape[0] = h > 0 ? h : w;
+		shape[1] = w;
+		strides[0] = h > 0 ? w * itemsize : itemsize;
+		strides[1] = itemsize;
+		len = (h > 0 ? h : 1) * w * itemsize;
+	}
+};
+
+template <typename T>
+struct ArrayFormat;
+
+template <>
+struct ArrayFormat<float> {
+	static constexpr const char *format = "f";
+};
+
+template <>
+struct ArrayFormat<double> {
+	static constexpr const char *format = "d";
+};
+
+/**
+ * ArrayStorage implementation taking ownership of a container with a data()
+ * method, such as std::vector or Matrix.
+ */
+template <typename Container, typename T>
+class ContainerStorage : public ArrayStorage {
+private:
+	Container container;
+
+public:
+	ContainerStorage(Container &&c, T *ptr, size_t w, size_t h = 0)
+	    : container(std::move(c))
+	{
+		// Fetch the pointer only after the container has been moved, it is
+		// passed in for containers without a mutable data() method
+		data = ptr == nullptr ? static_cast<void *>(container.data())
+		                      : static_cast<void *>(ptr);
+		format = ArrayFormat<T>::format;
+		itemsize = sizeof(T);
+		setShape(w, h);
+	}
+};
+
+/**
+ * Python object owning an ArrayStorage instance.
+ */
+struct ArrayObject {
+	PyObject_HEAD ArrayStorage *storage;
+};
+
+static PyTypeObject ArrayType;
+static PyBufferProcs ArrayBufferProcs;
+
+/**
+ * Converts a Python object of type ArrayType into the ArrayObject it is part
+ * of, going through void * keeps the cast free of type punning.
+ */
+static ArrayObject *asArray(PyObject *self)
+{
+	return static_cast<ArrayObject *>(static_cast<void *>(self));
+}
+
+static void arrayDealloc(PyObject *self)
+{
+	delete asArray(self)->storage;
+	Py_TYPE(self)->tp_free(self);
+}
+
+static int arrayGetBuffer(PyObject *self, Py_buffer *view, int flags)
+{
+	const ArrayStorage &s = *asArray(self)->storage;
+	view->obj = self;
+	view->buf = s.data;
+	view->len = s.len;
+	view->readonly = 0;
+	view->itemsize = s.itemsize;
+	view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>(s.format)
+	                                      : nullptr;
+	view->ndim = s.ndim;
+	view->shape = ((flags & PyBUF_ND) == PyBUF_ND)
+	                  ? const_cast<Py_ssize_t *>(s.shape)
+	                  : nullptr;
+	view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+	                    ? const_cast<Py_ssize_t *>(s.strides)
+	                    : nullptr;
+	view->suboffsets = nullptr;
+	view->internal = nullptr;
+	Py_INCREF(self);
+	return 0;
+}
+
+/**
+ * Wraps the given container in a memoryview without copying the data. The
+ * array is one-dimensional if h is zero, otherwise it has h rows and w
+ * columns.
+ */
+template <typename T, typename Container>
+static PyObject *wrap(Container &&container, size_t w, size_t h = 0,
+                      T *ptr = nullptr)
+{
+	ArrayObject *obj = PyObject_New(ArrayObject, &ArrayType);
+	if (obj == nullptr) {
+		return nullptr;
+	}
+	obj->storage =
+	    new ContainerStorage<Container, T>(std::move(container), ptr, w, h);
+	PyObject *res = PyMemoryView_FromObject(&obj->ob_base);
+	Py_DECREF(&obj->ob_base);
+	return res;
+}
+
+/*
+ * Input arrays
+ */
+
+/**
+ * Two-dimensional input array converted to double values.
+ */
+struct InputArray {
+	std::vector<double> data;
+	size_t rows = 0;
+	size_t cols = 0;
+
+	double operator()(size_t row, size_t col) const
+	{
+		return data[row * cols + col];
+	}
+};
+
+/**
+ * Reads a one- or two-dimensional array of floating point values from an
+ * object supporting the buffer protocol. One-dimensional arrays are treated as
+ * a single row.
+ */
+static bool readBuffer(PyObject *obj, const char *name, InputArray &res)
+{
+	Py_buffer view;
+	if (PyObject_GetBuffer(obj, &view, PyBUF_RECORDS_RO) != 0) {
+		return false;
+	}
+
+	// Only accept native floating point formats
+	const char *format = view.format == nullptr ? "B" : view.format;
+	if (*format == '@' || *format == '=' || *format == '<') {
+		format++;
+	}
+	const bool isDouble = format[0] == 'd' && format[1] == 0;
+	const bool isFloat = format[0] == 'f' && format[1] == 0;
+	if ((!isDouble && !isFloat) || view.ndim < 1 || view.ndim > 2) {
+		PyErr_Format(PyExc_TypeError,
+		             "%s must be a one- or two-dimensional array of float32 "
+		             "or float64 values",
+		             name);
+		PyBuffer_Release(&view);
+		return false;
+	}
+
+	res.rows = view.ndim == 2 ? view.shape[0] : 1;
+	res.cols = view.shape[view.ndim - 1];
+	res.data.resize(res.rows * res.cols);
+	const Py_ssize_t rowStride = view.ndim == 2 ? view.strides[0] : 0;
+	const Py_ssize_t colStride = view.strides[view.ndim - 1];
+	for (size_t i = 0; i < res.rows; i++) {
+		const char *row = static_cast<const char *>(view.buf) + i * rowStride;
+		for (size_t j = 0; j < res.cols; j++) {
+			const char *p = row + j * colStride;
+			res.data[i * res.cols + j] =
+			    isDouble ? *reinterpret_cast<const double *>(p)
+			             : *reinterpret_cast<const float *>(p);
+		}
+	}
+	PyBuffer_Release(&view);
+	return true;
+}
+
+/**
+ * Reads a row of numbers from a sequence.
+ */
+static bool readSequenceRow(PyObject *seq, const char *name,
+                            std::vector<double> &row)
+{
+	PyObject *fast = PySequence_Fast(seq, name);
+	if (fast == nullptr) {
+		return false;
+	}
+	const Py_ssize_t n = PySequence_Fast_GET_SIZE(fast);
+	row.resize(n);
+	for (Py_ssize_t i = 0; i < n; i++) {
+		row[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(fast, i));
+		if (PyErr_Occurred()) {
+			Py_DECREF(fast);
+			return false;
+		}
+	}
+	Py_DECREF(fast);
+	return true;
+}
+
+/**
+ * Reads a one- or two-dimensional array either from a buffer or from a
+ * (nested) sequence of numbers.
+ */
+static bool readArray(PyObject *obj, const char *name, InputArray &res)
+{
+	if (PyObject_CheckBuffer(obj)) {
+		return readBuffer(obj, name, res);
+	}
+	if (!PySequence_Check(obj)) {
+		PyErr_Format(PyExc_TypeError, "%s must be an array or a sequence",
+		             name);
+		return false;
+	}
+
+	// Check whether this is a sequence of sequences
+	const Py_ssize_t n = PySequence_Size(obj);
+	PyObject *first = n > 0 ? PySequence_GetItem(obj, 0) : nullptr;
+	const bool nested = first != nullptr && PySequence_Check(first);
+	Py_XDECREF(first);
+	if (!nested) {
+		res.rows = 1;
+		if (!readSequenceRow(obj, name, res.data)) {
+			return false;
+		}
+		res.cols = res.data.size();
+		return true;
+	}
+
+	res.rows = n;
+	res.data.clear();
+	std::vector<double> row;
+	for (Py_ssize_t i = 0; i < n; i++) {
+		PyObject *item = PySequence_GetItem(obj, i);
+		const bool ok = item != nullptr && readSequenceRow(item, name, row);
+		Py_XDECREF(item);
+		if (!ok) {
+			return false;
+		}
+		if (i == 0) {
+			res.cols = row.size();
+		} else if (row.size() != res.cols) {
+			PyErr_Format(PyExc_ValueError, "rows of %s differ in length",
+			             name);
+			return false;
+		}
+		res.data.insert(res.data.end(), row.begin(), row.end());
+	}
+	return true;
+}
+
+/**
+ * Reads a batch of parameter sets. Each row either contains the Parameters::Size
+ * entries of the full parameter set or the WorkingParameters::Size entries of
+ * the DoF reduced working parameter set.
+ *
+ * @param full is set to true if the full parameter sets were given.
+ */
+static bool readParameters(PyObject *obj, std::vector<Parameters> &params,
+                           std::vector<WorkingParameters> &working,
+                           bool &full)
+{
+	InputArray arr;
+	if (!readArray(obj, "params", arr)) {
+		return false;
+	}
+	if (arr.cols != Parameters::Size && arr.cols != WorkingParameters::Size) {
+		PyErr_Format(PyExc_ValueError,
+		             "params must have %d (full parameters) or %d (working "
+		             "parameters) columns",
+		             int(Parameters::Size), int(WorkingParameters::Size));
+		return false;
+	}
+
+	full = arr.cols == Parameters::Size;
+	params.resize(arr.rows);
+	working.resize(arr.rows);
+	for (size_t i = 0; i < arr.rows; i++) {
+		if (full) {
+			for (size_t j = 0; j < Parameters::Size; j++) {
+				params[i][j] = arr(i, j);
+			}
+			working[i] = WorkingParameters(params[i]);
+		} else {
+			for (size_t j = 0; j < WorkingParameters::Size; j++) {
+				working[i][j] = arr(i, j);
+			}
+			working[i].update();
+			params[i] = working[i].toParameters(DefaultParameters::cM,
+			                                    DefaultParameters::eL);
+		}
+	}
+	return true;
+}
+
+/**
+ * Reads an input spike train given as an array with the spike times in
+ * seconds in the first and the relative synaptic weights in the second column.
+ */
+static bool readSpikes(PyObject *obj, SpikeVec &spikes)
+{
+	InputArray arr;
+	if (!readArray(obj, "spikes", arr)) {
+		return false;
+	}
+	if (arr.cols != 2 && arr.data.size() > 0) {
+		PyErr_SetString(PyExc_ValueError,
+		                "spikes must have two columns (time, weight)");
+		return false;
+	}
+	spikes.clear();
+	for (size_t i = 0; i < arr.data.size() / 2; i++) {
+		spikes.emplace_back(Time::sec(arr(i, 0)), arr(i, 1));
+	}
+	std::stable_sort(spikes.begin(), spikes.end(),
+	                 [](const Spike &a, const Spike &b) { return a.t < b.t; });
+	return true;
+}
+
+/**
+ * Replaces the spikes of the given spike train with the given spikes. Each row
+ * of the ranges array contains the start time of a range in seconds and the
+ * number of expected output spikes, the last row marks the end of the spike
+ * train.
+ */
+static bool readSpikeTrain(PyObject *spikesObj, PyObject *rangesObj,
+                           SpikeTrain &train)
+{
+	SpikeVec spikes;
+	InputArray arr;
+	if (!readSpikes(spikesObj, spikes) ||
+	    !readArray(rangesObj, "ranges", arr)) {
+		return false;
+	}
+	if (arr.cols != 2 || arr.rows < 2) {
+		PyErr_SetString(PyExc_ValueError,
+		                "ranges must have two columns (start, expected output "
+		                "spike count) and at least two rows");
+		return false;
+	}
+
+	std::vector<SpikeTrain::Range> ranges;
+	std::vector<size_t> rangeStartSpikes;
+	for (size_t i = 0; i < arr.rows; i++) {
+		const Time start = Time::sec(arr(i, 0));
+		if (i > 0 && start < ranges.back().start) {
+			PyErr_SetString(PyExc_ValueError, "ranges must be sorted");
+			return false;
+		}
+		if (i + 1 < arr.rows) {
+			ranges.emplace_back(start, i, i, size_t(std::max(0.0, arr(i, 1))));
+			rangeStartSpikes.emplace_back(std::distance(
+			    spikes.begin(),
+			    std::lower_bound(spikes.begin(), spikes.end(), Spike(start))));
+		} else {
+			ranges.emplace_back(start, i, 0, 0);
+		}
+	}
+	train.restore(spikes, ranges, rangeStartSpikes);
+	return true;
+}
+
+/**
+ * Looks up the given name in the list of names, sets a Python exception if the
+ * name was not found.
+ */
+static bool lookup(PyObject *obj, const char *name,
+                   const std::vector<std::string> &names, size_t &idx)
+{
+	const char *s = PyUnicode_AsUTF8(obj);
+	if (s == nullptr) {
+		return false;
+	}
+	auto it = std::find(names.begin(), names.end(), s);
+	if (it == names.end()) {
+		std::string valid;
+		for (const std::string &n : names) {
+			valid += (valid.empty() ? "" : ", ") + n;
+		}
+		PyErr_Format(PyExc_ValueError, "%s must be one of %s", name,
+		             valid.c_str());
+		return false;
+	}
+	idx = std::distance(names.begin(), it);
+	return true;
+}
+
+/**
+ * Creates the ParameterCollection describing the model and evaluation setup.
+ * The collection is loaded from the given JSON string (as written by the GUI)
+ * if present, the other arguments override individual settings.
+ */
+static bool readCollection(PyObject *config, PyObject *model,
+                           PyObject *evaluation, PyObject *spikes,
+                           PyObject *ranges, long seed,
+                           ParameterCollection &pc)
+{
+	if (config != nullptr && config != Py_None) {
+		const char *json = PyUnicode_AsUTF8(config);
+		if (json == nullptr) {
+			return false;
+		}
+		std::istringstream is(json);
+		if (!JsonIo::loadParameters(is, pc)) {
+			PyErr_SetString(PyExc_ValueError, "Invalid configuration");
+			return false;
+		}
+	}
+
+	size_t idx;
+	if (model != nullptr && model != Py_None) {
+		if (!lookup(model, "model", ParameterCollection::modelNames, idx)) {
+			return false;
+		}
+		pc.model = ModelType(idx);
+	}
+	if (evaluation != nullptr && evaluation != Py_None) {
+		if (!lookup(evaluation, "evaluation",
+		            ParameterCollection::evaluationNames, idx)) {
+			return false;
+		}
+		pc.evaluation = EvaluationType(idx);
+	}
+
+	if (seed >= 0) {
+		pc.train.rebuild(seed);
+	}
+	const bool hasSpikes = spikes != nullptr && spikes != Py_None;
+	const bool hasRanges = ranges != nullptr && ranges != Py_None;
+	if (hasSpikes != hasRanges) {
+		PyErr_SetString(PyExc_ValueError,
+		                "spikes and ranges must be given together");
+		return false;
+	}
+	return !hasSpikes || readSpikeTrain(spikes, ranges, pc.train);
+}
+
+/**
+ * Calls the given function with the evaluation selected in the given
+ * ParameterCollection.
+ */
+template <typename F>
+static void withEvaluation(const ParameterCollection &pc, F f)
+{
+	const bool useIfCondExp = pc.model == ModelType::IF_COND_EXP;
+	switch (pc.evaluation) {
+		case EvaluationType::SPIKE_TRAIN:
+			f(SpikeTrainEvaluation(pc.train, useIfCondExp));
+			break;
+		case EvaluationType::SINGLE_GROUP_SINGLE_OUT:
+			f(SingleGroupSingleOutEvaluation(pc.environment, pc.singleGroup,
+			                                 useIfCondExp));
+			break;
+		case EvaluationType::SINGLE_GROUP_MULTI_OUT:
+			f(SingleGroupMultiOutEvaluation(pc.environment, pc.singleGroup,
+			                                useIfCondExp));
+			break;
+	}
+}
+
+/**
+ * Runs the given function with the GIL released. C++ exceptions are converted
+ * to a Python RuntimeError.
+ */
+template <typename F>
+static bool runWithoutGIL(F f)
+{
+	std::string error;
+	Py_BEGIN_ALLOW_THREADS;
+	try {
+		f();
+	}
+	catch (const std::exception &e) {
+		error = e.what();
+	}
+	Py_END_ALLOW_THREADS;
+	if (!error.empty()) {
+		PyErr_SetString(PyExc_RuntimeError, error.c_str());
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Module functions
+ */
+
+/**
+ * Recorder storing the rescaled neuron state in separate vectors.
+ */
+class ColumnRecorder : public RecorderBase<ColumnRecorder> {
+public:
+	friend RecorderBase<ColumnRecorder>;
+
+	std::vector<double> ts;
+	std::vector<Val> v, gE, gI, w, iL, iE, iI, iTh;
+	std::vector<double> outputSpikeTimes;
+
+	ColumnRecorder(const Parameters &params, Time interval)
+	    : RecorderBase<ColumnRecorder>(params, interval)
+	{
+	}
+
+	void outputSpike(Time t, const State &)
+	{
+		outputSpikeTimes.push_back(t.sec());
+	}
+
+private:
+	void doRecord(Time t, Val v, Val gE, Val gI, Val w, Val iL, Val iE,
+	              Val iI, Val iTh)
+	{
+		this->ts.push_back(t.sec());
+		this->v.push_back(v);
+		this->gE.push_back(gE);
+		this->gI.push_back(gI);
+		this->w.push_back(w);
+		this->iL.push_back(iL);
+		this->iE.push_back(iE);
+		this->iI.push_back(iI);
+		this->iTh.push_back(iTh);
+	}
+};
+
+/**
+ * Moves the given vector into a new one-dimensional array and stores it in
+ * the dictionary.
+ */
+template <typename T>
+static bool setItem(PyObject *dict, const char *key, std::vector<T> &vec)
+{
+	const size_t n = vec.size();
+	PyObject *arr = wrap<T>(std::move(vec), n);
+	if (arr == nullptr) {
+		return false;
+	}
+	const bool ok = PyDict_SetItemString(dict, key, arr) == 0;
+	Py_DECREF(arr);
+	return ok;
+}
+
+static const char *simulateDoc =
+    "simulate(params, spikes, t_end, model='IfCondExp', interval=0.0)\n\n"
+    "Simulates a single neuron for the given parameter set and input spikes\n"
+    "(rows of time in seconds and relative weight) until t_end seconds.\n"
+    "Returns a dictionary containing the recorded time 't', membrane\n"
+    "potential 'v', conductances 'gE', 'gI', currents 'w', 'iL', 'iE', 'iI',\n"
+    "'iTh' and the output spike times 'spikes'. The state is recorded at\n"
+    "most every 'interval' seconds.";
+
+static PyObject *simulate(PyObject *, PyObject *args, PyObject *kwargs)
+{
+	static const char *keywords[] = {"params", "spikes",   "t_end",
+	                                 "model",  "interval", nullptr};
+	PyObject *paramsObj, *spikesObj, *model = nullptr;
+	double tEnd, interval = 0.0;
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOd|Od",
+	                                 const_cast<char **>(keywords),
+	                                 &paramsObj, &spikesObj, &tEnd, &model,
+	                                 &interval)) {
+		return nullptr;
+	}
+
+	std::vector<Parameters> params;
+	std::vector<WorkingParameters> working;
+	bool full;
+	SpikeVec spikes;
+	ParameterCollection pc;
+	if (!readParameters(paramsObj, params, working, full) ||
+	    !readSpikes(spikesObj, spikes) ||
+	    !readCollection(nullptr, model, nullptr, nullptr, nullptr, -1, pc)) {
+		return nullptr;
+	}
+	if (params.size() != 1) {
+		PyErr_SetString(PyExc_ValueError,
+		                "simulate expects a single parameter set");
+		return nullptr;
+	}
+
+	ColumnRecorder recorder(params[0], Time::sec(interval));
+	const bool ok = runWithoutGIL([&]() {
+		NullController controller;
+		DormandPrinceIntegrator integrator;
+		if (pc.model == ModelType::IF_COND_EXP) {
+			Model::simulate<Model::IF_COND_EXP>(spikes, recorder, controller,
+			                                    integrator, working[0],
+			                                    Time(-1), Time::sec(tEnd));
+		} else {
+			Model::simulate<Model::FAST_EXP>(spikes, recorder, controller,
+			                                 integrator, working[0], Time(-1),
+			                                 Time::sec(tEnd));
+		}
+	});
+	if (!ok) {
+		return nullptr;
+	}
+
+	PyObject *res = PyDict_New();
+	if (res == nullptr || !setItem(res, "t", recorder.ts) ||
+	    !setItem(res, "v", recorder.v) || !setItem(res, "gE", recorder.gE) ||
+	    !setItem(res, "gI", recorder.gI) || !setItem(res, "w", recorder.w) ||
+	    !setItem(res, "iL", recorder.iL) || !setItem(res, "iE", recorder.iE) ||
+	    !setItem(res, "iI", recorder.iI) ||
+	    !setItem(res, "iTh", recorder.iTh) ||
+	    !setItem(res, "spikes", recorder.outputSpikeTimes)) {
+		Py_XDECREF(res);
+		return nullptr;
+	}
+	return res;
+}
+
+static const char *evaluateDoc =
+    "evaluate(params, evaluation=None, model=None, config=None, spikes=None,\n"
+    "         ranges=None, seed=-1)\n\n"
+    "Evaluates a batch of parameter sets (one per row, either the full\n"
+    "parameter set or the working parameters) and returns an array with one\n"
+    "row per parameter set and one column per evaluation result dimension\n"
+    "(see descriptor()). The setup is read from the JSON configuration\n"
+    "written by the GUI, 'evaluation' (Train, SgSo, SgMo) and 'model'\n"
+    "(IfCondExp, AdIfCondExp) override the configuration. For the Train\n"
+    "evaluation, 'spikes' and 'ranges' (rows of start time and number of\n"
+    "expected output spikes, the last row marks the end) replace the spike\n"
+    "train, 'seed' regenerates it reproducibly.";
+
+static PyObject *evaluate(PyObject *, PyObject *args, PyObject *kwargs)
+{
+	static const char *keywords[] = {"params", "evaluation", "model",
+	                                 "config", "spikes",     "ranges",
+	                                 "seed",   nullptr};
+	PyObject *paramsObj, *evaluation = nullptr, *model = nullptr,
+	                     *config = nullptr, *spikes = nullptr,
+	                     *ranges = nullptr;
+	long seed = -1;
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOOOOl",
+	                                 const_cast<char **>(keywords),
+	                                 &paramsObj, &evaluation, &model, &config,
+	                                 &spikes, &ranges, &seed)) {
+		return nullptr;
+	}
+
+	std::vector<Parameters> params;
+	std::vector<WorkingParameters> working;
+	bool full;
+	ParameterCollection pc;
+	if (!readParameters(paramsObj, params, working, full) ||
+	    !readCollection(config, model, evaluation, spikes, ranges, seed, pc)) {
+		return nullptr;
+	}
+
+	// Evaluate directly into the output buffer
+	std::vector<Val> out;
+	size_t nDims = 0;
+	const bool ok = runWithoutGIL([&]() {
+		withEvaluation(pc, [&](const auto &eval) {
+			nDims = eval.descriptor().size();
+			out.resize(working.size() * nDims);
+			for (size_t i = 0; i < working.size(); i++) {
+				eval.evaluateInto(working[i], out.data() + i * nDims);
+			}
+		});
+	});
+	if (!ok) {
+		return nullptr;
+	}
+	return wrap<Val>(std::move(out), nDims, working.size());
+}
+
+static const char *exploreDoc =
+    "explore(params, dim_x, dim_y, range_x, range_y, evaluation=None,\n"
+    "        model=None, config=None, spikes=None, ranges=None, seed=-1,\n"
+    "        threads=0)\n\n"
+    "Explores the parameter space around the given parameter set by varying\n"
+    "the parameters with the indices dim_x and dim_y in the given ranges\n"
+    "(tuples of min, max and number of steps). Indices refer to the full\n"
+    "parameter set if the full parameter set is given, to the working\n"
+    "parameters otherwise. Returns a dictionary mapping the ids of the\n"
+    "evaluation result dimensions to arrays with one row per y-step. All\n"
+    "other arguments are the same as for evaluate(), 'threads' is the number\n"
+    "of threads (zero for one per core).";
+
+static PyObject *explore(PyObject *, PyObject *args, PyObject *kwargs)
+{
+	static const char *keywords[] = {
+	    "params", "dim_x",  "dim_y",  "range_x", "range_y", "evaluation",
+	    "model",  "config", "spikes", "ranges",  "seed",    "threads",
+	    nullptr};
+	PyObject *paramsObj, *evaluation = nullptr, *model = nullptr,
+	                     *config = nullptr, *spikes = nullptr,
+	                     *ranges = nullptr;
+	unsigned int dimX, dimY, stepsX, stepsY, threads = 0;
+	double minX, maxX, minY, maxY;
+	long seed = -1;
+	if (!PyArg_ParseTupleAndKeywords(
+	        args, kwargs, "OII(ddI)(ddI)|OOOOOlI",
+	        const_cast<char **>(keywords), &paramsObj, &dimX, &dimY, &minX,
+	        &maxX, &stepsX, &minY, &maxY, &stepsY, &evaluation, &model,
+	        &config, &spikes, &ranges, &seed, &threads)) {
+		return nullptr;
+	}
+
+	std::vector<Parameters> params;
+	std::vector<WorkingParameters> working;
+	bool full;
+	ParameterCollection pc;
+	if (!readParameters(paramsObj, params, working, full) ||
+	    !readCollection(config, model, evaluation, spikes, ranges, seed, pc)) {
+		return nullptr;
+	}
+	const size_t nParams = full ? Parameters::Size : WorkingParameters::Size;
+	if (params.size() != 1 || dimX >= nParams || dimY >= nParams ||
+	    stepsX == 0 || stepsY == 0) {
+		PyErr_SetString(PyExc_ValueError,
+		                "explore expects a single parameter set, valid "
+		                "dimensions and a positive number of steps");
+		return nullptr;
+	}
+
+	ExplorationMemory mem;
+	const bool ok = runWithoutGIL([&]() {
+		const DiscreteRange rangeX(minX, maxX, stepsX);
+		const DiscreteRange rangeY(minY, maxY, stepsY);
+		Exploration exploration =
+		    full ? Exploration(true, params[0], dimX, dimY, rangeX, rangeY)
+		         : Exploration(working[0], dimX, dimY, rangeX, rangeY);
+		exploration.setThreadCount(threads);
+		withEvaluation(pc, [&](const auto &eval) { exploration.run(eval); });
+		mem = exploration.mem();
+	});
+	if (!ok) {
+		return nullptr;
+	}
+
+	// Hand the matrices over to the result arrays, the memory is not copied
+	// as the exploration instance has already been destroyed
+	PyObject *res = PyDict_New();
+	for (size_t i = 0; res != nullptr && i < mem.size(); i++) {
+		Matrix m = mem.compressed() ? mem.matrix(i) : std::move(mem.data[i]);
+		Val *data = m.data();
+		PyObject *arr = wrap<Val>(std::move(m), stepsX, stepsY, data);
+		if (arr == nullptr ||
+		    PyDict_SetItemString(res, mem.descriptor.id(i).c_str(), arr) != 0) {
+			Py_XDECREF(arr);
+			Py_DECREF(res);
+			return nullptr;
+		}
+		Py_DECREF(arr);
+	}
+	return res;
+}
+
+static const char *descriptorDoc =
+    "descriptor(evaluation=None, model=None, config=None)\n\n"
+    "Returns a list of (id, name, unit) tuples describing the result\n"
+    "dimensions of the selected evaluation.";
+
+static PyObject *descriptor(PyObject *, PyObject *args, PyObject *kwargs)
+{
+	static const char *keywords[] = {"evaluation", "model", "config",
+	                                 nullptr};
+	PyObject *evaluation = nullptr, *model = nullptr, *config = nullptr;
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOO",
+	                                 const_cast<char **>(keywords),
+	                                 &evaluation, &model, &config)) {
+		return nullptr;
+	}
+
+	ParameterCollection pc;
+	if (!readCollection(config, model, evaluation, nullptr, nullptr, -1, pc)) {
+		return nullptr;
+	}
+
+	EvaluationResultDescriptor descr;
+	withEvaluation(pc, [&](const auto &eval) { descr = eval.descriptor(); });
+	PyObject *res = PyList_New(descr.size());
+	for (size_t i = 0; res != nullptr && i < descr.size(); i++) {
+		PyList_SET_ITEM(res, i, Py_BuildValue("(sss)", descr.id(i).c_str(),
+		                                      descr.name(i).c_str(),
+		                                      descr.unit(i).c_str()));
+	}
+	return res;
+}
+
+static const char *parametersDoc =
+    "parameters(working=False)\n\n"
+    "Returns a tuple containing the list of parameter ids and an array with\n"
+    "the default values of either the full parameter set or the working\n"
+    "parameters. The order defines the columns of the params argument and\n"
+    "the dimension indices passed to explore().";
+
+static PyObject *parameters(PyObject *, PyObject *args, PyObject *kwargs)
+{
+	static const char *keywords[] = {"working", nullptr};
+	int useWorking = 0;
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p",
+	                                 const_cast<char **>(keywords),
+	                                 &useWorking)) {
+		return nullptr;
+	}
+
+	const Parameters params;
+	const WorkingParameters working(params);
+	const std::vector<std::string> &ids =
+	    useWorking ? WorkingParameters::nameIds : Parameters::nameIds;
+	std::vector<Val> values(ids.size());
+	for (size_t i = 0; i < ids.size(); i++) {
+		values[i] = useWorking ? working[i] : params[i];
+	}
+
+	PyObject *list = PyList_New(ids.size());
+	for (size_t i = 0; list != nullptr && i < ids.size(); i++) {
+		PyList_SET_ITEM(list, i, PyUnicode_FromString(ids[i].c_str()));
+	}
+	PyObject *arr = list == nullptr ? nullptr
+	                                : wrap<Val>(std::move(values), ids.size());
+	if (arr == nullptr) {
+		Py_XDECREF(list);
+		return nullptr;
+	}
+	return Py_BuildValue("(NN)", list, arr);
+}
+
+/**
+ * Converts a function taking keyword arguments to the PyCFunction type stored
+ * in the method table.
+ */
+static PyCFunction method(PyObject *(*f)(PyObject *, PyObject *, PyObject *))
+{
+	return reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(f));
+}
+
+static PyMethodDef methods[] = {
+    {"parameters", method(parameters),
+     METH_VARARGS | METH_KEYWORDS, parametersDoc},
+    {"simulate", method(simulate),
+     METH_VARARGS | METH_KEYWORDS, simulateDoc},
+    {"evaluate", method(evaluate),
+     METH_VARARGS | METH_KEYWORDS, evaluateDoc},
+    {"explore", method(explore),
+     METH_VARARGS | METH_KEYWORDS, exploreDoc},
+    {"descriptor", method(descriptor),
+     METH_VARARGS | METH_KEYWORDS, descriptorDoc},
+    {nullptr, nullptr, 0, nullptr}};
+
+static PyModuleDef module = {PyModuleDef_HEAD_INIT,
+                             "adexpsim",
+                             "Python bindings for the AdExpSim simulator",
+                             -1,
+                             methods,
+                             nullptr,
+                             nullptr,
+                             nullptr,
+                             nullptr};
+}
+
+PyMODINIT_FUNC PyInit_adexpsim()
+{
+	using namespace AdExpSim;
+
+	ArrayBufferProcs.bf_getbuffer = arrayGetBuffer;
+	ArrayType.tp_name = "adexpsim.Array";
+	ArrayType.tp_basicsize = sizeof(ArrayObject);
+	ArrayType.tp_dealloc = arrayDealloc;
+	ArrayType.tp_as_buffer = &ArrayBufferProcs;
+	ArrayType.tp_flags = Py_TPFLAGS_DEFAULT;
+	ArrayType.tp_doc = "Array owning memory written by AdExpSim";
+	if (PyType_Ready(&ArrayType) < 0) {
+		return nullptr;
+	}
+
+	PyObject *m = PyModule_Create(&module);
+	if (m == nullptr) {
+		return nullptr;
+	}
+	// PyModule_AddObject only steals the reference on success
+	PyObject *type = &ArrayType.ob_base.ob_base;
+	Py_INCREF(type);
+	if (PyModule_AddObject(m, "Array", type) < 0) {
+		Py_DECREF(type);
+		Py_DECREF(m);
+		return nullptr;
+	}
+	return m;
+}